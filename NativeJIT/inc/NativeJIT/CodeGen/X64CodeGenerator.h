@@ -104,6 +104,8 @@ namespace NativeJIT
         Not,
         Or,
         Pop,
+        PrefetchNta,    // Prefetch to all cache levels, non-temporal.
+        PrefetchT0,     // Prefetch to all cache levels.
         Push,
         Rep,
         Ret,
@@ -204,6 +206,14 @@ namespace NativeJIT
                   SIB scale,
                   int32_t offset);
 
+        // Single memory operand with scale-index-base (SIB) + offset (e.g.
+        // prefetchnta, prefetcht0).
+        template <OpCode OP>
+        void Emit(Register<8, false> base,
+                  Register<8, false> index,
+                  SIB scale,
+                  int32_t offset);
+
         // Two operands - indirect destination and register source with the same type and size.
         template <OpCode OP, unsigned SIZE, bool ISFLOAT>
         void Emit(Register<8, false> dest, int32_t destOffset, Register<SIZE, ISFLOAT> src);
@@ -265,6 +275,14 @@ namespace NativeJIT
         void Pop(Register<8, false> r);
         void Push(Register<8, false> r);
 
+        // Emits 0F 18 /hint with a SIB memory operand. The hint selects the
+        // prefetch flavor (0 = nta, 1 = t0, 2 = t1, 3 = t2).
+        void Prefetch(uint8_t hint,
+                      Register<8, false> base,
+                      Register<8, false> index,
+                      SIB scale,
+                      int32_t offset);
+
         void Ret();
 
         template <unsigned SIZE>
@@ -499,6 +517,12 @@ namespace NativeJIT
         {
             static void Emit(X64CodeGenerator& code);
 
+            static void Emit(X64CodeGenerator& code,
+                             Register<8, false> base,
+                             Register<8, false> index,
+                             SIB scale,
+                             int32_t offset);
+
             struct ArgTypes0
             {
                 template <unsigned SIZE>
@@ -605,6 +629,12 @@ namespace NativeJIT
 
             void Print(OpCode op);
 
+            void Print(OpCode op,
+                       Register<8u, false> base,
+                       Register<8u, false> index,
+                       SIB scale,
+                       int32_t offset);
+
             template <unsigned SIZE>
             void Print(OpCode op, Register<8u, false> base, int32_t offset);
 
@@ -1118,6 +1148,20 @@ namespace NativeJIT
     }
 
 
+    template <OpCode OP>
+    void X64CodeGenerator::Emit(Register<8, false> base,
+                                Register<8, false> index,
+                                SIB scale,
+                                int32_t offset)
+    {
+        CodePrinter printer(*this);
+
+        Helper<OP>::Emit(*this, base, index, scale, offset);
+
+        printer.Print(OP, base, index, scale, offset);
+    }
+
+
     template <OpCode OP, unsigned SIZE, bool ISFLOAT>
     void X64CodeGenerator::Emit(Register<8, false> dest, int32_t destOffset, Register<SIZE, ISFLOAT> src)
     {
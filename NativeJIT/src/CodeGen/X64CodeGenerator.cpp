@@ -149,6 +149,8 @@ namespace NativeJIT
             "not",
             "or",
             "pop",
+            "prefetchnta",
+            "prefetcht0",
             "push",
             "rep",
             "ret",
@@ -249,6 +251,47 @@ namespace NativeJIT
     }
 
 
+    void X64CodeGenerator::Prefetch(uint8_t hint,
+                                    Register<8, false> base,
+                                    Register<8, false> index,
+                                    SIB scale,
+                                    int32_t offset)
+    {
+        // An index field of 4 (rsp) means "no index" in the SIB byte.
+        LogThrowAssert(index.GetId() != 4, "rsp cannot be used as an index register");
+
+        if (index.IsExtended() || base.IsExtended())
+        {
+            Emit8(0x40
+                  | (index.IsExtended() ? 2 : 0)
+                  | (base.IsExtended() ? 1 : 0));
+        }
+
+        Emit8(0x0f);
+        Emit8(0x18);
+
+        // With mod 0, a base field of 5 (rbp, r13) means "disp32, no base", so
+        // those registers always need an explicit displacement.
+        uint8_t mod = Mod(offset);
+        if (mod == 0 && base.GetId8() == 5)
+        {
+            mod = 1;
+        }
+
+        Emit8((mod << 6) | (hint << 3) | 4);
+        Emit8((static_cast<uint8_t>(scale) << 6) | (index.GetId8() << 3) | base.GetId8());
+
+        if (mod == 1)
+        {
+            Emit8(static_cast<uint8_t>(offset));
+        }
+        else if (mod == 2)
+        {
+            Emit32(offset);
+        }
+    }
+
+
     void X64CodeGenerator::Ret()
     {
         Emit8(0xc3);
@@ -287,6 +330,26 @@ namespace NativeJIT
     }
 
 
+    template <> void X64CodeGenerator::Helper<OpCode::PrefetchNta>::Emit(X64CodeGenerator& code,
+                                                                         Register<8, false> base,
+                                                                         Register<8, false> index,
+                                                                         SIB scale,
+                                                                         int32_t offset)
+    {
+        code.Prefetch(0, base, index, scale, offset);
+    }
+
+
+    template <> void X64CodeGenerator::Helper<OpCode::PrefetchT0>::Emit(X64CodeGenerator& code,
+                                                                        Register<8, false> base,
+                                                                        Register<8, false> index,
+                                                                        SIB scale,
+                                                                        int32_t offset)
+    {
+        code.Prefetch(1, base, index, scale, offset);
+    }
+
+
     template <> void X64CodeGenerator::Helper<OpCode::Rep>::Emit(X64CodeGenerator& code)
     {
         code.Emit8(0xf3);
@@ -437,6 +500,42 @@ namespace NativeJIT
     }
 
 
+    void X64CodeGenerator::CodePrinter::Print(OpCode op,
+                                              Register<8u, false> base,
+                                              Register<8u, false> index,
+                                              SIB scale,
+                                              int32_t offset)
+    {
+        if (m_out != nullptr)
+        {
+            IosMiniStateRestorer state(*m_out);
+
+            PrintBytes(m_startPosition, m_code.CurrentPosition());
+
+            *m_out << OpCodeName(op)
+                   << " byte ptr ["
+                   << base.GetName()
+                   << " + "
+                   << index.GetName()
+                   << " * "
+                   << (1u << static_cast<unsigned>(scale))
+                   << std::uppercase
+                   << std::hex;
+
+            if (offset > 0)
+            {
+                *m_out << " + " << offset << "h";
+            }
+            else if (offset < 0)
+            {
+                *m_out << " - " << -static_cast<int64_t>(offset) << "h";
+            }
+
+            *m_out << "]" << std::endl;
+        }
+    }
+
+
     char const * X64CodeGenerator::CodePrinter::GetPointerName(unsigned pointerSize)
     {
         switch (pointerSize)
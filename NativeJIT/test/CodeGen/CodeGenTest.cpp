@@ -140,6 +140,11 @@ namespace NativeJIT
             buffer.Emit<OpCode::And>(rdi, rdx, SIB::Scale4, 0x5678, rax);
             buffer.Emit<OpCode::And>(rdi, rdx, SIB::Scale8, 0x5678, rax);
 
+            // Prefetch (SIB addressing mode, memory operand only)
+            buffer.Emit<OpCode::PrefetchNta>(rsi, rcx, SIB::Scale8, 0x1234);
+            buffer.Emit<OpCode::PrefetchT0>(r14, r13, SIB::Scale8, 0x40);
+            buffer.Emit<OpCode::PrefetchT0>(r13, rcx, SIB::Scale1, 0);
+
             // Another special case
             buffer.Emit<OpCode::Add>(r13, r13, 0);
             buffer.Emit<OpCode::Mov>(r13, r13, 0);
@@ -851,6 +856,15 @@ namespace NativeJIT
                 "           00005678                                                                                \n"
 
 
+                // Prefetch
+                " 00000170  0F 18 84 CE          prefetchnta [rsi + rcx * 8 + 1234h]                                \n"
+                "           00001234                                                                                \n"
+                " 00000178  43/ 0F 18 4C EE      prefetcht0 [r14 + r13 * 8 + 40h]                                   \n"
+                "           40                                                                                      \n"
+                " 0000017E  41/ 0F 18 4C 0D      prefetcht0 [r13 + rcx * 1]                                         \n"
+                "           00                                                                                      \n"
+
+
                 "                                ; Another special case                                             \n"
                 " 00000000  4D/ 03 6D 00         add r13, [r13]                                                     \n"
                 " 00000000  4D/ 8B 6D 00         mov r13, [r13]                                                     \n"
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <mutex>                                // std::mutex member.
+
 #include "BitFunnel/Utilities/Random.h"         // RandomReal embedded.
 #include "BitFunnel/Chunks/IChunkProcessor.h"   // Base class.
 
@@ -55,7 +57,9 @@ namespace BitFunnel
     //
     // Keeps a document with probability equal to the fraction passed to the
     // constructor. Constructor takes a random number generator seed to allow
-    // for reproducibility from run to run.
+    // for reproducibility from run to run. KeepDocument() may be called from
+    // several threads, but the sample is then only reproducible if the
+    // documents arrive in the same order.
     //
     //*************************************************************************
     class RandomDocumentFilter : public IDocumentFilter
@@ -67,6 +71,8 @@ namespace BitFunnel
 
     private:
         const double m_fraction;
+
+        std::mutex m_lock;
         RandomReal<double> m_engine;
     };
 
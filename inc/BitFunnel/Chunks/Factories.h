@@ -32,6 +32,7 @@
 
 namespace BitFunnel
 {
+    class IChunkIngestionPipeline;
     class IChunkManifestIngestor;
     class IConfiguration;
     class IDocument;
@@ -39,6 +40,7 @@ namespace BitFunnel
     class IFileManager;
     class IFileSystem;
     class IIngestor;
+    class IStreamingStatistics;
 
     namespace Factories
     {
@@ -50,6 +52,33 @@ namespace BitFunnel
                 bool cacheDocuments);
 
 
+        // Returns an IChunkIngestionPipeline that ingests the chunks in
+        // filePaths with one reader thread, one splitter thread, and
+        // threadCount indexing threads.
+        std::unique_ptr<IChunkIngestionPipeline>
+            CreateChunkIngestionPipeline(
+                IFileSystem& fileSystem,
+                std::vector<std::string> const & filePaths,
+                IConfiguration const & config,
+                IIngestor& ingestor,
+                IDocumentFilter & filter,
+                bool cacheDocuments,
+                size_t threadCount);
+
+
+        // Returns an IChunkManifestIngestor that converts each chunk to the
+        // hashed chunk format, writing it to outputFiles.Chunk(index). When
+        // expandNGrams is true, the hashed chunks hold the postings formed
+        // with the gram size and IDF table of config.
+        std::unique_ptr<IChunkManifestIngestor>
+            CreateChunkManifestHasher(
+                IFileSystem& fileSystem,
+                IFileManager& outputFiles,
+                std::vector<std::string> const & filePaths,
+                IConfiguration const & config,
+                bool expandNGrams);
+
+
         std::unique_ptr<IChunkManifestIngestor>
             CreateChunkManifestIngestor(
                 IFileSystem& fileSystem,
@@ -61,6 +90,17 @@ namespace BitFunnel
                 bool cacheDocuments);
 
 
+        // Returns an IChunkManifestIngestor that records the documents in
+        // each chunk in an IStreamingStatistics instead of an index.
+        std::unique_ptr<IChunkManifestIngestor>
+            CreateChunkManifestStatistics(
+                IFileSystem& fileSystem,
+                std::vector<std::string> const & filePaths,
+                IConfiguration const & config,
+                IStreamingStatistics& statistics,
+                IDocumentFilter & filter);
+
+
         std::unique_ptr<IDocument>
             CreateDocument(IConfiguration const & configuration, DocId id);
     }
@@ -0,0 +1,55 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                   // std::ostream parameter.
+
+#include "BitFunnel/IInterface.h"   // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // IChunkIngestionPipeline
+    //
+    // Abstract base class or interface for classes that ingest a set of
+    // chunk files with separate stages for reading chunk files, splitting
+    // them into batches of documents, and indexing the batches. Stages run
+    // concurrently, connected by bounded queues, so I/O overlaps with
+    // indexing and all indexing threads stay busy until the last batch,
+    // regardless of the number and size of the chunk files.
+    //
+    //*************************************************************************
+    class IChunkIngestionPipeline : public IInterface
+    {
+    public:
+        // Ingests every chunk file. Returns once all of the documents have
+        // been added to the index.
+        virtual void Ingest() = 0;
+
+        // Writes the throughput of each stage and the depth of each queue
+        // during the most recent call to Ingest().
+        virtual void PrintStatistics(std::ostream & out) const = 0;
+    };
+}
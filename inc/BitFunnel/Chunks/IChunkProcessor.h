@@ -96,6 +96,15 @@ namespace BitFunnel
         virtual void OnDocumentEnter(DocId id) = 0;
         virtual void OnStreamEnter(Term::StreamId id) = 0;
         virtual void OnTerm(char const * term) = 0;
+
+        // Readers of the hashed chunk format call these methods instead of
+        // OnTerm(). OnTermHash() supplies the Term::ComputeRawHash() value of
+        // a single word, which still needs ngram expansion. OnPosting()
+        // supplies a posting from a chunk whose ngrams were expanded when it
+        // was converted.
+        virtual void OnTermHash(Term::Hash rawHash) = 0;
+        virtual void OnPosting(Term const & term) = 0;
+
         virtual void OnStreamExit() = 0;
         virtual void OnDocumentExit(IChunkWriter & writer,
                                     size_t bytesRead) = 0;
@@ -44,6 +44,10 @@ namespace BitFunnel
         virtual std::unique_ptr<std::istream>
             OpenForRead(char const * filename,
                         std::ios_base::openmode mode = std::ios::in) = 0;
+
+        // Removes a file. Throws RecoverableError if the file cannot be
+        // removed.
+        virtual void Delete(char const * filename) = 0;
     };
 }
 
@@ -78,11 +78,13 @@ namespace BitFunnel
         //virtual FileDescriptor0 CommonNegatedTerms() = 0;
         //virtual FileDescriptor0 CommonPhrases() = 0;
         //virtual FileDescriptor0 DocFreqTable() = 0;
+        virtual FileDescriptor0 BenchmarkResults() = 0;
         virtual FileDescriptor0 ColumnDensities() = 0;
         virtual FileDescriptor0 ColumnDensitySummary() = 0;
         virtual FileDescriptor0 DocumentHistogram() = 0;
         //virtual FileDescriptor0 L1RankerConfig() = 0;
         virtual FileDescriptor0 Manifest() = 0;
+        virtual FileDescriptor0 MatcherCodeCache() = 0;
         //virtual FileDescriptor0 Model() = 0;
         //virtual FileDescriptor0 PlanDescriptors() = 0;
         //virtual FileDescriptor0 PostingCounts() = 0;
@@ -111,11 +113,13 @@ namespace BitFunnel
         virtual FileDescriptor1 Chunk(size_t number) = 0;
         virtual FileDescriptor1 Correlate(size_t shard) = 0;
         virtual FileDescriptor1 CumulativeTermCounts(size_t shard) = 0;
+        virtual FileDescriptor1 DocFreqBounds(size_t shard) = 0;
         virtual FileDescriptor1 DocFreqTable(size_t shard) = 0;
         virtual FileDescriptor1 IndexedIdfTable(size_t shard) = 0;
         //virtual FileDescriptor1 DocTable(size_t shard) = 0;
         //virtual FileDescriptor1 ScoreTable(size_t shard) = 0;
         virtual FileDescriptor1 RowDensities(size_t shard) = 0;
+        virtual FileDescriptor1 TermCountRun(size_t run) = 0;
         virtual FileDescriptor1 TermTable(size_t shard) = 0;
         virtual FileDescriptor1 TermTableStatistics(size_t shard) = 0;
 
@@ -135,7 +139,7 @@ namespace BitFunnel
         // virtual std::unique_ptr<std::ostream> OpenTempForWrite() = 0;
         // virtual void Commit() = 0;
         // virtual bool Exists() = 0;
-        // virtual void Delete() = 0;
+        virtual void Delete() = 0;
     };
 
 
@@ -150,7 +154,7 @@ namespace BitFunnel
         // virtual std::unique_ptr<std::ostream> OpenTempForWrite(size_t p1) = 0;
         // virtual void Commit(size_t p1) = 0;
         // virtual bool Exists(size_t p1) = 0;
-        // virtual void Delete(size_t p1) = 0;
+        virtual void Delete(size_t p1) = 0;
     };
 
 
@@ -165,7 +169,7 @@ namespace BitFunnel
         // virtual std::unique_ptr<std::ostream> OpenTempForWrite(size_t p1, size_t p2) = 0;
         // virtual void Commit(size_t p1, size_t p2) = 0;
         // virtual bool Exists(size_t p1, size_t p2) = 0;
-        // virtual void Delete(size_t p1, size_t p2) = 0;
+        virtual void Delete(size_t p1, size_t p2) = 0;
     };
 
 
@@ -185,7 +189,7 @@ namespace BitFunnel
         // std::unique_ptr<std::ostream> OpenTempForWrite() { return m_file.OpenTempForWrite(); }
         // void Commit() { return m_file.Commit(); }
         // bool Exists() { return m_file.Exists(); }
-        // void Delete() { m_file.Delete(); }
+        void Delete() { m_file.Delete(); }
 
     private:
         IParameterizedFile0& m_file;
@@ -209,7 +213,7 @@ namespace BitFunnel
         // std::unique_ptr<std::ostream> OpenTempForWrite() { return m_file.OpenTempForWrite(m_p1); }
         // void Commit() { return m_file.Commit(m_p1); }
         // bool Exists() { return m_file.Exists(m_p1); }
-        // void Delete() { m_file.Delete(m_p1); }
+        void Delete() { m_file.Delete(m_p1); }
 
     private:
         IParameterizedFile1& m_file;
@@ -235,7 +239,7 @@ namespace BitFunnel
         // std::unique_ptr<std::ostream> OpenTempForWrite() { return m_file.OpenTempForWrite(m_p1, m_p2); }
         // void Commit() { return m_file.Commit(m_p1, m_p2); }
         // bool Exists() { return m_file.Exists(m_p1, m_p2); }
-        // void Delete() { m_file.Delete(m_p1, m_p2); }
+        void Delete() { m_file.Delete(m_p1, m_p2); }
 
     private:
         IParameterizedFile2& m_file;
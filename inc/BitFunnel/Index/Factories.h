@@ -49,6 +49,7 @@ namespace BitFunnel
     class IShardDefinition;
     class ISimpleIndex;
     class ISliceBufferAllocator;
+    class IStreamingStatistics;
     class ITermTable;
     class ITermTableCollection;
     class ITermTableBuilder;
@@ -56,16 +57,23 @@ namespace BitFunnel
     class ITermToText;
     class ITermTreatment;
     class ITermTreatmentFactory;
+    class ITermTreatmentSearch;
     class Slice;
 
     namespace Factories
     {
+        // Row densities are computed in parallel across slices, and column
+        // densities across documents, on threadCount threads.
         void AnalyzeRowTables(ISimpleIndex const & index,
-                              char const * outDir);
+                              char const * outDir,
+                              size_t threadCount);
 
+        // Row collisions are counted in parallel across shards and blocks of
+        // rows on threadCount threads.
         void CreateCorrelate(ISimpleIndex const & index,
                              char const * outDir,
-                             std::vector<std::string> const & terms);
+                             std::vector<std::string> const & terms,
+                             size_t threadCount);
 
         std::unique_ptr<IConfiguration>
             CreateConfiguration(size_t maxGramSize,
@@ -113,16 +121,29 @@ namespace BitFunnel
         std::unique_ptr<ISliceBufferAllocator>
             CreateSliceBufferAllocator(size_t blockSize, size_t blockCount);
 
+        // The in-memory term count table for each shard is spilled to disk
+        // as a sorted run once it holds maxTermsInMemory terms. The
+        // samplingRate is the fraction of the corpus that will be passed to
+        // IStreamingStatistics::AddDocument().
+        std::unique_ptr<IStreamingStatistics>
+            CreateStreamingStatistics(IFileManager & fileManager,
+                                      IShardDefinition const & shardDefinition,
+                                      size_t maxTermsInMemory,
+                                      double samplingRate);
+
         std::unique_ptr<ITermTable> CreateTermTable();
         std::unique_ptr<ITermTable> CreateTermTable(std::istream & input);
 
+        // Row assignment for different ranks runs concurrently on up to
+        // threadCount threads.
         std::unique_ptr<ITermTableBuilder>
             CreateTermTableBuilder(double density,
                                    double adhocFrequency,
                                    ITermTreatment const & treatment,
                                    IDocumentFrequencyTable const & terms,
                                    IFactSet const & facts,
-                                   ITermTable & termTable);
+                                   ITermTable & termTable,
+                                   size_t threadCount);
 
         std::unique_ptr<ITermTableCollection>
             CreateTermTableCollection();
@@ -134,6 +155,15 @@ namespace BitFunnel
 
         std::unique_ptr<ITermTreatmentFactory> CreateTreatmentFactory();
 
+        // Candidates must give every term an SNR of at least snr and use at
+        // most bitsPerDocumentBudget bits per document (zero for no
+        // budget). Rows above maxRank are not considered.
+        std::unique_ptr<ITermTreatmentSearch>
+            CreateTermTreatmentSearch(IDocumentFrequencyTable const & terms,
+                                      double snr,
+                                      double bitsPerDocumentBudget,
+                                      Rank maxRank);
+
         std::unique_ptr<ITermToText> CreateTermToText(std::istream & input);
     }
 }
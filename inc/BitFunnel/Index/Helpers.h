@@ -24,6 +24,7 @@
 
 
 #include <stddef.h>
+#include <stdint.h>
 
 namespace BitFunnel
 {
@@ -39,4 +40,9 @@ namespace BitFunnel
     // TODO: this number should get bigger as the corpus gets bigger.
     size_t GetReasonableBlockSize(IDocumentDataSchema const & schema,
                                   ITermTable const & termTable);
+
+    // Returns a hash of the serialized form of a term table. Files that are
+    // only valid for a particular term table can record this value and
+    // compare it at load time to detect that the term table was rebuilt.
+    uint64_t GetTermTableVersion(ITermTable const & termTable);
 }
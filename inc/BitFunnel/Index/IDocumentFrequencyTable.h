@@ -54,6 +54,11 @@ namespace BitFunnel
         virtual void Write(std::ostream & output,
                            ITermToText const * termToText) = 0;
 
+        // Sorts the entries by descending frequency then writes them to a
+        // stream in binary form. The binary form has no text column. It is
+        // accepted wherever the .csv form is.
+        virtual void WriteBinary(std::ostream & output) = 0;
+
         // Adds an Entry to the table. Note that this method does not guard
         // against duplicate Term::Hash values and it does not enforce any
         // ordering on the frequencies. Entries are sorted on write.
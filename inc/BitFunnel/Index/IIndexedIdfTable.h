@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <iosfwd>                       // std::ostream parameter.
+
 #include "BitFunnel/IInterface.h"       // Base class.
 #include "BitFunnel/Term.h"             // Term::Hash parameter..
 
@@ -32,5 +34,8 @@ namespace BitFunnel
     {
     public:
         virtual Term::IdfX10 GetIdf(Term::Hash) const = 0; 
+
+        // Writes the table in its binary form.
+        virtual void Write(std::ostream& output) const = 0;
     };
 }
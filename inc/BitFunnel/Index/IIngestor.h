@@ -37,8 +37,11 @@ namespace BitFunnel
     class IDocumentCache;
     class IFileManager;
     class IRecycler;
+    class IRowDensityMonitor;
     class ITokenManager;
     class IShard;
+    class IShardDefinition;
+    class ISliceCompactor;
     class ITermToText;
 
     // BITFUNNELTYPES
@@ -104,6 +107,22 @@ namespace BitFunnel
         // some of which may already have been deleted for other reasons.
         virtual bool Delete(DocId id) = 0;
 
+        // Replaces the document with the given id. When the document is in
+        // the index and its new posting count routes it to the same shard,
+        // its postings are replaced within its existing column, so no
+        // expired column is left behind, and this method returns true.
+        // Otherwise the document is deleted, if present, and added as a new
+        // document, and this method returns false. Either way the ingestion
+        // statistics count the new contents in place of the old ones.
+        //
+        // An in-place update clears the document-active bit before it
+        // rewrites the column and sets it again afterwards. Queries started
+        // after Update() returns see only the new contents. A query which
+        // overlaps the rewrite reads its rows at different times, so it may
+        // miss the document, or match it on a mix of old and new postings.
+        // Contains() returns true throughout.
+        virtual bool Update(DocId id, IDocument const & document) = 0;
+
         // Sets or clears a fact about a document with the given DocId. The
         // FactHandle must have been previously registered in the IFactSet,
         // otherwise the function throws.
@@ -136,6 +155,35 @@ namespace BitFunnel
         virtual size_t GetShardCount() const = 0;
         virtual IShard& GetShard(size_t shard) const = 0;
 
+        // Returns the number of documents currently active in a shard.
+        virtual size_t GetShardDocumentCount(size_t shard) const = 0;
+
+        // Returns the IShardDefinition currently used to route new
+        // documents to shards.
+        virtual IShardDefinition const & GetShardDefinition() const = 0;
+
+        // Recomputes the optimal shard definition from the posting counts of
+        // all documents ingested so far. The number of shards never grows
+        // because each shard has its own TermTable. New documents are routed
+        // by the new boundaries. Documents already in the index stay in
+        // their shards until they are deleted or expire.
+        virtual void RebalanceShards() = 0;
+
+        // Calls RebalanceShards() each time another documentInterval
+        // documents have been added. Zero, the default, disables periodic
+        // rebalancing.
+        virtual void SetShardRebalanceInterval(size_t documentInterval) = 0;
+
+        // Returns the monitor that samples the densities of shared rows in
+        // recently allocated slices. The monitor is idle until it is started
+        // or sampled, and is stopped by Shutdown().
+        virtual IRowDensityMonitor & GetRowDensityMonitor() const = 0;
+
+        // Returns the compactor that merges sparsely populated slices. The
+        // compactor is idle until it is started or run, and is stopped by
+        // Shutdown().
+        virtual ISliceCompactor & GetSliceCompactor() const = 0;
+
         virtual IRecycler& GetRecycler() const = 0;
 
         virtual ITokenManager& GetTokenManager() const = 0;
@@ -156,12 +204,21 @@ namespace BitFunnel
         //    - All future addition operations are done in this new group.
         //    - The previous group is closed. A closed group cannot be reopened or
         //      modified.
+        //    - Each group occupies whole slices. Opening a group seals the
+        //      slices which were receiving documents.
+        // Throws if groupId has been opened before and not yet expired.
         virtual void OpenGroup(GroupId groupId) = 0;
 
         // Closes the current group, if any.
         virtual void CloseGroup() = 0;
 
-        // Expires the group with the given id.
+        // Expires the group with the given id. The documents in the group are
+        // removed from serving and the group's slices are recycled as a whole,
+        // without looking up each document. Throws if the group is unknown or
+        // still open. Also throws RecoverableError, without expiring
+        // anything, while a call to Add() which began before the group was
+        // closed has not yet committed its document. The call may then be
+        // retried.
         virtual void ExpireGroup(GroupId groupId) = 0;
     };
 }
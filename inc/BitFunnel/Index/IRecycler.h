@@ -24,6 +24,7 @@
 #pragma once
 
 #include <memory>                   // std::shared_ptr is a parameter.
+#include <stddef.h>                 // size_t return value.
 
 #include "BitFunnel/IInterface.h"
 #include "BitFunnel/NonCopyable.h"
@@ -48,6 +49,15 @@ namespace BitFunnel
         // Recycler takes ownership of the resource.
         virtual void ScheduleRecyling(std::unique_ptr<IRecyclable>& resource) = 0;
 
+        // Returns the number of bytes held by resources which have been
+        // scheduled for recycling but not yet released. This method is
+        // thread-safe.
+        virtual size_t GetPendingByteCount() const = 0;
+
+        // Returns the number of resources which have been scheduled for
+        // recycling but not yet released. This method is thread-safe.
+        virtual size_t GetPendingItemCount() const = 0;
+
         virtual void Shutdown() = 0;
     };
 }
@@ -0,0 +1,105 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream parameter.
+#include <stddef.h>                     // size_t parameter.
+#include <vector>                       // std::vector return value.
+
+#include "BitFunnel/BitFunnelTypes.h"   // ShardId parameter.
+#include "BitFunnel/IInterface.h"       // Base class.
+#include "BitFunnel/Index/RowId.h"      // RowId embedded.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // IRowDensityMonitor
+    //
+    // Abstract base class or interface for classes that watch the densities
+    // of shared rows as documents are ingested. Shared rows degrade silently
+    // as term frequencies drift: when a row's density climbs above the
+    // target used to build the TermTable, the false positive rate and the
+    // quadwords scanned per query rise with it.
+    //
+    // Each sample estimates row densities over the most recently allocated
+    // slices of each shard, so that it reflects the current document mix
+    // rather than the whole history of the index. Private rows are ignored
+    // since their density is just the frequency of their term.
+    //
+    // Thread safety: all methods are thread safe.
+    //
+    //*************************************************************************
+    class IRowDensityMonitor : public IInterface
+    {
+    public:
+        // A shared row whose sampled density exceeds the alert density.
+        class OverfullRow
+        {
+        public:
+            ShardId m_shard;
+            RowId m_row;
+            double m_density;
+        };
+
+        // Sets the number of most recent slices sampled in each shard, the
+        // density above which a shared row is reported as overfull, and the
+        // maximum number of overfull rows reported.
+        virtual void Configure(size_t sliceCount,
+                               double alertDensity,
+                               size_t maxOverfullRows) = 0;
+
+        // Takes one sample now, replacing the previous results.
+        virtual void Sample() = 0;
+
+        // Starts a background thread that calls Sample() every
+        // intervalMilliseconds. Restarts the thread if it is already
+        // running.
+        virtual void Start(size_t intervalMilliseconds) = 0;
+
+        // Stops the background thread, if any, and waits for it to exit.
+        virtual void Stop() = 0;
+
+        // Returns true if the background thread is running.
+        virtual bool IsRunning() const = 0;
+
+        // Returns the number of samples taken so far.
+        virtual size_t GetSampleCount() const = 0;
+
+        // Returns a histogram of shared row densities from the latest
+        // sample, over all shards and ranks. Entry i counts the rows with
+        // density in [i / c_histogramBuckets, (i + 1) / c_histogramBuckets).
+        // The last entry also counts rows with density 1.
+        virtual std::vector<size_t> GetDensityHistogram() const = 0;
+
+        // Returns the shared rows whose density exceeded the alert density
+        // in the latest sample, most overfull first.
+        virtual std::vector<OverfullRow> GetOverfullRows() const = 0;
+
+        // Writes a human readable report of the latest sample.
+        virtual void Print(std::ostream& out) const = 0;
+
+        static const size_t c_histogramBuckets = 20;
+    };
+}
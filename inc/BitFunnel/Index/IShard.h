@@ -55,6 +55,17 @@ namespace BitFunnel
         // Returns the offset of the row in the slice buffer in a shard.
         virtual ptrdiff_t GetRowOffset(RowId rowId) const = 0;
 
+        // Returns true if the row has a summary bitmap. Each summary bit
+        // covers GetDocumentsPerSummaryBit() documents and is set if any of
+        // those documents might have the row's bit set.
+        virtual bool HasSummary(RowId rowId) const = 0;
+
+        // Returns the offset of the row's summary bitmap in the slice buffer.
+        // Only valid for rows where HasSummary() is true.
+        virtual ptrdiff_t GetSummaryOffset(RowId rowId) const = 0;
+
+        virtual size_t GetDocumentsPerSummaryBit() const = 0;
+
         virtual void TemporaryWriteDocumentFrequencyTable(
             std::ostream& out,
             ITermToText const * termToText) const = 0;
@@ -65,5 +76,11 @@ namespace BitFunnel
         // documents.
         virtual std::vector<double>
             GetDensities(Rank rank) const = 0;
+
+        // Like GetDensities(), but only over the sliceCount most recently
+        // allocated slices. Used to track densities as the document mix
+        // changes.
+        virtual std::vector<double>
+            GetRecentDensities(Rank rank, size_t sliceCount) const = 0;
     };
 }
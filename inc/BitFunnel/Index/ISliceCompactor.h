@@ -0,0 +1,81 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>                     // size_t parameter.
+
+#include "BitFunnel/IInterface.h"       // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // ISliceCompactor
+    //
+    // Abstract base class or interface for classes that merge sparsely
+    // populated slices. A slice is only recycled once every one of its
+    // documents has expired, so a slice with a handful of live documents
+    // costs as much memory and query time as a full one.
+    //
+    // A compaction pass copies the live documents of closed slices whose
+    // fraction of live documents is below a threshold into new slices and
+    // retires the old slices once the queries using them have drained.
+    // Queries running during a pass see each document exactly once. Slices
+    // are only merged with slices from the same group.
+    //
+    // Thread safety: all methods are thread safe.
+    //
+    //*************************************************************************
+    class ISliceCompactor : public IInterface
+    {
+    public:
+        // Sets the fraction of live documents below which a closed slice is
+        // compacted.
+        virtual void Configure(double minLiveRatio) = 0;
+
+        // Runs one compaction pass now. Returns the number of slices
+        // retired.
+        virtual size_t Compact() = 0;
+
+        // Starts a background thread that calls Compact() every
+        // intervalMilliseconds. Restarts the thread if it is already
+        // running.
+        virtual void Start(size_t intervalMilliseconds) = 0;
+
+        // Stops the background thread, if any, and waits for it to exit.
+        virtual void Stop() = 0;
+
+        // Returns true if the background thread is running.
+        virtual bool IsRunning() const = 0;
+
+        // Returns the number of compaction passes run so far.
+        virtual size_t GetPassCount() const = 0;
+
+        // Returns the total number of slices retired by compaction.
+        virtual size_t GetRetiredSliceCount() const = 0;
+
+        // Returns the total number of documents moved by compaction.
+        virtual size_t GetMovedDocumentCount() const = 0;
+    };
+}
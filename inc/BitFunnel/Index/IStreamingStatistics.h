@@ -0,0 +1,75 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>                     // size_t parameter.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/IInterface.h"       // Base class.
+#include "BitFunnel/Term.h"             // Term template parameter.
+
+
+namespace BitFunnel
+{
+    class ITermToText;
+
+    //*************************************************************************
+    //
+    // IStreamingStatistics
+    //
+    // Abstract base class or interface for classes that gather corpus
+    // statistics without building an index. Term counts are accumulated in a
+    // table of bounded size which is spilled to disk as a sorted run
+    // whenever it fills. WriteStatistics() merges the runs to produce the
+    // same files as IIngestor::WriteStatistics().
+    //
+    // Thread safety: AddDocument() is threadsafe. WriteStatistics() must not
+    // be called concurrently with AddDocument().
+    //
+    //*************************************************************************
+    class IStreamingStatistics : public IInterface
+    {
+    public:
+        // Records a document. The terms vector must contain each of the
+        // document's unique terms exactly once.
+        virtual void AddDocument(std::vector<Term> const & terms,
+                                 size_t sourceByteSize) = 0;
+
+        // Returns the number of documents recorded so far.
+        virtual size_t GetDocumentCount() const = 0;
+
+        // Returns the total number of bytes in the source representation of
+        // all documents recorded so far.
+        virtual size_t GetTotalSourceBytesIngested() const = 0;
+
+        // Returns the number of sorted runs spilled to disk so far.
+        virtual size_t GetRunCount() const = 0;
+
+        // Merges the sorted runs and writes out the DocumentHistogram and,
+        // for each shard, the CumulativeTermCounts, DocumentFrequencyTable
+        // and IndexedIdfTable. When the documents are a sample of the
+        // corpus, also writes the DocFreqBounds for each shard. Writes
+        // TermToText if termToText is not nullptr.
+        virtual void WriteStatistics(ITermToText const * termToText) = 0;
+    };
+}
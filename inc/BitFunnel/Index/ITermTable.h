@@ -23,6 +23,7 @@
 #pragma once
 
 #include <iosfwd>                                   // std::ostream parameter.
+#include <vector>                                   // std::vector return value.
 
 #include "BitFunnel/IInterface.h"                   // Base class.
 #include "BitFunnel/Index/PackedRowIdSequence.h"    // PackedRowIdSequence return value.
@@ -120,6 +121,13 @@ namespace BitFunnel
         // document using this TermTable.
         virtual double GetBytesPerDocument(Rank rank) const = 0;
 
+        // Returns one entry for each row at the specified rank, which is true
+        // if more than one term may set bits in the row. Adhoc rows are always
+        // shared. Explicit rows are shared when they appear in the rows of
+        // more than one explicit term. Walks every explicit term, so callers
+        // should cache the result.
+        virtual std::vector<bool> GetSharedRows(Rank rank) const = 0;
+
         // Returns a PackedRowIdSequence structure associated with the
         // specified term. The PackedRowIdSequence structure contains
         // information about the term's rows. PackedRowIdSequence is used
@@ -57,5 +57,9 @@ namespace BitFunnel
         //   text: Unquoted term text. May contain spaces if term's ngram size
         //         is greater than 1.
         virtual void Write(std::ostream& output) const = 0;
+
+        // Persists the map to a stream in binary form. The binary form is
+        // accepted wherever the .csv form is.
+        virtual void WriteBinary(std::ostream& output) const = 0;
     };
 }
@@ -0,0 +1,127 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                   // std::ostream parameter.
+#include <memory>                   // std::unique_ptr return value.
+#include <stddef.h>                 // size_t return value.
+#include <vector>                   // std::vector parameter.
+
+#include "BitFunnel/IInterface.h"   // Base class.
+#include "BitFunnel/Term.h"         // Term parameter.
+
+
+namespace BitFunnel
+{
+    class ITermTreatment;
+
+    //*************************************************************************
+    //
+    // ITermTreatmentSearch
+    //
+    // Searches the space of term treatments for the one that minimizes the
+    // expected quadwords read per query over a query log, subject to a
+    // signal-to-noise floor for every term and a budget on bits per
+    // document.
+    //
+    // Each candidate is a bit density. For each density, the row
+    // configuration (number of rows at each rank) for each idf is chosen
+    // with the analytic model used by TreatmentOptimal. The candidate's cost
+    // is then the model's quadwords summed over the terms of each query and
+    // its memory is the model's bits summed over the terms of the corpus.
+    // When the configurations with the fewest quadwords exceed the budget,
+    // the configurations are chosen together to minimize quadwords within
+    // the budget.
+    //
+    //*************************************************************************
+    class ITermTreatmentSearch : public IInterface
+    {
+    public:
+        class Candidate;
+
+        // Adds one query from the query log to the cost model.
+        virtual void AddQuery(std::vector<Term> const & terms) = 0;
+
+        // Evaluates one candidate for each density.
+        virtual void Search(std::vector<double> const & densities) = 0;
+
+        virtual size_t GetCandidateCount() const = 0;
+        virtual Candidate const & GetCandidate(size_t index) const = 0;
+
+        // Returns the index of the feasible candidate with the fewest
+        // expected quadwords per query. Throws RecoverableError if no
+        // candidate is feasible.
+        virtual size_t GetBestCandidate() const = 0;
+
+        // Returns the ITermTreatment for a candidate, for use with the
+        // ITermTableBuilder.
+        virtual std::unique_ptr<ITermTreatment>
+            CreateTreatment(size_t index) const = 0;
+
+        // Writes one line per candidate.
+        virtual void Print(std::ostream& output) const = 0;
+
+        class Candidate
+        {
+        public:
+            Candidate(double density,
+                      bool isFeasible,
+                      double quadwordsPerQuery,
+                      double bitsPerDocument)
+              : m_density(density),
+                m_isFeasible(isFeasible),
+                m_quadwordsPerQuery(quadwordsPerQuery),
+                m_bitsPerDocument(bitsPerDocument)
+            {
+            }
+
+            double GetDensity() const
+            {
+                return m_density;
+            }
+
+            // False if some term cannot meet the SNR floor or no choice of
+            // configurations fits the memory budget.
+            bool IsFeasible() const
+            {
+                return m_isFeasible;
+            }
+
+            double GetQuadwordsPerQuery() const
+            {
+                return m_quadwordsPerQuery;
+            }
+
+            double GetBitsPerDocument() const
+            {
+                return m_bitsPerDocument;
+            }
+
+        private:
+            double m_density;
+            bool m_isFeasible;
+            double m_quadwordsPerQuery;
+            double m_bitsPerDocument;
+        };
+    };
+}
@@ -26,7 +26,8 @@
 #include <string>
 #include <vector>  // std::vector return value.
 
-#include "BitFunnel/BitFunnelTypes.h"  // DocId.
+#include "BitFunnel/BitFunnelTypes.h"      // DocId.
+#include "BitFunnel/Plan/MatcherMode.h"    // MatcherMode parameter.
 
 
 namespace BitFunnel
@@ -34,6 +35,7 @@ namespace BitFunnel
     class IAllocator;
     class IDiagnosticStream;
     class IInputStream;
+    class IMatcherCodeCache;
     class IMatchVerifier;
     class IPlanRows;
     class IRowSet;
@@ -48,6 +50,11 @@ namespace BitFunnel
     {
         std::unique_ptr<IMatchVerifier> CreateMatchVerifier(std::string query);
 
+        // Creates a cache of compiled matchers that can hold up to capacity
+        // bytes of code.
+        std::unique_ptr<IMatcherCodeCache>
+            CreateMatcherCodeCache(size_t capacity);
+
         IPlanRows& CreatePlanRows(IInputStream& input,
                                   const ISimpleIndex& index,
                                   IAllocator& allocator);
@@ -65,6 +72,6 @@ namespace BitFunnel
                              IDiagnosticStream & diagnosticStream,
                              QueryInstrumentation & instrumentation,
                              ResultsBuffer & resultsBuffer,
-                             bool useNativeCode);
+                             MatcherMode matcherMode);
     }
 }
@@ -0,0 +1,82 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#pragma once
+
+#include <iosfwd>                       // std::istream, std::ostream parameters.
+#include <stddef.h>                     // size_t parameter.
+#include <stdint.h>                     // uint64_t parameter.
+#include <string>                       // std::string parameter.
+
+#include "BitFunnel/IInterface.h"       // IInterface base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // IMatcherCodeCache
+    //
+    // A cache of matcher functions generated by the native code compiler,
+    // keyed by the shape of the plan they were compiled from. The generated
+    // matchers do not contain absolute addresses, so the code for an entry
+    // can be written to a stream and later loaded into executable memory at
+    // a different address, allowing a process to skip the NativeJIT compile
+    // for plans it has seen in a previous run.
+    //
+    // Implementations must be thread-safe.
+    //
+    //*************************************************************************
+    class IMatcherCodeCache : public IInterface
+    {
+    public:
+        // Returns the entry point of the matcher previously added for key,
+        // or nullptr if the cache has no such matcher.
+        virtual void const * Find(std::string const & key) = 0;
+
+        // Copies byteCount bytes of position-independent code into the
+        // cache's executable memory and associates them with key. The
+        // function's entry point is at entryOffset bytes from code.
+        // Returns the entry point of the cached copy, or nullptr if the
+        // cache is out of space.
+        virtual void const * Add(std::string const & key,
+                                 void const * code,
+                                 size_t byteCount,
+                                 size_t entryOffset) = 0;
+
+        // Returns the number of matchers in the cache.
+        virtual size_t GetEntryCount() const = 0;
+
+        // Writes every cached matcher to a stream. The termTableVersion is
+        // recorded so that Read() can reject code that was generated for
+        // a different configuration of the index.
+        virtual void Write(std::ostream & output,
+                           uint64_t termTableVersion) const = 0;
+
+        // Adds the matchers from a stream produced by Write(). Returns false
+        // and leaves the cache unchanged if the stream was written for a
+        // different termTableVersion or by an incompatible code generator.
+        // Throws RecoverableError, again leaving the cache unchanged, if the
+        // stream is truncated or corrupt.
+        virtual bool Read(std::istream & input,
+                          uint64_t termTableVersion) = 0;
+    };
+}
@@ -0,0 +1,142 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>                         // size_t, ptrdiff_t embedded.
+#include <stdint.h>                         // uint64_t embedded.
+#include <vector>                           // std::vector embedded.
+
+#include "BitFunnel/BitFunnelTypes.h"       // Rank embedded.
+#include "BitFunnel/NonCopyable.h"          // Base class.
+#include "BitFunnel/Plan/MatcherMode.h"     // MatcherMode parameter.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // MatcherBenchmark
+    //
+    // Times the ByteCodeInterpreter and the NativeJIT matcher against
+    // fabricated slice buffers, without building a SimpleIndex. The
+    // constructor lays out one row per RowDescriptor in each slice and sets
+    // each bit independently with the row's density, using a seeded
+    // generator so that runs are repeatable.
+    //
+    // Run() takes a row match tree in the text format read by
+    // RowMatchNode::Parse(), e.g.
+    //
+    //   And { Children: [ Row(0, 3, 0, false), Row(1, 0, 0, false) ] }
+    //
+    // The first parameter of each Row is an index into the RowDescriptors and
+    // the second must be that descriptor's rank. The tree goes through the
+    // same rewrite and rank down compilation as a query plan.
+    //
+    // Each rank 0 row is followed by a summary bitmap, laid out as the index
+    // lays them out (see RowTableDescriptor), so that Run() can also time
+    // matching with SummaryFilter.
+    //
+    //*************************************************************************
+    class MatcherBenchmark : public NonCopyable
+    {
+    public:
+        struct RowDescriptor
+        {
+            Rank m_rank;
+
+            // Probability that any given bit in the row is set.
+            double m_density;
+        };
+
+        class Result
+        {
+        public:
+            Result(size_t quadwordCount,
+                   size_t matchCount,
+                   double compileTime,
+                   double matchTime);
+
+            // Row quadwords read by one pass over the slices.
+            size_t GetQuadwordCount() const;
+
+            // Matches reported by one pass over the slices.
+            size_t GetMatchCount() const;
+
+            // Seconds spent generating code. Zero for the interpreter.
+            double GetCompileTime() const;
+
+            // Seconds taken by the fastest pass over the slices.
+            double GetMatchTime() const;
+
+            double GetNanosecondsPerQuadword() const;
+            double GetNanosecondsPerMatch() const;
+
+        private:
+            size_t m_quadwordCount;
+            size_t m_matchCount;
+            double m_compileTime;
+            double m_matchTime;
+        };
+
+        // sliceCapacity must be a multiple of 64 << c_maxRankValue so that
+        // rows of every rank hold a whole number of quadwords.
+        MatcherBenchmark(std::vector<RowDescriptor> const & rows,
+                         size_t sliceCapacity,
+                         size_t sliceCount,
+                         unsigned seed);
+
+        // Matches the plan against every slice passCount times with the
+        // ByteCodeInterpreter (MatcherMode::Interpreter) or native code
+        // (MatcherMode::Compiler) and returns the fastest pass. Throws
+        // RecoverableError for MatcherMode::Adaptive, which would measure
+        // whichever backend it happened to pick.
+        //
+        // When useSummaries is true and the plan has a required rank 0 row,
+        // the matchers skip iterations ruled out by the summaries, as they do
+        // for queries. The time to compute the live iterations is included
+        // in each pass.
+        Result Run(char const * plan,
+                   MatcherMode mode,
+                   size_t passCount,
+                   size_t prefetchDistance,
+                   bool useSummaries) const;
+
+        size_t GetDocumentCount() const;
+
+    private:
+        std::vector<RowDescriptor> m_rows;
+        size_t m_sliceCapacity;
+
+        // Byte offset of each row from the start of a slice buffer.
+        std::vector<ptrdiff_t> m_rowOffsets;
+
+        // Byte offset of each row's summary from the start of a slice buffer.
+        // Zero for rows above rank 0, which have no summary.
+        std::vector<ptrdiff_t> m_summaryOffsets;
+
+        // Backing store for all of the slices. m_sliceBuffers holds the
+        // cache line aligned start of each slice within it.
+        std::vector<uint64_t> m_storage;
+        std::vector<void *> m_sliceBuffers;
+    };
+}
@@ -0,0 +1,50 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // MatcherMode selects how a query's compiled match tree is executed.
+    //
+    // Interpreter runs the ByteCodeInterpreter.
+    //
+    // Compiler generates x64 code with NativeJIT. The compile time is paid
+    // up front on every query that misses the matcher code cache.
+    //
+    // Adaptive estimates the cost of the scan from the row count, initial
+    // rank and slice count. Cheap queries are interpreted. Expensive queries
+    // start in the interpreter while NativeJIT compiles on a background
+    // thread and switch to native code for the remaining slices once the
+    // compile finishes.
+    //
+    //*************************************************************************
+    enum class MatcherMode
+    {
+        Interpreter,
+        Compiler,
+        Adaptive
+    };
+}
@@ -24,7 +24,8 @@
 
 #include <ostream>                          // std::ostream methods inlined.
 
-#include "BitFunnel/Utilities/Stopwatch.h"  // Stopwatch embedded.
+#include "BitFunnel/Utilities/PerformanceCounters.h"  // PerformanceCounters::Values embedded.
+#include "BitFunnel/Utilities/Stopwatch.h"            // Stopwatch embedded.
 
 
 namespace CsvTsv
@@ -40,6 +41,20 @@ namespace BitFunnel
     public:
         class Data;
 
+        inline QueryInstrumentation()
+          : m_counters(nullptr),
+            m_phaseStart()
+        {
+        }
+
+        // Samples counters at the start and end of the planning and matching
+        // phases. The counters must belong to the calling thread. Call
+        // before FinishParsing().
+        inline void SetPerformanceCounters(PerformanceCounters const * counters)
+        {
+            m_counters = counters;
+        }
+
         inline void SetMatchCount(size_t matchCount)
         {
             m_data.m_matchCount = matchCount;
@@ -68,16 +83,44 @@ namespace BitFunnel
         inline void FinishParsing()
         {
             m_data.m_parsingTime = m_stopwatch.ElapsedTime();
+            if (m_counters != nullptr)
+            {
+                m_phaseStart = m_counters->Read();
+            }
         }
 
         inline void FinishPlanning()
         {
             m_data.m_planningTime = m_stopwatch.ElapsedTime() - m_data.m_parsingTime;
+            SampleCounters(m_data.m_planningCounters);
         }
 
         inline void FinishMatching()
         {
-            m_data.m_matchingTime = m_stopwatch.ElapsedTime() - m_data.m_planningTime;
+            m_data.m_matchingTime = m_stopwatch.ElapsedTime()
+                - m_data.m_parsingTime
+                - m_data.m_planningTime;
+            SampleCounters(m_data.m_matchingCounters);
+        }
+
+        // Time spent generating native code with NativeJIT. In the adaptive
+        // matcher mode this overlaps with the interpreter time because the
+        // compile runs on a background thread.
+        inline void AddCompileTime(double time)
+        {
+            m_data.m_compileTime += time;
+        }
+
+        // Time spent matching in the ByteCodeInterpreter.
+        inline void AddInterpreterTime(double time)
+        {
+            m_data.m_interpreterTime += time;
+        }
+
+        // Time spent matching in native code.
+        inline void AddNativeTime(double time)
+        {
+            m_data.m_nativeTime += time;
         }
 
         inline Data & GetData()
@@ -95,10 +138,17 @@ namespace BitFunnel
                 m_cacheLineCount(0ll),
                 m_parsingTime(0.0),
                 m_planningTime(0.0),
-                m_matchingTime(0.0)
+                m_matchingTime(0.0),
+                m_compileTime(0.0),
+                m_interpreterTime(0.0),
+                m_nativeTime(0.0),
+                m_planningCounters(),
+                m_matchingCounters()
             {
             }
 
+            Data(Data const & other) = default;
+
             Data & operator=(Data const & other)
             {
                 m_rowCount = other.m_rowCount;
@@ -108,44 +158,78 @@ namespace BitFunnel
                 m_parsingTime = other.m_parsingTime;
                 m_planningTime = other.m_planningTime;
                 m_matchingTime = other.m_matchingTime;
+                m_compileTime = other.m_compileTime;
+                m_interpreterTime = other.m_interpreterTime;
+                m_nativeTime = other.m_nativeTime;
+                m_planningCounters = other.m_planningCounters;
+                m_matchingCounters = other.m_matchingCounters;
                 return *this;
             }
 
-            inline size_t GetRowCount()
+            inline size_t GetRowCount() const
             {
                 return m_rowCount;
             }
 
-            inline size_t GetMatchCount()
+            inline size_t GetMatchCount() const
             {
                 return m_matchCount;
             }
 
-            inline size_t GetQuadwordCount()
+            inline size_t GetQuadwordCount() const
             {
                 return m_quadwordCount;
             }
 
-            inline size_t GetCacheLineCount()
+            inline size_t GetCacheLineCount() const
             {
                 return m_cacheLineCount;
             }
 
-            inline double GetParsingTime()
+            inline double GetParsingTime() const
             {
                 return m_parsingTime;
             }
 
-            inline double GetPlanningTime()
+            inline double GetPlanningTime() const
             {
                 return m_planningTime;
             }
 
-            inline double GetMatchingTime()
+            inline double GetMatchingTime() const
             {
                 return m_matchingTime;
             }
 
+            inline double GetCompileTime() const
+            {
+                return m_compileTime;
+            }
+
+            inline double GetInterpreterTime() const
+            {
+                return m_interpreterTime;
+            }
+
+            inline double GetNativeTime() const
+            {
+                return m_nativeTime;
+            }
+
+            // Hardware event counts for the planning and matching phases.
+            // All zero unless the QueryInstrumentation had
+            // PerformanceCounters. Counts which could not be measured are
+            // PerformanceCounters::c_unavailable.
+            inline PerformanceCounters::Values const & GetPlanningCounters() const
+            {
+                return m_planningCounters;
+            }
+
+            inline PerformanceCounters::Values const & GetMatchingCounters() const
+            {
+                return m_matchingCounters;
+            }
+
             static void FormatHeader(CsvTsv::CsvTableFormatter & formatter);
             void Format(CsvTsv::CsvTableFormatter & formatter) const;
 
@@ -159,10 +243,29 @@ namespace BitFunnel
             double m_parsingTime;
             double m_planningTime;
             double m_matchingTime;
+            double m_compileTime;
+            double m_interpreterTime;
+            double m_nativeTime;
+            PerformanceCounters::Values m_planningCounters;
+            PerformanceCounters::Values m_matchingCounters;
         };
 
     private:
+        // Stores the counts since the end of the previous phase in delta.
+        inline void SampleCounters(PerformanceCounters::Values & delta)
+        {
+            if (m_counters != nullptr)
+            {
+                PerformanceCounters::Sample now = m_counters->Read();
+                delta = m_counters->GetDelta(m_phaseStart, now);
+                m_phaseStart = now;
+            }
+        }
+
         Stopwatch m_stopwatch;
         Data m_data;
+
+        PerformanceCounters const * m_counters;
+        PerformanceCounters::Sample m_phaseStart;
     };
 }
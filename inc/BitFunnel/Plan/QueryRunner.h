@@ -22,45 +22,107 @@
 
 #pragma once
 
+#include <iosfwd>       // std::ostream parameter.
 #include <vector>       // std::vector parameter
 
+#include "BitFunnel/Plan/MatcherMode.h"             // MatcherMode parameter.
+#include "BitFunnel/Plan/QueryInstrumentation.h"    // QueryInstrumentation::Data parameter.
+#include "BitFunnel/Utilities/LatencyHistogram.h"   // LatencyHistogram member.
+
 
 namespace BitFunnel
 {
+    class IMatcherCodeCache;
     class ISimpleIndex;
 
     class QueryRunner
     {
     public:
+        // Histograms of the time each query spends in each phase of
+        // processing. Each query thread records into its own Latencies,
+        // which are merged when the threads finish.
+        class Latencies
+        {
+        public:
+            // Records the phase times in data, along with totalTime, the
+            // time to process the query from start to finish.
+            void Record(QueryInstrumentation::Data const & data, double totalTime);
+
+            void Merge(Latencies const & other);
+
+            void Reset();
+
+            // Writes the percentiles of each phase.
+            void Print(std::ostream& out) const;
+
+            LatencyHistogram const & GetParsing() const;
+            LatencyHistogram const & GetPlanning() const;
+            LatencyHistogram const & GetCompile() const;
+            LatencyHistogram const & GetMatching() const;
+            LatencyHistogram const & GetTotal() const;
+
+        private:
+            LatencyHistogram m_parsing;
+            LatencyHistogram m_planning;
+            LatencyHistogram m_compile;
+            LatencyHistogram m_matching;
+            LatencyHistogram m_total;
+        };
+
         class Statistics
         {
         public:
             Statistics(size_t threadCount,
                        size_t uniqueQueryCount,
                        size_t processedCount,
-                       double elapsedTime);
+                       double elapsedTime,
+                       Latencies const & latencies);
 
             void Print(std::ostream& out) const;
 
+            size_t GetThreadCount() const;
+            size_t GetProcessedCount() const;
+            double GetElapsedTime() const;
+
+            // Queries processed per second of elapsed time.
+            double GetQueriesPerSecond() const;
+
+            Latencies const & GetLatencies() const;
+
+            // Shorthand for GetLatencies().GetTotal().GetPercentile().
+            double GetLatencyPercentile(double percentile) const;
+
         private:
             const size_t m_threadCount;
             const size_t m_uniqueQueryCount;
             size_t m_processedCount;
             double m_elapsedTime;
+            Latencies m_latencies;
         };
 
+        // Processes a single query. If latencies is not nullptr, the
+        // query's phase times are recorded in it. If countHardwareEvents is
+        // true, the planning and matching phases are measured with
+        // PerformanceCounters.
         static QueryInstrumentation::Data Run(
             char const * query,
             ISimpleIndex const & index,
-            bool useNativeCode,
-            bool countCacheLines);
+            MatcherMode matcherMode,
+            bool countCacheLines,
+            bool countHardwareEvents,
+            IMatcherCodeCache * codeCache,
+            size_t prefetchDistance,
+            Latencies * latencies = nullptr);
 
         static Statistics Run(ISimpleIndex const & index,
                               char const * outputDir,
                               size_t threadCount,
                               std::vector<std::string> const & queries,
                               size_t iterations,
-                              bool useNativeCode,
-                              bool countCacheLines);
+                              MatcherMode matcherMode,
+                              bool countCacheLines,
+                              bool countHardwareEvents,
+                              IMatcherCodeCache * codeCache,
+                              size_t prefetchDistance);
     };
 }
@@ -25,6 +25,9 @@
 #include <memory>   // std::unique_ptr return value.
 #include <string>   // std::string parameter.
 
+#include "BitFunnel/Plan/MatcherMode.h"            // MatcherMode parameter.
+#include "BitFunnel/Plan/QueryInstrumentation.h"   // QueryInstrumentation::Data parameter.
+
 
 namespace BitFunnel
 {
@@ -35,5 +38,15 @@ namespace BitFunnel
         ISimpleIndex const & index,
         std::string query,
         bool runVerification,
-        bool compilerMode);
+        MatcherMode matcherMode);
+
+
+    // Same as above, but also copies the query's instrumentation (e.g. row
+    // and quadword counts) into data.
+    std::unique_ptr<IMatchVerifier> VerifyOneQuery(
+        ISimpleIndex const & index,
+        std::string query,
+        bool runVerification,
+        MatcherMode matcherMode,
+        QueryInstrumentation::Data & data);
 }
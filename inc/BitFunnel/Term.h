@@ -99,6 +99,15 @@ namespace BitFunnel
              IdfX10 idf,
              GramSize = 1);
 
+        // Constructs an ngram from its components, including an IdfMax that
+        // differs from its IdfSum. Used to restore postings that were
+        // serialized after ngram expansion.
+        Term(Hash rawHash,
+             StreamId stream,
+             GramSize gramSize,
+             IdfX10 idfSum,
+             IdfX10 idfMax);
+
         Term(IObjectParser& parser, bool parseParametersOnly);
 
         // Construct a term from data previously persisted to a stream via the
@@ -37,6 +37,7 @@ namespace BitFunnel
     class IDiagnosticStream;
     class IObjectFormatter;
     class ITaskProcessor;
+    class ITaskScheduler;
     class ITokenManager;
 
     namespace Factories
@@ -57,6 +58,11 @@ namespace BitFunnel
                 std::vector<std::unique_ptr<ITaskProcessor>> const & processors,
                 size_t taskCount);
 
+        // Returns an ITaskScheduler with threadCount work-stealing worker
+        // threads. The threads exit when the ITaskScheduler is destroyed.
+        std::unique_ptr<ITaskScheduler>
+            CreateTaskScheduler(size_t threadCount);
+
         std::unique_ptr<IThreadManager>
             CreateThreadManager(const std::vector<std::unique_ptr<IThreadBase>>& threads);
 
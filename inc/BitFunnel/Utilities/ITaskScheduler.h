@@ -0,0 +1,75 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <functional>               // std::function parameter.
+#include <stddef.h>                 // size_t parameter.
+
+#include "BitFunnel/IInterface.h"   // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // ITaskScheduler is an abstract base class or interface for a pool of
+    // worker threads that run numbered tasks.
+    //
+    // Unlike ITaskDistributor, which starts one thread per ITaskProcessor and
+    // runs a single batch of tasks, an ITaskScheduler keeps its threads for
+    // its lifetime and runs any number of batches, including batches started
+    // by tasks that are already running. This lets an outer loop (e.g. over
+    // queries or chunks) and an inner loop (e.g. over the slices of one
+    // shard) share the same threads.
+    //
+    //*************************************************************************
+    class ITaskScheduler : public IInterface
+    {
+    public:
+        typedef std::function<void(size_t taskId)> Task;
+
+        // Calls task(taskId) for each taskId in [0, taskCount), spreading
+        // the calls over the worker threads and the calling thread. Returns
+        // once every call has returned. Threads claim grainSize consecutive
+        // task ids at a time; a grainSize of 0 selects a grain that gives
+        // each thread several claims.
+        //
+        // Tasks may call ParallelFor() themselves. The calling thread runs
+        // other tasks while it waits, so nested calls do not tie up threads.
+        // If a task throws, the first exception is rethrown to the caller
+        // of ParallelFor() after the remaining tasks have run.
+        virtual void ParallelFor(size_t taskCount,
+                                 Task const & task,
+                                 size_t grainSize = 0) = 0;
+
+        // Returns the number of worker threads, not counting threads that
+        // call ParallelFor() from outside the pool.
+        virtual size_t GetThreadCount() const = 0;
+
+        // Returns the index, in [0, GetThreadCount()), of the worker thread
+        // that calls this method, or GetThreadCount() when called from a
+        // thread outside the pool. Tasks use this to select per-thread
+        // state.
+        virtual size_t GetWorkerIndex() const = 0;
+    };
+}
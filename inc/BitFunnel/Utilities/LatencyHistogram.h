@@ -0,0 +1,99 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>       // std::ostream parameter.
+#include <stddef.h>     // size_t return value.
+#include <stdint.h>     // uint64_t member.
+#include <vector>       // std::vector member.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // LatencyHistogram
+    //
+    // Records a series of latencies in buckets whose width grows with the
+    // latency, in the style of HdrHistogram. Every latency from 1ns up to
+    // hundreds of years is counted in a bucket whose width is at most 1/64
+    // of the latency, so percentiles are accurate to about 1.5% with a
+    // fixed amount of memory.
+    //
+    // LatencyHistogram is not thread safe. Each thread should record into
+    // its own histogram, and Merge() can then combine them without loss.
+    //
+    //*************************************************************************
+    class LatencyHistogram
+    {
+    public:
+        LatencyHistogram();
+
+        // Records a latency, in seconds. Negative latencies are recorded
+        // as zero.
+        void Record(double seconds);
+
+        // Adds the latencies recorded by other to this histogram.
+        void Merge(LatencyHistogram const & other);
+
+        void Reset();
+
+        size_t GetCount() const;
+
+        // Returns the mean and the maximum latency, in seconds. The mean
+        // and the maximum are exact. Both are zero if the histogram is
+        // empty.
+        double GetMean() const;
+        double GetMax() const;
+
+        // Returns the latency, in seconds, at or below which percentile
+        // percent of the recorded latencies fall (e.g. percentile = 99.9).
+        // The value returned is the upper bound of the bucket holding that
+        // latency, capped at GetMax(). Returns zero if the histogram is
+        // empty.
+        double GetPercentile(double percentile) const;
+
+        // Writes the count, mean, p50, p90, p99, p99.9 and max on one line,
+        // with latencies in microseconds.
+        void Print(std::ostream & out, char const * name) const;
+
+    private:
+        // Sub-buckets per power of two. The first c_subBucketCount buckets
+        // count latencies of 0 to c_subBucketCount - 1 nanoseconds exactly.
+        // Each later power of two is split into c_subBucketCount / 2
+        // buckets.
+        static const unsigned c_subBucketBits = 7;
+        static const uint64_t c_subBucketCount = 1ull << c_subBucketBits;
+        static const uint64_t c_halfSubBucketCount = c_subBucketCount / 2;
+        static const size_t c_bucketCount =
+            c_subBucketCount + (64 - c_subBucketBits) * c_halfSubBucketCount;
+
+        static size_t GetBucket(uint64_t nanoseconds);
+        static uint64_t GetBucketUpperBound(size_t bucket);
+
+        std::vector<uint64_t> m_counts;
+        uint64_t m_totalCount;
+        uint64_t m_sum;
+        uint64_t m_max;
+    };
+}
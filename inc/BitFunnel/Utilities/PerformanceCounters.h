@@ -0,0 +1,123 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <array>                    // std::array member.
+#include <stdint.h>                 // uint64_t template parameter.
+#include <vector>                   // std::vector member.
+
+#include "BitFunnel/NonCopyable.h"  // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // PerformanceCounters
+    //
+    // Hardware event counters for the calling thread, backed by
+    // perf_event_open() on Linux. The counters measure only user mode
+    // execution of the thread that constructed the PerformanceCounters, so
+    // each thread must construct its own.
+    //
+    // Counters that the processor, kernel or permissions do not support
+    // (e.g. on other platforms, in most virtual machines, or when
+    // /proc/sys/kernel/perf_event_paranoid is above 2) always read as zero.
+    //
+    // When other users of the performance monitoring unit leave too few
+    // hardware counters, the kernel multiplexes the group and it counts only
+    // part of the time. GetDelta() scales the counts up to the whole
+    // interval, and reports them as c_unavailable if the group never ran.
+    //
+    //*************************************************************************
+    class PerformanceCounters : NonCopyable
+    {
+    public:
+        enum Counter
+        {
+            Cycles,
+            Instructions,
+            LastLevelCacheMisses,
+            DataTLBMisses,
+            BranchMisses,
+            CounterCount
+        };
+
+        typedef std::array<uint64_t, CounterCount> Values;
+
+        // Count reported by GetDelta() for a counter which is not available
+        // or which was never scheduled during the interval.
+        static const uint64_t c_unavailable = UINT64_MAX;
+
+        // Raw counts, together with the nanoseconds for which the group was
+        // enabled and for which it was actually counting.
+        class Sample
+        {
+        public:
+            Sample();
+
+            Values m_values;
+            uint64_t m_timeEnabled;
+            uint64_t m_timeRunning;
+        };
+
+        // Opens and starts the counters for the calling thread.
+        PerformanceCounters();
+
+        ~PerformanceCounters();
+
+        // Returns true if the counter could be opened.
+        bool IsAvailable(Counter counter) const;
+
+        // Returns true if any of the counters could be opened.
+        bool IsAvailable() const;
+
+        // Returns the raw counts since construction.
+        Sample Read() const;
+
+        // Returns the counts between two samples, scaled for multiplexing.
+        Values GetDelta(Sample const & start, Sample const & end) const;
+
+        // Scales a count made while the group was running for timeRunning
+        // of timeEnabled nanoseconds. Returns c_unavailable if timeRunning
+        // is zero.
+        static uint64_t Scale(uint64_t count,
+                              uint64_t timeEnabled,
+                              uint64_t timeRunning);
+
+        // Returns a short name for the counter, suitable for a column
+        // heading (e.g. "llc_misses").
+        static char const * GetName(Counter counter);
+
+    private:
+        // File descriptors returned by perf_event_open(), or -1 for
+        // counters that are not available. The first available counter
+        // leads a group, so that all of the counters are scheduled together
+        // and can be read with a single system call.
+        std::array<int, CounterCount> m_files;
+        int m_groupLeader;
+
+        // The available counters, in the order they were added to the group.
+        std::vector<Counter> m_groupOrder;
+    };
+}
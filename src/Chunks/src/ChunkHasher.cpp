@@ -0,0 +1,238 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+#include "BitFunnel/Exceptions.h"
+#include "ChunkHasher.h"
+#include "HashedChunkReader.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // ChunkHasher
+    //
+    //*************************************************************************
+    ChunkHasher::ChunkHasher(IConfiguration const & configuration,
+                             bool expandNGrams,
+                             std::ostream & output)
+      : m_configuration(configuration),
+        m_expandNGrams(expandNGrams),
+        m_output(output),
+        m_streamCount(0),
+        m_entryCountOffset(0),
+        m_entryCount(0)
+    {
+    }
+
+
+    void ChunkHasher::OnFileEnter()
+    {
+        const uint32_t version = HashedChunkReader::c_version;
+        const uint32_t flags =
+            m_expandNGrams ? HashedChunkReader::c_expandedNGrams : 0;
+
+        m_output.write(HashedChunkReader::c_magic,
+                       sizeof(HashedChunkReader::c_magic));
+        m_output.write(reinterpret_cast<char const *>(&version),
+                       sizeof(version));
+        m_output.write(reinterpret_cast<char const *>(&flags),
+                       sizeof(flags));
+    }
+
+
+    void ChunkHasher::OnDocumentEnter(DocId id)
+    {
+        m_record.clear();
+        Append(static_cast<uint64_t>(id));
+
+        // Placeholder for the stream count.
+        Append(static_cast<uint32_t>(0));
+        m_streamCount = 0;
+
+        if (m_expandNGrams)
+        {
+            m_currentDocument.reset(new Document(m_configuration, id));
+        }
+    }
+
+
+    void ChunkHasher::OnStreamEnter(Term::StreamId id)
+    {
+        if (m_expandNGrams)
+        {
+            m_currentDocument->OpenStream(id);
+        }
+        else
+        {
+            ++m_streamCount;
+            Append(id);
+            m_entryCountOffset = m_record.size();
+            Append(static_cast<uint32_t>(0));
+            m_entryCount = 0;
+        }
+    }
+
+
+    void ChunkHasher::OnTerm(char const * term)
+    {
+        if (m_expandNGrams)
+        {
+            m_currentDocument->AddTerm(term);
+        }
+        else
+        {
+            Append(Term::ComputeRawHash(term));
+            ++m_entryCount;
+        }
+    }
+
+
+    void ChunkHasher::OnTermHash(Term::Hash rawHash)
+    {
+        if (m_expandNGrams)
+        {
+            m_currentDocument->AddTermHash(rawHash);
+        }
+        else
+        {
+            Append(rawHash);
+            ++m_entryCount;
+        }
+    }
+
+
+    void ChunkHasher::OnPosting(Term const & term)
+    {
+        if (!m_expandNGrams)
+        {
+            throw FatalError("ChunkHasher: cannot recover raw hashes from expanded ngrams.");
+        }
+        m_currentDocument->AddPosting(term);
+    }
+
+
+    void ChunkHasher::OnStreamExit()
+    {
+        if (m_expandNGrams)
+        {
+            m_currentDocument->CloseStream();
+        }
+        else
+        {
+            Patch(m_entryCountOffset, m_entryCount);
+        }
+    }
+
+
+    void ChunkHasher::OnDocumentExit(IChunkWriter & /*writer*/,
+                                     size_t /*bytesRead*/)
+    {
+        if (m_expandNGrams)
+        {
+            AppendPostings();
+            m_currentDocument.reset(nullptr);
+        }
+
+        Patch(sizeof(uint64_t), m_streamCount);
+
+        const uint32_t byteCount = static_cast<uint32_t>(m_record.size());
+        m_output.write(reinterpret_cast<char const *>(&byteCount),
+                       sizeof(byteCount));
+        m_output.write(m_record.data(), m_record.size());
+    }
+
+
+    void ChunkHasher::OnFileExit(IChunkWriter & /*writer*/)
+    {
+        const uint32_t endOfChunk = 0;
+        m_output.write(reinterpret_cast<char const *>(&endOfChunk),
+                       sizeof(endOfChunk));
+    }
+
+
+    void ChunkHasher::AppendPostings()
+    {
+        m_postings.clear();
+        m_currentDocument->GetPostings(m_postings);
+
+        // Sort for a deterministic layout, since Document keeps its
+        // postings in a hash set.
+        std::sort(m_postings.begin(),
+                  m_postings.end(),
+                  [](Term const & a, Term const & b)
+                  {
+                      if (a.GetStream() != b.GetStream())
+                      {
+                          return a.GetStream() < b.GetStream();
+                      }
+                      if (a.GetRawHash() != b.GetRawHash())
+                      {
+                          return a.GetRawHash() < b.GetRawHash();
+                      }
+                      return a.GetGramSize() < b.GetGramSize();
+                  });
+
+        auto posting = m_postings.begin();
+        while (posting != m_postings.end())
+        {
+            const Term::StreamId stream = posting->GetStream();
+            ++m_streamCount;
+            Append(stream);
+            m_entryCountOffset = m_record.size();
+            Append(static_cast<uint32_t>(0));
+            m_entryCount = 0;
+
+            for (; posting != m_postings.end() && posting->GetStream() == stream;
+                 ++posting)
+            {
+                Append(posting->GetRawHash());
+                Append(posting->GetGramSize());
+                Append(posting->GetIdfSum());
+                Append(posting->GetIdfMax());
+                ++m_entryCount;
+            }
+
+            Patch(m_entryCountOffset, m_entryCount);
+        }
+    }
+
+
+    template <typename T>
+    void ChunkHasher::Append(T value)
+    {
+        const size_t offset = m_record.size();
+        m_record.resize(offset + sizeof(T));
+        memcpy(m_record.data() + offset, &value, sizeof(T));
+    }
+
+
+    template <typename T>
+    void ChunkHasher::Patch(size_t offset, T value)
+    {
+        memcpy(m_record.data() + offset, &value, sizeof(T));
+    }
+}
@@ -0,0 +1,108 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                               // std::ostream member.
+#include <memory>                               // std::unique_ptr member.
+#include <stddef.h>                             // size_t member.
+#include <stdint.h>                             // uint32_t member.
+#include <vector>                               // std::vector member.
+
+#include "BitFunnel/Chunks/IChunkProcessor.h"  // Base class.
+#include "BitFunnel/NonCopyable.h"              // Base class.
+#include "Document.h"                           // std::unique_ptr<Document>.
+
+
+namespace BitFunnel
+{
+    class IConfiguration;
+
+    //*************************************************************************
+    //
+    // ChunkHasher
+    //
+    // IChunkProcessor that writes each document it receives to a stream in
+    // the hashed chunk format described in HashedChunkReader.h.
+    //
+    // When expandNGrams is true, the ngrams are formed with the gram size and
+    // IDF table of the IConfiguration, and the chunk holds postings.
+    // Otherwise each word is written as its raw hash and ngrams are formed
+    // at ingestion.
+    //
+    //*************************************************************************
+    class ChunkHasher : public NonCopyable, public IChunkProcessor
+    {
+    public:
+        ChunkHasher(IConfiguration const & configuration,
+                    bool expandNGrams,
+                    std::ostream & output);
+
+        //
+        // IChunkProcessor methods.
+        //
+        virtual void OnFileEnter() override;
+        virtual void OnDocumentEnter(DocId id) override;
+        virtual void OnStreamEnter(Term::StreamId id) override;
+        virtual void OnTerm(char const * term) override;
+        virtual void OnTermHash(Term::Hash rawHash) override;
+        virtual void OnPosting(Term const & term) override;
+        virtual void OnStreamExit() override;
+        virtual void OnDocumentExit(IChunkWriter & writer,
+                                    size_t bytesRead) override;
+        virtual void OnFileExit(IChunkWriter & writer) override;
+
+    private:
+        // Appends the postings of m_currentDocument to m_record, grouped by
+        // stream.
+        void AppendPostings();
+
+        template <typename T>
+        void Append(T value);
+
+        template <typename T>
+        void Patch(size_t offset, T value);
+
+        //
+        // Constructor parameters
+        //
+        IConfiguration const & m_configuration;
+        const bool m_expandNGrams;
+        std::ostream & m_output;
+
+        //
+        // Other members
+        //
+
+        // Document record under construction, without its byte count.
+        std::vector<char> m_record;
+        uint32_t m_streamCount;
+
+        // Offset in m_record of the entry count of the current stream.
+        size_t m_entryCountOffset;
+        uint32_t m_entryCount;
+
+        // Forms ngrams when m_expandNGrams is true.
+        std::unique_ptr<Document> m_currentDocument;
+        std::vector<Term> m_postings;
+    };
+}
@@ -0,0 +1,473 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Chunks/IChunkProcessor.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "ChunkIngestionPipeline.h"
+#include "ChunkIngestor.h"
+#include "ChunkManifestIngestor.h"
+#include "ChunkReader.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IChunkIngestionPipeline>
+        Factories::CreateChunkIngestionPipeline(
+            IFileSystem& fileSystem,
+            std::vector<std::string> const & filePaths,
+            IConfiguration const & config,
+            IIngestor& ingestor,
+            IDocumentFilter & filter,
+            bool cacheDocuments,
+            size_t threadCount)
+    {
+        return std::unique_ptr<IChunkIngestionPipeline>(
+            new ChunkIngestionPipeline(
+                fileSystem,
+                filePaths,
+                config,
+                ingestor,
+                filter,
+                cacheDocuments,
+                threadCount));
+    }
+
+
+    //*************************************************************************
+    //
+    // ChunkIngestionPipeline::ReadThread
+    //
+    //*************************************************************************
+    class ChunkIngestionPipeline::ReadThread : public IThreadBase
+    {
+    public:
+        ReadThread(ChunkIngestionPipeline & pipeline)
+          : m_pipeline(pipeline)
+        {
+        }
+
+        virtual void EntryPoint() override
+        {
+            for (auto const & path : m_pipeline.m_filePaths)
+            {
+                Stopwatch stopwatch;
+                std::unique_ptr<Chunk> chunk(new Chunk());
+                ChunkManifestIngestor::LoadChunk(m_pipeline.m_fileSystem,
+                                                 path,
+                                                 *chunk);
+                m_pipeline.m_read.m_busyTime += stopwatch.ElapsedTime();
+                ++m_pipeline.m_read.m_itemCount;
+                m_pipeline.m_read.m_byteCount += chunk->size();
+
+                if (chunk->empty())
+                {
+                    // ChunkReader rejects empty chunks.
+                    continue;
+                }
+
+                m_pipeline.m_chunks->TryEnqueue(std::move(chunk));
+                m_pipeline.m_chunkQueue.Sample(++m_pipeline.m_chunkDepth);
+            }
+
+            m_pipeline.m_chunks->TryEnqueue(nullptr);
+        }
+
+    private:
+        ChunkIngestionPipeline & m_pipeline;
+    };
+
+
+    //*************************************************************************
+    //
+    // ChunkIngestionPipeline::SplitThread
+    //
+    //*************************************************************************
+    class ChunkIngestionPipeline::SplitThread
+        : public IThreadBase, public IChunkProcessor
+    {
+    public:
+        SplitThread(ChunkIngestionPipeline & pipeline)
+          : m_pipeline(pipeline),
+            m_enqueueTime(0.0)
+        {
+        }
+
+        virtual void EntryPoint() override
+        {
+            std::unique_ptr<Chunk> chunk;
+            while (m_pipeline.m_chunks->TryDequeue(chunk) && chunk != nullptr)
+            {
+                --m_pipeline.m_chunkDepth;
+
+                Stopwatch stopwatch;
+                m_enqueueTime = 0.0;
+                ChunkReader(&(*chunk)[0],
+                            &(*chunk)[0] + chunk->size(),
+                            *this);
+                m_pipeline.m_split.m_busyTime +=
+                    stopwatch.ElapsedTime() - m_enqueueTime;
+                ++m_pipeline.m_split.m_itemCount;
+                m_pipeline.m_split.m_byteCount += chunk->size();
+            }
+
+            for (size_t i = 0; i < m_pipeline.m_threadCount; ++i)
+            {
+                m_pipeline.m_batches->TryEnqueue(nullptr);
+            }
+        }
+
+        //
+        // IChunkProcessor methods.
+        //
+        virtual void OnFileEnter() override
+        {
+        }
+
+        virtual void OnDocumentEnter(DocId /*id*/) override
+        {
+        }
+
+        virtual void OnStreamEnter(Term::StreamId /*id*/) override
+        {
+        }
+
+        virtual void OnTerm(char const * /*term*/) override
+        {
+        }
+
+        virtual void OnTermHash(Term::Hash /*rawHash*/) override
+        {
+        }
+
+        virtual void OnPosting(Term const & /*term*/) override
+        {
+        }
+
+        virtual void OnStreamExit() override
+        {
+        }
+
+        virtual void OnDocumentExit(IChunkWriter & writer,
+                                    size_t /*bytesRead*/) override
+        {
+            if (m_output.get() == nullptr)
+            {
+                m_output.reset(new std::ostringstream());
+                m_documentCount = 0;
+            }
+
+            writer.Write(*m_output);
+            ++m_documentCount;
+
+            if (m_documentCount == c_documentsPerBatch)
+            {
+                EnqueueBatch(writer);
+            }
+        }
+
+        virtual void OnFileExit(IChunkWriter & writer) override
+        {
+            if (m_output.get() != nullptr)
+            {
+                EnqueueBatch(writer);
+            }
+        }
+
+    private:
+        void EnqueueBatch(IChunkWriter & writer)
+        {
+            writer.Complete(*m_output);
+
+            std::unique_ptr<Batch> batch(new Batch());
+            batch->m_data = m_output->str();
+            batch->m_documentCount = m_documentCount;
+            m_output.reset(nullptr);
+
+            m_pipeline.m_split.m_documentCount += batch->m_documentCount;
+
+            Stopwatch stopwatch;
+            m_pipeline.m_batches->TryEnqueue(std::move(batch));
+            m_pipeline.m_batchQueue.Sample(++m_pipeline.m_batchDepth);
+            m_enqueueTime += stopwatch.ElapsedTime();
+        }
+
+        ChunkIngestionPipeline & m_pipeline;
+
+        // Time spent blocked on a full batch queue during the current chunk.
+        double m_enqueueTime;
+
+        // The batch under construction.
+        std::unique_ptr<std::ostringstream> m_output;
+        size_t m_documentCount;
+    };
+
+
+    //*************************************************************************
+    //
+    // ChunkIngestionPipeline::IndexThread
+    //
+    //*************************************************************************
+    class ChunkIngestionPipeline::IndexThread : public IThreadBase
+    {
+    public:
+        IndexThread(ChunkIngestionPipeline & pipeline)
+          : m_pipeline(pipeline)
+        {
+        }
+
+        virtual void EntryPoint() override
+        {
+            std::unique_ptr<Batch> batch;
+            while (m_pipeline.m_batches->TryDequeue(batch) && batch != nullptr)
+            {
+                --m_pipeline.m_batchDepth;
+
+                Stopwatch stopwatch;
+                ChunkIngestor processor(m_pipeline.m_config,
+                                        m_pipeline.m_ingestor,
+                                        m_pipeline.m_cacheDocuments,
+                                        m_pipeline.m_filter,
+                                        nullptr);
+
+                ChunkReader(batch->m_data.data(),
+                            batch->m_data.data() + batch->m_data.size(),
+                            processor);
+
+                m_statistics.m_busyTime += stopwatch.ElapsedTime();
+                ++m_statistics.m_itemCount;
+                m_statistics.m_documentCount += batch->m_documentCount;
+                m_statistics.m_byteCount += batch->m_data.size();
+            }
+        }
+
+        StageStatistics const & GetStatistics() const
+        {
+            return m_statistics;
+        }
+
+    private:
+        ChunkIngestionPipeline & m_pipeline;
+        StageStatistics m_statistics;
+    };
+
+
+    //*************************************************************************
+    //
+    // ChunkIngestionPipeline
+    //
+    //*************************************************************************
+    ChunkIngestionPipeline::ChunkIngestionPipeline(
+        IFileSystem & fileSystem,
+        std::vector<std::string> const & filePaths,
+        IConfiguration const & config,
+        IIngestor & ingestor,
+        IDocumentFilter & filter,
+        bool cacheDocuments,
+        size_t threadCount)
+      : m_fileSystem(fileSystem),
+        m_filePaths(filePaths),
+        m_config(config),
+        m_ingestor(ingestor),
+        m_filter(filter),
+        m_cacheDocuments(cacheDocuments),
+        m_threadCount(std::max(threadCount, static_cast<size_t>(1))),
+        m_chunkDepth(0),
+        m_batchDepth(0),
+        m_elapsedTime(0.0)
+    {
+    }
+
+
+    void ChunkIngestionPipeline::Ingest()
+    {
+        Stopwatch stopwatch;
+
+        const unsigned batchQueueCapacity =
+            static_cast<unsigned>(m_threadCount) * c_batchQueueCapacityPerThread;
+        m_chunks.reset(
+            new BlockingQueue<std::unique_ptr<Chunk>>(c_chunkQueueCapacity));
+        m_batches.reset(
+            new BlockingQueue<std::unique_ptr<Batch>>(batchQueueCapacity));
+        m_chunkDepth = 0;
+        m_batchDepth = 0;
+
+        m_read = StageStatistics();
+        m_split = StageStatistics();
+        m_index = StageStatistics();
+        m_chunkQueue = QueueStatistics(c_chunkQueueCapacity);
+        m_batchQueue = QueueStatistics(batchQueueCapacity);
+
+        std::vector<IndexThread*> indexThreads;
+        std::vector<std::unique_ptr<IThreadBase>> threads;
+        threads.push_back(
+            std::unique_ptr<IThreadBase>(new ReadThread(*this)));
+        threads.push_back(
+            std::unique_ptr<IThreadBase>(new SplitThread(*this)));
+        for (size_t i = 0; i < m_threadCount; ++i)
+        {
+            indexThreads.push_back(new IndexThread(*this));
+            threads.push_back(std::unique_ptr<IThreadBase>(indexThreads.back()));
+        }
+
+        auto threadManager = Factories::CreateThreadManager(threads);
+        threadManager->WaitForThreads();
+
+        for (auto thread : indexThreads)
+        {
+            m_index.Add(thread->GetStatistics());
+        }
+
+        // Every item, including the end markers, has been dequeued, so
+        // Shutdown() returns immediately.
+        m_chunks->Shutdown();
+        m_batches->Shutdown();
+
+        m_elapsedTime = stopwatch.ElapsedTime();
+    }
+
+
+    static void PrintStage(std::ostream & out,
+                           char const * name,
+                           char const * items,
+                           size_t itemCount,
+                           size_t byteCount,
+                           double busyTime,
+                           size_t threadCount)
+    {
+        const double megabytes = byteCount / 1e6;
+        out << "  " << std::left << std::setw(6) << name << std::right
+            << std::setw(10) << itemCount << " " << items
+            << ", " << std::fixed << std::setprecision(1)
+            << megabytes << " MB, "
+            << std::setprecision(3) << busyTime << "s busy";
+        if (threadCount > 1)
+        {
+            out << " over " << threadCount << " threads";
+        }
+        if (busyTime > 0)
+        {
+            out << ", " << std::setprecision(1)
+                << megabytes / busyTime
+                << " MB/s per thread";
+        }
+        out << std::defaultfloat << std::endl;
+    }
+
+
+    void ChunkIngestionPipeline::PrintStatistics(std::ostream & out) const
+    {
+        out << "Ingestion pipeline ("
+            << m_filePaths.size() << " chunks, "
+            << m_index.m_documentCount << " documents, "
+            << m_elapsedTime << "s)" << std::endl;
+
+        PrintStage(out, "read", "chunks",
+                   m_read.m_itemCount,
+                   m_read.m_byteCount,
+                   m_read.m_busyTime,
+                   1);
+        PrintStage(out, "split", "chunks",
+                   m_split.m_itemCount,
+                   m_split.m_byteCount,
+                   m_split.m_busyTime,
+                   1);
+        PrintStage(out, "index", "batches",
+                   m_index.m_itemCount,
+                   m_index.m_byteCount,
+                   m_index.m_busyTime,
+                   m_threadCount);
+
+        m_chunkQueue.Print(out, "chunk");
+        m_batchQueue.Print(out, "batch");
+    }
+
+
+    //*************************************************************************
+    //
+    // ChunkIngestionPipeline::StageStatistics
+    //
+    //*************************************************************************
+    ChunkIngestionPipeline::StageStatistics::StageStatistics()
+      : m_itemCount(0),
+        m_documentCount(0),
+        m_byteCount(0),
+        m_busyTime(0.0)
+    {
+    }
+
+
+    void ChunkIngestionPipeline::StageStatistics::Add(
+        StageStatistics const & other)
+    {
+        m_itemCount += other.m_itemCount;
+        m_documentCount += other.m_documentCount;
+        m_byteCount += other.m_byteCount;
+        m_busyTime += other.m_busyTime;
+    }
+
+
+    //*************************************************************************
+    //
+    // ChunkIngestionPipeline::QueueStatistics
+    //
+    //*************************************************************************
+    ChunkIngestionPipeline::QueueStatistics::QueueStatistics(unsigned capacity)
+      : m_capacity(capacity),
+        m_sampleCount(0),
+        m_depthSum(0),
+        m_maxDepth(0)
+    {
+    }
+
+
+    void ChunkIngestionPipeline::QueueStatistics::Sample(ptrdiff_t depth)
+    {
+        const size_t items =
+            (depth < 0) ? 0 : std::min(static_cast<size_t>(depth),
+                                       static_cast<size_t>(m_capacity));
+        ++m_sampleCount;
+        m_depthSum += items;
+        m_maxDepth = std::max(m_maxDepth, items);
+    }
+
+
+    void ChunkIngestionPipeline::QueueStatistics::Print(
+        std::ostream & out,
+        char const * name) const
+    {
+        const double mean = (m_sampleCount == 0) ?
+            0.0 :
+            static_cast<double>(m_depthSum) / m_sampleCount;
+
+        out << "  " << name << " queue: capacity " << m_capacity
+            << ", mean depth " << std::fixed << std::setprecision(2) << mean
+            << std::defaultfloat
+            << ", max depth " << m_maxDepth << std::endl;
+    }
+}
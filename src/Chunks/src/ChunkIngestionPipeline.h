@@ -0,0 +1,167 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>                                       // std::atomic member.
+#include <iosfwd>                                       // std::ostream parameter.
+#include <memory>                                       // std::unique_ptr member.
+#include <stddef.h>                                     // size_t, ptrdiff_t members.
+#include <string>                                       // std::string member.
+#include <vector>                                       // std::vector member.
+
+#include "BitFunnel/Chunks/IChunkIngestionPipeline.h"   // Base class.
+#include "BitFunnel/NonCopyable.h"                      // Base class.
+#include "BitFunnel/Utilities/BlockingQueue.h"          // BlockingQueue member.
+#include "BitFunnel/Utilities/IThreadManager.h"         // IThreadBase base class.
+
+
+namespace BitFunnel
+{
+    class IConfiguration;
+    class IDocumentFilter;
+    class IFileSystem;
+    class IIngestor;
+
+    //*************************************************************************
+    //
+    // ChunkIngestionPipeline
+    //
+    // IChunkIngestionPipeline with three stages:
+    //   read:  one thread loads chunk files, running up to
+    //          c_chunkQueueCapacity chunks ahead of the split stage.
+    //   split: one thread parses each chunk just far enough to find its
+    //          document boundaries, and copies runs of c_documentsPerBatch
+    //          documents into Batches using the chunk's IChunkWriter. Each
+    //          Batch is a complete chunk in the format of its source.
+    //   index: threadCount threads each build the Documents in a Batch and
+    //          add them to the IIngestor.
+    //
+    // The stages are connected by BlockingQueues, so a slow stage applies
+    // back pressure to the stages before it. Each stage ends the stage
+    // after it by enqueueing a nullptr for each of its consumers.
+    //
+    //*************************************************************************
+    class ChunkIngestionPipeline : public IChunkIngestionPipeline, NonCopyable
+    {
+    public:
+        ChunkIngestionPipeline(IFileSystem & fileSystem,
+                               std::vector<std::string> const & filePaths,
+                               IConfiguration const & config,
+                               IIngestor & ingestor,
+                               IDocumentFilter & filter,
+                               bool cacheDocuments,
+                               size_t threadCount);
+
+        //
+        // IChunkIngestionPipeline methods.
+        //
+        virtual void Ingest() override;
+        virtual void PrintStatistics(std::ostream & out) const override;
+
+        static const unsigned c_chunkQueueCapacity = 2;
+        static const unsigned c_batchQueueCapacityPerThread = 4;
+        static const size_t c_documentsPerBatch = 64;
+
+    private:
+        // A run of consecutive documents from one chunk, followed by the
+        // chunk epilogue, so that ChunkReader can parse it on its own.
+        class Batch
+        {
+        public:
+            std::string m_data;
+            size_t m_documentCount;
+        };
+
+        typedef std::vector<char> Chunk;
+
+        // Counts the work done by one or more threads running a stage.
+        // The busy time excludes time spent waiting on the queues.
+        class StageStatistics
+        {
+        public:
+            StageStatistics();
+
+            void Add(StageStatistics const & other);
+
+            size_t m_itemCount;
+            size_t m_documentCount;
+            size_t m_byteCount;
+            double m_busyTime;
+        };
+
+        // Depths of a queue, sampled by its producer after each enqueue.
+        class QueueStatistics
+        {
+        public:
+            QueueStatistics(unsigned capacity = 0);
+
+            // The depth counter also includes items that consumers have
+            // dequeued but not yet counted, so samples are clamped to the
+            // capacity.
+            void Sample(ptrdiff_t depth);
+            void Print(std::ostream & out, char const * name) const;
+
+            unsigned m_capacity;
+            size_t m_sampleCount;
+            size_t m_depthSum;
+            size_t m_maxDepth;
+        };
+
+        class ReadThread;
+        class SplitThread;
+        class IndexThread;
+
+        //
+        // Constructor parameters.
+        //
+        IFileSystem & m_fileSystem;
+        std::vector<std::string> const & m_filePaths;
+        IConfiguration const & m_config;
+        IIngestor & m_ingestor;
+        IDocumentFilter & m_filter;
+        bool m_cacheDocuments;
+        size_t m_threadCount;
+
+        //
+        // State of the current call to Ingest().
+        //
+        std::unique_ptr<BlockingQueue<std::unique_ptr<Chunk>>> m_chunks;
+        std::unique_ptr<BlockingQueue<std::unique_ptr<Batch>>> m_batches;
+
+        // Number of items in m_chunks and m_batches. Producers increment
+        // after each enqueue, so a consumer may briefly take a depth below
+        // zero.
+        std::atomic<ptrdiff_t> m_chunkDepth;
+        std::atomic<ptrdiff_t> m_batchDepth;
+
+        //
+        // Statistics for the most recent call to Ingest().
+        //
+        double m_elapsedTime;
+        StageStatistics m_read;
+        StageStatistics m_split;
+        StageStatistics m_index;
+        QueueStatistics m_chunkQueue;
+        QueueStatistics m_batchQueue;
+    };
+}
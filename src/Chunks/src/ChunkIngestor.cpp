@@ -73,6 +73,18 @@ namespace BitFunnel
     }
 
 
+    void ChunkIngestor::OnTermHash(Term::Hash rawHash)
+    {
+        m_currentDocument->AddTermHash(rawHash);
+    }
+
+
+    void ChunkIngestor::OnPosting(Term const & term)
+    {
+        m_currentDocument->AddPosting(term);
+    }
+
+
     void ChunkIngestor::OnStreamExit()
     {
         m_currentDocument->CloseStream();
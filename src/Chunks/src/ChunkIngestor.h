@@ -53,6 +53,8 @@ namespace BitFunnel
         virtual void OnDocumentEnter(DocId id) override;
         virtual void OnStreamEnter(Term::StreamId id) override;
         virtual void OnTerm(char const * term) override;
+        virtual void OnTermHash(Term::Hash rawHash) override;
+        virtual void OnPosting(Term const & term) override;
         virtual void OnStreamExit() override;
         virtual void OnDocumentExit(IChunkWriter & writer,
                                     size_t bytesRead) override;
@@ -0,0 +1,95 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <ostream>
+
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "ChunkHasher.h"
+#include "ChunkManifestHasher.h"
+#include "ChunkManifestIngestor.h"
+#include "ChunkReader.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IChunkManifestIngestor>
+        Factories::CreateChunkManifestHasher(
+            IFileSystem& fileSystem,
+            IFileManager& outputFiles,
+            std::vector<std::string> const & filePaths,
+            IConfiguration const & config,
+            bool expandNGrams)
+    {
+        return std::unique_ptr<IChunkManifestIngestor>(
+            new ChunkManifestHasher(
+                fileSystem,
+                outputFiles,
+                filePaths,
+                config,
+                expandNGrams));
+    }
+
+
+    ChunkManifestHasher::ChunkManifestHasher(
+        IFileSystem& fileSystem,
+        IFileManager& outputFiles,
+        std::vector<std::string> const & filePaths,
+        IConfiguration const & config,
+        bool expandNGrams)
+      : m_fileSystem(fileSystem),
+        m_outputFiles(outputFiles),
+        m_filePaths(filePaths),
+        m_configuration(config),
+        m_expandNGrams(expandNGrams)
+    {
+    }
+
+
+    size_t ChunkManifestHasher::GetChunkCount() const
+    {
+        return m_filePaths.size();
+    }
+
+
+    void ChunkManifestHasher::IngestChunk(size_t index) const
+    {
+        if (index >= m_filePaths.size())
+        {
+            FatalError error("ChunkManifestHasher: chunk index out of range.");
+            throw error;
+        }
+
+        std::vector<char> chunkData;
+        ChunkManifestIngestor::LoadChunk(m_fileSystem,
+                                         m_filePaths[index],
+                                         chunkData);
+
+        auto output = m_outputFiles.Chunk(index).OpenForWrite();
+        ChunkHasher processor(m_configuration, m_expandNGrams, *output);
+
+        ChunkReader(&chunkData[0],
+                    &chunkData[0] + chunkData.size(),
+                    processor);
+    }
+}
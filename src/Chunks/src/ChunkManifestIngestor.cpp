@@ -89,27 +89,8 @@ namespace BitFunnel
             throw error;
         }
 
-        auto input = m_fileSystem.OpenForRead(m_filePaths[index].c_str(),
-                                              std::ios::binary);
-
-        if (input->fail())
-        {
-            std::stringstream message;
-            message << "Failed to open chunk file '"
-                << m_filePaths[index]
-                << "'";
-            throw FatalError(message.str());
-        }
-
-        input->seekg(0, input->end);
-        auto length = input->tellg();
-        input->seekg(0, input->beg);
-
         std::vector<char> chunkData;
-        chunkData.reserve(static_cast<size_t>(length) + 1ull);
-        chunkData.insert(chunkData.begin(),
-                         (std::istreambuf_iterator<char>(*input)),
-                         std::istreambuf_iterator<char>());
+        LoadChunk(m_fileSystem, m_filePaths[index], chunkData);
 
         {
             // Block scopes std::ostream.
@@ -130,4 +111,32 @@ namespace BitFunnel
                         processor);
         }
     }
+
+
+    void ChunkManifestIngestor::LoadChunk(IFileSystem & fileSystem,
+                                          std::string const & path,
+                                          std::vector<char> & chunkData)
+    {
+        auto input = fileSystem.OpenForRead(path.c_str(),
+                                            std::ios::binary);
+
+        if (input->fail())
+        {
+            std::stringstream message;
+            message << "Failed to open chunk file '"
+                << path
+                << "'";
+            throw FatalError(message.str());
+        }
+
+        input->seekg(0, input->end);
+        auto length = input->tellg();
+        input->seekg(0, input->beg);
+
+        chunkData.clear();
+        chunkData.reserve(static_cast<size_t>(length) + 1ull);
+        chunkData.insert(chunkData.begin(),
+                         (std::istreambuf_iterator<char>(*input)),
+                         std::istreambuf_iterator<char>());
+    }
 }
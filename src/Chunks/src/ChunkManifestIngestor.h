@@ -55,6 +55,12 @@ namespace BitFunnel
 
         virtual void IngestChunk(size_t index) const override;
 
+        // Reads the entire contents of a chunk file into chunkData. Throws
+        // FatalError if the file cannot be opened.
+        static void LoadChunk(IFileSystem & fileSystem,
+                              std::string const & path,
+                              std::vector<char> & chunkData);
+
     private:
 
         //
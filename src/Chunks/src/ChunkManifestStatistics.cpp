@@ -0,0 +1,93 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Exceptions.h"
+#include "ChunkManifestIngestor.h"
+#include "ChunkManifestStatistics.h"
+#include "ChunkReader.h"
+#include "ChunkStatisticsProcessor.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IChunkManifestIngestor>
+        Factories::CreateChunkManifestStatistics(
+            IFileSystem& fileSystem,
+            std::vector<std::string> const & filePaths,
+            IConfiguration const & config,
+            IStreamingStatistics& statistics,
+            IDocumentFilter & filter)
+    {
+        return std::unique_ptr<IChunkManifestIngestor>(
+            new ChunkManifestStatistics(
+                fileSystem,
+                filePaths,
+                config,
+                statistics,
+                filter));
+    }
+
+
+    ChunkManifestStatistics::ChunkManifestStatistics(
+        IFileSystem& fileSystem,
+        std::vector<std::string> const & filePaths,
+        IConfiguration const & config,
+        IStreamingStatistics& statistics,
+        IDocumentFilter & filter)
+      : m_fileSystem(fileSystem),
+        m_filePaths(filePaths),
+        m_configuration(config),
+        m_statistics(statistics),
+        m_filter(filter)
+    {
+    }
+
+
+    size_t ChunkManifestStatistics::GetChunkCount() const
+    {
+        return m_filePaths.size();
+    }
+
+
+    void ChunkManifestStatistics::IngestChunk(size_t index) const
+    {
+        if (index >= m_filePaths.size())
+        {
+            FatalError error("ChunkManifestStatistics: chunk index out of range.");
+            throw error;
+        }
+
+        std::vector<char> chunkData;
+        ChunkManifestIngestor::LoadChunk(m_fileSystem,
+                                         m_filePaths[index],
+                                         chunkData);
+
+        ChunkStatisticsProcessor processor(m_configuration,
+                                           m_statistics,
+                                           m_filter);
+
+        ChunkReader(&chunkData[0],
+                    &chunkData[0] + chunkData.size(),
+                    processor);
+    }
+}
@@ -25,6 +25,7 @@
 #include "BitFunnel/Chunks/IChunkProcessor.h"
 #include "BitFunnel/Exceptions.h"
 #include "ChunkReader.h"
+#include "HashedChunkReader.h"
 
 
 namespace BitFunnel
@@ -51,6 +52,12 @@ namespace BitFunnel
             throw FatalError("Attempt to read empty chunk.");
         }
 
+        if (HashedChunkReader::IsHashedChunk(start, end))
+        {
+            HashedChunkReader reader(start, end, processor);
+            return;
+        }
+
         m_processor.OnFileEnter();
         while (PeekChar() != 0)
         {
@@ -25,8 +25,9 @@
 #include <stdint.h>
 #include <vector>
 
-#include "BitFunnel/NonCopyable.h"  // Base class.
-#include "BitFunnel/Term.h"         // Term::StreamId return value.
+#include "BitFunnel/Chunks/IChunkProcessor.h"  // IChunkWriter base class.
+#include "BitFunnel/NonCopyable.h"              // Base class.
+#include "BitFunnel/Term.h"                     // Term::StreamId return value.
 
 
 namespace BitFunnel
@@ -38,7 +39,8 @@ namespace BitFunnel
     // ChunkReader
     //
     // Parses a buffer of documents encoded in the BitFunnel chunk format,
-    // generating callbacks to an IChunkProcessor.
+    // generating callbacks to an IChunkProcessor. Buffers in the hashed
+    // chunk format are passed on to HashedChunkReader.
     //
     //*************************************************************************
     class ChunkReader : public NonCopyable
@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "BitFunnel/Chunks/IChunkProcessor.h"
+#include "BitFunnel/Index/IStreamingStatistics.h"
+#include "ChunkStatisticsProcessor.h"
+
+
+namespace BitFunnel
+{
+    ChunkStatisticsProcessor::ChunkStatisticsProcessor(
+        IConfiguration const & config,
+        IStreamingStatistics & statistics,
+        IDocumentFilter & filter)
+      : m_config(config),
+        m_statistics(statistics),
+        m_filter(filter)
+    {
+    }
+
+
+    void ChunkStatisticsProcessor::OnFileEnter()
+    {
+    }
+
+
+    void ChunkStatisticsProcessor::OnDocumentEnter(DocId id)
+    {
+        m_currentDocument.reset(new Document(m_config, id));
+    }
+
+
+    void ChunkStatisticsProcessor::OnStreamEnter(Term::StreamId id)
+    {
+        m_currentDocument->OpenStream(id);
+    }
+
+
+    void ChunkStatisticsProcessor::OnTerm(char const * term)
+    {
+        m_currentDocument->AddTerm(term);
+    }
+
+
+    void ChunkStatisticsProcessor::OnTermHash(Term::Hash rawHash)
+    {
+        m_currentDocument->AddTermHash(rawHash);
+    }
+
+
+    void ChunkStatisticsProcessor::OnPosting(Term const & term)
+    {
+        m_currentDocument->AddPosting(term);
+    }
+
+
+    void ChunkStatisticsProcessor::OnStreamExit()
+    {
+        m_currentDocument->CloseStream();
+    }
+
+
+    void ChunkStatisticsProcessor::OnDocumentExit(IChunkWriter & /*writer*/,
+                                                  size_t bytesRead)
+    {
+        m_currentDocument->CloseDocument(bytesRead);
+
+        if (m_filter.KeepDocument(*m_currentDocument))
+        {
+            m_postings.clear();
+            m_currentDocument->GetPostings(m_postings);
+            m_statistics.AddDocument(m_postings, bytesRead);
+        }
+
+        m_currentDocument.reset(nullptr);
+    }
+
+
+    void ChunkStatisticsProcessor::OnFileExit(IChunkWriter & /*writer*/)
+    {
+    }
+}
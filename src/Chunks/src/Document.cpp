@@ -27,6 +27,7 @@
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/DocumentHandle.h"
 #include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IIndexedIdfTable.h"
 #include "Document.h"
 #include "LoggerInterfaces/Logging.h"
 
@@ -119,15 +120,39 @@ namespace BitFunnel
                                               m_currentStreamId,
                                               m_configuration);
 
-            if (m_ringBuffer.GetCount() == m_maxGramSize)
-            {
-                ProcessNGrams();
-                m_ringBuffer.PopFront();
-            }
+            AdvanceRingBuffer();
         }
     }
 
 
+    void Document::AddTermHash(Term::Hash rawHash)
+    {
+        if (!m_streamIsOpen)
+        {
+            throw FatalError("Attempting AddTermHash() with no open stream.");
+        }
+        else if (m_configuration.KeepTermText())
+        {
+            throw FatalError("Attempting AddTermHash() when keeping term text.");
+        }
+        else
+        {
+            new(m_ringBuffer.PushBack())
+                Term(rawHash,
+                     m_currentStreamId,
+                     m_configuration.GetIdfTable().GetIdf(rawHash));
+
+            AdvanceRingBuffer();
+        }
+    }
+
+
+    void Document::AddPosting(Term const & term)
+    {
+        m_postings.insert(term);
+    }
+
+
     void Document::CloseStream()
     {
         if (!m_streamIsOpen)
@@ -150,6 +175,12 @@ namespace BitFunnel
     }
 
 
+    void Document::GetPostings(std::vector<Term> & postings) const
+    {
+        postings.insert(postings.end(), m_postings.begin(), m_postings.end());
+    }
+
+
     void Document::ProcessNGrams()
     {
         const size_t count = m_ringBuffer.GetCount();
@@ -166,9 +197,9 @@ namespace BitFunnel
     }
 
 
-    void Document::PurgeRingBuffer()
+    void Document::AdvanceRingBuffer()
     {
-        while (!m_ringBuffer.IsEmpty())
+        if (m_ringBuffer.GetCount() == m_maxGramSize)
         {
             ProcessNGrams();
             m_ringBuffer.PopFront();
@@ -176,8 +207,12 @@ namespace BitFunnel
     }
 
 
-    void Document::AddPosting(Term term)
+    void Document::PurgeRingBuffer()
     {
-        m_postings.insert(term);
+        while (!m_ringBuffer.IsEmpty())
+        {
+            ProcessNGrams();
+            m_ringBuffer.PopFront();
+        }
     }
 }
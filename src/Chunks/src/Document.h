@@ -23,6 +23,7 @@
 #pragma once
 
 #include <unordered_set>                    // TODO: Remove this temporary include.
+#include <vector>                           // std::vector parameter.
 
 #include "BitFunnel/BitFunnelTypes.h"       // DocId parameter.
 #include "BitFunnel/Index/IDocument.h"      // Inherits from IDocument.
@@ -72,13 +73,32 @@ namespace BitFunnel
         // Adds a term to the currently opened stream.
         virtual void AddTerm(char const * term) override;
 
+        // Adds a term, given by its Term::ComputeRawHash() value, to the
+        // currently opened stream. The term's IDF comes from the
+        // IConfiguration. Throws if the IConfiguration keeps term text,
+        // since the text is not available.
+        void AddTermHash(Term::Hash rawHash);
+
+        // Adds a posting without ngram expansion. Used for postings whose
+        // ngrams were expanded ahead of time.
+        void AddPosting(Term const & term);
+
         // Closes the current stream.
         virtual void CloseStream() override;
 
         // CloseDocument() should be called once all terms have been added.
         virtual void CloseDocument(size_t sourceByteSize) override;
 
+        // Appends each of the terms that Ingest() would post to the
+        // document. Each term appears exactly once.
+        void GetPostings(std::vector<Term> & postings) const;
+
     private:
+        // Forms the ngrams that start at the front of m_ringBuffer once it
+        // holds m_maxGramSize terms. Called after each term is pushed onto
+        // m_ringBuffer.
+        void AdvanceRingBuffer();
+
         // Invoke AddPosting() for each ngram starting at the front of
         // m_ringBuffer. This includes ngrams with lengths 1 to
         // IConfiguration::GetMaxGramSize.
@@ -88,10 +108,6 @@ namespace BitFunnel
         // m_ringBuffer.
         void PurgeRingBuffer();
 
-        // Add term to the set of terms used to create postings in a
-        // call to Ingest().
-        void AddPosting(Term term);
-
         //
         // Constructor parameters.
         //
@@ -66,6 +66,7 @@ namespace BitFunnel
 
     bool RandomDocumentFilter::KeepDocument(IDocument const & /*document*/)
     {
+        std::lock_guard<std::mutex> lock(m_lock);
         return m_engine() < m_fraction;
     }
 
@@ -0,0 +1,201 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstring>
+#include <ostream>
+
+#include "BitFunnel/Chunks/IChunkProcessor.h"
+#include "BitFunnel/Exceptions.h"
+#include "HashedChunkReader.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // HashedChunkReader
+    //
+    //*************************************************************************
+    char const HashedChunkReader::c_magic[8] =
+        { '\0', 'B', 'F', 'H', 'A', 'S', 'H', '\0' };
+
+    const uint32_t HashedChunkReader::c_version;
+    const uint32_t HashedChunkReader::c_expandedNGrams;
+    const size_t HashedChunkReader::c_headerByteCount;
+
+
+    HashedChunkReader::HashedChunkReader(char const * start,
+                                         char const * end,
+                                         IChunkProcessor& processor)
+        : m_processor(processor),
+          m_header(start),
+          m_next(start),
+          m_end(end),
+          m_expandedNGrams(false),
+          m_headerOutput(nullptr)
+    {
+        if (!IsHashedChunk(start, end))
+        {
+            throw FatalError("Expected hashed chunk magic number.");
+        }
+        m_next += sizeof(c_magic);
+
+        if (Read<uint32_t>() != c_version)
+        {
+            throw FatalError("Unsupported hashed chunk version.");
+        }
+        m_expandedNGrams = (Read<uint32_t>() & c_expandedNGrams) != 0;
+
+        m_processor.OnFileEnter();
+
+        uint32_t byteCount;
+        while ((byteCount = Read<uint32_t>()) != 0)
+        {
+            ProcessDocument(byteCount);
+        }
+
+        ChunkWriter writer(m_header, nullptr, nullptr, m_headerOutput);
+        m_processor.OnFileExit(writer);
+    }
+
+
+    bool HashedChunkReader::IsHashedChunk(char const * start, char const * end)
+    {
+        return (end - start) >= static_cast<ptrdiff_t>(c_headerByteCount)
+            && memcmp(start, c_magic, sizeof(c_magic)) == 0;
+    }
+
+
+    void HashedChunkReader::ProcessDocument(uint32_t byteCount)
+    {
+        char const * start = m_next - sizeof(uint32_t);
+        if (static_cast<size_t>(m_end - m_next) < byteCount)
+        {
+            throw FatalError("Hashed chunk record extends beyond end of buffer.");
+        }
+        char const * recordEnd = m_next + byteCount;
+
+        m_processor.OnDocumentEnter(static_cast<DocId>(Read<uint64_t>()));
+
+        const uint32_t streamCount = Read<uint32_t>();
+        for (uint32_t stream = 0; stream < streamCount; ++stream)
+        {
+            const Term::StreamId streamId = Read<Term::StreamId>();
+            m_processor.OnStreamEnter(streamId);
+
+            const uint32_t entryCount = Read<uint32_t>();
+            if (m_expandedNGrams)
+            {
+                for (uint32_t i = 0; i < entryCount; ++i)
+                {
+                    const Term::Hash rawHash = Read<Term::Hash>();
+                    const Term::GramSize gramSize = Read<Term::GramSize>();
+                    const Term::IdfX10 idfSum = Read<Term::IdfX10>();
+                    const Term::IdfX10 idfMax = Read<Term::IdfX10>();
+                    m_processor.OnPosting(
+                        Term(rawHash, streamId, gramSize, idfSum, idfMax));
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < entryCount; ++i)
+                {
+                    m_processor.OnTermHash(Read<Term::Hash>());
+                }
+            }
+
+            m_processor.OnStreamExit();
+        }
+
+        if (m_next != recordEnd)
+        {
+            throw FatalError("Hashed chunk record size mismatch.");
+        }
+
+        ChunkWriter writer(m_header, start, m_next, m_headerOutput);
+        m_processor.OnDocumentExit(writer,
+                                   static_cast<size_t>(m_next - start));
+    }
+
+
+    template <typename T>
+    T HashedChunkReader::Read()
+    {
+        if (static_cast<size_t>(m_end - m_next) < sizeof(T))
+        {
+            throw FatalError("Attempt to read beyond end of buffer.");
+        }
+
+        // Records are packed, so values may be unaligned.
+        T value;
+        memcpy(&value, m_next, sizeof(T));
+        m_next += sizeof(T);
+        return value;
+    }
+
+
+    //*************************************************************************
+    //
+    // HashedChunkReader::ChunkWriter
+    //
+    //*************************************************************************
+    HashedChunkReader::ChunkWriter::ChunkWriter(char const * header,
+                                                char const * start,
+                                                char const * end,
+                                                std::ostream const * & headerOutput)
+      : m_header(header),
+        m_start(start),
+        m_end(end),
+        m_headerOutput(headerOutput)
+    {
+    }
+
+
+    void HashedChunkReader::ChunkWriter::Write(std::ostream & output)
+    {
+        WriteHeader(output);
+        output.write(m_start, m_end - m_start);
+    }
+
+
+    void HashedChunkReader::ChunkWriter::Complete(std::ostream & output)
+    {
+        WriteHeader(output);
+        const uint32_t endOfChunk = 0;
+        output.write(reinterpret_cast<char const *>(&endOfChunk),
+                     sizeof(endOfChunk));
+
+        // The chunk in output is closed, so the next Write() starts a new
+        // chunk, even if it goes to a new stream at the same address.
+        m_headerOutput = nullptr;
+    }
+
+
+    void HashedChunkReader::ChunkWriter::WriteHeader(std::ostream & output)
+    {
+        if (m_headerOutput != &output)
+        {
+            output.write(m_header, c_headerByteCount);
+            m_headerOutput = &output;
+        }
+    }
+}
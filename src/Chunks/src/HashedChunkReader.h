@@ -0,0 +1,139 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                               // std::ostream member.
+#include <stddef.h>                             // size_t member.
+#include <stdint.h>                             // uint32_t member.
+
+#include "BitFunnel/Chunks/IChunkProcessor.h"  // IChunkWriter base class.
+#include "BitFunnel/NonCopyable.h"              // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // HashedChunkReader
+    //
+    // Parses a buffer of documents encoded in the hashed chunk format,
+    // generating callbacks to an IChunkProcessor. The hashed chunk format is
+    // a binary form of the BitFunnel chunk format in which each term is
+    // replaced by its raw hash, so ingestion does no tokenizing or hashing.
+    // ChunkHasher produces hashed chunks.
+    //
+    // A hashed chunk consists of a header followed by a sequence of document
+    // records. Values are stored in host byte order.
+    //   header:
+    //     magic:           8 bytes. The first byte is zero, so a hashed
+    //                      chunk can be told apart from a text chunk, which
+    //                      starts with a hex digit or is the single byte '\0'.
+    //     version:         4 bytes.
+    //     flags:           4 bytes. c_expandedNGrams is set if the streams
+    //                      hold postings instead of raw hashes.
+    //   document:
+    //     byte count:      4 byte size of the rest of the record. A byte
+    //                      count of zero ends the chunk.
+    //     id:              8 byte DocId.
+    //     stream count:    4 bytes, followed by the streams.
+    //   stream:
+    //     id:              1 byte Term::StreamId.
+    //     entry count:     4 bytes, followed by the entries.
+    //   entry:
+    //     raw hash:        8 bytes.
+    //     If c_expandedNGrams is set, the raw hash is followed by one byte
+    //     each for the gram size, the IDF sum, and the IDF max.
+    //
+    // Raw hashes are turned into Terms with the IDF values of the
+    // IConfiguration used for ingestion. Expanded postings keep the IDF
+    // values of the IConfiguration used for conversion.
+    //
+    //*************************************************************************
+    class HashedChunkReader : public NonCopyable
+    {
+    public:
+        HashedChunkReader(char const * start,
+                          char const * end,
+                          IChunkProcessor& processor);
+
+        // Returns true if the buffer [start, end) starts with the hashed
+        // chunk magic number.
+        static bool IsHashedChunk(char const * start, char const * end);
+
+        static char const c_magic[8];
+        static const uint32_t c_version = 1;
+        static const uint32_t c_expandedNGrams = 1;
+        static const size_t c_headerByteCount = 16;
+
+    private:
+        class ChunkWriter : public IChunkWriter
+        {
+        public:
+            ChunkWriter(char const * header,
+                        char const * start,
+                        char const * end,
+                        std::ostream const * & headerOutput);
+
+            // Writes the bytes in range [m_start, m_end), preceded by the
+            // chunk header if this is the first write to the stream.
+            void Write(std::ostream & output) override;
+
+            // Writes the record that ends a chunk, preceded by the chunk
+            // header if no documents were written to the stream.
+            void Complete(std::ostream & output) override;
+
+        private:
+            void WriteHeader(std::ostream & output);
+
+            char const * m_header;
+            char const * m_start;
+            char const * m_end;
+            std::ostream const * & m_headerOutput;
+        };
+
+        void ProcessDocument(uint32_t byteCount);
+
+        template <typename T>
+        T Read();
+
+        // Constructor parameters.
+        IChunkProcessor& m_processor;
+
+        // Start of the chunk header.
+        char const * m_header;
+
+        // Next byte to be processed.
+        char const * m_next;
+
+        // Pointer to byte beyond the end of the input.
+        char const * m_end;
+
+        bool m_expandedNGrams;
+
+        // The stream that the IChunkWriters most recently wrote the chunk
+        // header to, or nullptr after Complete(). A processor may split the
+        // chunk's documents across several streams, each of which needs its
+        // own header.
+        std::ostream const * m_headerOutput;
+    };
+}
@@ -88,6 +88,24 @@ namespace BitFunnel
             }
 
 
+            void OnTermHash(Term::Hash rawHash) override
+            {
+                m_trace << "OnTermHash;hash: "
+                        << std::hex << rawHash << std::dec
+                        << std::endl;
+            }
+
+
+            void OnPosting(Term const & term) override
+            {
+                m_trace << "OnPosting;hash: "
+                        << std::hex << term.GetRawHash() << std::dec
+                        << ", gramSize: "
+                        << static_cast<uint64_t>(term.GetGramSize())
+                        << std::endl;
+            }
+
+
             void OnStreamExit() override
             {
                 m_trace << "OnStreamExit" << std::endl;
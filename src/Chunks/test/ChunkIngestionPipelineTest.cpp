@@ -0,0 +1,146 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Chunks/DocumentFilters.h"
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Chunks/IChunkIngestionPipeline.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "ChunkHasher.h"
+#include "ChunkIngestionPipeline.h"
+#include "ChunkReader.h"
+
+
+namespace BitFunnel
+{
+    namespace ChunkIngestionPipelineTest
+    {
+        // Returns a text chunk with documentCount documents, numbered
+        // consecutively from firstId.
+        static std::string CreateTextChunk(DocId firstId, size_t documentCount)
+        {
+            std::stringstream chunk;
+            for (DocId id = firstId; id < firstId + documentCount; ++id)
+            {
+                chunk << std::hex << std::setfill('0') << std::setw(16) << id
+                      << std::dec << '\0'
+                      << "00" << '\0'
+                      << "term" << (id % 7) << '\0'
+                      << "doc" << id << '\0'
+                      << '\0'
+                      << '\0';
+            }
+            chunk << '\0';
+            return chunk.str();
+        }
+
+
+        static std::string Hash(std::string const & chunk,
+                                IConfiguration const & config)
+        {
+            std::stringstream output;
+            ChunkHasher hasher(config, false, output);
+            ChunkReader(chunk.data(), chunk.data() + chunk.size(), hasher);
+            return output.str();
+        }
+
+
+        static void Ingest(size_t threadCount)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            auto index = Factories::CreateSimpleIndex(*fileSystem);
+            index->ConfigureAsMock(1, false);
+            index->StartIndex();
+
+            // Chunk sizes straddle ChunkIngestionPipeline::c_documentsPerBatch
+            // so that the pipeline sees both full and partial batches.
+            const size_t batch = ChunkIngestionPipeline::c_documentsPerBatch;
+            const std::vector<size_t> documentCounts =
+                { 1, batch, batch + 1, 3 * batch + 5, 2, batch - 1 };
+
+            std::vector<std::string> filePaths;
+            DocId id = 0;
+            for (size_t i = 0; i < documentCounts.size(); ++i)
+            {
+                std::string chunk = CreateTextChunk(id, documentCounts[i]);
+                if (i % 2 == 1)
+                {
+                    chunk = Hash(chunk, index->GetConfiguration());
+                }
+                id += documentCounts[i];
+
+                filePaths.push_back("chunk" + std::to_string(i));
+                auto output = fileSystem->OpenForWrite(filePaths.back().c_str(),
+                                                       std::ios::binary);
+                output->write(chunk.data(), chunk.size());
+            }
+            const DocId documentCount = id;
+
+            NopFilter filter;
+            auto pipeline =
+                Factories::CreateChunkIngestionPipeline(*fileSystem,
+                                                        filePaths,
+                                                        index->GetConfiguration(),
+                                                        index->GetIngestor(),
+                                                        filter,
+                                                        false,
+                                                        threadCount);
+            pipeline->Ingest();
+
+            IIngestor & ingestor = index->GetIngestor();
+            EXPECT_EQ(ingestor.GetDocumentCount(), documentCount);
+            for (id = 0; id < documentCount; ++id)
+            {
+                EXPECT_TRUE(ingestor.Contains(id)) << "DocId " << id;
+            }
+
+            std::stringstream statistics;
+            pipeline->PrintStatistics(statistics);
+            EXPECT_NE(statistics.str().find(std::to_string(documentCount)
+                                            + " documents"),
+                      std::string::npos);
+        }
+
+
+        TEST(ChunkIngestionPipeline, SingleThread)
+        {
+            Ingest(1);
+        }
+
+
+        TEST(ChunkIngestionPipeline, MultipleThreads)
+        {
+            Ingest(3);
+        }
+    }
+}
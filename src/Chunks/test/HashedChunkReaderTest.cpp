@@ -0,0 +1,276 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IFactSet.h"
+#include "BitFunnel/Index/IIndexedIdfTable.h"
+#include "ChunkEventTracer.h"
+#include "ChunkHasher.h"
+#include "ChunkReader.h"
+#include "Document.h"
+#include "HashedChunkReader.h"
+
+
+namespace BitFunnel
+{
+    namespace HashedChunkReaderTest
+    {
+        typedef std::unordered_set<Term, Term::Hasher> PostingSet;
+
+        // Ingests each document into a Document, recording its postings,
+        // and copies the documents to an optional output stream.
+        class DocumentCollector : public IChunkProcessor
+        {
+        public:
+            DocumentCollector(IConfiguration const & config,
+                              std::ostream * output = nullptr)
+              : m_config(config),
+                m_output(output)
+            {
+            }
+
+            std::vector<PostingSet> const & GetPostings() const
+            {
+                return m_postings;
+            }
+
+            virtual void OnFileEnter() override
+            {
+            }
+
+            virtual void OnDocumentEnter(DocId id) override
+            {
+                m_document.reset(new Document(m_config, id));
+            }
+
+            virtual void OnStreamEnter(Term::StreamId id) override
+            {
+                m_document->OpenStream(id);
+            }
+
+            virtual void OnTerm(char const * term) override
+            {
+                m_document->AddTerm(term);
+            }
+
+            virtual void OnTermHash(Term::Hash rawHash) override
+            {
+                m_document->AddTermHash(rawHash);
+            }
+
+            virtual void OnPosting(Term const & term) override
+            {
+                m_document->AddPosting(term);
+            }
+
+            virtual void OnStreamExit() override
+            {
+                m_document->CloseStream();
+            }
+
+            virtual void OnDocumentExit(IChunkWriter & writer,
+                                        size_t bytesRead) override
+            {
+                m_document->CloseDocument(bytesRead);
+
+                std::vector<Term> postings;
+                m_document->GetPostings(postings);
+                m_postings.emplace_back(postings.begin(), postings.end());
+
+                if (m_output != nullptr)
+                {
+                    writer.Write(*m_output);
+                }
+            }
+
+            virtual void OnFileExit(IChunkWriter & writer) override
+            {
+                if (m_output != nullptr)
+                {
+                    writer.Complete(*m_output);
+                }
+            }
+
+        private:
+            IConfiguration const & m_config;
+            std::ostream * m_output;
+            std::unique_ptr<Document> m_document;
+            std::vector<PostingSet> m_postings;
+        };
+
+
+        static std::vector<char> ToVector(std::string const & s)
+        {
+            return std::vector<char>(s.begin(), s.end());
+        }
+
+
+        static std::vector<char> const & GetTextChunk()
+        {
+            static char const text[] =
+                "0000000000000001\0"
+                "00\0Dogs\0are\0man's\0best\0friend.\0\0"
+                "01\0Dogs\0\0"
+                "\0"
+                "0000000000000002\0"
+                "00\0The\0internet\0is\0made\0of\0cats.\0\0"
+                "02\0\0"
+                "\0"
+                "\0";
+            static const std::vector<char> chunk(text, text + sizeof(text) - 1);
+            return chunk;
+        }
+
+
+        static std::vector<char> Hash(std::vector<char> const & chunk,
+                                      IConfiguration const & config,
+                                      bool expandNGrams)
+        {
+            std::stringstream output;
+            ChunkHasher hasher(config, expandNGrams, output);
+            ChunkReader(chunk.data(), chunk.data() + chunk.size(), hasher);
+            return ToVector(output.str());
+        }
+
+
+        static std::vector<PostingSet> GetPostings(std::vector<char> const & chunk,
+                                                   IConfiguration const & config)
+        {
+            DocumentCollector collector(config);
+            ChunkReader(chunk.data(), chunk.data() + chunk.size(), collector);
+            return collector.GetPostings();
+        }
+
+
+        TEST(HashedChunkReader, Trace)
+        {
+            auto idfTable = Factories::CreateIndexedIdfTable();
+            auto facts = Factories::CreateFactSet();
+            auto config = Factories::CreateConfiguration(1, false, *idfTable, *facts);
+
+            auto hashed = Hash(GetTextChunk(), *config, false);
+            ASSERT_TRUE(HashedChunkReader::IsHashedChunk(hashed.data(),
+                                                         hashed.data() + hashed.size()));
+            EXPECT_FALSE(HashedChunkReader::IsHashedChunk(GetTextChunk().data(),
+                                                          GetTextChunk().data() + GetTextChunk().size()));
+
+            Mocks::ChunkEventTracer tracer(hashed);
+
+            std::stringstream trace;
+            trace
+                << "OnFileEnter" << std::endl
+                << "OnDocumentEnter;DocId: 1" << std::endl
+                << "OnStreamEnter;streamId: 0" << std::endl;
+            for (auto word : { "Dogs", "are", "man's", "best", "friend." })
+            {
+                trace << "OnTermHash;hash: " << std::hex
+                      << Term::ComputeRawHash(word) << std::dec << std::endl;
+            }
+            trace
+                << "OnStreamExit" << std::endl
+                << "OnStreamEnter;streamId: 1" << std::endl
+                << "OnTermHash;hash: " << std::hex
+                << Term::ComputeRawHash("Dogs") << std::dec << std::endl
+                << "OnStreamExit" << std::endl
+                << "OnDocumentExit" << std::endl
+                << "OnDocumentEnter;DocId: 2" << std::endl
+                << "OnStreamEnter;streamId: 0" << std::endl;
+            for (auto word : { "The", "internet", "is", "made", "of", "cats." })
+            {
+                trace << "OnTermHash;hash: " << std::hex
+                      << Term::ComputeRawHash(word) << std::dec << std::endl;
+            }
+            trace
+                << "OnStreamExit" << std::endl
+                << "OnStreamEnter;streamId: 2" << std::endl
+                << "OnStreamExit" << std::endl
+                << "OnDocumentExit" << std::endl
+                << "OnFileExit" << std::endl;
+
+            EXPECT_EQ(trace.str(), tracer.Trace());
+        }
+
+
+        // Documents read from hashed chunks, with and without ngram
+        // expansion, must have the same postings as those read from text.
+        TEST(HashedChunkReader, Postings)
+        {
+            auto idfTable = Factories::CreateIndexedIdfTable();
+            auto facts = Factories::CreateFactSet();
+            auto config = Factories::CreateConfiguration(3, false, *idfTable, *facts);
+
+            auto expected = GetPostings(GetTextChunk(), *config);
+            ASSERT_EQ(expected.size(), 2u);
+
+            for (bool expand : { false, true })
+            {
+                auto hashed = Hash(GetTextChunk(), *config, expand);
+                EXPECT_EQ(GetPostings(hashed, *config), expected);
+
+                // Converting a hashed chunk again yields the same bytes.
+                EXPECT_EQ(Hash(hashed, *config, expand), hashed);
+            }
+        }
+
+
+        // IChunkWriter copies of hashed chunks are themselves hashed chunks.
+        TEST(HashedChunkReader, Copy)
+        {
+            auto idfTable = Factories::CreateIndexedIdfTable();
+            auto facts = Factories::CreateFactSet();
+            auto config = Factories::CreateConfiguration(2, false, *idfTable, *facts);
+
+            auto hashed = Hash(GetTextChunk(), *config, false);
+
+            std::stringstream output;
+            DocumentCollector collector(*config, &output);
+            ChunkReader(hashed.data(), hashed.data() + hashed.size(), collector);
+
+            EXPECT_EQ(ToVector(output.str()), hashed);
+        }
+
+
+        TEST(HashedChunkReader, Truncated)
+        {
+            auto idfTable = Factories::CreateIndexedIdfTable();
+            auto facts = Factories::CreateFactSet();
+            auto config = Factories::CreateConfiguration(1, false, *idfTable, *facts);
+
+            auto hashed = Hash(GetTextChunk(), *config, false);
+            hashed.resize(hashed.size() - 12);
+
+            DocumentCollector collector(*config);
+            EXPECT_ANY_THROW(
+                ChunkReader(hashed.data(), hashed.data() + hashed.size(), collector));
+        }
+    }
+}
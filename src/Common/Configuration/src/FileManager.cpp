@@ -44,11 +44,15 @@ namespace BitFunnel
     }
 
 
-    FileManager::FileManager(char const * /*configDirectory*/,
+    FileManager::FileManager(char const * configDirectory,
                              char const * statisticsDirectory,
                              char const * indexDirectory,
                              IFileSystem & fileSystem)
-        : m_chunk(
+        : m_benchmarkResults(new ParameterizedFile0(fileSystem,
+                                                    statisticsDirectory,
+                                                    "BenchmarkResults",
+                                                    ".csv")),
+          m_chunk(
             new ParameterizedFile1(fileSystem,
                                    indexDirectory,
                                    "Chunk",
@@ -71,6 +75,9 @@ namespace BitFunnel
                                                         statisticsDirectory,
                                                         "CumulativeTermCounts",
                                                         ".csv")),
+          m_docFreqBounds(new ParameterizedFile1(fileSystem,
+                                                 statisticsDirectory,
+                                                 "DocFreqBounds", ".csv")),
           m_docFreqTable(new ParameterizedFile1(fileSystem,
                                                 statisticsDirectory,
                                                 "DocFreqTable", ".csv")),
@@ -86,6 +93,10 @@ namespace BitFunnel
                                             indexDirectory,
                                             "Manifest",
                                             ".txt" )),
+          m_matcherCodeCache(new ParameterizedFile0(fileSystem,
+                                                    configDirectory,
+                                                    "MatcherCodeCache",
+                                                    ".bin")),
           m_queryLog(new ParameterizedFile0(fileSystem,
                                             statisticsDirectory,
                                             "QueryLog",
@@ -108,6 +119,10 @@ namespace BitFunnel
                                      statisticsDirectory,
                                      "ShardDefinition",
                                      ".csv")),
+          m_termCountRun(new ParameterizedFile1(fileSystem,
+                                                statisticsDirectory,
+                                                "TermCountRun",
+                                                ".bin")),
           m_termTable(new ParameterizedFile1(fileSystem,
                                              indexDirectory,
                                              "TermTable",
@@ -132,6 +147,12 @@ namespace BitFunnel
     // FileDescriptor0 files.
     //
 
+    FileDescriptor0 FileManager::BenchmarkResults()
+    {
+        return FileDescriptor0(*m_benchmarkResults);
+    }
+
+
     FileDescriptor0 FileManager::ColumnDensities()
     {
         return FileDescriptor0(*m_columnDensities);
@@ -156,6 +177,12 @@ namespace BitFunnel
     }
 
 
+    FileDescriptor0 FileManager::MatcherCodeCache()
+    {
+        return FileDescriptor0(*m_matcherCodeCache);
+    }
+
+
     FileDescriptor0 FileManager::QueryLog()
     {
         return FileDescriptor0(*m_queryLog);
@@ -214,6 +241,12 @@ namespace BitFunnel
     }
 
 
+    FileDescriptor1 FileManager::DocFreqBounds(size_t shard)
+    {
+        return FileDescriptor1(*m_docFreqBounds, shard);
+    }
+
+
     FileDescriptor1 FileManager::DocFreqTable(size_t shard)
     {
         return FileDescriptor1(*m_docFreqTable, shard);
@@ -232,6 +265,12 @@ namespace BitFunnel
     }
 
 
+    FileDescriptor1 FileManager::TermCountRun(size_t run)
+    {
+        return FileDescriptor1(*m_termCountRun, run);
+    }
+
+
     FileDescriptor1 FileManager::TermTable(size_t shard)
     {
         return FileDescriptor1(*m_termTable, shard);
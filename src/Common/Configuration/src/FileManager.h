@@ -48,11 +48,13 @@ namespace BitFunnel
         //virtual FileDescriptor0 CommonNegatedTerms() override;
         //virtual FileDescriptor0 CommonPhrases() override;
         //virtual FileDescriptor0 DocFreqTable() override;
+        virtual FileDescriptor0 BenchmarkResults() override;
         virtual FileDescriptor0 ColumnDensities() override;
         virtual FileDescriptor0 ColumnDensitySummary() override;
         virtual FileDescriptor0 DocumentHistogram() override;
         //virtual FileDescriptor0 L1RankerConfig() override;
         virtual FileDescriptor0 Manifest() override;
+        virtual FileDescriptor0 MatcherCodeCache() override;
         //virtual FileDescriptor0 Model() override;
         //virtual FileDescriptor0 PlanDescriptors() override;
         //virtual FileDescriptor0 PostingCounts() override;
@@ -77,31 +79,37 @@ namespace BitFunnel
         virtual FileDescriptor1 Chunk(size_t number) override;
         virtual FileDescriptor1 Correlate(size_t shard) override;
         virtual FileDescriptor1 CumulativeTermCounts(size_t shard) override;
+        virtual FileDescriptor1 DocFreqBounds(size_t shard) override;
         virtual FileDescriptor1 DocFreqTable(size_t shard) override;
         virtual FileDescriptor1 IndexedIdfTable(size_t shard) override;
         //virtual FileDescriptor1 DocTable(size_t shard) override;
         //virtual FileDescriptor1 ScoreTable(size_t shard) override;
         virtual FileDescriptor1 RowDensities(size_t shard) override;
+        virtual FileDescriptor1 TermCountRun(size_t run) override;
         virtual FileDescriptor1 TermTable(size_t shard) override;
         virtual FileDescriptor1 TermTableStatistics(size_t shard) override;
 
         //virtual FileDescriptor2 IndexSlice(size_t shard, size_t slice) override;
 
     private:
+        std::unique_ptr<IParameterizedFile0> m_benchmarkResults;
         std::unique_ptr<IParameterizedFile1> m_chunk;
         std::unique_ptr<IParameterizedFile0> m_columnDensities;
         std::unique_ptr<IParameterizedFile0> m_columnDensitySummary;
         std::unique_ptr<IParameterizedFile1> m_correlate;
         std::unique_ptr<IParameterizedFile1> m_cumulativeTermCounts;
+        std::unique_ptr<IParameterizedFile1> m_docFreqBounds;
         std::unique_ptr<IParameterizedFile1> m_docFreqTable;
         std::unique_ptr<IParameterizedFile0> m_documentHistogram;
         std::unique_ptr<IParameterizedFile1> m_indexedIdfTable;
         std::unique_ptr<IParameterizedFile0> m_manifest;
+        std::unique_ptr<IParameterizedFile0> m_matcherCodeCache;
         std::unique_ptr<IParameterizedFile0> m_queryLog;
         std::unique_ptr<IParameterizedFile0> m_queryPipelineStatistics;
         std::unique_ptr<IParameterizedFile0> m_querySummaryStatistics;
         std::unique_ptr<IParameterizedFile1> m_rowDensities;
         std::unique_ptr<IParameterizedFile0> m_shardDefinition;
+        std::unique_ptr<IParameterizedFile1> m_termCountRun;
         std::unique_ptr<IParameterizedFile1> m_termTable;
         std::unique_ptr<IParameterizedFile1> m_termTableStatistics;
         std::unique_ptr<IParameterizedFile0> m_termToText;
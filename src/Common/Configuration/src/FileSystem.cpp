@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 
@@ -84,4 +85,19 @@ namespace BitFunnel
 
         return std::unique_ptr<std::istream>(stream.release());
     }
+
+
+    void FileSystem::Delete(char const * filename)
+    {
+        if (std::remove(filename) != 0)
+        {
+            std::stringstream message;
+            message
+                << "File "
+                << filename
+                << " could not be deleted.";
+            RecoverableError error(message.str().c_str());
+            throw error;
+        }
+    }
 }
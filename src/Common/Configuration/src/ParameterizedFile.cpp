@@ -125,13 +125,10 @@ namespace BitFunnel
     // }
 
 
-    // void ParameterizedFile::Delete(const std::string& filename)
-    // {
-    //     LogAssertB(DeleteFileA(filename.c_str()) != 0,
-    //                "Error %d deleting file %s.",
-    //                GetLastError(),
-    //                filename.c_str());
-    // }
+    void ParameterizedFile::Delete(const std::string& filename)
+    {
+        m_fileSystem.Delete(filename.c_str());
+    }
 
 
     ParameterizedFile0::ParameterizedFile0(IFileSystem & fileSystem,
@@ -181,8 +178,8 @@ namespace BitFunnel
     // }
 
 
-    // void ParameterizedFile0::Delete()
-    // {
-    //     ParameterizedFile::Delete(GetName());
-    // }
+    void ParameterizedFile0::Delete()
+    {
+        ParameterizedFile::Delete(GetName());
+    }
 }
@@ -53,7 +53,7 @@ namespace BitFunnel
         std::unique_ptr<std::ostream> OpenForWrite(const std::string& filename);
         // void Commit(const std::string& filename);
         // bool Exists(const std::string& filename);
-        // void Delete(const std::string& filename);
+        void Delete(const std::string& filename);
 
         IFileSystem & m_fileSystem;
 
@@ -86,7 +86,7 @@ namespace BitFunnel
         // std::unique_ptr<std::ostream> OpenTempForWrite();
         // void Commit();
         // bool Exists();
-        // void Delete();
+        void Delete();
     };
 
 
@@ -141,10 +141,10 @@ namespace BitFunnel
         // }
 
 
-        // void Delete(size_t p1)
-        // {
-        //     ParameterizedFile::Delete(GetName(p1));
-        // }
+        void Delete(size_t p1)
+        {
+            ParameterizedFile::Delete(GetName(p1));
+        }
     };
 
 
@@ -202,9 +202,9 @@ namespace BitFunnel
         // }
 
 
-        // void Delete(size_t p1, size_t p2)
-        // {
-        //     ParameterizedFile::Delete(GetName(p1, p2));
-        // }
+        void Delete(size_t p1, size_t p2)
+        {
+            ParameterizedFile::Delete(GetName(p1, p2));
+        }
     };
 }
@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 
 #include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Exceptions.h"
 #include "RAMFileSystem.h"
 
 
@@ -56,6 +57,21 @@ namespace BitFunnel
     }
 
 
+    void RAMFileSystem::Delete(char const * filename)
+    {
+        if (m_files.erase(filename) == 0)
+        {
+            std::stringstream message;
+            message
+                << "File "
+                << filename
+                << " could not be deleted.";
+            RecoverableError error(message.str().c_str());
+            throw error;
+        }
+    }
+
+
     RAMFileSystem::Buffer
         RAMFileSystem::EnsureStream(const char * filename,
                                     bool forWrite)
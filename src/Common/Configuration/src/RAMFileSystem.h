@@ -45,6 +45,8 @@ namespace BitFunnel
             OpenForRead(char const * filename,
                         std::ios_base::openmode mode = std::ios::in) override;
 
+        virtual void Delete(char const * filename) override;
+
     private:
         static std::stringstream& GetStringStream();
         typedef decltype (GetStringStream().rdbuf()) Buffer;
@@ -0,0 +1,199 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+#include "BitFunnel/Utilities/LatencyHistogram.h"
+
+
+namespace BitFunnel
+{
+    const unsigned LatencyHistogram::c_subBucketBits;
+    const uint64_t LatencyHistogram::c_subBucketCount;
+    const uint64_t LatencyHistogram::c_halfSubBucketCount;
+    const size_t LatencyHistogram::c_bucketCount;
+
+
+    LatencyHistogram::LatencyHistogram()
+      : m_counts(c_bucketCount, 0),
+        m_totalCount(0),
+        m_sum(0),
+        m_max(0)
+    {
+    }
+
+
+    void LatencyHistogram::Record(double seconds)
+    {
+        // Latencies too long for uint64_t nanoseconds (over 584 years) are
+        // clamped.
+        const double nanoseconds = seconds * 1e9;
+        uint64_t value = 0;
+        if (nanoseconds >= static_cast<double>(UINT64_MAX))
+        {
+            value = UINT64_MAX;
+        }
+        else if (nanoseconds > 0)
+        {
+            value = static_cast<uint64_t>(nanoseconds + 0.5);
+        }
+
+        ++m_counts[GetBucket(value)];
+        ++m_totalCount;
+        m_sum += value;
+        m_max = (std::max)(m_max, value);
+    }
+
+
+    void LatencyHistogram::Merge(LatencyHistogram const & other)
+    {
+        for (size_t i = 0; i < c_bucketCount; ++i)
+        {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_totalCount += other.m_totalCount;
+        m_sum += other.m_sum;
+        m_max = (std::max)(m_max, other.m_max);
+    }
+
+
+    void LatencyHistogram::Reset()
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_totalCount = 0;
+        m_sum = 0;
+        m_max = 0;
+    }
+
+
+    size_t LatencyHistogram::GetCount() const
+    {
+        return m_totalCount;
+    }
+
+
+    double LatencyHistogram::GetMean() const
+    {
+        return (m_totalCount == 0) ?
+            0.0 :
+            static_cast<double>(m_sum) / m_totalCount * 1e-9;
+    }
+
+
+    double LatencyHistogram::GetMax() const
+    {
+        return m_max * 1e-9;
+    }
+
+
+    double LatencyHistogram::GetPercentile(double percentile) const
+    {
+        if (m_totalCount == 0)
+        {
+            return 0.0;
+        }
+
+        // The rank of the requested latency among the recorded latencies,
+        // counting from 1.
+        const double fraction =
+            (std::min)(100.0, (std::max)(0.0, percentile)) / 100.0;
+        uint64_t rank = static_cast<uint64_t>(fraction * m_totalCount + 0.5);
+        rank = (std::max)(static_cast<uint64_t>(1), (std::min)(rank, m_totalCount));
+
+        uint64_t count = 0;
+        for (size_t i = 0; i < c_bucketCount; ++i)
+        {
+            count += m_counts[i];
+            if (count >= rank)
+            {
+                return (std::min)(GetBucketUpperBound(i), m_max) * 1e-9;
+            }
+        }
+
+        return GetMax();
+    }
+
+
+    void LatencyHistogram::Print(std::ostream & out, char const * name) const
+    {
+        const double c_microseconds = 1e6;
+
+        out << std::left << std::setw(10) << name << std::right
+            << " count " << std::setw(8) << GetCount()
+            << std::fixed << std::setprecision(1)
+            << "  mean " << std::setw(9) << GetMean() * c_microseconds
+            << "  p50 " << std::setw(9) << GetPercentile(50) * c_microseconds
+            << "  p90 " << std::setw(9) << GetPercentile(90) * c_microseconds
+            << "  p99 " << std::setw(9) << GetPercentile(99) * c_microseconds
+            << "  p99.9 " << std::setw(9) << GetPercentile(99.9) * c_microseconds
+            << "  max " << std::setw(9) << GetMax() * c_microseconds
+            << std::defaultfloat << std::endl;
+    }
+
+
+    size_t LatencyHistogram::GetBucket(uint64_t nanoseconds)
+    {
+        if (nanoseconds < c_subBucketCount)
+        {
+            return static_cast<size_t>(nanoseconds);
+        }
+
+        // Find the shift that brings nanoseconds into
+        // [c_halfSubBucketCount, c_subBucketCount) by binary search on the
+        // position of its highest set bit.
+        unsigned highBit = 0;
+        for (unsigned step = 32; step > 0; step /= 2)
+        {
+            if ((nanoseconds >> (highBit + step)) != 0)
+            {
+                highBit += step;
+            }
+        }
+        const unsigned shift = highBit - (c_subBucketBits - 1);
+        const uint64_t subBucket = (nanoseconds >> shift) - c_halfSubBucketCount;
+
+        return static_cast<size_t>(c_subBucketCount
+                                   + (shift - 1) * c_halfSubBucketCount
+                                   + subBucket);
+    }
+
+
+    uint64_t LatencyHistogram::GetBucketUpperBound(size_t bucket)
+    {
+        if (bucket < c_subBucketCount)
+        {
+            return bucket;
+        }
+
+        const uint64_t offset = bucket - c_subBucketCount;
+        const unsigned shift =
+            static_cast<unsigned>(offset / c_halfSubBucketCount) + 1;
+        const uint64_t subBucket =
+            c_halfSubBucketCount + offset % c_halfSubBucketCount;
+
+        // Equal to ((subBucket + 1) << shift) - 1, without overflowing in
+        // the last bucket.
+        return (subBucket << shift) + ((1ull << shift) - 1);
+    }
+}
@@ -0,0 +1,228 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "BitFunnel/Utilities/PerformanceCounters.h"
+
+
+namespace BitFunnel
+{
+#ifdef __linux__
+    static int OpenCounter(PerformanceCounters::Counter counter, int groupLeader)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP
+            | PERF_FORMAT_TOTAL_TIME_ENABLED
+            | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        switch (counter)
+        {
+        case PerformanceCounters::Cycles:
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerformanceCounters::Instructions:
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerformanceCounters::LastLevelCacheMisses:
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PerformanceCounters::DataTLBMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PerformanceCounters::BranchMisses:
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            return -1;
+        }
+
+        // pid 0 and cpu -1 count the calling thread on any processor.
+        return static_cast<int>(
+            syscall(__NR_perf_event_open, &attr, 0, -1, groupLeader, 0));
+    }
+#endif
+
+
+    const uint64_t PerformanceCounters::c_unavailable;
+
+
+    PerformanceCounters::Sample::Sample()
+      : m_timeEnabled(0),
+        m_timeRunning(0)
+    {
+        m_values.fill(0);
+    }
+
+
+    PerformanceCounters::PerformanceCounters()
+      : m_groupLeader(-1)
+    {
+        m_files.fill(-1);
+
+#ifdef __linux__
+        for (unsigned i = 0; i < CounterCount; ++i)
+        {
+            const Counter counter = static_cast<Counter>(i);
+            const int file = OpenCounter(counter, m_groupLeader);
+            if (file >= 0)
+            {
+                m_files[i] = file;
+                m_groupOrder.push_back(counter);
+                if (m_groupLeader < 0)
+                {
+                    m_groupLeader = file;
+                }
+            }
+        }
+#endif
+    }
+
+
+    PerformanceCounters::~PerformanceCounters()
+    {
+#ifdef __linux__
+        // Close the members of the group before the leader.
+        for (size_t i = m_groupOrder.size(); i > 0; --i)
+        {
+            close(m_files[m_groupOrder[i - 1]]);
+        }
+#endif
+    }
+
+
+    bool PerformanceCounters::IsAvailable(Counter counter) const
+    {
+        return m_files[counter] >= 0;
+    }
+
+
+    bool PerformanceCounters::IsAvailable() const
+    {
+        return m_groupLeader >= 0;
+    }
+
+
+    PerformanceCounters::Sample PerformanceCounters::Read() const
+    {
+        Sample sample;
+
+#ifdef __linux__
+        if (m_groupLeader >= 0)
+        {
+            // With PERF_FORMAT_GROUP and both PERF_FORMAT_TOTAL_TIME flags,
+            // read() returns the number of counters, the time enabled, the
+            // time running, and then the values of the counters in the order
+            // they joined the group.
+            const size_t c_headerSize = 3;
+            uint64_t buffer[c_headerSize + CounterCount];
+            const ssize_t bytes = read(m_groupLeader, buffer, sizeof(buffer));
+            if (bytes >= static_cast<ssize_t>(c_headerSize * sizeof(uint64_t)))
+            {
+                const size_t count = static_cast<size_t>(buffer[0]);
+                sample.m_timeEnabled = buffer[1];
+                sample.m_timeRunning = buffer[2];
+                for (size_t i = 0; i < count && i < m_groupOrder.size(); ++i)
+                {
+                    sample.m_values[m_groupOrder[i]] = buffer[c_headerSize + i];
+                }
+            }
+        }
+#endif
+
+        return sample;
+    }
+
+
+    PerformanceCounters::Values
+        PerformanceCounters::GetDelta(Sample const & start,
+                                      Sample const & end) const
+    {
+        Values values;
+        for (unsigned i = 0; i < CounterCount; ++i)
+        {
+            if (IsAvailable(static_cast<Counter>(i)))
+            {
+                values[i] = Scale(end.m_values[i] - start.m_values[i],
+                                  end.m_timeEnabled - start.m_timeEnabled,
+                                  end.m_timeRunning - start.m_timeRunning);
+            }
+            else
+            {
+                values[i] = c_unavailable;
+            }
+        }
+
+        return values;
+    }
+
+
+    uint64_t PerformanceCounters::Scale(uint64_t count,
+                                        uint64_t timeEnabled,
+                                        uint64_t timeRunning)
+    {
+        if (timeRunning == 0)
+        {
+            return c_unavailable;
+        }
+        if (timeRunning >= timeEnabled)
+        {
+            return count;
+        }
+
+        return static_cast<uint64_t>(
+            static_cast<double>(count) * timeEnabled / timeRunning + 0.5);
+    }
+
+
+    char const * PerformanceCounters::GetName(Counter counter)
+    {
+        switch (counter)
+        {
+        case Cycles:
+            return "cycles";
+        case Instructions:
+            return "instructions";
+        case LastLevelCacheMisses:
+            return "llc_misses";
+        case DataTLBMisses:
+            return "dtlb_misses";
+        case BranchMisses:
+            return "branch_misses";
+        default:
+            return "unknown";
+        }
+    }
+}
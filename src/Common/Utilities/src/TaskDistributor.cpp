@@ -53,11 +53,17 @@ namespace BitFunnel
 
     bool TaskDistributor::TryAllocateTask(size_t& taskId)
     {
-        std::lock_guard<std::mutex> lock(m_lock);
+        // Once m_nextTaskId passes m_taskCount, stop incrementing it so that
+        // repeated calls cannot wrap it around.
+        if (m_nextTaskId >= m_taskCount)
+        {
+            return false;
+        }
 
-        if (m_nextTaskId < m_taskCount)
+        const size_t id = m_nextTaskId++;
+        if (id < m_taskCount)
         {
-            taskId = m_nextTaskId++;
+            taskId = id;
             return true;
         }
         else
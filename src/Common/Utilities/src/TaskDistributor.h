@@ -22,8 +22,8 @@
 
 #pragma once
 
+#include <atomic>                                   // std::atomic member.
 #include <memory>                                   // For std::unique_ptr.
-#include <mutex>                                    // std::mutex member.
 #include <vector>                                   // std::vector member.
 
 #include "BitFunnel/Utilities/ITaskDistributor.h"   // Inherits from ITaskDistributor.
@@ -73,11 +73,13 @@ namespace BitFunnel
     private:
         std::vector<std::unique_ptr<ITaskProcessor>> const & m_processors;
         size_t m_taskCount;
-        size_t m_nextTaskId;
+
+        // Claimed with fetch-add rather than under a lock, because threads
+        // with short tasks call TryAllocateTask() at a high rate. Can exceed
+        // m_taskCount once all tasks are allocated.
+        std::atomic<size_t> m_nextTaskId;
 
         std::vector<std::unique_ptr<IThreadBase>> m_threads;
         std::unique_ptr<ThreadManager> m_threadManager;
-
-        std::mutex m_lock;
     };
 }
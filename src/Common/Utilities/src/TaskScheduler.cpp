@@ -0,0 +1,328 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <thread>
+
+#include "BitFunnel/Utilities/Factories.h"
+#include "TaskScheduler.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<ITaskScheduler>
+        Factories::CreateTaskScheduler(size_t threadCount)
+    {
+        return std::unique_ptr<ITaskScheduler>(new TaskScheduler(threadCount));
+    }
+
+
+    // Identifies the TaskScheduler, if any, that owns the current thread.
+    static thread_local TaskScheduler const * t_scheduler = nullptr;
+    static thread_local size_t t_workerIndex = 0;
+
+    // Number of claims that ParallelFor() aims to give each thread when the
+    // caller does not specify a grain size.
+    static const size_t c_claimsPerThread = 8;
+
+
+    //*************************************************************************
+    //
+    // TaskScheduler
+    //
+    //*************************************************************************
+    TaskScheduler::TaskScheduler(size_t threadCount)
+      : m_threadCount(threadCount),
+        m_queuedJobCount(0),
+        m_shutdown(false)
+    {
+        for (size_t i = 0; i <= m_threadCount; ++i)
+        {
+            m_queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+        }
+
+        for (size_t i = 0; i < m_threadCount; ++i)
+        {
+            m_threads.push_back(
+                std::unique_ptr<IThreadBase>(new WorkerThread(*this, i)));
+        }
+        m_threadManager = Factories::CreateThreadManager(m_threads);
+    }
+
+
+    TaskScheduler::~TaskScheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeLock);
+            m_shutdown = true;
+        }
+        m_wake.notify_all();
+        m_threadManager->WaitForThreads();
+    }
+
+
+    void TaskScheduler::ParallelFor(size_t taskCount,
+                                    Task const & task,
+                                    size_t grainSize)
+    {
+        if (taskCount == 0)
+        {
+            return;
+        }
+
+        if (grainSize == 0)
+        {
+            grainSize = (std::max)(
+                static_cast<size_t>(1),
+                taskCount / (c_claimsPerThread * (m_threadCount + 1)));
+        }
+
+        const size_t workerIndex = GetWorkerIndex();
+        Job job(task, taskCount, grainSize, *m_queues[workerIndex]);
+
+        // A Job with a single claim is not worth sharing.
+        if (taskCount > grainSize)
+        {
+            Push(job);
+        }
+
+        job.Run();
+        Remove(job);
+        Wait(job, workerIndex);
+
+        // Helpers that found the Job just before it was removed may still
+        // hold a pointer to it. They will find no ids left to claim.
+        while (job.m_helperCount != 0)
+        {
+            std::this_thread::yield();
+        }
+
+        if (job.m_exception)
+        {
+            std::rethrow_exception(job.m_exception);
+        }
+    }
+
+
+    size_t TaskScheduler::GetThreadCount() const
+    {
+        return m_threadCount;
+    }
+
+
+    size_t TaskScheduler::GetWorkerIndex() const
+    {
+        return (t_scheduler == this) ? t_workerIndex : m_threadCount;
+    }
+
+
+    void TaskScheduler::Push(Job & job)
+    {
+        // Count the Job before it becomes visible, so that m_queuedJobCount
+        // never drops below the number of Jobs in the deques.
+        {
+            std::lock_guard<std::mutex> lock(m_wakeLock);
+            ++m_queuedJobCount;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(job.m_queue.m_lock);
+            job.m_queue.m_jobs.push_back(&job);
+        }
+
+        m_wake.notify_all();
+    }
+
+
+    void TaskScheduler::Remove(Job & job)
+    {
+        std::lock_guard<std::mutex> lock(job.m_queue.m_lock);
+        auto & jobs = job.m_queue.m_jobs;
+        auto it = std::find(jobs.begin(), jobs.end(), &job);
+        if (it != jobs.end())
+        {
+            jobs.erase(it);
+            --m_queuedJobCount;
+        }
+    }
+
+
+    TaskScheduler::Job * TaskScheduler::TryAcquire(size_t workerIndex)
+    {
+        {
+            WorkerQueue & own = *m_queues[workerIndex];
+            std::lock_guard<std::mutex> lock(own.m_lock);
+            if (!own.m_jobs.empty())
+            {
+                Job * job = own.m_jobs.back();
+                ++job->m_helperCount;
+                return job;
+            }
+        }
+
+        for (size_t i = 1; i < m_queues.size(); ++i)
+        {
+            WorkerQueue & victim = *m_queues[(workerIndex + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.m_lock);
+            if (!victim.m_jobs.empty())
+            {
+                Job * job = victim.m_jobs.front();
+                ++job->m_helperCount;
+                return job;
+            }
+        }
+
+        return nullptr;
+    }
+
+
+    void TaskScheduler::Help(Job & job)
+    {
+        job.Run();
+        Remove(job);
+
+        // This must be the last access to job, which may be destroyed as
+        // soon as its owner sees m_helperCount reach zero.
+        --job.m_helperCount;
+    }
+
+
+    void TaskScheduler::Wait(Job & job, size_t workerIndex)
+    {
+        while (!job.IsComplete())
+        {
+            Job * other = TryAcquire(workerIndex);
+            if (other != nullptr)
+            {
+                Help(*other);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+
+    void TaskScheduler::WorkerLoop(size_t workerIndex)
+    {
+        t_scheduler = this;
+        t_workerIndex = workerIndex;
+
+        for (;;)
+        {
+            Job * job = TryAcquire(workerIndex);
+            if (job != nullptr)
+            {
+                Help(*job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wakeLock);
+            while (m_queuedJobCount == 0 && !m_shutdown)
+            {
+                m_wake.wait(lock);
+            }
+            if (m_shutdown)
+            {
+                break;
+            }
+        }
+    }
+
+
+    //*************************************************************************
+    //
+    // TaskScheduler::Job
+    //
+    //*************************************************************************
+    TaskScheduler::Job::Job(Task const & task,
+                            size_t taskCount,
+                            size_t grainSize,
+                            WorkerQueue & queue)
+      : m_task(task),
+        m_taskCount(taskCount),
+        m_grainSize(grainSize),
+        m_queue(queue),
+        m_nextTaskId(0),
+        m_completedCount(0),
+        m_helperCount(0)
+    {
+    }
+
+
+    void TaskScheduler::Job::Run()
+    {
+        for (;;)
+        {
+            const size_t first = m_nextTaskId.fetch_add(m_grainSize);
+            if (first >= m_taskCount)
+            {
+                break;
+            }
+
+            const size_t end = (std::min)(first + m_grainSize, m_taskCount);
+            for (size_t taskId = first; taskId < end; ++taskId)
+            {
+                try
+                {
+                    m_task(taskId);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(m_exceptionLock);
+                    if (!m_exception)
+                    {
+                        m_exception = std::current_exception();
+                    }
+                }
+            }
+
+            m_completedCount += end - first;
+        }
+    }
+
+
+    bool TaskScheduler::Job::IsComplete() const
+    {
+        return m_completedCount == m_taskCount;
+    }
+
+
+    //*************************************************************************
+    //
+    // TaskScheduler::WorkerThread
+    //
+    //*************************************************************************
+    TaskScheduler::WorkerThread::WorkerThread(TaskScheduler & scheduler,
+                                              size_t index)
+      : m_scheduler(scheduler),
+        m_index(index)
+    {
+    }
+
+
+    void TaskScheduler::WorkerThread::EntryPoint()
+    {
+        m_scheduler.WorkerLoop(m_index);
+    }
+}
@@ -0,0 +1,172 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>                                   // std::atomic member.
+#include <condition_variable>                       // std::condition_variable member.
+#include <deque>                                    // std::deque member.
+#include <exception>                                // std::exception_ptr member.
+#include <memory>                                   // std::unique_ptr member.
+#include <mutex>                                    // std::mutex member.
+#include <vector>                                   // std::vector member.
+
+#include "BitFunnel/NonCopyable.h"                  // Base class.
+#include "BitFunnel/Utilities/ITaskScheduler.h"     // Base class.
+#include "BitFunnel/Utilities/IThreadManager.h"     // IThreadBase base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // TaskScheduler
+    //
+    // Work-stealing ITaskScheduler.
+    //
+    // Each call to ParallelFor() creates a Job, which covers a range of task
+    // ids, and pushes it onto the deque of the calling thread. The range is
+    // not split up front. Instead, any number of threads may work on a Job
+    // at once, each claiming grainSize ids at a time with an atomic
+    // fetch-add on the Job's next id. Idle threads look for a Job at the
+    // back of their own deque (the most recent, and most deeply nested, Job)
+    // and then steal from the front of the other deques (the oldest, and
+    // usually largest, Jobs). Threads that call ParallelFor() from outside
+    // the pool share one extra deque.
+    //
+    // A Job lives on the stack of the thread that called ParallelFor(). That
+    // thread works on its own Job first and then helps with other Jobs until
+    // every task in its Job has returned. A Job is removed from its deque
+    // once all of its ids have been claimed, and ParallelFor() does not
+    // return until no other thread holds a pointer to it.
+    //
+    //*************************************************************************
+    class TaskScheduler : public ITaskScheduler, NonCopyable
+    {
+    public:
+        TaskScheduler(size_t threadCount);
+
+        // Waits for the worker threads to exit. There must be no calls to
+        // ParallelFor() in progress.
+        ~TaskScheduler();
+
+        //
+        // ITaskScheduler methods.
+        //
+        virtual void ParallelFor(size_t taskCount,
+                                 Task const & task,
+                                 size_t grainSize = 0) override;
+        virtual size_t GetThreadCount() const override;
+        virtual size_t GetWorkerIndex() const override;
+
+    private:
+        class WorkerQueue;
+
+        class Job : NonCopyable
+        {
+        public:
+            Job(Task const & task,
+                size_t taskCount,
+                size_t grainSize,
+                WorkerQueue & queue);
+
+            // Claims and runs ranges of task ids until none remain.
+            void Run();
+
+            bool IsComplete() const;
+
+            Task const & m_task;
+            const size_t m_taskCount;
+            const size_t m_grainSize;
+
+            // The deque that holds this Job until its ids are exhausted.
+            WorkerQueue & m_queue;
+
+            // The first unclaimed task id. Can exceed m_taskCount.
+            std::atomic<size_t> m_nextTaskId;
+
+            // Number of tasks that have returned.
+            std::atomic<size_t> m_completedCount;
+
+            // Number of threads, other than the owner, that hold a pointer
+            // to this Job.
+            std::atomic<size_t> m_helperCount;
+
+            // The first exception thrown by a task.
+            std::mutex m_exceptionLock;
+            std::exception_ptr m_exception;
+        };
+
+        class WorkerQueue : NonCopyable
+        {
+        public:
+            std::mutex m_lock;
+            std::deque<Job*> m_jobs;
+        };
+
+        class WorkerThread : public IThreadBase
+        {
+        public:
+            WorkerThread(TaskScheduler & scheduler, size_t index);
+
+            virtual void EntryPoint() override;
+
+        private:
+            TaskScheduler & m_scheduler;
+            size_t m_index;
+        };
+
+        // Adds job to the back of its deque and wakes the idle workers.
+        void Push(Job & job);
+
+        // Removes job from its deque, if it is still there.
+        void Remove(Job & job);
+
+        // Returns a Job from the back of the deque for workerIndex, or from
+        // the front of another deque, after incrementing its m_helperCount.
+        // Returns nullptr if all of the deques are empty.
+        Job * TryAcquire(size_t workerIndex);
+
+        // Runs job on behalf of a thread that acquired it with TryAcquire().
+        void Help(Job & job);
+
+        // Helps with other Jobs until the tasks in job have returned.
+        void Wait(Job & job, size_t workerIndex);
+
+        void WorkerLoop(size_t workerIndex);
+
+        const size_t m_threadCount;
+
+        // One deque for each worker, plus one for outside threads.
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
+        // Number of Jobs in m_queues. Idle workers sleep on m_wake while
+        // it is zero.
+        std::atomic<size_t> m_queuedJobCount;
+        std::mutex m_wakeLock;
+        std::condition_variable m_wake;
+        bool m_shutdown;
+
+        std::vector<std::unique_ptr<IThreadBase>> m_threads;
+        std::unique_ptr<IThreadManager> m_threadManager;
+    };
+}
@@ -0,0 +1,133 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <sstream>
+
+#include "BitFunnel/Utilities/LatencyHistogram.h"
+#include "gtest/gtest.h"
+
+
+namespace BitFunnel
+{
+    namespace LatencyHistogramTest
+    {
+        // Percentiles are reported as bucket upper bounds, which are within
+        // 1/64 of the true value.
+        static const double c_tolerance = 1.0 / 64;
+
+
+        TEST(LatencyHistogram, Empty)
+        {
+            LatencyHistogram histogram;
+            EXPECT_EQ(histogram.GetCount(), 0u);
+            EXPECT_EQ(histogram.GetMean(), 0.0);
+            EXPECT_EQ(histogram.GetMax(), 0.0);
+            EXPECT_EQ(histogram.GetPercentile(99), 0.0);
+        }
+
+
+        TEST(LatencyHistogram, Percentiles)
+        {
+            // Latencies of 1us through 10000us.
+            LatencyHistogram histogram;
+            for (unsigned i = 1; i <= 10000; ++i)
+            {
+                histogram.Record(i * 1e-6);
+            }
+
+            EXPECT_EQ(histogram.GetCount(), 10000u);
+            EXPECT_NEAR(histogram.GetMean(), 5000.5e-6, 1e-8);
+            EXPECT_NEAR(histogram.GetMax(), 10000e-6, 1e-8);
+
+            const double percentiles[] = { 50, 90, 99, 99.9, 100 };
+            for (double p : percentiles)
+            {
+                const double expected = p * 100 * 1e-6;
+                const double actual = histogram.GetPercentile(p);
+                EXPECT_GE(actual, expected * (1 - 1e-6)) << "p" << p;
+                EXPECT_LE(actual, expected * (1 + c_tolerance)) << "p" << p;
+            }
+        }
+
+
+        TEST(LatencyHistogram, SmallAndLarge)
+        {
+            // Latencies below 128ns are counted exactly.
+            LatencyHistogram histogram;
+            histogram.Record(0.0);
+            histogram.Record(-1.0);
+            histogram.Record(100e-9);
+            EXPECT_EQ(histogram.GetPercentile(50), 0.0);
+            EXPECT_NEAR(histogram.GetPercentile(100), 100e-9, 1e-12);
+
+            // An hour-long latency lands in a bucket of the right size.
+            histogram.Record(3600.0);
+            EXPECT_NEAR(histogram.GetPercentile(100), 3600.0, 1e-6);
+            EXPECT_NEAR(histogram.GetPercentile(75), 100e-9, 1e-12);
+        }
+
+
+        TEST(LatencyHistogram, Merge)
+        {
+            // Two threads' histograms merge into the histogram of all of the
+            // latencies.
+            LatencyHistogram all;
+            LatencyHistogram even;
+            LatencyHistogram odd;
+            for (unsigned i = 1; i <= 1000; ++i)
+            {
+                const double latency = i * 1e-5;
+                all.Record(latency);
+                ((i % 2 == 0) ? even : odd).Record(latency);
+            }
+
+            LatencyHistogram merged;
+            merged.Merge(even);
+            merged.Merge(odd);
+
+            EXPECT_EQ(merged.GetCount(), all.GetCount());
+            EXPECT_EQ(merged.GetMax(), all.GetMax());
+            EXPECT_DOUBLE_EQ(merged.GetMean(), all.GetMean());
+            for (double p = 0; p <= 100; p += 0.5)
+            {
+                EXPECT_EQ(merged.GetPercentile(p), all.GetPercentile(p));
+            }
+
+            merged.Reset();
+            EXPECT_EQ(merged.GetCount(), 0u);
+            EXPECT_EQ(merged.GetPercentile(50), 0.0);
+        }
+
+
+        TEST(LatencyHistogram, Print)
+        {
+            LatencyHistogram histogram;
+            histogram.Record(2e-3);
+
+            std::stringstream output;
+            histogram.Print(output, "match");
+            EXPECT_NE(output.str().find("match"), std::string::npos);
+            EXPECT_NE(output.str().find("p99.9"), std::string::npos);
+            EXPECT_NE(output.str().find("2000.0"), std::string::npos);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <set>
+#include <string>
+
+#include "BitFunnel/Utilities/PerformanceCounters.h"
+#include "gtest/gtest.h"
+
+
+namespace BitFunnel
+{
+    namespace PerformanceCountersTest
+    {
+        TEST(PerformanceCounters, Names)
+        {
+            std::set<std::string> names;
+            for (unsigned i = 0; i < PerformanceCounters::CounterCount; ++i)
+            {
+                names.insert(PerformanceCounters::GetName(
+                    static_cast<PerformanceCounters::Counter>(i)));
+            }
+            EXPECT_EQ(names.size(), PerformanceCounters::CounterCount);
+        }
+
+
+        // Hardware counters are often unavailable (e.g. in virtual machines
+        // and containers), so this test only checks that the counters that
+        // are available never run backwards and that the rest read zero and
+        // are reported as unavailable.
+        TEST(PerformanceCounters, Read)
+        {
+            PerformanceCounters counters;
+            const PerformanceCounters::Sample before = counters.Read();
+
+            volatile uint64_t sum = 0;
+            for (uint64_t i = 0; i < 100000; ++i)
+            {
+                sum = sum + i * i;
+            }
+
+            const PerformanceCounters::Sample after = counters.Read();
+            const PerformanceCounters::Values delta =
+                counters.GetDelta(before, after);
+            bool anyAvailable = false;
+            for (unsigned i = 0; i < PerformanceCounters::CounterCount; ++i)
+            {
+                auto counter = static_cast<PerformanceCounters::Counter>(i);
+                if (counters.IsAvailable(counter))
+                {
+                    anyAvailable = true;
+                    EXPECT_GE(after.m_values[i], before.m_values[i]);
+                }
+                else
+                {
+                    EXPECT_EQ(before.m_values[i], 0u);
+                    EXPECT_EQ(after.m_values[i], 0u);
+                    EXPECT_EQ(delta[i], PerformanceCounters::c_unavailable);
+                }
+            }
+            EXPECT_EQ(counters.IsAvailable(), anyAvailable);
+            EXPECT_GE(after.m_timeEnabled, after.m_timeRunning);
+
+            if (counters.IsAvailable(PerformanceCounters::Instructions) &&
+                delta[PerformanceCounters::Instructions] !=
+                    PerformanceCounters::c_unavailable)
+            {
+                EXPECT_GT(delta[PerformanceCounters::Instructions], 0u);
+            }
+        }
+
+
+        TEST(PerformanceCounters, Scale)
+        {
+            // Never scheduled.
+            EXPECT_EQ(PerformanceCounters::Scale(0, 1000, 0),
+                      PerformanceCounters::c_unavailable);
+            EXPECT_EQ(PerformanceCounters::Scale(0, 0, 0),
+                      PerformanceCounters::c_unavailable);
+
+            // Counted the whole time.
+            EXPECT_EQ(PerformanceCounters::Scale(123, 1000, 1000), 123u);
+
+            // Counted a quarter of the time.
+            EXPECT_EQ(PerformanceCounters::Scale(123, 1000, 250), 492u);
+        }
+    }
+}
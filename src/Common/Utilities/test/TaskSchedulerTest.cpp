@@ -0,0 +1,189 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskScheduler.h"
+#include "gtest/gtest.h"
+
+
+namespace BitFunnel
+{
+    namespace TaskSchedulerTest
+    {
+        // Runs taskCount tasks and verifies that each ran exactly once.
+        static void RunOnce(ITaskScheduler & scheduler,
+                            size_t taskCount,
+                            size_t grainSize)
+        {
+            std::vector<std::atomic<size_t>> counts(taskCount);
+            for (auto & count : counts)
+            {
+                count = 0;
+            }
+
+            scheduler.ParallelFor(taskCount,
+                                  [&counts] (size_t taskId)
+                                  {
+                                      ++counts[taskId];
+                                  },
+                                  grainSize);
+
+            for (size_t i = 0; i < taskCount; ++i)
+            {
+                ASSERT_EQ(counts[i].load(), 1u) << "taskId " << i;
+            }
+        }
+
+
+        TEST(TaskScheduler, EachTaskOnce)
+        {
+            for (size_t threadCount : { 0, 1, 4 })
+            {
+                auto scheduler = Factories::CreateTaskScheduler(threadCount);
+                EXPECT_EQ(scheduler->GetThreadCount(), threadCount);
+
+                for (size_t taskCount : { 0, 1, 7, 1000 })
+                {
+                    for (size_t grainSize : { 0, 1, 3, 64 })
+                    {
+                        RunOnce(*scheduler, taskCount, grainSize);
+                    }
+                }
+            }
+        }
+
+
+        // Each outer task runs a nested ParallelFor(). Every inner task must
+        // run once, even though all of the workers are busy with outer tasks
+        // when the inner Jobs start.
+        TEST(TaskScheduler, Nested)
+        {
+            const size_t threadCount = 3;
+            const size_t outerCount = 16;
+            const size_t innerCount = 100;
+
+            auto scheduler = Factories::CreateTaskScheduler(threadCount);
+            std::vector<std::atomic<size_t>> counts(outerCount * innerCount);
+            for (auto & count : counts)
+            {
+                count = 0;
+            }
+            std::atomic<bool> badWorkerIndex(false);
+
+            scheduler->ParallelFor(
+                outerCount,
+                [&] (size_t outer)
+                {
+                    scheduler->ParallelFor(
+                        innerCount,
+                        [&] (size_t inner)
+                        {
+                            if (scheduler->GetWorkerIndex() > threadCount)
+                            {
+                                badWorkerIndex = true;
+                            }
+                            ++counts[outer * innerCount + inner];
+                        },
+                        1);
+                },
+                1);
+
+            EXPECT_FALSE(badWorkerIndex);
+            for (size_t i = 0; i < counts.size(); ++i)
+            {
+                ASSERT_EQ(counts[i].load(), 1u) << "task " << i;
+            }
+        }
+
+
+        TEST(TaskScheduler, WorkerIndex)
+        {
+            const size_t threadCount = 4;
+            auto scheduler = Factories::CreateTaskScheduler(threadCount);
+
+            // Threads outside the pool use the extra index.
+            EXPECT_EQ(scheduler->GetWorkerIndex(), threadCount);
+
+            std::vector<std::atomic<size_t>> tasksByWorker(threadCount + 1);
+            for (auto & count : tasksByWorker)
+            {
+                count = 0;
+            }
+
+            const size_t taskCount = 10000;
+            scheduler->ParallelFor(taskCount,
+                                   [&] (size_t /*taskId*/)
+                                   {
+                                       ++tasksByWorker[scheduler->GetWorkerIndex()];
+                                   });
+
+            size_t total = 0;
+            for (auto const & count : tasksByWorker)
+            {
+                total += count;
+            }
+            EXPECT_EQ(total, taskCount);
+
+            // A second scheduler does not recognize the first one's workers.
+            auto other = Factories::CreateTaskScheduler(1);
+            std::atomic<size_t> otherIndex(0);
+            scheduler->ParallelFor(1,
+                                   [&] (size_t /*taskId*/)
+                                   {
+                                       otherIndex = other->GetWorkerIndex();
+                                   });
+            EXPECT_EQ(otherIndex.load(), 1u);
+        }
+
+
+        TEST(TaskScheduler, Exception)
+        {
+            auto scheduler = Factories::CreateTaskScheduler(2);
+            const size_t taskCount = 100;
+            std::atomic<size_t> completed(0);
+
+            EXPECT_THROW(
+                scheduler->ParallelFor(taskCount,
+                                       [&] (size_t taskId)
+                                       {
+                                           if (taskId % 10 == 5)
+                                           {
+                                               throw std::runtime_error("task failed");
+                                           }
+                                           ++completed;
+                                       },
+                                       1),
+                std::runtime_error);
+
+            // The tasks that did not throw still ran.
+            EXPECT_EQ(completed.load(), taskCount - taskCount / 10);
+
+            // The scheduler is still usable.
+            RunOnce(*scheduler, 50, 0);
+        }
+    }
+}
@@ -0,0 +1,296 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/StreamUtilities.h"
+#include "BinaryTableFormat.h"
+#include "LoggerInterfaces/Check.h"
+#include "MurmurHash2.h"
+
+
+namespace BitFunnel
+{
+    // Seed for the payload checksum.
+    static const unsigned c_checksumSeed = 0x42465442;
+
+    // Largest piece of payload read at once. When the stream cannot report
+    // its remaining length, the payload buffer grows one piece at a time,
+    // so a header claiming more bytes than the file holds fails on a short
+    // read before allocating much more than the file's actual size.
+    static const size_t c_readChunkBytes = 1ull << 24;
+
+
+    // Reads exactly byteCount bytes. Throws RecoverableError on a short
+    // read, which is how a truncated table shows up.
+    static void ReadExactly(std::istream & input,
+                            void * buffer,
+                            size_t byteCount)
+    {
+        input.read(static_cast<char *>(buffer),
+                   static_cast<std::streamsize>(byteCount));
+        if (static_cast<size_t>(input.gcount()) != byteCount)
+        {
+            RecoverableError error("BinaryTableFormat::Read: table is truncated.");
+            throw error;
+        }
+    }
+
+
+    template <typename T>
+    static T ReadHeaderField(std::istream & input)
+    {
+        T value;
+        ReadExactly(input, &value, sizeof(T));
+        return value;
+    }
+
+
+    // Sets remaining to the number of bytes between the read position and
+    // the end of input. Returns false if the stream cannot seek.
+    static bool TryGetBytesRemaining(std::istream & input, size_t & remaining)
+    {
+        const std::streampos position = input.tellg();
+        if (position == std::streampos(-1))
+        {
+            input.clear();
+            return false;
+        }
+
+        input.seekg(0, std::ios::end);
+        const std::streampos end = input.tellg();
+        input.clear();
+        input.seekg(position);
+        if (end == std::streampos(-1) || !input)
+        {
+            input.clear();
+            return false;
+        }
+
+        remaining = static_cast<size_t>(end - position);
+        return true;
+    }
+
+
+    bool BinaryTableFormat::IsBinary(std::istream & input)
+    {
+        return input.peek() == 0;
+    }
+
+
+    void BinaryTableFormat::Write(std::ostream & output,
+                                  uint64_t magic,
+                                  uint32_t version,
+                                  size_t entryCount,
+                                  void const * payload,
+                                  size_t payloadBytes)
+    {
+        WriteHeader(output,
+                    magic,
+                    version,
+                    entryCount,
+                    payloadBytes,
+                    MurmurHash64A(payload, payloadBytes, c_checksumSeed));
+        StreamUtilities::WriteBytes(output,
+                                    static_cast<char const *>(payload),
+                                    payloadBytes);
+    }
+
+
+    void BinaryTableFormat::WriteHeader(std::ostream & output,
+                                        uint64_t magic,
+                                        uint32_t version,
+                                        size_t entryCount,
+                                        size_t payloadBytes,
+                                        uint64_t checksum)
+    {
+        StreamUtilities::WriteField<uint64_t>(output, magic);
+        StreamUtilities::WriteField<uint32_t>(output, version);
+        StreamUtilities::WriteField<uint32_t>(output, 0);
+        StreamUtilities::WriteField<uint64_t>(output, entryCount);
+        StreamUtilities::WriteField<uint64_t>(output, payloadBytes);
+        StreamUtilities::WriteField<uint64_t>(output, checksum);
+    }
+
+
+    size_t BinaryTableFormat::Read(std::istream & input,
+                                   uint64_t magic,
+                                   uint32_t version,
+                                   std::vector<uint64_t> & payload)
+    {
+        if (ReadHeaderField<uint64_t>(input) != magic)
+        {
+            RecoverableError error("BinaryTableFormat::Read: unexpected table type.");
+            throw error;
+        }
+
+        return ReadAfterMagic(input, version, payload);
+    }
+
+
+    size_t BinaryTableFormat::ReadAfterMagic(std::istream & input,
+                                             uint32_t version,
+                                             std::vector<uint64_t> & payload)
+    {
+        if (ReadHeaderField<uint32_t>(input) != version)
+        {
+            RecoverableError error("BinaryTableFormat::Read: unsupported version.");
+            throw error;
+        }
+
+        ReadHeaderField<uint32_t>(input);
+        const uint64_t entryCount = ReadHeaderField<uint64_t>(input);
+        const uint64_t payloadBytes = ReadHeaderField<uint64_t>(input);
+        const uint64_t checksum = ReadHeaderField<uint64_t>(input);
+
+        // Check the claimed payload size against the file before trusting
+        // it with an allocation.
+        size_t remaining;
+        const bool knowRemaining = TryGetBytesRemaining(input, remaining);
+        if (knowRemaining && payloadBytes > remaining)
+        {
+            RecoverableError error("BinaryTableFormat::Read: table is truncated.");
+            throw error;
+        }
+
+        payload.clear();
+        if (knowRemaining)
+        {
+            payload.reserve(QuadwordsFromBytes(static_cast<size_t>(payloadBytes)));
+        }
+
+        size_t bytesRead = 0;
+        while (bytesRead < payloadBytes)
+        {
+            const size_t chunk =
+                static_cast<size_t>(std::min<uint64_t>(payloadBytes - bytesRead,
+                                                       c_readChunkBytes));
+            payload.resize(QuadwordsFromBytes(bytesRead + chunk), 0);
+            ReadExactly(input,
+                        reinterpret_cast<char *>(payload.data()) + bytesRead,
+                        chunk);
+            bytesRead += chunk;
+        }
+
+        if (MurmurHash64A(payload.data(), bytesRead, c_checksumSeed) != checksum)
+        {
+            RecoverableError error("BinaryTableFormat::Read: checksum mismatch.");
+            throw error;
+        }
+
+        return static_cast<size_t>(entryCount);
+    }
+
+
+    size_t BinaryTableFormat::QuadwordsFromBytes(size_t byteCount)
+    {
+        return (byteCount + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    }
+
+
+    //*************************************************************************
+    //
+    // BinaryTableFormat::Checksum
+    //
+    // Incremental form of MurmurHash64A(). The payload length is mixed in
+    // first, so it must be known up front.
+    //
+    //*************************************************************************
+    static const uint64_t c_murmurMultiplier = 0xc6a4a7935bd1e995;
+    static const int c_murmurShift = 47;
+
+
+    BinaryTableFormat::Checksum::Checksum(size_t payloadBytes)
+      : m_payloadBytes(payloadBytes),
+        m_bytesAdded(0),
+        m_hash(c_checksumSeed ^ (payloadBytes * c_murmurMultiplier)),
+        m_pendingCount(0)
+    {
+    }
+
+
+    void BinaryTableFormat::Checksum::Add(void const * bytes, size_t byteCount)
+    {
+        unsigned char const * data = static_cast<unsigned char const *>(bytes);
+        m_bytesAdded += byteCount;
+
+        while (byteCount > 0)
+        {
+            if (m_pendingCount == 0 && byteCount >= sizeof(uint64_t))
+            {
+                uint64_t block;
+                std::memcpy(&block, data, sizeof(uint64_t));
+                AddBlock(block);
+                data += sizeof(uint64_t);
+                byteCount -= sizeof(uint64_t);
+            }
+            else
+            {
+                m_pending[m_pendingCount++] = *data++;
+                --byteCount;
+                if (m_pendingCount == sizeof(uint64_t))
+                {
+                    uint64_t block;
+                    std::memcpy(&block, m_pending, sizeof(uint64_t));
+                    AddBlock(block);
+                    m_pendingCount = 0;
+                }
+            }
+        }
+    }
+
+
+    uint64_t BinaryTableFormat::Checksum::Complete()
+    {
+        CHECK_EQ(m_bytesAdded, m_payloadBytes)
+            << "BinaryTableFormat::Checksum: payload size mismatch.";
+
+        uint64_t h = m_hash;
+        if (m_pendingCount > 0)
+        {
+            for (size_t i = m_pendingCount; i > 0; --i)
+            {
+                h ^= uint64_t(m_pending[i - 1]) << (8 * (i - 1));
+            }
+            h *= c_murmurMultiplier;
+        }
+
+        h ^= h >> c_murmurShift;
+        h *= c_murmurMultiplier;
+        h ^= h >> c_murmurShift;
+        return h;
+    }
+
+
+    void BinaryTableFormat::Checksum::AddBlock(uint64_t block)
+    {
+        block *= c_murmurMultiplier;
+        block ^= block >> c_murmurShift;
+        block *= c_murmurMultiplier;
+        m_hash ^= block;
+        m_hash *= c_murmurMultiplier;
+    }
+}
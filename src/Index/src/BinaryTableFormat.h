@@ -0,0 +1,124 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>       // std::istream, std::ostream parameters.
+#include <stddef.h>     // size_t parameter.
+#include <stdint.h>     // uint64_t parameter.
+#include <vector>       // std::vector parameter.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // BinaryTableFormat reads and writes the framing shared by the binary
+    // forms of DocumentFrequencyTable, IndexedIdfTable and TermToText.
+    //
+    // A binary table consists of a fixed-size header followed by a payload
+    // whose layout is defined by each table. The header holds
+    //   magic:         8 bytes identifying the table type. The first byte
+    //                  is always zero, so a binary table can be told apart
+    //                  from the .csv form by its first character.
+    //   version:       4 byte payload layout version.
+    //   reserved:      4 bytes, always zero.
+    //   entry count:   8 bytes.
+    //   payload size:  8 bytes.
+    //   checksum:      8 byte MurmurHash64A of the payload.
+    //
+    // Payloads are read into quadword-aligned buffers with one read, so
+    // tables may use them as arrays without parsing individual entries.
+    //
+    //*************************************************************************
+    class BinaryTableFormat
+    {
+    public:
+        // Returns true if the next byte in input starts a binary table.
+        // Does not consume any input.
+        static bool IsBinary(std::istream & input);
+
+        // Writes a header describing payload, followed by the payload.
+        static void Write(std::ostream & output,
+                          uint64_t magic,
+                          uint32_t version,
+                          size_t entryCount,
+                          void const * payload,
+                          size_t payloadBytes);
+
+        // Writes just the header. The caller must then write exactly
+        // payloadBytes bytes of payload whose checksum, computed with
+        // Checksum, is checksum.
+        static void WriteHeader(std::ostream & output,
+                                uint64_t magic,
+                                uint32_t version,
+                                size_t entryCount,
+                                size_t payloadBytes,
+                                uint64_t checksum);
+
+        // Computes the payload checksum a piece at a time, for payloads
+        // that are written with WriteHeader() without being held in memory.
+        // The result matches the checksum Write() computes for the same
+        // bytes.
+        class Checksum
+        {
+        public:
+            Checksum(size_t payloadBytes);
+
+            void Add(void const * bytes, size_t byteCount);
+
+            // Returns the checksum. All payloadBytes must have been added.
+            uint64_t Complete();
+
+        private:
+            void AddBlock(uint64_t block);
+
+            const size_t m_payloadBytes;
+            size_t m_bytesAdded;
+            uint64_t m_hash;
+            unsigned char m_pending[sizeof(uint64_t)];
+            size_t m_pendingCount;
+        };
+
+        // Reads a header and its payload. Throws RecoverableError if the
+        // magic or version do not match, if the input ends before the
+        // payload size given in the header, or if the checksum is wrong.
+        // On return, payload holds the payload bytes, padded with zeros to
+        // a multiple of 8 bytes. Returns the entry count, which the header
+        // states but nothing checks, so callers must bound it by the
+        // payload size without overflowing.
+        static size_t Read(std::istream & input,
+                           uint64_t magic,
+                           uint32_t version,
+                           std::vector<uint64_t> & payload);
+
+        // Same as Read(), for callers that have already consumed the magic
+        // number in order to distinguish a binary table from an older
+        // format.
+        static size_t ReadAfterMagic(std::istream & input,
+                                     uint32_t version,
+                                     std::vector<uint64_t> & payload);
+
+        // Returns the number of quadwords needed to hold byteCount bytes.
+        static size_t QuadwordsFromBytes(size_t byteCount);
+    };
+}
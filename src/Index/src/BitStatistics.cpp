@@ -0,0 +1,348 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifdef _MSC_VER
+#include <intrin.h>         // __cpuidex(), _xgetbv().
+#endif
+
+#include <immintrin.h>      // AVX2 intrinsics.
+#include <nmmintrin.h>      // _mm_popcnt_u64().
+
+#include "BitStatistics.h"
+
+
+// The AVX2 kernels are compiled for AVX2 regardless of the target flags
+// for the rest of the build. They only run after UsesAvx2() returns true.
+#ifdef _MSC_VER
+#define BITFUNNEL_TARGET_AVX2
+#else
+#define BITFUNNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+namespace BitFunnel
+{
+    static bool DetectAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuidex(info, 1, 0);
+        const bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+        if (!osUsesXSave || (_xgetbv(0) & 6) != 6)
+        {
+            // The OS doesn't save the YMM registers.
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+
+
+    static const bool c_useAvx2 = DetectAvx2();
+
+
+    static size_t PopCount64(uint64_t value)
+    {
+        return static_cast<size_t>(_mm_popcnt_u64(value));
+    }
+
+
+    //*************************************************************************
+    //
+    // AVX2 Harley-Seal popcount.
+    //
+    // Sixteen 256-bit vectors are reduced through a tree of carry-save
+    // adders into ones, twos, fours, eights and sixteens accumulators, so
+    // that only one vector popcount is needed per sixteen vectors loaded.
+    // See Mula, Kurz and Lemire, "Faster Population Counts Using AVX2
+    // Instructions".
+    //
+    // The LOADER supplies vector i of the bits to count, which lets the same
+    // adder tree count plain rows, masked rows and masked higher rank rows.
+    //
+    //*************************************************************************
+    BITFUNNEL_TARGET_AVX2
+    static __m256i PopCount256(__m256i v)
+    {
+        // Per-nibble popcount via table lookup, then horizontal byte sums.
+        const __m256i lookup =
+            _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowMask = _mm256_set1_epi8(0x0f);
+        const __m256i low = _mm256_and_si256(v, lowMask);
+        const __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+        const __m256i counts =
+            _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                            _mm256_shuffle_epi8(lookup, high));
+        return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+    }
+
+
+    BITFUNNEL_TARGET_AVX2
+    static void CarrySaveAdd(__m256i& high,
+                             __m256i& low,
+                             __m256i a,
+                             __m256i b,
+                             __m256i c)
+    {
+        const __m256i u = _mm256_xor_si256(a, b);
+        high = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+        low = _mm256_xor_si256(u, c);
+    }
+
+
+    template <typename LOADER>
+    BITFUNNEL_TARGET_AVX2
+    static size_t HarleySeal(LOADER const & load, size_t vectorCount)
+    {
+        __m256i total = _mm256_setzero_si256();
+        __m256i ones = _mm256_setzero_si256();
+        __m256i twos = _mm256_setzero_si256();
+        __m256i fours = _mm256_setzero_si256();
+        __m256i eights = _mm256_setzero_si256();
+        __m256i sixteens;
+        __m256i twosA, twosB, foursA, foursB, eightsA, eightsB;
+
+        size_t i = 0;
+        for (; i + 16 <= vectorCount; i += 16)
+        {
+            CarrySaveAdd(twosA, ones, ones, load(i + 0), load(i + 1));
+            CarrySaveAdd(twosB, ones, ones, load(i + 2), load(i + 3));
+            CarrySaveAdd(foursA, twos, twos, twosA, twosB);
+            CarrySaveAdd(twosA, ones, ones, load(i + 4), load(i + 5));
+            CarrySaveAdd(twosB, ones, ones, load(i + 6), load(i + 7));
+            CarrySaveAdd(foursB, twos, twos, twosA, twosB);
+            CarrySaveAdd(eightsA, fours, fours, foursA, foursB);
+            CarrySaveAdd(twosA, ones, ones, load(i + 8), load(i + 9));
+            CarrySaveAdd(twosB, ones, ones, load(i + 10), load(i + 11));
+            CarrySaveAdd(foursA, twos, twos, twosA, twosB);
+            CarrySaveAdd(twosA, ones, ones, load(i + 12), load(i + 13));
+            CarrySaveAdd(twosB, ones, ones, load(i + 14), load(i + 15));
+            CarrySaveAdd(foursB, twos, twos, twosA, twosB);
+            CarrySaveAdd(eightsB, fours, fours, foursA, foursB);
+            CarrySaveAdd(sixteens, eights, eights, eightsA, eightsB);
+
+            total = _mm256_add_epi64(total, PopCount256(sixteens));
+        }
+
+        total = _mm256_slli_epi64(total, 4);
+        total = _mm256_add_epi64(total,
+                                 _mm256_slli_epi64(PopCount256(eights), 3));
+        total = _mm256_add_epi64(total,
+                                 _mm256_slli_epi64(PopCount256(fours), 2));
+        total = _mm256_add_epi64(total,
+                                 _mm256_slli_epi64(PopCount256(twos), 1));
+        total = _mm256_add_epi64(total, PopCount256(ones));
+
+        for (; i < vectorCount; ++i)
+        {
+            total = _mm256_add_epi64(total, PopCount256(load(i)));
+        }
+
+        return static_cast<size_t>(
+            static_cast<uint64_t>(_mm256_extract_epi64(total, 0)) +
+            static_cast<uint64_t>(_mm256_extract_epi64(total, 1)) +
+            static_cast<uint64_t>(_mm256_extract_epi64(total, 2)) +
+            static_cast<uint64_t>(_mm256_extract_epi64(total, 3)));
+    }
+
+
+    BITFUNNEL_TARGET_AVX2
+    static __m256i LoadVector(uint64_t const * data)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data));
+    }
+
+
+    class RowLoader
+    {
+    public:
+        RowLoader(uint64_t const * data)
+          : m_data(data)
+        {
+        }
+
+        BITFUNNEL_TARGET_AVX2
+        __m256i operator()(size_t i) const
+        {
+            return LoadVector(m_data + 4 * i);
+        }
+
+    private:
+        uint64_t const * m_data;
+    };
+
+
+    // Vector i holds rank 0 quadwords 4i through 4i + 3 of the mask, ANDed
+    // with the rank r row quadwords covering them.
+    class MaskedRowLoader
+    {
+    public:
+        MaskedRowLoader(uint64_t const * row, Rank rank, uint64_t const * mask)
+          : m_row(row),
+            m_rank(rank),
+            m_mask(mask)
+        {
+        }
+
+        BITFUNNEL_TARGET_AVX2
+        __m256i operator()(size_t i) const
+        {
+            const size_t w = 4 * i;
+            __m256i row;
+            if (m_rank == 0)
+            {
+                row = LoadVector(m_row + w);
+            }
+            else if (m_rank == 1)
+            {
+                // Quadwords w and w + 1 share row quadword w / 2, and
+                // w + 2 and w + 3 share the next one.
+                const __m128i pair =
+                    _mm_loadu_si128(reinterpret_cast<__m128i const *>(m_row + (w >> 1)));
+                row = _mm256_permute4x64_epi64(_mm256_castsi128_si256(pair),
+                                               0x50);
+            }
+            else
+            {
+                // All four quadwords share one row quadword.
+                row = _mm256_set1_epi64x(static_cast<long long>(m_row[w >> m_rank]));
+            }
+            return _mm256_and_si256(row, LoadVector(m_mask + w));
+        }
+
+    private:
+        uint64_t const * m_row;
+        Rank m_rank;
+        uint64_t const * m_mask;
+    };
+
+
+    //*************************************************************************
+    //
+    // BitStatistics
+    //
+    //*************************************************************************
+    size_t BitStatistics::PopCount(uint64_t const * data, size_t quadwordCount)
+    {
+        size_t count = 0;
+        size_t w = 0;
+        if (c_useAvx2)
+        {
+            const size_t vectorCount = quadwordCount / 4;
+            count = HarleySeal(RowLoader(data), vectorCount);
+            w = 4 * vectorCount;
+        }
+
+        for (; w < quadwordCount; ++w)
+        {
+            count += PopCount64(data[w]);
+        }
+
+        return count;
+    }
+
+
+    size_t BitStatistics::PopCountMasked(uint64_t const * row,
+                                         Rank rank,
+                                         uint64_t const * mask,
+                                         size_t quadwordCount)
+    {
+        size_t count = 0;
+        size_t w = 0;
+        if (c_useAvx2)
+        {
+            const size_t vectorCount = quadwordCount / 4;
+            count = HarleySeal(MaskedRowLoader(row, rank, mask), vectorCount);
+            w = 4 * vectorCount;
+        }
+
+        for (; w < quadwordCount; ++w)
+        {
+            count += PopCount64(row[w >> rank] & mask[w]);
+        }
+
+        return count;
+    }
+
+
+    void BitStatistics::AddColumnCounts(std::vector<uint64_t const *> const & rows,
+                                        Rank rank,
+                                        size_t quadword,
+                                        uint32_t counts[64])
+    {
+        const size_t rowQuadword = quadword >> rank;
+
+        uint64_t block[64];
+        for (size_t first = 0; first < rows.size(); first += 64)
+        {
+            const size_t rowCount =
+                (rows.size() - first < 64) ? rows.size() - first : 64;
+            for (size_t i = 0; i < rowCount; ++i)
+            {
+                block[i] = rows[first + i][rowQuadword];
+            }
+            for (size_t i = rowCount; i < 64; ++i)
+            {
+                block[i] = 0;
+            }
+
+            // After the transpose, block[j] holds document j's bit from each
+            // of the rows.
+            Transpose(block);
+
+            for (size_t j = 0; j < 64; ++j)
+            {
+                counts[j] += static_cast<uint32_t>(PopCount64(block[j]));
+            }
+        }
+    }
+
+
+    void BitStatistics::Transpose(uint64_t block[64])
+    {
+        // Swap progressively smaller off-diagonal sub-blocks: 32x32, then
+        // 16x16 within each quadrant, and so on down to single bits.
+        uint64_t mask = 0x00000000ffffffffull;
+        for (size_t width = 32; width != 0; width >>= 1, mask ^= (mask << width))
+        {
+            for (size_t i = 0; i < 64; i = ((i | width) + 1) & ~width)
+            {
+                const uint64_t t =
+                    ((block[i] >> width) ^ block[i | width]) & mask;
+                block[i | width] ^= t;
+                block[i] ^= (t << width);
+            }
+        }
+    }
+
+
+    bool BitStatistics::UsesAvx2()
+    {
+        return c_useAvx2;
+    }
+}
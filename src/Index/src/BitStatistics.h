@@ -0,0 +1,81 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>                     // size_t parameter.
+#include <stdint.h>                     // uint64_t parameter.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/BitFunnelTypes.h"   // Rank parameter.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // BitStatistics
+    //
+    // Bit counting kernels for row and column density computations over
+    // RowTable data. Row popcounts use an AVX2 Harley-Seal carry-save adder
+    // tree when the processor supports AVX2 and fall back to the POPCNT
+    // instruction otherwise. Column counts transpose 64x64 bit blocks so
+    // that each document's bits land in a single quadword.
+    //
+    // Rows of rank r fold 2^r rank 0 quadwords into each of their quadwords,
+    // so rank 0 quadword w lines up with quadword (w >> r) of a rank r row.
+    // All quadword counts below are in rank 0 quadwords.
+    //
+    //*************************************************************************
+    class BitStatistics
+    {
+    public:
+        // Returns the number of bits set in the first quadwordCount
+        // quadwords of data.
+        static size_t PopCount(uint64_t const * data, size_t quadwordCount);
+
+        // Returns the number of bits set in (row & mask), where row is a rank
+        // rank row and mask is a rank 0 row such as the document active row.
+        // For a rank 0 row, this is the number of masked documents whose bit
+        // is set. For higher ranks, each masked document is counted if the
+        // row bit covering it is set.
+        static size_t PopCountMasked(uint64_t const * row,
+                                     Rank rank,
+                                     uint64_t const * mask,
+                                     size_t quadwordCount);
+
+        // For each of the 64 documents covered by rank 0 quadword
+        // 'quadword', adds to counts[i] the number of rows whose bit for
+        // document (64 * quadword + i) is set. All rows have the given rank.
+        static void AddColumnCounts(std::vector<uint64_t const *> const & rows,
+                                    Rank rank,
+                                    size_t quadword,
+                                    uint32_t counts[64]);
+
+        // Transposes a 64x64 bit matrix in place, so that bit j of block[i]
+        // moves to bit i of block[j].
+        static void Transpose(uint64_t block[64]);
+
+        // Returns true if the AVX2 kernels are in use on this processor.
+        static bool UsesAvx2();
+    };
+}
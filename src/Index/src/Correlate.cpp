@@ -21,149 +21,359 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
+#include <memory>
 #include <ostream>
-#include <unordered_map>                        // TODO: consider changing.
+#include <utility>
 
 #include "BitFunnel/Configuration/Factories.h"
 #include "BitFunnel/Configuration/IFileSystem.h"
 #include "BitFunnel/IFileManager.h"
-#include "BitFunnel/Index/DocumentHandle.h"
 #include "BitFunnel/Index/Factories.h"
-#include "BitFunnel/Index/IDocument.h"
-#include "BitFunnel/Index/IDocumentCache.h"
-#include "BitFunnel/Index/IDocumentFrequencyTable.h"
 #include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/ISimpleIndex.h"
 #include "BitFunnel/Index/RowId.h"
 #include "BitFunnel/Index/RowIdSequence.h"
-#include "BitFunnel/Index/Token.h"
 #include "BitFunnel/Term.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
 #include "Correlate.h"
 #include "CsvTsv/Csv.h"
-#include "DocumentHandleInternal.h"
 #include "LoggerInterfaces/Check.h"
-#include "NativeJIT/TypeConverter.h"
-#include "RowTableAnalyzer.h"
-#include "RowTableDescriptor.h"
-#include "Shard.h"
-#include "Slice.h"
 #include "TermToText.h"
 
 
-// Define hash of RowId to allow use of map/set.
-// TODO: remove this when we stop using map/set.
-namespace std
-{
-    template<>
-    struct hash<BitFunnel::RowId>
-    {
-        std::size_t operator()(BitFunnel::RowId const & row) const
-        {
-            // TODO: do we need to hash this?
-            return NativeJIT::convertType<BitFunnel::RowId, size_t>(row);
-        }
-    };
-}
-
-
 namespace BitFunnel
 {
     void Factories::CreateCorrelate(ISimpleIndex const & index,
                                     char const * outDir,
-                                    std::vector<std::string> const & terms)
+                                    std::vector<std::string> const & terms,
+                                    size_t threadCount)
     {
         CHECK_NE(*outDir, '\0')
             << "Output directory not set. ";
 
-        Correlate correlate(index, terms);
+        Correlate correlate(index, terms, threadCount);
         correlate.CorrelateRows(outDir);
     }
 
 
+    //*************************************************************************
+    //
+    // CollisionTable
+    //
+    //*************************************************************************
+    static bool LessThan(CollisionTable::Entry const & a,
+                         CollisionTable::Entry const & b)
+    {
+        return (a.m_left < b.m_left) ||
+            (a.m_left == b.m_left && a.m_right < b.m_right);
+    }
+
+
+    static bool SamePair(CollisionTable::Entry const & a,
+                         CollisionTable::Entry const & b)
+    {
+        return a.m_left == b.m_left && a.m_right == b.m_right;
+    }
+
+
+    // Merges two sorted, collapsed entry vectors, summing the counts of pairs
+    // that appear in both.
+    static std::vector<CollisionTable::Entry>
+        MergeEntries(std::vector<CollisionTable::Entry> const & a,
+                     std::vector<CollisionTable::Entry> const & b)
+    {
+        std::vector<CollisionTable::Entry> result;
+        result.reserve(a.size() + b.size());
+
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a.size() && j < b.size())
+        {
+            if (LessThan(a[i], b[j]))
+            {
+                result.push_back(a[i++]);
+            }
+            else if (LessThan(b[j], a[i]))
+            {
+                result.push_back(b[j++]);
+            }
+            else
+            {
+                result.push_back(a[i++]);
+                result.back().m_count += b[j++].m_count;
+            }
+        }
+        result.insert(result.end(), a.begin() + i, a.end());
+        result.insert(result.end(), b.begin() + j, b.end());
+
+        return result;
+    }
+
+
+    CollisionTable::CollisionTable()
+    {
+    }
+
+
+    void CollisionTable::AddRow(std::vector<Term::Hash> const & hashes)
+    {
+        for (auto leftHash : hashes)
+        {
+            for (auto rightHash : hashes)
+            {
+                if (leftHash != rightHash)
+                {
+                    m_pending.push_back({ leftHash, rightHash, 1 });
+                }
+            }
+        }
+
+        if (m_pending.size() >= c_maxPendingEntries)
+        {
+            Seal();
+        }
+    }
+
+
+    void CollisionTable::Seal()
+    {
+        if (m_pending.empty())
+        {
+            return;
+        }
+
+        std::sort(m_pending.begin(), m_pending.end(), LessThan);
+
+        // Collapse runs of the same pair into a single entry.
+        size_t last = 0;
+        for (size_t i = 1; i < m_pending.size(); ++i)
+        {
+            if (SamePair(m_pending[i], m_pending[last]))
+            {
+                m_pending[last].m_count += m_pending[i].m_count;
+            }
+            else
+            {
+                m_pending[++last] = m_pending[i];
+            }
+        }
+        m_pending.resize(last + 1);
+
+        m_entries = MergeEntries(m_entries, m_pending);
+
+        // Release the buffer rather than just clearing it, since its
+        // capacity may be large.
+        std::vector<Entry>().swap(m_pending);
+    }
+
+
+    void CollisionTable::Merge(CollisionTable & other)
+    {
+        Seal();
+        other.Seal();
+        m_entries = MergeEntries(m_entries, other.m_entries);
+    }
+
+
+    std::vector<CollisionTable::Entry> const &
+        CollisionTable::GetEntries() const
+    {
+        return m_entries;
+    }
+
+
+    //*************************************************************************
+    //
+    // CorrelateProcessor
+    //
+    // Adds the collisions for one block of rows per task to this processor's
+    // own CollisionTable for the block's shard. The caller merges the
+    // per-processor tables once all tasks are done.
+    //
+    //*************************************************************************
+    class CorrelateProcessor : public ITaskProcessor
+    {
+    public:
+        // The term hashes that share each row, for each shard.
+        typedef std::vector<std::vector<std::vector<Term::Hash>>> RowsByShard;
+
+        struct RowBlock
+        {
+            ShardId m_shard;
+            size_t m_begin;
+            size_t m_end;
+        };
+
+        CorrelateProcessor(RowsByShard const & rows,
+                           std::vector<RowBlock> const & tasks)
+          : m_rows(rows),
+            m_tasks(tasks),
+            m_collisions(rows.size())
+        {
+        }
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            RowBlock const & task = m_tasks[taskId];
+            auto const & rows = m_rows[task.m_shard];
+            for (size_t row = task.m_begin; row < task.m_end; ++row)
+            {
+                m_collisions[task.m_shard].AddRow(rows[row]);
+            }
+        }
+
+        virtual void Finished() override
+        {
+            for (auto & collisions : m_collisions)
+            {
+                collisions.Seal();
+            }
+        }
+
+        CollisionTable & GetCollisions(ShardId shard)
+        {
+            return m_collisions[shard];
+        }
+
+    private:
+        RowsByShard const & m_rows;
+        std::vector<RowBlock> const & m_tasks;
+        std::vector<CollisionTable> m_collisions;
+    };
+
+
+    //*************************************************************************
+    //
+    // Correlate
+    //
+    //*************************************************************************
     Correlate::Correlate(ISimpleIndex const & index,
-                         std::vector<std::string> const & terms)
+                         std::vector<std::string> const & terms,
+                         size_t threadCount)
         : m_index(index),
-          m_terms(terms)
+          m_terms(terms),
+          m_threadCount(threadCount)
     {
+        CHECK_GT(threadCount, 0u)
+            << "Correlate: threadCount must be at least 1.";
     }
 
 
     void Correlate::CorrelateRows(char const * outDir) const
     {
-        auto & ingestor = m_index.GetIngestor();
-
         auto & fileManager = m_index.GetFileManager();
         TermToText termToText(*fileManager.TermToText().OpenForRead());
-        for (ShardId shardId = 0; shardId < ingestor.GetShardCount(); ++shardId)
+
+        auto collisions = GetCollisions();
+
+        auto fileSystem = Factories::CreateFileSystem();
+        auto outFileManager =
+            Factories::CreateFileManager(outDir,
+                                         outDir,
+                                         outDir,
+                                         *fileSystem);
+
+        for (ShardId shardId = 0; shardId < collisions.size(); ++shardId)
         {
-            auto fileSystem = Factories::CreateFileSystem();
-            auto outFileManager =
-                Factories::CreateFileManager(outDir,
-                                             outDir,
-                                             outDir,
-                                             *fileSystem);
-
-            CorrelateShard(shardId,
-                           termToText,
-                           *outFileManager->Correlate(shardId).OpenForWrite());
+            WriteCollisions(collisions[shardId],
+                            termToText,
+                            *outFileManager->Correlate(shardId).OpenForWrite());
         }
     }
 
 
-    void Correlate::CorrelateShard(ShardId const & shardId,
-                                   ITermToText const & termToText,
-                                   std::ostream& out) const
+    std::vector<CollisionTable> Correlate::GetCollisions() const
     {
         const Term::StreamId c_TODOStreamId = 0;
-        // TODO: this should be a vector instead of a set. That change shouldn't
-        // really affect running time much, though, since we that should be
-        // dominated by the later phases.
-        std::unordered_map<RowId, std::vector<Term::Hash>> rowIdToHash;
+        const size_t c_rowsPerTask = 1024;
+
+        auto & ingestor = m_index.GetIngestor();
 
-        // auto & fileManager = m_index.GetFileManager();
-        for (auto const & termText : m_terms)
+        CorrelateProcessor::RowsByShard rows(ingestor.GetShardCount());
+        std::vector<CorrelateProcessor::RowBlock> tasks;
+        for (ShardId shardId = 0; shardId < ingestor.GetShardCount(); ++shardId)
         {
-            Term term(termText.c_str(), c_TODOStreamId, m_index.GetConfiguration());
-            RowIdSequence rows(term, m_index.GetTermTable(shardId));
-            for (RowId row : rows)
+            // Sort (row, term) pairs to group the terms that share each row.
+            std::vector<std::pair<RowId, Term::Hash>> rowTerms;
+            for (auto const & termText : m_terms)
+            {
+                Term term(termText.c_str(), c_TODOStreamId, m_index.GetConfiguration());
+                RowIdSequence rowIds(term, m_index.GetTermTable(shardId));
+                for (RowId row : rowIds)
+                {
+                    rowTerms.push_back(std::make_pair(row, term.GetRawHash()));
+                }
+            }
+            std::sort(rowTerms.begin(), rowTerms.end());
+
+            auto & shardRows = rows[shardId];
+            for (size_t i = 0; i < rowTerms.size(); ++i)
+            {
+                if (i == 0 || rowTerms[i].first != rowTerms[i - 1].first)
+                {
+                    shardRows.emplace_back();
+                }
+                shardRows.back().push_back(rowTerms[i].second);
+            }
+
+            for (size_t begin = 0; begin < shardRows.size(); begin += c_rowsPerTask)
             {
-                rowIdToHash[row].push_back(term.GetRawHash());
+                tasks.push_back({
+                    shardId,
+                    begin,
+                    (std::min)(begin + c_rowsPerTask, shardRows.size()) });
             }
         }
 
+        std::vector<std::unique_ptr<ITaskProcessor>> processors;
+        const size_t processorCount =
+            (std::max)(size_t(1), (std::min)(m_threadCount, tasks.size()));
+        for (size_t i = 0; i < processorCount; ++i)
+        {
+            processors.push_back(
+                std::unique_ptr<ITaskProcessor>(
+                    new CorrelateProcessor(rows, tasks)));
+        }
+        auto distributor =
+            Factories::CreateTaskDistributor(processors, tasks.size());
+        distributor->WaitForCompletion();
 
-        std::unordered_map<Term::Hash,
-                           std::unordered_map<Term::Hash, uint8_t>> collisions;
-        for (auto const & item : rowIdToHash)
+        std::vector<CollisionTable> collisions(rows.size());
+        for (ShardId shardId = 0; shardId < rows.size(); ++shardId)
         {
-            auto const & rowId = item.first;
-            auto const & hashes = rowIdToHash[rowId];
-            for (auto const & leftHash : hashes)
+            for (auto & processor : processors)
             {
-                for (auto const & rightHash : hashes)
-                {
-                    if (leftHash != rightHash)
-                    {
-                        ++collisions[leftHash][rightHash];
-                    }
-                }
+                collisions[shardId].Merge(
+                    static_cast<CorrelateProcessor&>(*processor)
+                    .GetCollisions(shardId));
             }
         }
 
+        return collisions;
+    }
+
+
+    void Correlate::WriteCollisions(CollisionTable const & collisions,
+                                    ITermToText const & termToText,
+                                    std::ostream& out) const
+    {
         CsvTsv::CsvTableFormatter formatter(out);
-        for (auto const & item : collisions)
+        auto const & entries = collisions.GetEntries();
+        size_t i = 0;
+        while (i < entries.size())
         {
-            auto const & leftHash = item.first;
+            const Term::Hash leftHash = entries[i].m_left;
             // TODO: consider only writing out terms with collisions.
             formatter.WriteField(termToText.Lookup(leftHash));
-            for (auto const & innerItem : item.second)
+            for (; i < entries.size() && entries[i].m_left == leftHash; ++i)
             {
-                auto const & rightHash = innerItem.first;
-                const uint8_t numCollisions = innerItem.second;
-                if (numCollisions > 1)
+                if (entries[i].m_count > 1)
                 {
-                    formatter.WriteField(termToText.Lookup(rightHash));
-                    formatter.WriteField(numCollisions);
+                    formatter.WriteField(termToText.Lookup(entries[i].m_right));
+                    formatter.WriteField(entries[i].m_count);
                 }
             }
             formatter.WriteRowEnd();
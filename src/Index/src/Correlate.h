@@ -27,6 +27,7 @@
 #include <vector>                               // std::vector embedded.
 
 #include "BitFunnel/BitFunnelTypes.h"           // DocId embedded.
+#include "BitFunnel/Term.h"                     // Term::Hash embedded.
 #include "BitFunnel/Utilities/Accumulator.h"    // Accumulator embedded.
 
 
@@ -36,20 +37,71 @@ namespace BitFunnel
     class ISimpleIndex;
     class ITermToText;
 
+    //*************************************************************************
+    //
+    // CollisionTable
+    //
+    // Counts, for each ordered pair of distinct terms, the number of rows the
+    // two terms share. Pairs are buffered by AddRow() and periodically
+    // sorted and collapsed into (left, right, count) entries. Tables built
+    // from disjoint sets of rows can be combined with Merge().
+    //
+    //*************************************************************************
+    class CollisionTable
+    {
+    public:
+        struct Entry
+        {
+            Term::Hash m_left;
+            Term::Hash m_right;
+            uint32_t m_count;
+        };
+
+        CollisionTable();
+
+        // Records a collision between every ordered pair of distinct hashes
+        // in a row.
+        void AddRow(std::vector<Term::Hash> const & hashes);
+
+        // Folds all buffered pairs into the entries.
+        void Seal();
+
+        // Adds the counts from another table. Both tables are sealed first.
+        void Merge(CollisionTable & other);
+
+        // Returns the entries, sorted by left hash and then right hash. Only
+        // valid after Seal().
+        std::vector<Entry> const & GetEntries() const;
+
+    private:
+        // Number of buffered pairs that triggers an automatic Seal().
+        static const size_t c_maxPendingEntries = 1ull << 20;
+
+        std::vector<Entry> m_entries;
+        std::vector<Entry> m_pending;
+    };
+
+
     class Correlate
     {
     public:
         Correlate (ISimpleIndex const & index,
-                   std::vector<std::string> const & terms);
+                   std::vector<std::string> const & terms,
+                   size_t threadCount);
         void CorrelateRows(char const * outDir) const;
 
+        // Returns the collision table for each shard. Shards and blocks of
+        // rows within each shard are spread across threads.
+        std::vector<CollisionTable> GetCollisions() const;
+
     private:
-        void CorrelateShard(
-            ShardId const & shardId,
+        void WriteCollisions(
+            CollisionTable const & collisions,
             ITermToText const & termToText,
             std::ostream& out) const;
 
         ISimpleIndex const & m_index;
         std::vector<std::string> const & m_terms;
+        const size_t m_threadCount;
     };
 }
@@ -208,18 +208,48 @@ namespace BitFunnel
         {
             for (DocIndex i = 0; i < m_capacity; ++i)
             {
-                for (unsigned blob = 0; blob < m_variableSizeBlobCount; ++blob)
-                {
-                    VariableSizeBlob& blobData =
-                        GetVariableBlobRef(sliceBuffer, i, blob);
+                Cleanup(sliceBuffer, i);
+            }
+        }
+    }
 
-                    if (blobData.m_data != nullptr)
-                    {
-                        free(blobData.m_data);
-                        blobData.m_data = nullptr;
-                        blobData.m_size = 0;
-                    }
-                }
+
+    void DocTableDescriptor::Cleanup(void* sliceBuffer, DocIndex index) const
+    {
+        for (unsigned blob = 0; blob < m_variableSizeBlobCount; ++blob)
+        {
+            VariableSizeBlob& blobData =
+                GetVariableBlobRef(sliceBuffer, index, blob);
+
+            if (blobData.m_data != nullptr)
+            {
+                free(blobData.m_data);
+                blobData.m_data = nullptr;
+                blobData.m_size = 0;
+            }
+        }
+    }
+
+
+    void DocTableDescriptor::CopyItem(void* destBuffer,
+                                      DocIndex destIndex,
+                                      void* sourceBuffer,
+                                      DocIndex sourceIndex) const
+    {
+        memcpy(GetItem(destBuffer, destIndex),
+               GetItem(sourceBuffer, sourceIndex),
+               m_bytesPerItem);
+
+        for (unsigned blob = 0; blob < m_variableSizeBlobCount; ++blob)
+        {
+            VariableSizeBlob& blobData =
+                GetVariableBlobRef(destBuffer, destIndex, blob);
+
+            if (blobData.m_data != nullptr)
+            {
+                void* data = malloc(blobData.m_size);
+                memcpy(data, blobData.m_data, blobData.m_size);
+                blobData.m_data = data;
             }
         }
     }
@@ -107,6 +107,20 @@ namespace BitFunnel
         // Releases memory held by the variable sized blobs.
         void Cleanup(void* sliceBuffer) const;
 
+        // Releases memory held by the variable sized blobs of a single
+        // document so that they can be allocated again.
+        void Cleanup(void* sliceBuffer, DocIndex index) const;
+
+        // Copies a document's item, including its DocId and fixed size
+        // blobs, from one slice buffer to another. The destination receives
+        // its own copies of the variable size blobs, so the source may be
+        // cleaned up independently. The destination item must not hold any
+        // variable size blobs.
+        void CopyItem(void* destBuffer,
+                      DocIndex destIndex,
+                      void* sourceBuffer,
+                      DocIndex sourceIndex) const;
+
         // Allocates buffer for variable sized blob of per-document data.
         // Throws if this blob had previously been allocated.
         void* AllocateVariableSizeBlob(void* sliceBuffer,
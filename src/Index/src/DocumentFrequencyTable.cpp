@@ -26,6 +26,7 @@
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Index/ITermToText.h"
+#include "BinaryTableFormat.h"
 #include "CsvTsv/Csv.h"
 #include "DocumentFrequencyTable.h"
 #include "TermToText.h"
@@ -59,6 +60,12 @@ namespace BitFunnel
 
     DocumentFrequencyTable::DocumentFrequencyTable(std::istream& input)
     {
+        if (BinaryTableFormat::IsBinary(input))
+        {
+            ReadBinary(input);
+            return;
+        }
+
         //
         // Read sorted entries from stream.
         //
@@ -126,84 +133,110 @@ namespace BitFunnel
     void DocumentFrequencyTable::Write(std::ostream & output,
                                        ITermToText const * termToText)
     {
-        //
-        // Sort entries by descending frequency.
-        //
+        SortEntries();
 
-        struct
+        DocumentFrequencyTableWriter writer(output, termToText);
+        for (auto & entry : m_entries)
         {
-            bool operator() (Entry a, Entry b)
-            {
-                // Sorts by decreasing frequency.
-                return a.GetFrequency() > b.GetFrequency();
-            }
-        } compare;
-
-        // Sort document frequency records by decreasing frequency.
-        std::sort(m_entries.begin(), m_entries.end(), compare);
-
+            writer.Write(entry);
+        }
+        writer.Complete();
+    }
 
-        //
-        // Write sorted entries to stream.
-        //
 
-        CsvTsv::CsvTableFormatter formatter(output);
-        CsvTsv::TableWriter writer(formatter);
+    void DocumentFrequencyTable::WriteBinary(std::ostream & output)
+    {
+        SortEntries();
+
+        // Payload is an array of Term::Hash, an array of frequencies, then
+        // arrays of gram sizes and stream ids.
+        const size_t count = m_entries.size();
+        const size_t bytes =
+            count * (sizeof(Term::Hash) + sizeof(double) +
+                     sizeof(Term::GramSize) + sizeof(Term::StreamId));
+        std::vector<uint64_t> payload(BinaryTableFormat::QuadwordsFromBytes(bytes), 0);
+
+        Term::Hash * hashes = reinterpret_cast<Term::Hash *>(payload.data());
+        double * frequencies = reinterpret_cast<double *>(hashes + count);
+        Term::GramSize * gramSizes =
+            reinterpret_cast<Term::GramSize *>(frequencies + count);
+        Term::StreamId * streamIds =
+            reinterpret_cast<Term::StreamId *>(gramSizes + count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            Term const & term = m_entries[i].GetTerm();
+            hashes[i] = term.GetRawHash();
+            frequencies[i] = m_entries[i].GetFrequency();
+            gramSizes[i] = term.GetGramSize();
+            streamIds[i] = term.GetStream();
+        }
 
-        CsvTsv::OutputColumn<Term::Hash> hash(
-            "hash",
-            "Term's raw hash.");
-        hash.SetHexMode(true);
+        BinaryTableFormat::Write(output,
+                                 c_magic,
+                                 c_version,
+                                 count,
+                                 payload.data(),
+                                 bytes);
+    }
 
-        // NOTE: Cannot use OutputColumn<Term::GramSize> because OutputColumn
-        // does not implement a specialization for char.
-        CsvTsv::OutputColumn<unsigned> gramSize(
-            "gramSize",
-            "Term's gram size.");
 
-        // NOTE: Cannot use OutputColumn<Term::StreamId> because OutputColumn
-        // does not implement a specialization for char.
-        CsvTsv::OutputColumn<unsigned> streamId(
-            "streamId",
-            "Term's stream id.");
+    void DocumentFrequencyTable::ReadBinary(std::istream& input)
+    {
+        std::vector<uint64_t> payload;
+        const size_t count =
+            BinaryTableFormat::Read(input, c_magic, c_version, payload);
+
+        // Divide rather than multiply so that a corrupt count cannot
+        // overflow past the check.
+        const size_t bytesPerEntry =
+            sizeof(Term::Hash) + sizeof(double) +
+            sizeof(Term::GramSize) + sizeof(Term::StreamId);
+        if (count > payload.size() * sizeof(uint64_t) / bytesPerEntry)
+        {
+            RecoverableError error("DocumentFrequencyTable: payload too small.");
+            throw error;
+        }
 
-        CsvTsv::OutputColumn<double> frequency(
-            "frequency",
-            "Term's frequency.");
+        Term::Hash const * hashes = reinterpret_cast<Term::Hash const *>(payload.data());
+        double const * frequencies = reinterpret_cast<double const *>(hashes + count);
+        Term::GramSize const * gramSizes =
+            reinterpret_cast<Term::GramSize const *>(frequencies + count);
+        Term::StreamId const * streamIds =
+            reinterpret_cast<Term::StreamId const *>(gramSizes + count);
 
-        CsvTsv::OutputColumn<std::string> text(
-            "text",
-            "Term's text.");
+        m_entries.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i > 0 && frequencies[i - 1] < frequencies[i])
+            {
+                RecoverableError
+                    error("DocumentFrequencyTable: expect non-increasing frequencies.");
+                throw error;
+            }
 
-        writer.DefineColumn(hash);
-        writer.DefineColumn(gramSize);
-        writer.DefineColumn(streamId);
-        writer.DefineColumn(frequency);
-        writer.DefineColumn(text);
+            Term term(hashes[i],
+                      streamIds[i],
+                      Term::ComputeIdfX10(frequencies[i], Term::c_maxIdfX10Value),
+                      gramSizes[i]);
+            m_entries.push_back(Entry(term, frequencies[i]));
+        }
+    }
 
-        writer.WritePrologue();
 
-        for (auto & entry : m_entries)
+    void DocumentFrequencyTable::SortEntries()
+    {
+        struct
         {
-            Term const & term = entry.GetTerm();
-            hash = term.GetRawHash();
-            gramSize = term.GetGramSize();
-            streamId = term.GetStream();
-            frequency = entry.GetFrequency();
-
-            if (termToText != nullptr)
-            {
-                text = termToText->Lookup(term.GetRawHash());
-            }
-            else
+            bool operator() (Entry a, Entry b)
             {
-                text = std::string("");
+                // Sorts by decreasing frequency.
+                return a.GetFrequency() > b.GetFrequency();
             }
+        } compare;
 
-            writer.WriteDataRow();
-        }
-
-        writer.WriteEpilogue();
+        // Sort document frequency records by decreasing frequency.
+        std::sort(m_entries.begin(), m_entries.end(), compare);
     }
 
 
@@ -235,4 +268,61 @@ namespace BitFunnel
     {
         return m_entries.size();
     }
+
+
+    //*************************************************************************
+    //
+    // DocumentFrequencyTableWriter
+    //
+    //*************************************************************************
+    DocumentFrequencyTableWriter::DocumentFrequencyTableWriter(
+        std::ostream& output,
+        ITermToText const * termToText)
+      : m_termToText(termToText),
+        m_formatter(output),
+        m_writer(m_formatter),
+        m_hash("hash", "Term's raw hash."),
+        m_gramSize("gramSize", "Term's gram size."),
+        m_streamId("streamId", "Term's stream id."),
+        m_frequency("frequency", "Term's frequency."),
+        m_text("text", "Term's text.")
+    {
+        m_hash.SetHexMode(true);
+
+        m_writer.DefineColumn(m_hash);
+        m_writer.DefineColumn(m_gramSize);
+        m_writer.DefineColumn(m_streamId);
+        m_writer.DefineColumn(m_frequency);
+        m_writer.DefineColumn(m_text);
+
+        m_writer.WritePrologue();
+    }
+
+
+    void DocumentFrequencyTableWriter::Write(
+        IDocumentFrequencyTable::Entry const & entry)
+    {
+        Term const & term = entry.GetTerm();
+        m_hash = term.GetRawHash();
+        m_gramSize = term.GetGramSize();
+        m_streamId = term.GetStream();
+        m_frequency = entry.GetFrequency();
+
+        if (m_termToText != nullptr)
+        {
+            m_text = m_termToText->Lookup(term.GetRawHash());
+        }
+        else
+        {
+            m_text = std::string("");
+        }
+
+        m_writer.WriteDataRow();
+    }
+
+
+    void DocumentFrequencyTableWriter::Complete()
+    {
+        m_writer.WriteEpilogue();
+    }
 }
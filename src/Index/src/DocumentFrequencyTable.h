@@ -23,11 +23,14 @@
 #pragma once
 
 #include <iosfwd>                                       // std::istream member.
+#include <stdint.h>                                     // uint64_t constant.
 #include <utility>                                      // std::pair return value.
 #include <vector>                                       // std::vector member.
 
 #include "BitFunnel/Index/IDocumentFrequencyTable.h"    // Base class.
+#include "BitFunnel/NonCopyable.h"                      // Base class.
 #include "BitFunnel/Term.h"                             // Term template parameter.
+#include "CsvTsv/Csv.h"                                 // CsvTsv::CsvTableFormatter member.
 
 
 namespace BitFunnel
@@ -49,6 +52,10 @@ namespace BitFunnel
         //    stream id (e.g. 0 for body, 1 for title, etc.)
         //    frequency of term in corpus (double precision floating point)
         // Entries must be ordered by non-increasing frequency.
+        //
+        // The stream may instead hold the binary form written by
+        // WriteBinary(). The binary form stores the same fields as parallel
+        // arrays (see BinaryTableFormat).
         DocumentFrequencyTable(std::istream& input);
 
         // Sorts the entries by descending frequency then writes to a stream.
@@ -59,6 +66,8 @@ namespace BitFunnel
         virtual void Write(std::ostream & output,
                            ITermToText const * termToText) override;
 
+        virtual void WriteBinary(std::ostream & output) override;
+
         // Adds an Entry to the table. Note that this method does not guard
         // against duplicate Term::Hash values and it does not enforce any
         // ordering on the frequencies. Entries are sorted on write.
@@ -73,6 +82,54 @@ namespace BitFunnel
         virtual size_t size() const override;
 
     private:
+        void ReadBinary(std::istream& input);
+        void SortEntries();
+
+        static const uint64_t c_magic = 0x0000544644464200ull;
+        static const uint32_t c_version = 1;
+
         std::vector<Entry> m_entries;
     };
+
+
+    //*************************************************************************
+    //
+    // DocumentFrequencyTableWriter
+    //
+    // Writes the .csv form of a DocumentFrequencyTable one entry at a time
+    // so that callers that generate entries in order need not hold the
+    // whole table in memory. Entries must be supplied in order of
+    // non-increasing frequency.
+    //
+    //*************************************************************************
+    class DocumentFrequencyTableWriter : public NonCopyable
+    {
+    public:
+        // Writes the column headers. If termToText is not nullptr, the
+        // "text" column will hold the text for each term.
+        DocumentFrequencyTableWriter(std::ostream& output,
+                                     ITermToText const * termToText);
+
+        void Write(IDocumentFrequencyTable::Entry const & entry);
+
+        // Must be called once after the last entry has been written.
+        void Complete();
+
+    private:
+        ITermToText const * m_termToText;
+
+        CsvTsv::CsvTableFormatter m_formatter;
+        CsvTsv::TableWriter m_writer;
+
+        CsvTsv::OutputColumn<Term::Hash> m_hash;
+
+        // NOTE: Cannot use OutputColumn<Term::GramSize> or
+        // OutputColumn<Term::StreamId> because OutputColumn does not
+        // implement a specialization for char.
+        CsvTsv::OutputColumn<unsigned> m_gramSize;
+        CsvTsv::OutputColumn<unsigned> m_streamId;
+
+        CsvTsv::OutputColumn<double> m_frequency;
+        CsvTsv::OutputColumn<std::string> m_text;
+    };
 }
@@ -79,8 +79,7 @@ namespace BitFunnel
         std::ostream& output,
         double truncateBelowFrequency) const
     {
-        typedef std::pair<Term::Hash, Term::IdfX10> Entry;
-        std::vector<Entry> entries;
+        std::vector<IndexedIdfTable::Entry> entries;
 
         // For each term count record, compute the document frequency then
         // add to entries if frequency is above threshold.
@@ -97,15 +96,11 @@ namespace BitFunnel
             }
         }
 
-        IndexedIdfTable::WriteHeader(output, entries.size());
-        for (auto entry : entries)
-        {
-            IndexedIdfTable::WriteEntry(output, entry.first, entry.second);
-        }
-
         std::cout << "IndexedIdfTable count: "
                   << entries.size()
                   << std::endl;
+
+        IndexedIdfTable::Write(output, std::move(entries));
     }
 
 
@@ -66,6 +66,18 @@ namespace BitFunnel
     }
 
 
+    DocumentHistogram::DocumentHistogram(
+        std::vector<std::pair<size_t, size_t>> const & entries)
+        : m_documentCount(0),
+          m_entries(entries)
+    {
+        for (auto const & entry : entries)
+        {
+            m_documentCount += entry.second;
+        }
+    }
+
+
     size_t DocumentHistogram::GetEntryCount() const
     {
         return m_entries.size();
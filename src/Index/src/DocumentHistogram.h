@@ -36,6 +36,10 @@ namespace BitFunnel
     public:
         DocumentHistogram(std::istream & input);
 
+        // Constructs from (posting count, document count) pairs ordered by
+        // increasing posting count.
+        DocumentHistogram(std::vector<std::pair<size_t, size_t>> const & entries);
+
         //
         // IDocumentHistogram methods.
         //
@@ -21,8 +21,12 @@
 // THE SOFTWARE.
 
 
+#include <utility>
+#include <vector>
+
 #include "CsvTsv/Csv.h"
 #include "CsvTsv/Table.h"
+#include "DocumentHistogram.h"
 #include "DocumentHistogramBuilder.h"
 
 namespace BitFunnel
@@ -35,11 +39,25 @@ namespace BitFunnel
 
     void DocumentHistogramBuilder::AddDocument(size_t postingCount)
     {
+        const std::lock_guard<std::mutex> lock(m_lock);
+        ++m_hist[postingCount];
+        m_totalCount += postingCount;
+    }
+
+
+    void DocumentHistogramBuilder::RemoveDocument(size_t postingCount)
+    {
+        const std::lock_guard<std::mutex> lock(m_lock);
+
+        auto it = m_hist.find(postingCount);
+        if (it != m_hist.end())
         {
-            const std::lock_guard<std::mutex> lock(m_lock);
-            ++m_hist[postingCount];
+            if (--it->second == 0)
+            {
+                m_hist.erase(it);
+            }
+            m_totalCount -= postingCount;
         }
-        m_totalCount += postingCount;
     }
 
 
@@ -93,4 +111,41 @@ namespace BitFunnel
 
         writer.WriteEpilogue();
     }
+
+
+    std::unique_ptr<IDocumentHistogram>
+        DocumentHistogramBuilder::CreateHistogram() const
+    {
+        std::vector<std::pair<size_t, size_t>> entries;
+        {
+            const std::lock_guard<std::mutex> lock(m_lock);
+            entries.assign(m_hist.begin(), m_hist.end());
+        }
+
+        return std::unique_ptr<IDocumentHistogram>(
+            new DocumentHistogram(entries));
+    }
+
+
+    void DocumentHistogramBuilder::Decay()
+    {
+        const std::lock_guard<std::mutex> lock(m_lock);
+
+        size_t totalCount = 0;
+        auto it = m_hist.begin();
+        while (it != m_hist.end())
+        {
+            it->second /= 2;
+            if (it->second == 0)
+            {
+                it = m_hist.erase(it);
+            }
+            else
+            {
+                totalCount += it->first * it->second;
+                ++it;
+            }
+        }
+        m_totalCount = totalCount;
+    }
 }
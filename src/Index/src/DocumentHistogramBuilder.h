@@ -25,6 +25,7 @@
 #include <atomic>   // std::atomic member
 #include <iosfwd>   // std::ostream parameter
 #include <map>      // std::map member
+#include <memory>   // std::unique_ptr return value
 #include <mutex>    // std::mutex member
 
 #include "BitFunnel/NonCopyable.h"
@@ -36,6 +37,8 @@
 
 namespace BitFunnel
 {
+    class IDocumentHistogram;
+
     class DocumentHistogramBuilder : public NonCopyable
     {
     public:
@@ -44,6 +47,11 @@ namespace BitFunnel
         // AddDocument is thread safe with multiple writers.
         void AddDocument(size_t postingCount);
 
+        // Removes a document previously passed to AddDocument(). Does nothing
+        // if there is no document with this posting count. Thread safe with
+        // multiple writers.
+        void RemoveDocument(size_t postingCount);
+
         size_t GetPostingCount() const;
 
         // GetValue is thread safe with multiple readers and writers.
@@ -52,6 +60,16 @@ namespace BitFunnel
         // Persists the contents of the histogram to a stream, not thread-safe
         void Write(std::ostream& output) const;
 
+        // Returns a snapshot of the histogram. Thread safe with multiple
+        // readers and writers.
+        std::unique_ptr<IDocumentHistogram> CreateHistogram() const;
+
+        // Halves the document count for each posting count, dropping entries
+        // which reach zero, so that older documents carry exponentially less
+        // weight than recent ones. Thread safe with multiple readers and
+        // writers.
+        void Decay();
+
 
     private:
         std::map<size_t, size_t> m_hist;
@@ -28,7 +28,9 @@
 
 namespace BitFunnel
 {
-    void DocumentMap::Add(DocumentHandleInternal handle)
+    void DocumentMap::Add(DocumentHandleInternal handle,
+                          size_t postingCount,
+                          size_t sourceByteSize)
     {
         std::lock_guard<std::mutex> lock(m_lock);
 
@@ -44,7 +46,8 @@ namespace BitFunnel
             RecoverableError error(message.str());
         }
 
-        m_docIdToDocHandle.insert(std::make_pair(id, handle));
+        m_docIdToDocHandle.insert(
+            std::make_pair(id, Entry(handle, postingCount, sourceByteSize)));
     }
 
 
@@ -62,7 +65,7 @@ namespace BitFunnel
         else
         {
             isFound = true;
-            handle = (*it).second;
+            handle = (*it).second.m_handle;
         }
 
         return handle;
@@ -86,10 +89,88 @@ namespace BitFunnel
     }
 
 
+    size_t DocumentMap::Delete(std::vector<DocumentHandleInternal> const & handles)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        size_t deletedCount = 0;
+        for (auto const & handle : handles)
+        {
+            auto it = m_docIdToDocHandle.find(handle.GetDocId());
+            if (it != m_docIdToDocHandle.end()
+                && &it->second.m_handle.GetSlice() == &handle.GetSlice()
+                && it->second.m_handle.GetIndex() == handle.GetIndex())
+            {
+                m_docIdToDocHandle.erase(it);
+                ++deletedCount;
+            }
+        }
+
+        return deletedCount;
+    }
+
+
+    size_t DocumentMap::Update(std::vector<DocumentHandleInternal> const & handles)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        size_t updatedCount = 0;
+        for (auto const & handle : handles)
+        {
+            auto it = m_docIdToDocHandle.find(handle.GetDocId());
+            if (it != m_docIdToDocHandle.end())
+            {
+                it->second.m_handle = handle;
+                ++updatedCount;
+            }
+        }
+
+        return updatedCount;
+    }
+
+
+    bool DocumentMap::ReplaceSizes(DocId id,
+                                   size_t postingCount,
+                                   size_t sourceByteSize,
+                                   size_t& oldPostingCount,
+                                   size_t& oldSourceByteSize)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto it = m_docIdToDocHandle.find(id);
+        if (it == m_docIdToDocHandle.end())
+        {
+            return false;
+        }
+
+        oldPostingCount = it->second.m_postingCount;
+        oldSourceByteSize = it->second.m_sourceByteSize;
+        it->second.m_postingCount = postingCount;
+        it->second.m_sourceByteSize = sourceByteSize;
+
+        return true;
+    }
+
+
     size_t DocumentMap::size() const
     {
         std::lock_guard<std::mutex> lock(m_lock);
 
         return m_docIdToDocHandle.size();
     }
+
+
+    //*************************************************************************
+    //
+    // DocumentMap::Entry
+    //
+    //*************************************************************************
+    DocumentMap::Entry::Entry(DocumentHandleInternal handle,
+                              size_t postingCount,
+                              size_t sourceByteSize)
+        : m_handle(handle),
+          m_postingCount(postingCount),
+          m_sourceByteSize(sourceByteSize)
+    {
+    }
 }
@@ -24,6 +24,7 @@
 
 #include <mutex>                        // std::mutex member.
 #include <unordered_map>                // std::unordered_map member.
+#include <vector>                       // std::vector parameter.
 
 #include "BitFunnel/BitFunnelTypes.h"   // For DocId parameter.
 #include "BitFunnel/NonCopyable.h"      // Base class.
@@ -37,8 +38,13 @@ namespace BitFunnel
     public:
         // Adds a new (DocId, DocumentHandleInternal) pair to the map. DocId is
         // obtained from DocumentHandleInternal::GetDocId(). Throws if the map
-        // already contains an entry for a given DocId.
-        void Add(DocumentHandleInternal value);
+        // already contains an entry for a given DocId. The document's posting
+        // count and source byte size are recorded with the entry so that they
+        // can be retracted from the ingestion statistics when the document is
+        // replaced.
+        void Add(DocumentHandleInternal value,
+                 size_t postingCount,
+                 size_t sourceByteSize);
 
         // Attempts to find the DocumentHandleInternal corresponding to the
         // specified DocId value. If such a DocumentHandleInternal exists, a
@@ -56,14 +62,48 @@ namespace BitFunnel
         // Returns true otherwise.
         bool Delete(DocId id);
 
+        // Deletes the entries which refer to the given documents, taking the
+        // lock once for the entire batch. An entry whose DocId has since been
+        // reused by a document elsewhere in the index is left in place.
+        // Returns the number of entries deleted.
+        size_t Delete(std::vector<DocumentHandleInternal> const & handles);
+
+        // Repoints the entries for the DocIds of the given documents at their
+        // new locations, taking the lock once for the entire batch. Used when
+        // documents are moved to a different Slice. DocIds with no entry are
+        // ignored. Returns the number of entries updated.
+        size_t Update(std::vector<DocumentHandleInternal> const & handles);
+
+        // Records a new posting count and source byte size for a DocId and
+        // returns the previous ones in oldPostingCount and
+        // oldSourceByteSize. Returns false, leaving the out parameters
+        // unchanged, if the map has no entry for the DocId.
+        bool ReplaceSizes(DocId id,
+                          size_t postingCount,
+                          size_t sourceByteSize,
+                          size_t& oldPostingCount,
+                          size_t& oldSourceByteSize);
+
         // Returns the number of DocIds in the map.
         size_t size() const;
 
     private:
+        class Entry
+        {
+        public:
+            Entry(DocumentHandleInternal handle,
+                  size_t postingCount,
+                  size_t sourceByteSize);
+
+            DocumentHandleInternal m_handle;
+            size_t m_postingCount;
+            size_t m_sourceByteSize;
+        };
+
         // Lock protecting operations on m_docIdToHandle.
         // Made mutable to allow using it from const functions.
         mutable std::mutex m_lock;
 
-        std::unordered_map<DocId, DocumentHandleInternal> m_docIdToDocHandle;
+        std::unordered_map<DocId, Entry> m_docIdToDocHandle;
     };
 }
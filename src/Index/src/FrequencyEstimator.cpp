@@ -0,0 +1,179 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>                // std::min(), std::max().
+#include <cmath>                    // std::sqrt().
+
+#include "FrequencyEstimator.h"
+#include "LoggerInterfaces/Check.h"
+
+
+namespace BitFunnel
+{
+    // Two sided 95% confidence.
+    static const double c_z = 1.96;
+
+
+    FrequencyEstimator::FrequencyEstimator(
+        size_t documentCount,
+        double samplingRate,
+        std::vector<size_t> const & countOfCounts)
+      : m_documentCount(documentCount),
+        m_samplingRate(samplingRate)
+    {
+        CHECK_GT(samplingRate, 0.0)
+            << "FrequencyEstimator: samplingRate must be in (0, 1].";
+        CHECK_LE(samplingRate, 1.0)
+            << "FrequencyEstimator: samplingRate must be in (0, 1].";
+
+        auto n = [&](size_t k)
+        {
+            return (k < countOfCounts.size()) ? countOfCounts[k] : 0;
+        };
+
+        m_correctedCounts.push_back(0.0);
+        for (size_t k = 1; k <= c_maxCorrectedCount; ++k)
+        {
+            double corrected = static_cast<double>(k);
+            if (samplingRate < 1.0 && n(k) > 0 && n(k + 1) > 0)
+            {
+                corrected = (k + 1) * static_cast<double>(n(k + 1)) / n(k);
+            }
+
+            corrected = (std::min)(corrected, static_cast<double>(k));
+            corrected = (std::max)(corrected, m_correctedCounts.back());
+            m_correctedCounts.push_back(corrected);
+        }
+    }
+
+
+    double FrequencyEstimator::GetFrequency(uint64_t count) const
+    {
+        if (m_documentCount == 0)
+        {
+            return 0.0;
+        }
+        return GetCorrectedCount(count) / m_documentCount;
+    }
+
+
+    double FrequencyEstimator::GetLowerBound(uint64_t count) const
+    {
+        double center;
+        const double halfWidth = GetInterval(count, center);
+        return (std::max)(0.0, center - halfWidth);
+    }
+
+
+    double FrequencyEstimator::GetUpperBound(uint64_t count) const
+    {
+        double center;
+        const double halfWidth = GetInterval(count, center);
+        return (std::min)(1.0, center + halfWidth);
+    }
+
+
+    double FrequencyEstimator::GetCorrectedCount(uint64_t count) const
+    {
+        if (count < m_correctedCounts.size())
+        {
+            return m_correctedCounts[static_cast<size_t>(count)];
+        }
+        return static_cast<double>(count);
+    }
+
+
+    double FrequencyEstimator::GetInterval(uint64_t count,
+                                           double & center) const
+    {
+        const double p = GetFrequency(count);
+
+        if (m_samplingRate >= 1.0 || m_documentCount == 0)
+        {
+            // The whole corpus was counted.
+            center = p;
+            return 0.0;
+        }
+
+        // The finite population correction shrinks the variance by
+        // (1 - samplingRate), which is equivalent to enlarging the sample.
+        const double n = m_documentCount / (1.0 - m_samplingRate);
+        const double z2 = c_z * c_z;
+        const double denominator = 1.0 + z2 / n;
+
+        center = (p + z2 / (2.0 * n)) / denominator;
+        return c_z / denominator *
+            std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n));
+    }
+
+
+    //*************************************************************************
+    //
+    // FrequencyBoundsWriter
+    //
+    //*************************************************************************
+    FrequencyBoundsWriter::FrequencyBoundsWriter(std::ostream& output)
+      : m_formatter(output),
+        m_writer(m_formatter),
+        m_hash("hash", "Term's raw hash."),
+        m_gramSize("gramSize", "Term's gram size."),
+        m_streamId("streamId", "Term's stream id."),
+        m_count("count", "Number of sampled documents containing the term."),
+        m_frequency("frequency", "Term's estimated frequency."),
+        m_lower("lower", "Lower bound of 95% confidence interval."),
+        m_upper("upper", "Upper bound of 95% confidence interval.")
+    {
+        m_hash.SetHexMode(true);
+
+        m_writer.DefineColumn(m_hash);
+        m_writer.DefineColumn(m_gramSize);
+        m_writer.DefineColumn(m_streamId);
+        m_writer.DefineColumn(m_count);
+        m_writer.DefineColumn(m_frequency);
+        m_writer.DefineColumn(m_lower);
+        m_writer.DefineColumn(m_upper);
+
+        m_writer.WritePrologue();
+    }
+
+
+    void FrequencyBoundsWriter::Write(Term term,
+                                      uint64_t count,
+                                      FrequencyEstimator const & estimator)
+    {
+        m_hash = term.GetRawHash();
+        m_gramSize = term.GetGramSize();
+        m_streamId = term.GetStream();
+        m_count = count;
+        m_frequency = estimator.GetFrequency(count);
+        m_lower = estimator.GetLowerBound(count);
+        m_upper = estimator.GetUpperBound(count);
+
+        m_writer.WriteDataRow();
+    }
+
+
+    void FrequencyBoundsWriter::Complete()
+    {
+        m_writer.WriteEpilogue();
+    }
+}
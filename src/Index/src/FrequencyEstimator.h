@@ -0,0 +1,131 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream parameter.
+#include <stddef.h>                     // size_t parameter.
+#include <stdint.h>                     // uint64_t parameter.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/NonCopyable.h"      // Base class.
+#include "BitFunnel/Term.h"             // Term parameter.
+#include "CsvTsv/Csv.h"                 // CsvTsv::CsvTableFormatter member.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // FrequencyEstimator
+    //
+    // Estimates the corpus document frequency of a term from the number of
+    // documents containing the term in a uniform random sample of the
+    // corpus.
+    //
+    // The estimate is count / documentCount, except for rare terms. Terms
+    // seen only a handful of times in the sample are, as a group, rarer in
+    // the corpus than their sample counts suggest, since the sample only
+    // reveals the rare terms that happened to be drawn. Counts up to
+    // c_maxCorrectedCount are replaced by their Good-Turing estimates
+    //     k* = (k + 1) * N(k + 1) / N(k)
+    // where N(k) is the number of distinct terms seen in exactly k sampled
+    // documents. The corrected counts are clamped so that they never exceed
+    // the observed count and never decrease as the observed count grows.
+    //
+    // The bounds are 95% Wilson score intervals with a finite population
+    // correction, so they collapse onto the estimate when the sampling rate
+    // is 1. No correction is applied when the sampling rate is 1.
+    //
+    //*************************************************************************
+    class FrequencyEstimator
+    {
+    public:
+        // documentCount is the number of documents in the sample and
+        // samplingRate is the fraction of the corpus they represent.
+        // countOfCounts[k] holds N(k). It may be shorter than
+        // c_maxCorrectedCount + 2, in which case the missing entries are
+        // treated as zero.
+        FrequencyEstimator(size_t documentCount,
+                           double samplingRate,
+                           std::vector<size_t> const & countOfCounts);
+
+        double GetFrequency(uint64_t count) const;
+        double GetLowerBound(uint64_t count) const;
+        double GetUpperBound(uint64_t count) const;
+
+        static const size_t c_maxCorrectedCount = 5;
+
+    private:
+        double GetCorrectedCount(uint64_t count) const;
+
+        // Returns the half width of the confidence interval, and sets center
+        // to the interval's center.
+        double GetInterval(uint64_t count, double & center) const;
+
+        const size_t m_documentCount;
+        const double m_samplingRate;
+
+        // Indexed by observed count, for counts up to c_maxCorrectedCount.
+        std::vector<double> m_correctedCounts;
+    };
+
+
+    //*************************************************************************
+    //
+    // FrequencyBoundsWriter
+    //
+    // Writes a .csv file with the sampled count, estimated frequency, and
+    // confidence bounds of each term, one term at a time.
+    //
+    //*************************************************************************
+    class FrequencyBoundsWriter : public NonCopyable
+    {
+    public:
+        // Writes the column headers.
+        FrequencyBoundsWriter(std::ostream& output);
+
+        void Write(Term term,
+                   uint64_t count,
+                   FrequencyEstimator const & estimator);
+
+        // Must be called once after the last term has been written.
+        void Complete();
+
+    private:
+        CsvTsv::CsvTableFormatter m_formatter;
+        CsvTsv::TableWriter m_writer;
+
+        CsvTsv::OutputColumn<Term::Hash> m_hash;
+
+        // NOTE: Cannot use OutputColumn<Term::GramSize> or
+        // OutputColumn<Term::StreamId> because OutputColumn does not
+        // implement a specialization for char.
+        CsvTsv::OutputColumn<unsigned> m_gramSize;
+        CsvTsv::OutputColumn<unsigned> m_streamId;
+
+        CsvTsv::OutputColumn<uint64_t> m_count;
+        CsvTsv::OutputColumn<double> m_frequency;
+        CsvTsv::OutputColumn<double> m_lower;
+        CsvTsv::OutputColumn<double> m_upper;
+    };
+}
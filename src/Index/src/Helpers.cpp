@@ -20,9 +20,12 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <sstream>
+
 #include "BitFunnel/Index/Helpers.h"
 #include "BitFunnel/Index/ITermTable.h"
 #include "BitFunnel/Index/Row.h"
+#include "MurmurHash2.h"
 #include "Rounding.h"
 #include "Shard.h"
 
@@ -50,4 +53,15 @@ namespace BitFunnel
         size_t minimumFunctionalSize = GetMinimumBlockSize(schema, termTable);
         return RoundUp<size_t>(minimumFunctionalSize, c_bitsPerPage);
     }
+
+
+    uint64_t GetTermTableVersion(ITermTable const & termTable)
+    {
+        std::stringstream stream;
+        termTable.Write(stream);
+        std::string const & bytes = stream.str();
+
+        const unsigned c_seed = 0x5df83c7c;
+        return MurmurHash64A(bytes.data(), bytes.size(), c_seed);
+    }
 }
@@ -23,22 +23,36 @@
 
 #pragma once
 
+#include <stddef.h>                 // size_t return value.
+
 #include "BitFunnel/IInterface.h"
 
 namespace BitFunnel
 {
+    class ITokenManager;
+
     //*************************************************************************
     //
     // Abstract class or interface for classes that rely on offline garbage
     // collection to release their resources after all consumers of the
-    // resource have been drained. Implementors will need to provide a way
-    // to indicate if this object can be recycled, as well as the function
-    // to call to recycle.
+    // resource have been drained. Implementors name the ITokenManager whose
+    // Tokens may still reference the resource. The IRecycler waits for
+    // those Tokens to drain before calling Recycle().
     //
     //*************************************************************************
     class IRecyclable : public IInterface
     {
     public:
+        // Returns the ITokenManager which issues Tokens to consumers of the
+        // resource. Recycle() will not be called until all Tokens issued
+        // before the resource was scheduled have been returned.
+        virtual ITokenManager& GetTokenManager() const = 0;
+
+        // Returns the number of bytes released by Recycle(). Used to report
+        // the amount of memory awaiting reclamation.
+        virtual size_t GetByteSize() const = 0;
+
+        // Releases the resource. Called once its consumers have drained.
         // Not thread safe - the caller must maintain thread safety.
         virtual void Recycle() = 0;
     };
@@ -20,9 +20,14 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>    // std::lower_bound(), std::stable_sort(), std::unique().
+
+#include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Utilities/StreamUtilities.h"
+#include "BinaryTableFormat.h"
 #include "IndexedIdfTable.h"
+#include "LoggerInterfaces/Check.h"
 
 
 namespace BitFunnel
@@ -57,52 +62,201 @@ namespace BitFunnel
 
     // TODO: Proper implementation or remove.
     IndexedIdfTable::IndexedIdfTable()
-        : m_defaultIdf(60)
+        : m_defaultIdf(60),
+          m_entryCount(0)
     {
     }
 
 
     IndexedIdfTable::IndexedIdfTable(std::istream& input,
                                      Term::IdfX10 defaultIdf)
-        : m_defaultIdf(defaultIdf)
+        : m_defaultIdf(defaultIdf),
+          m_entryCount(0)
     {
         // TODO: Should defaultIdf be part of the file?
 
-        size_t count = StreamUtilities::ReadField<size_t>(input);
+        // The older format starts with the entry count where the binary
+        // form starts with its magic number.
+        const uint64_t first = StreamUtilities::ReadField<uint64_t>(input);
+        if (first == c_magic)
+        {
+            m_entryCount = BinaryTableFormat::ReadAfterMagic(input,
+                                                             c_version,
+                                                             m_buffer);
+            if (m_entryCount >
+                m_buffer.size() * sizeof(uint64_t) / c_bytesPerEntry)
+            {
+                RecoverableError error("IndexedIdfTable: payload too small.");
+                throw error;
+            }
+        }
+        else
+        {
+            std::vector<Entry> entries;
+            entries.reserve(static_cast<size_t>(first));
+            for (size_t i = 0; i < first; ++i)
+            {
+                const Term::Hash hash(StreamUtilities::ReadField<Term::Hash>(input));
+                const Term::IdfX10 idf(StreamUtilities::ReadField<Term::IdfX10>(input));
+                entries.push_back(std::make_pair(hash, idf));
+            }
+            Initialize(std::move(entries));
+        }
+    }
+
+
+    void IndexedIdfTable::Write(std::ostream& output,
+                                std::vector<Entry> entries)
+    {
+        IndexedIdfTable table;
+        table.Initialize(std::move(entries));
+        table.Write(output);
+    }
+
+
+    // Calls action for each entry of source, skipping all but the first
+    // entry for each hash.
+    template <typename ACTION>
+    static void ForEachUniqueEntry(IndexedIdfTable::IEntrySource & source,
+                                   ACTION action)
+    {
+        source.Reset();
 
-        for (size_t i = 0; i < count; ++i)
+        IndexedIdfTable::Entry entry;
+        bool isFirst = true;
+        Term::Hash previous = 0;
+        while (source.Next(entry))
         {
-            const Term::Hash hash(StreamUtilities::ReadField<Term::Hash>(input));
-            const Term::IdfX10 idf(StreamUtilities::ReadField<Term::IdfX10>(input));
-            m_terms.insert(std::make_pair(hash, idf));
+            if (!isFirst)
+            {
+                CHECK_GE(entry.first, previous)
+                    << "IndexedIdfTable::Write: entries out of order.";
+                if (entry.first == previous)
+                {
+                    continue;
+                }
+            }
+            action(entry);
+            previous = entry.first;
+            isFirst = false;
         }
     }
 
 
-    void IndexedIdfTable::WriteHeader(std::ostream& output, size_t entryCount)
+    void IndexedIdfTable::Write(std::ostream& output, IEntrySource & source)
     {
-        // TODO: Use FileHeader and version.
-        StreamUtilities::WriteField<size_t>(output, entryCount);
+        size_t entryCount = 0;
+        ForEachUniqueEntry(source, [&](Entry const &)
+        {
+            ++entryCount;
+        });
+
+        const size_t payloadBytes = GetPayloadBytes(entryCount);
+
+        BinaryTableFormat::Checksum checksum(payloadBytes);
+        ForEachUniqueEntry(source, [&](Entry const & entry)
+        {
+            checksum.Add(&entry.first, sizeof(Term::Hash));
+        });
+        ForEachUniqueEntry(source, [&](Entry const & entry)
+        {
+            checksum.Add(&entry.second, sizeof(Term::IdfX10));
+        });
+
+        BinaryTableFormat::WriteHeader(output,
+                                       c_magic,
+                                       c_version,
+                                       entryCount,
+                                       payloadBytes,
+                                       checksum.Complete());
+
+        ForEachUniqueEntry(source, [&](Entry const & entry)
+        {
+            StreamUtilities::WriteField<Term::Hash>(output, entry.first);
+        });
+        ForEachUniqueEntry(source, [&](Entry const & entry)
+        {
+            StreamUtilities::WriteField<Term::IdfX10>(output, entry.second);
+        });
     }
 
 
-    void IndexedIdfTable::WriteEntry(std::ostream& output, Term::Hash hash, Term::IdfX10 idf)
+    void IndexedIdfTable::Write(std::ostream& output) const
     {
-        StreamUtilities::WriteField<Term::Hash>(output, hash);
-        StreamUtilities::WriteField<Term::IdfX10>(output, idf);
+        BinaryTableFormat::Write(output,
+                                 c_magic,
+                                 c_version,
+                                 m_entryCount,
+                                 m_buffer.data(),
+                                 GetPayloadBytes(m_entryCount));
     }
 
 
     Term::IdfX10 IndexedIdfTable::GetIdf(Term::Hash hash) const
     {
-        auto it = m_terms.find(hash);
-        if (it != m_terms.end())
+        Term::Hash const * hashes = GetHashes();
+        Term::Hash const * it = std::lower_bound(hashes,
+                                                 hashes + m_entryCount,
+                                                 hash);
+        if (it != hashes + m_entryCount && *it == hash)
         {
-            return (*it).second;
+            return GetIdfs()[it - hashes];
         }
         else
         {
             return m_defaultIdf;
         }
     }
+
+
+    void IndexedIdfTable::Initialize(std::vector<Entry> entries)
+    {
+        // Sort by hash. The stable sort and unique keep the first entry for
+        // each hash.
+        std::stable_sort(entries.begin(),
+                         entries.end(),
+                         [](Entry const & a, Entry const & b)
+                         {
+                             return a.first < b.first;
+                         });
+        entries.erase(std::unique(entries.begin(),
+                                  entries.end(),
+                                  [](Entry const & a, Entry const & b)
+                                  {
+                                      return a.first == b.first;
+                                  }),
+                      entries.end());
+
+        m_entryCount = entries.size();
+        m_buffer.assign(
+            BinaryTableFormat::QuadwordsFromBytes(GetPayloadBytes(m_entryCount)),
+            0);
+
+        Term::Hash * hashes = reinterpret_cast<Term::Hash *>(m_buffer.data());
+        Term::IdfX10 * idfs = reinterpret_cast<Term::IdfX10 *>(hashes + m_entryCount);
+        for (size_t i = 0; i < m_entryCount; ++i)
+        {
+            hashes[i] = entries[i].first;
+            idfs[i] = entries[i].second;
+        }
+    }
+
+
+    Term::Hash const * IndexedIdfTable::GetHashes() const
+    {
+        return reinterpret_cast<Term::Hash const *>(m_buffer.data());
+    }
+
+
+    Term::IdfX10 const * IndexedIdfTable::GetIdfs() const
+    {
+        return reinterpret_cast<Term::IdfX10 const *>(GetHashes() + m_entryCount);
+    }
+
+
+    size_t IndexedIdfTable::GetPayloadBytes(size_t entryCount)
+    {
+        // Array of Term::Hash followed by array of Term::IdfX10.
+        return entryCount * c_bytesPerEntry;
+    }
 }
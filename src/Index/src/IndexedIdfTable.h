@@ -23,33 +23,86 @@
 #pragma once
 
 #include <iosfwd>                               // std::istream parameter.
-#include <unordered_map>                        // Embedded.
+#include <stdint.h>                             // uint64_t embedded.
+#include <utility>                              // std::pair parameter.
+#include <vector>                               // std::vector embedded.
 
 #include "BitFunnel/Index/IIndexedIdfTable.h"   // Base class.
 
 
 namespace BitFunnel
 {
+    //*************************************************************************
+    //
+    // IndexedIdfTable maps Term::Hash to Term::IdfX10.
+    //
+    // The table is stored as a hash-sorted array of Term::Hash followed by a
+    // parallel array of Term::IdfX10. The binary file form (see
+    // BinaryTableFormat) is this same layout, so loading is a single read
+    // and GetIdf() does a binary search in the loaded buffer. Files in the
+    // older format (an entry count followed by unsorted (hash, idf) pairs)
+    // are still accepted.
+    //
+    //*************************************************************************
     class IndexedIdfTable : public IIndexedIdfTable
     {
     public:
+        typedef std::pair<Term::Hash, Term::IdfX10> Entry;
+
         // TODO: Remove this temporary constructor.
         IndexedIdfTable();
 
         IndexedIdfTable(std::istream& input, Term::IdfX10 defaultIdf);
 
-        static void WriteHeader(std::ostream& output, size_t entryCount);
-        static void WriteEntry(std::ostream& output,
-                               Term::Hash hash, Term::IdfX10 idf);
+        // Writes entries in the binary form. If a Term::Hash appears more
+        // than once, the first entry wins.
+        static void Write(std::ostream& output, std::vector<Entry> entries);
+
+        // Supplies entries to the streaming form of Write(). Entries must be
+        // in non-decreasing hash order. If a Term::Hash appears more than
+        // once, the first entry wins.
+        class IEntrySource
+        {
+        public:
+            virtual ~IEntrySource() {}
+
+            // Restarts the sequence at the first entry.
+            virtual void Reset() = 0;
+
+            // Copies the next entry into entry and returns true. Returns
+            // false at the end of the sequence.
+            virtual bool Next(Entry & entry) = 0;
+        };
+
+        // Writes the same binary form as Write() above while holding only
+        // one entry in memory. Because the header records the entry count
+        // and payload checksum, and the payload stores all hashes before
+        // all idfs, the source is traversed five times.
+        static void Write(std::ostream& output, IEntrySource & source);
 
         //
         // IIndexedIdfTable methods.
         //
         virtual Term::IdfX10 GetIdf(Term::Hash hash) const override;
 
+        virtual void Write(std::ostream& output) const override;
+
     private:
+        void Initialize(std::vector<Entry> entries);
+
+        Term::Hash const * GetHashes() const;
+        Term::IdfX10 const * GetIdfs() const;
+
+        static size_t GetPayloadBytes(size_t entryCount);
+
+        static const uint64_t c_magic = 0x0000544449464200ull;
+        static const uint32_t c_version = 1;
+        static const size_t c_bytesPerEntry =
+            sizeof(Term::Hash) + sizeof(Term::IdfX10);
+
         Term::IdfX10 m_defaultIdf;
 
-        std::unordered_map<Term::Hash, Term::IdfX10> m_terms;
+        size_t m_entryCount;
+        std::vector<uint64_t> m_buffer;
     };
 }
@@ -22,16 +22,20 @@
 
 #include <iostream>     // TODO: Remove this temporary header.
 #include <memory>
+#include <sstream>
 
 #include "BitFunnel/Configuration/IShardDefinition.h"
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/IFileManager.h"
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Index/IDocument.h"
+#include "BitFunnel/Index/IDocumentHistogram.h"
 #include "BitFunnel/Index/IIndexedIdfTable.h"
 #include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/IShardCostFunction.h"
 #include "BitFunnel/Index/ISliceBufferAllocator.h"
 #include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/Index/ShardDefinitionBuilder.h"
 #include "BitFunnel/Utilities/Factories.h"
 #include "DocumentHandleInternal.h"
 #include "Ingestor.h"
@@ -63,11 +67,15 @@ namespace BitFunnel
                        ISliceBufferAllocator& sliceBufferAllocator)
         : m_recycler(recycler),
           m_shardDefinition(shardDefinition),
+          m_currentShardDefinition(&shardDefinition),
+          m_rebalanceInterval(0),
           m_documentCount(0),   // TODO: This member is now redundant (with m_documentMap).
           m_totalSourceByteSize(0),
           m_documentMap(new DocumentMap()),
           m_documentCache(new DocumentCache()),
           m_tokenManager(Factories::CreateTokenManager()),
+          m_isGroupOpen(false),
+          m_currentGroupId(0),
           m_sliceBufferAllocator(sliceBufferAllocator)
     {
         // Create shards based on shard definition in m_shardDefinition..
@@ -83,6 +91,15 @@ namespace BitFunnel
                               m_sliceBufferAllocator,
                               m_sliceBufferAllocator.GetSliceBufferSize())));
         }
+
+        m_shardDocumentCounts.reset(new std::atomic<size_t>[m_shards.size()]);
+        for (size_t shard = 0; shard < m_shards.size(); ++shard)
+        {
+            m_shardDocumentCounts[shard] = 0;
+        }
+
+        m_densityMonitor.reset(new RowDensityMonitor(*this, termTables));
+        m_sliceCompactor.reset(new SliceCompactor(*this));
     }
 
 
@@ -154,15 +171,47 @@ namespace BitFunnel
 
     void Ingestor::Add(DocId id, IDocument const & document)
     {
-        ++m_documentCount;
+        AddDocument(id, document, true);
+    }
+
+
+    void Ingestor::AddDocument(DocId id,
+                               IDocument const & document,
+                               bool isNewDocument)
+    {
         m_totalSourceByteSize += document.GetSourceByteSize();
 
         // Add postingCount to the DocumentHistogramBuilder
         m_histogram.AddDocument(document.GetPostingCount());
+        m_rebalanceHistogram.AddDocument(document.GetPostingCount());
 
-        // Choose correct shard and then allocate handle.
-        ShardId shardId = m_shardDefinition.GetShard(document.GetPostingCount());
+        if (isNewDocument)
+        {
+            const size_t documentCount = ++m_documentCount;
+            const size_t interval = m_rebalanceInterval;
+            if (interval != 0 && documentCount % interval == 0)
+            {
+                // Only one thread rebalances. The others keep routing
+                // documents with the current definition rather than wait.
+                std::unique_lock<std::mutex> lock(m_rebalanceLock, std::try_to_lock);
+                if (lock.owns_lock())
+                {
+                    RebalanceShardsLocked();
+                }
+            }
+        }
+
+        // Choose correct shard and then allocate handle. The Token keeps a
+        // definition replaced by a concurrent rebalance alive until it has
+        // been read.
+        ShardId shardId;
+        {
+            const Token token = m_tokenManager->RequestToken();
+            shardId = m_currentShardDefinition.load()->GetShard(
+                document.GetPostingCount());
+        }
         DocumentHandleInternal handle = m_shards[shardId]->AllocateDocument(id);
+        ++m_shardDocumentCounts[shardId];
 
         //std::cout
         //    << "IIngestor::Add("
@@ -183,12 +232,15 @@ namespace BitFunnel
 
         try
         {
-            m_documentMap->Add(handle);
+            m_documentMap->Add(handle,
+                               document.GetPostingCount(),
+                               document.GetSourceByteSize());
         }
         catch (...)
         {
             try
             {
+                --m_shardDocumentCounts[shardId];
                 handle.Expire();
             }
             catch (...)
@@ -223,6 +275,157 @@ namespace BitFunnel
     }
 
 
+    size_t Ingestor::GetShardDocumentCount(size_t shard) const
+    {
+        return m_shardDocumentCounts[shard];
+    }
+
+
+    IShardDefinition const & Ingestor::GetShardDefinition() const
+    {
+        return *m_currentShardDefinition.load();
+    }
+
+
+    void Ingestor::RebalanceShards()
+    {
+        std::lock_guard<std::mutex> lock(m_rebalanceLock);
+        RebalanceShardsLocked();
+    }
+
+
+    void Ingestor::SetShardRebalanceInterval(size_t documentInterval)
+    {
+        m_rebalanceInterval = documentInterval;
+    }
+
+
+    IRowDensityMonitor & Ingestor::GetRowDensityMonitor() const
+    {
+        return *m_densityMonitor;
+    }
+
+
+    ISliceCompactor & Ingestor::GetSliceCompactor() const
+    {
+        return *m_sliceCompactor;
+    }
+
+
+    size_t Ingestor::CompactSlices(double minLiveRatio, size_t& movedCount)
+    {
+        const Token token = m_tokenManager->RequestToken();
+
+        size_t retiredCount = 0;
+        movedCount = 0;
+        std::vector<DocumentHandleInternal> moved;
+        for (auto & shard : m_shards)
+        {
+            std::vector<std::unique_ptr<Shard::PendingMerge>> merges;
+            {
+                std::lock_guard<std::mutex> lock(m_deleteDocumentLock);
+                shard->SelectMerges(minLiveRatio, merges);
+            }
+
+            for (auto & merge : merges)
+            {
+                // Copying the rows does not hold the lock, so deletes and
+                // updates only wait for the final check and exchange.
+                shard->BuildMerge(*merge);
+
+                // A document which is deleted while it is being moved would
+                // be resurrected in its new Slice.
+                std::lock_guard<std::mutex> lock(m_deleteDocumentLock);
+                moved.clear();
+                retiredCount += shard->CommitMerge(*merge, moved);
+                m_documentMap->Update(moved);
+                movedCount += moved.size();
+            }
+        }
+
+        return retiredCount;
+    }
+
+
+    void Ingestor::RebalanceShardsLocked()
+    {
+        // Each boundary chosen by the builder is followed by an implicit
+        // shard for larger documents, so a single-shard index has nothing
+        // to rebalance.
+        if (m_shards.size() < 2)
+        {
+            return;
+        }
+
+        auto histogram = m_rebalanceHistogram.CreateHistogram();
+        if (histogram->GetEntryCount() == 0)
+        {
+            return;
+        }
+
+        // Documents seen before this rebalance count half as much at the
+        // next one.
+        m_rebalanceHistogram.Decay();
+
+        // Same cost function parameters as the 'BitFunnel shard' tool.
+        auto costFunction =
+            Factories::CreateShardCostFunction(*histogram, 1.0, 1, 3);
+
+        // The definition may use fewer shards than before, but never more
+        // than there are TermTables.
+        auto definition =
+            ShardDefinitionBuilder::CreateShardDefinition(*costFunction,
+                                                          m_shards.size() - 1);
+
+        m_currentShardDefinition = definition.get();
+        std::unique_ptr<IShardDefinition const>
+            replaced(std::move(m_rebalancedDefinition));
+        m_rebalancedDefinition = std::move(definition);
+
+        // The constructor's definition belongs to the caller.
+        if (replaced != nullptr)
+        {
+            std::unique_ptr<IRecyclable> recyclable(
+                new DeferredShardDefinitionDelete(std::move(replaced),
+                                                  *m_tokenManager));
+            m_recycler.ScheduleRecyling(recyclable);
+        }
+    }
+
+
+    //*************************************************************************
+    //
+    // DeferredShardDefinitionDelete
+    //
+    //*************************************************************************
+    Ingestor::DeferredShardDefinitionDelete::DeferredShardDefinitionDelete(
+        std::unique_ptr<IShardDefinition const> definition,
+        ITokenManager& tokenManager)
+        : m_definition(std::move(definition)),
+          m_tokenManager(tokenManager)
+    {
+    }
+
+
+    ITokenManager&
+        Ingestor::DeferredShardDefinitionDelete::GetTokenManager() const
+    {
+        return m_tokenManager;
+    }
+
+
+    size_t Ingestor::DeferredShardDefinitionDelete::GetByteSize() const
+    {
+        return sizeof(size_t) * m_definition->GetShardCount();
+    }
+
+
+    void Ingestor::DeferredShardDefinitionDelete::Recycle()
+    {
+        m_definition.reset();
+    }
+
+
     ITokenManager& Ingestor::GetTokenManager() const
     {
         return *m_tokenManager;
@@ -245,6 +448,7 @@ namespace BitFunnel
         if (isFound)
         {
             m_documentMap->Delete(id);
+            --m_shardDocumentCounts[location.GetSlice().GetShard().GetId()];
             location.Expire();
         }
 
@@ -257,6 +461,67 @@ namespace BitFunnel
     }
 
 
+    bool Ingestor::Update(DocId id, IDocument const & document)
+    {
+        bool isReplacement = false;
+        {
+            const Token token = m_tokenManager->RequestToken();
+
+            // Excludes Delete() and ExpireGroup() from the document's column
+            // while it is being rewritten.
+            std::lock_guard<std::mutex> lock(m_deleteDocumentLock);
+
+            bool isFound;
+            DocumentHandleInternal handle = m_documentMap->Find(id, isFound);
+
+            if (isFound)
+            {
+                // The new contents replace the old ones in the statistics,
+                // rather than adding to them.
+                size_t oldPostingCount = 0;
+                size_t oldSourceByteSize = 0;
+                m_documentMap->ReplaceSizes(id,
+                                            document.GetPostingCount(),
+                                            document.GetSourceByteSize(),
+                                            oldPostingCount,
+                                            oldSourceByteSize);
+                m_totalSourceByteSize -= oldSourceByteSize;
+                m_histogram.RemoveDocument(oldPostingCount);
+                m_rebalanceHistogram.RemoveDocument(oldPostingCount);
+                isReplacement = true;
+
+                const ShardId shardId =
+                    m_currentShardDefinition.load()->GetShard(document.GetPostingCount());
+                Shard & shard = handle.GetSlice().GetShard();
+
+                if (shard.GetId() == shardId)
+                {
+                    m_totalSourceByteSize += document.GetSourceByteSize();
+                    m_histogram.AddDocument(document.GetPostingCount());
+                    m_rebalanceHistogram.AddDocument(document.GetPostingCount());
+
+                    shard.ClearDocument(handle.GetIndex(),
+                                        handle.GetSlice().GetSliceBuffer());
+                    document.Ingest(handle);
+                    handle.Activate();
+
+                    return true;
+                }
+            }
+        }
+
+        // The document moves to another shard, or is new. Delete() and
+        // AddDocument() acquire their own Token and locks. AddDocument()
+        // records the new contents in the statistics. A document that moves
+        // is not a new document, so it does not count towards the
+        // rebalance interval.
+        Delete(id);
+        AddDocument(id, document, !isReplacement);
+
+        return false;
+    }
+
+
     void Ingestor::AssertFact(DocId /*id*/, FactHandle /*fact*/, bool /*value*/)
     {
         throw NotImplemented();
@@ -295,7 +560,13 @@ namespace BitFunnel
 
     size_t Ingestor::GetUsedCapacityInBytes() const
     {
-        throw NotImplemented();
+        size_t bytes = 0;
+        for (auto const & shard : m_shards)
+        {
+            bytes += shard->GetUsedCapacityInBytes();
+        }
+
+        return bytes;
     }
 
 
@@ -307,24 +578,107 @@ namespace BitFunnel
 
     void Ingestor::Shutdown()
     {
+        // The sampler and compactor threads request tokens, so they must
+        // stop first.
+        m_densityMonitor->Stop();
+        m_sliceCompactor->Stop();
         m_tokenManager->Shutdown();
     }
 
 
-    void Ingestor::OpenGroup(GroupId /*groupId*/)
+    void Ingestor::OpenGroup(GroupId groupId)
     {
-        throw NotImplemented();
+        std::lock_guard<std::mutex> lock(m_groupLock);
+
+        if (m_groups.find(groupId) != m_groups.end())
+        {
+            std::stringstream message;
+            message << "Ingestor::OpenGroup(): group " << groupId
+                    << " has already been opened.";
+            RecoverableError error(message.str());
+            throw error;
+        }
+
+        m_groups.insert(groupId);
+        m_isGroupOpen = true;
+        m_currentGroupId = groupId;
+
+        for (auto & shard : m_shards)
+        {
+            shard->OpenGroup(groupId);
+        }
     }
 
 
     void Ingestor::CloseGroup()
     {
-        throw NotImplemented();
+        std::lock_guard<std::mutex> lock(m_groupLock);
+
+        if (m_isGroupOpen)
+        {
+            m_isGroupOpen = false;
+            for (auto & shard : m_shards)
+            {
+                shard->CloseGroup();
+            }
+        }
     }
 
 
-    void Ingestor::ExpireGroup(GroupId /*groupId*/)
+    void Ingestor::ExpireGroup(GroupId groupId)
     {
-        throw NotImplemented();
+        // The Token keeps the group's Slices alive until their documents
+        // have been removed from m_documentMap.
+        const Token token = m_tokenManager->RequestToken();
+
+        std::lock_guard<std::mutex> groupLock(m_groupLock);
+
+        if (m_groups.find(groupId) == m_groups.end())
+        {
+            std::stringstream message;
+            message << "Ingestor::ExpireGroup(): group " << groupId
+                    << " is not in the index.";
+            RecoverableError error(message.str());
+            throw error;
+        }
+
+        if (m_isGroupOpen && m_currentGroupId == groupId)
+        {
+            std::stringstream message;
+            message << "Ingestor::ExpireGroup(): group " << groupId
+                    << " is still open.";
+            RecoverableError error(message.str());
+            throw error;
+        }
+
+        // A call to Add() which allocated its column before the group was
+        // closed may not have committed it yet. The group's Slices are
+        // sealed, so this resolves without intervention, and the caller may
+        // retry. Checking every shard first leaves the group intact.
+        for (auto const & shard : m_shards)
+        {
+            if (shard->IsGroupIngesting(groupId))
+            {
+                std::stringstream message;
+                message << "Ingestor::ExpireGroup(): group " << groupId
+                        << " has documents pending commit.";
+                RecoverableError error(message.str());
+                throw error;
+            }
+        }
+
+        // Excludes Delete() from the group's Slices while they are expired.
+        std::lock_guard<std::mutex> deleteLock(m_deleteDocumentLock);
+
+        std::vector<DocumentHandleInternal> expired;
+        for (size_t shard = 0; shard < m_shards.size(); ++shard)
+        {
+            expired.clear();
+            m_shards[shard]->ExpireGroup(groupId, expired);
+            m_shardDocumentCounts[shard] -= expired.size();
+            m_documentMap->Delete(expired);
+        }
+
+        m_groups.erase(groupId);
     }
 }
@@ -25,6 +25,7 @@
 #include <atomic>                           // std::atomic member.
 #include <memory>                           // std::unique_ptr embedded.
 #include <mutex>                            // std::mutex member.
+#include <set>                              // std::set member.
 #include <stddef.h>                         // size_t template parameter.
 #include <vector>                           // std::vector embedded.
 
@@ -35,6 +36,9 @@
 #include "DocumentCache.h"                  // DocumentCache embedded.
 #include "DocumentHistogramBuilder.h"       // Embeds DocumentHistogramBuilder.
 #include "DocumentMap.h"                    // DocumentMap template parameter.
+#include "IRecyclable.h"                    // Base class.
+#include "RowDensityMonitor.h"              // std::unique_ptr template parameter.
+#include "SliceCompactor.h"                 // std::unique_ptr template parameter.
 #include "Shard.h"                          // std::unique_ptr template parameter.
 
 
@@ -98,6 +102,16 @@ namespace BitFunnel
         // some of which may already have been deleted for other reasons.
         virtual bool Delete(DocId id) override;
 
+        // Replaces the document with the given id. When the document is in
+        // the index and its new posting count routes it to the same shard,
+        // its postings are replaced within its existing column, so no
+        // expired column is left behind, and this method returns true.
+        // Otherwise the document is deleted, if present, and added as a new
+        // document, and this method returns false. Queries running
+        // concurrently with an in-place update may briefly miss the
+        // document.
+        virtual bool Update(DocId id, IDocument const & document) override;
+
         // Sets or clears a fact about a document with the given DocId. The
         // FactHandle must have been previously registered in the IFactSet,
         // otherwise the function throws.
@@ -128,6 +142,13 @@ namespace BitFunnel
         virtual size_t GetShardCount() const override;
         virtual IShard& GetShard(size_t shard) const override;
 
+        virtual size_t GetShardDocumentCount(size_t shard) const override;
+        virtual IShardDefinition const & GetShardDefinition() const override;
+        virtual void RebalanceShards() override;
+        virtual void SetShardRebalanceInterval(size_t documentInterval) override;
+        virtual IRowDensityMonitor & GetRowDensityMonitor() const override;
+        virtual ISliceCompactor & GetSliceCompactor() const override;
+
         virtual IRecycler& GetRecycler() const override;
 
         virtual ITokenManager& GetTokenManager() const override;
@@ -148,18 +169,78 @@ namespace BitFunnel
         //    - All future addition operations are done in this new group.
         //    - The previous group is closed. A closed group cannot be reopened or
         //      modified.
+        //    - Each group occupies whole slices. Opening a group seals the
+        //      slices which were receiving documents.
+        // Throws if groupId has been opened before and not yet expired.
         virtual void OpenGroup(GroupId groupId) override;
 
         // Closes the current group, if any.
         virtual void CloseGroup() override;
 
-        // Expires the group with the given id.
+        // Expires the group with the given id. The documents in the group are
+        // removed from serving and the group's slices are recycled as a whole,
+        // without looking up each document. Throws if the group is unknown or
+        // still open. Documents must not be added to the group concurrently.
         virtual void ExpireGroup(GroupId groupId) override;
 
+        // Merges sparsely populated Slices in each Shard, as described in
+        // Shard::SelectMerges(), and repoints the DocumentMap at the moved
+        // documents. Sets movedCount to the number of documents moved.
+        // Returns the number of Slices retired. Called by the SliceCompactor.
+        size_t CompactSlices(double minLiveRatio, size_t& movedCount);
+
     private:
+        // Implements Add(). Update() passes false for isNewDocument when it
+        // moves an existing document to another shard, so that the move is
+        // not counted towards the rebalance interval.
+        void AddDocument(DocId id,
+                         IDocument const & document,
+                         bool isNewDocument);
+
+        // Computes a new shard definition while holding m_rebalanceLock.
+        void RebalanceShardsLocked();
+
+        // Deletes an IShardDefinition replaced by RebalanceShards() once the
+        // calls to Add() which may be routing with it have returned their
+        // Tokens.
+        class DeferredShardDefinitionDelete : public IRecyclable
+        {
+        public:
+            DeferredShardDefinitionDelete(
+                std::unique_ptr<IShardDefinition const> definition,
+                ITokenManager& tokenManager);
+
+            //
+            // IRecyclable API.
+            //
+            virtual ITokenManager& GetTokenManager() const override;
+            virtual size_t GetByteSize() const override;
+            virtual void Recycle() override;
+
+        private:
+            std::unique_ptr<IShardDefinition const> m_definition;
+            ITokenManager& m_tokenManager;
+        };
+
         IRecycler& m_recycler;
         IShardDefinition const & m_shardDefinition;
 
+        // Routes new documents. Starts out as &m_shardDefinition. Add() reads
+        // it while holding a Token, so a definition replaced by
+        // RebalanceShards() is handed to m_recycler, which deletes it once
+        // those Tokens have drained. m_rebalancedDefinition owns the current
+        // definition once the index has been rebalanced.
+        std::atomic<IShardDefinition const *> m_currentShardDefinition;
+        std::unique_ptr<IShardDefinition const> m_rebalancedDefinition;
+        std::mutex m_rebalanceLock;
+        std::atomic<size_t> m_rebalanceInterval;
+
+        // Posting count histogram used by RebalanceShards(). Unlike
+        // m_histogram, which describes the whole corpus for statistics, it
+        // is decayed after each rebalance so that the boundaries follow
+        // changes in the incoming documents.
+        DocumentHistogramBuilder m_rebalanceHistogram;
+
         // TODO: Replace these tempoary statistics variables with document
         // length hash table and term frequency tables.
         // TODO: This member is now redundant (with DocumentMap).
@@ -175,12 +256,27 @@ namespace BitFunnel
 
         std::vector<std::unique_ptr<Shard>> m_shards;
 
+        // Number of active documents in each shard.
+        std::unique_ptr<std::atomic<size_t>[]> m_shardDocumentCounts;
+
         // TokenManager which distributes tokens for thread synchronization.
         std::unique_ptr<ITokenManager> m_tokenManager;
 
         // Lock protecting concurrent DeleteDocument operations.
         std::mutex m_deleteDocumentLock;
 
+        // Lock protecting the group state below. Acquired before
+        // m_deleteDocumentLock.
+        std::mutex m_groupLock;
+
+        // Groups which have been opened and not yet expired.
+        std::set<GroupId> m_groups;
+
+        // Group receiving new documents. Only meaningful while
+        // m_isGroupOpen is true.
+        bool m_isGroupOpen;
+        GroupId m_currentGroupId;
+
 
         DocumentHistogramBuilder m_histogram;
 
@@ -189,5 +285,12 @@ namespace BitFunnel
         // blocks of the same byte size. Slices within Shards will choose the
         // capacity for which the byte size of the buffer is sufficient.
         ISliceBufferAllocator& m_sliceBufferAllocator;
+
+        // Samples the Shards, so it is declared last to be destroyed first.
+        std::unique_ptr<RowDensityMonitor> m_densityMonitor;
+
+        // Moves documents between the Shards' Slices, so it is also declared
+        // after them.
+        std::unique_ptr<SliceCompactor> m_sliceCompactor;
     };
 }
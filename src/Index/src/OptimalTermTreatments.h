@@ -25,10 +25,11 @@
 #include <cmath>  // Used for pow in TermTreatmentMetrics.
 #include <utility>  // std::pair.
 
+#include "BitFunnel/Index/ITermTreatment.h"  // RowConfiguration return value.
+
+
 namespace BitFunnel
 {
-    class ITermTreatment;
-
     //*************************************************************************
     //
     // TermTreatmentMetrics
@@ -120,4 +121,8 @@ namespace BitFunnel
                                                   double density,
                                                   double signal,
                                                   bool verbose);
+
+    // Converts a configuration in the format used by Analyze() to a
+    // RowConfiguration.
+    RowConfiguration RowConfigurationFromSizeT(size_t configuration);
 }
@@ -21,10 +21,14 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>                    // std::find.
+#include <chrono>                       // std::chrono::milliseconds.
+
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Index/Token.h"
 #include "LoggerInterfaces/Logging.h"
 #include "Recycler.h"
+#include "Shard.h"
 #include "Slice.h"
 
 
@@ -41,11 +45,18 @@ namespace BitFunnel
     }
 
 
-    // TODO: put this arbitrary 100 constant somewhere
+    // Interval at which the recycler thread polls the trackers of
+    // outstanding epochs. Bounds the delay between the last Token of an
+    // epoch being returned and the epoch's memory being released.
+    static const std::chrono::milliseconds c_epochPollInterval(1);
+
+
     Recycler::Recycler()
-        : m_queue (std::unique_ptr<BlockingQueue<IRecyclable*>>
-                   (new BlockingQueue<IRecyclable*>(100))),
-          m_shutdown (false)
+        : m_head(nullptr),
+          m_pendingByteCount(0),
+          m_pendingItemCount(0),
+          m_shutdown(false),
+          m_sleeping(false)
     {
     }
 
@@ -53,38 +64,219 @@ namespace BitFunnel
     Recycler::~Recycler()
     {
         Shutdown();
+
+        // Release anything which was never recycled, e.g. when the recycler
+        // thread was never started. The trackers of outstanding epochs are
+        // abandoned along with them.
+        m_epochs.clear();
+        Node* node = m_head.exchange(nullptr);
+        while (node != nullptr)
+        {
+            Node* next = node->m_next;
+            delete node->m_item;
+            delete node;
+            node = next;
+        }
     }
 
 
-    // Run until shutdown. When m_shutdown is flagged, run until queue is
-    // empty and then return.
     void Recycler::Run()
     {
-        for(;;)
+        for (;;)
         {
-            IRecyclable* item;
-            if (!m_queue->TryDequeue(item))
+            GatherEpoch();
+            RetireEpochs();
+
+            if (m_shutdown && m_epochs.empty() && m_head.load() == nullptr)
             {
-                // false indicates queue shutdown.
                 break;
             }
-            LogAssertB(item, "null IRecycable item.");
-            item->Recycle();
-            delete item;
+
+            Wait();
         }
     }
 
+
     void Recycler::ScheduleRecyling(std::unique_ptr<IRecyclable>& resource)
     {
-        auto ptr = resource.release();
-        LogAssertB(m_queue->TryEnqueue(ptr),
-                   "ScheduleRecycling called on queue that's shutting down.");
+        LogAssertB(!m_shutdown,
+                   "ScheduleRecycling called on recycler that's shutting down.");
+        LogAssertB(resource.get() != nullptr, "null IRecyclable item.");
+
+        // Account for the resource before publishing it so that the recycler
+        // thread never decrements the counts below zero.
+        m_pendingByteCount += resource->GetByteSize();
+        ++m_pendingItemCount;
+
+        Node* node = new Node();
+        node->m_item = resource.release();
+        node->m_next = m_head.load(std::memory_order_relaxed);
+        while (!m_head.compare_exchange_weak(node->m_next, node))
+        {
+        }
+
+        // Both the exchange above and the store to m_sleeping in Wait() are
+        // sequentially consistent, so either this thread observes
+        // m_sleeping, or the recycler thread observes the new node before it
+        // blocks.
+        if (m_sleeping)
+        {
+            std::lock_guard<std::mutex> lock(m_wakeupLock);
+            m_wakeup.notify_one();
+        }
+    }
+
+
+    size_t Recycler::GetPendingByteCount() const
+    {
+        return m_pendingByteCount;
+    }
+
+
+    size_t Recycler::GetPendingItemCount() const
+    {
+        return m_pendingItemCount;
     }
 
 
     void Recycler::Shutdown()
     {
-        m_queue->Shutdown();
+        m_shutdown = true;
+        std::lock_guard<std::mutex> lock(m_wakeupLock);
+        m_wakeup.notify_one();
+    }
+
+
+    bool Recycler::GatherEpoch()
+    {
+        Node* list = m_head.exchange(nullptr);
+        if (list == nullptr)
+        {
+            return false;
+        }
+
+        m_epochs.emplace_back(new Epoch(list));
+        return true;
+    }
+
+
+    void Recycler::RetireEpochs()
+    {
+        // Epochs formed against a single ITokenManager complete in order, but
+        // epochs spanning different managers need not, so every epoch is
+        // examined rather than stopping at the first incomplete one.
+        auto it = m_epochs.begin();
+        while (it != m_epochs.end())
+        {
+            if ((*it)->IsComplete())
+            {
+                m_pendingItemCount -= (*it)->GetItemCount();
+                m_pendingByteCount -= (*it)->Recycle();
+                it = m_epochs.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+
+    void Recycler::Wait()
+    {
+        std::unique_lock<std::mutex> lock(m_wakeupLock);
+        m_sleeping = true;
+
+        if (m_head.load() == nullptr && !m_shutdown)
+        {
+            if (m_epochs.empty())
+            {
+                m_wakeup.wait(lock);
+            }
+            else
+            {
+                m_wakeup.wait_for(lock, c_epochPollInterval);
+            }
+        }
+
+        m_sleeping = false;
+    }
+
+
+    //*************************************************************************
+    //
+    // Recycler::Epoch.
+    //
+    //*************************************************************************
+    Recycler::Epoch::Epoch(Node* list)
+    {
+        std::vector<ITokenManager*> tokenManagers;
+
+        // The list is in LIFO order. Reverse it so that resources are
+        // recycled in the order they were scheduled.
+        while (list != nullptr)
+        {
+            Node* next = list->m_next;
+            m_items.push_back(list->m_item);
+            delete list;
+            list = next;
+
+            ITokenManager* tokenManager = &m_items.back()->GetTokenManager();
+            if (std::find(tokenManagers.begin(),
+                          tokenManagers.end(),
+                          tokenManager) == tokenManagers.end())
+            {
+                tokenManagers.push_back(tokenManager);
+            }
+        }
+        std::reverse(m_items.begin(), m_items.end());
+
+        for (auto tokenManager : tokenManagers)
+        {
+            m_trackers.push_back(tokenManager->StartTracker());
+        }
+    }
+
+
+    Recycler::Epoch::~Epoch()
+    {
+        for (auto item : m_items)
+        {
+            delete item;
+        }
+    }
+
+
+    bool Recycler::Epoch::IsComplete() const
+    {
+        for (auto const & tracker : m_trackers)
+        {
+            if (!tracker->IsComplete())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    size_t Recycler::Epoch::Recycle()
+    {
+        size_t byteCount = 0;
+        for (auto item : m_items)
+        {
+            byteCount += item->GetByteSize();
+            item->Recycle();
+            delete item;
+        }
+        m_items.clear();
+        return byteCount;
+    }
+
+
+    size_t Recycler::Epoch::GetItemCount() const
+    {
+        return m_items.size();
     }
 
 
@@ -98,14 +290,35 @@ namespace BitFunnel
                                                      ITokenManager& tokenManager)
         : m_slice(slice),
           m_sliceBuffers(sliceBuffers),
-          m_tokenTracker(tokenManager.StartTracker())
+          m_tokenManager(tokenManager)
+    {
+    }
+
+
+    ITokenManager& DeferredSliceListDelete::GetTokenManager() const
+    {
+        return m_tokenManager;
+    }
+
+
+    size_t DeferredSliceListDelete::GetByteSize() const
     {
+        size_t byteCount = 0;
+        if (m_sliceBuffers != nullptr)
+        {
+            byteCount += sizeof(*m_sliceBuffers)
+                + m_sliceBuffers->capacity() * sizeof(void*);
+        }
+        if (m_slice != nullptr)
+        {
+            byteCount += m_slice->GetShard().GetSliceBufferSize();
+        }
+        return byteCount;
     }
 
 
     void DeferredSliceListDelete::Recycle()
     {
-        m_tokenTracker->WaitForCompletion();
         if (m_slice != nullptr)
         {
             // Deleting a Slice invokes its destructor which returns its
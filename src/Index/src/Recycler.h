@@ -23,12 +23,15 @@
 
 #pragma once
 
+#include <atomic>                       // std::atomic embedded.
+#include <condition_variable>           // std::condition_variable embedded.
+#include <deque>                        // std::deque embedded.
 #include <memory>
+#include <mutex>                        // std::mutex embedded.
 #include <vector>
 
 #include "BitFunnel/NonCopyable.h"
 #include "BitFunnel/Index/IRecycler.h"
-#include "BitFunnel/Utilities/BlockingQueue.h"
 #include "IRecyclable.h"
 
 
@@ -54,8 +57,11 @@ namespace BitFunnel
     //    involves deleting the vector and returning the Slice back to its
     //    allocator and deleting the resources it held.
     //
-    // Uses token system to determine when the consumers of the resource have
-    // exited.
+    // When several Slices are removed by a single change of the list, only
+    // one instance carries the old list and the others are handed nullptr.
+    //
+    // The Recycler uses the token system to determine when the consumers of
+    // the resource have exited.
     //
     // TODO: Consider moving to Shard.cpp, as it is the only consumer of the class.
     class DeferredSliceListDelete : public IRecyclable
@@ -68,28 +74,36 @@ namespace BitFunnel
         //
         // IRecyclable API.
         //
+        virtual ITokenManager& GetTokenManager() const override;
+        virtual size_t GetByteSize() const override;
         virtual void Recycle() override;
 
     private:
         Slice* m_slice;
         std::vector<void*> const * m_sliceBuffers;
-
-        // Token tracker which is associated with this recyclable.
-        // When all of the tokens which it tracks, have been removed from
-        // circulation, m_slice and m_sliceList can be recycled.
-        std::shared_ptr<ITokenTracker> m_tokenTracker;
+        ITokenManager& m_tokenManager;
     };
 
 
     //*************************************************************************
     //
     // Class which implements a list of IRecyclable instances which have been
-    // scheduled for recycling. Instances of IRecyclable indicate that they
-    // can be recycled by returning true from their CanRecycle() method.
+    // scheduled for recycling.
+    //
+    // Producers push resources onto a lock-free intrusive stack. The
+    // recycler thread periodically takes the entire stack and groups the
+    // resources into an epoch, starting a single ITokenTracker per
+    // ITokenManager for the epoch. An epoch retires when its trackers
+    // complete, at which point all of its resources are recycled in bulk.
     //
-    // Maintains a queue of objects that were dropped for recyling and polls
-    // them to check if they can be recycled by checking their CanRecycle(),
-    // and it if returns true, calls their OnRecycle().
+    // The recycler thread polls trackers instead of blocking on them, so a
+    // slow query delays only the epochs it overlaps, and new resources
+    // continue to be gathered into epochs while older ones are draining.
+    //
+    // Starting the tracker when the epoch is formed rather than when the
+    // resource is scheduled is safe. Any Token which could observe the
+    // resource was issued before it was scheduled, and is therefore either
+    // returned already or still outstanding when the tracker starts.
     //
     //*************************************************************************
     class Recycler : public IRecycler, NonCopyable
@@ -104,19 +118,84 @@ namespace BitFunnel
         // that things are shut down correctly on an exception.
         ~Recycler();
 
+        // Run until shutdown. When Shutdown() is called, runs until every
+        // scheduled resource has been recycled and then returns.
         void Run() override;
 
+        // Signals Run() to return once all scheduled resources have been
+        // recycled. Does not block.
         void Shutdown() override;
 
         // Adds a resource to the list for recycling.
         // Recycler takes ownership of the resource.
+        // This method is lock-free.
         virtual void
             ScheduleRecyling(std::unique_ptr<IRecyclable>& resource) override;
+
+        virtual size_t GetPendingByteCount() const override;
+        virtual size_t GetPendingItemCount() const override;
+
     private:
-        // TODO: we should log of this queue fills to the point of blocking on
-        // enqueue. That's an unexpected condition.
-        std::unique_ptr<BlockingQueue<IRecyclable*>> m_queue;
+        // Link in the lock-free stack of scheduled resources.
+        struct Node
+        {
+            IRecyclable* m_item;
+            Node* m_next;
+        };
+
+        // A group of resources which become recyclable when all of its
+        // trackers have completed.
+        class Epoch : NonCopyable
+        {
+        public:
+            // Takes ownership of the nodes in list and starts a tracker for
+            // each distinct ITokenManager referenced by the list.
+            Epoch(Node* list);
+
+            ~Epoch();
+
+            bool IsComplete() const;
+
+            // Recycles all resources in the epoch. Returns the number of
+            // bytes released.
+            size_t Recycle();
+
+            size_t GetItemCount() const;
+
+        private:
+            std::vector<IRecyclable*> m_items;
+            std::vector<std::shared_ptr<ITokenTracker>> m_trackers;
+        };
+
+        // Takes every resource from the stack and forms a new epoch.
+        // Returns false if the stack was empty.
+        bool GatherEpoch();
+
+        // Recycles each epoch whose trackers have completed.
+        void RetireEpochs();
+
+        // Blocks the recycler thread until there is new work or until it is
+        // time to poll the outstanding epochs.
+        void Wait();
+
+        // Head of the lock-free stack of scheduled resources.
+        std::atomic<Node*> m_head;
+
+        // Epochs awaiting completion of their trackers. Accessed only by the
+        // recycler thread.
+        std::deque<std::unique_ptr<Epoch>> m_epochs;
+
+        std::atomic<size_t> m_pendingByteCount;
+        std::atomic<size_t> m_pendingItemCount;
 
         std::atomic<bool> m_shutdown;
+
+        // m_sleeping is set while the recycler thread waits on m_wakeup.
+        // ScheduleRecyling() takes m_wakeupLock only when m_sleeping is set,
+        // so producers do not contend with the recycler thread while it is
+        // active.
+        std::atomic<bool> m_sleeping;
+        std::mutex m_wakeupLock;
+        std::condition_variable m_wakeup;
     };
 }
@@ -0,0 +1,301 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IShard.h"
+#include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "LoggerInterfaces/Check.h"
+#include "LoggerInterfaces/Logging.h"
+#include "RowDensityMonitor.h"
+
+
+namespace BitFunnel
+{
+    const size_t IRowDensityMonitor::c_histogramBuckets;
+
+
+    RowDensityMonitor::RowDensityMonitor(IIngestor const & ingestor,
+                                         ITermTableCollection const & termTables)
+      : m_ingestor(ingestor),
+        m_termTables(termTables),
+        m_sliceCount(c_defaultSliceCount),
+        // TermTables are typically built for shared row densities around
+        // 0.1, so 0.15 leaves room for noise before alerting.
+        m_alertDensity(0.15),
+        m_maxOverfullRows(c_defaultMaxOverfullRows),
+        m_sampleCount(0),
+        m_sampledAlertDensity(0),
+        m_sampledRowCount(0),
+        m_overfullRowCount(0),
+        m_histogram(c_histogramBuckets, 0),
+        m_stopping(false)
+    {
+    }
+
+
+    RowDensityMonitor::~RowDensityMonitor()
+    {
+        Stop();
+    }
+
+
+    void RowDensityMonitor::Configure(size_t sliceCount,
+                                      double alertDensity,
+                                      size_t maxOverfullRows)
+    {
+        CHECK_GT(sliceCount, 0u)
+            << "RowDensityMonitor: sliceCount must be at least 1.";
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_sliceCount = sliceCount;
+        m_alertDensity = alertDensity;
+        m_maxOverfullRows = maxOverfullRows;
+    }
+
+
+    void RowDensityMonitor::Sample()
+    {
+        std::lock_guard<std::mutex> sampleLock(m_sampleLock);
+
+        size_t sliceCount;
+        double alertDensity;
+        size_t maxOverfullRows;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            sliceCount = m_sliceCount;
+            alertDensity = m_alertDensity;
+            maxOverfullRows = m_maxOverfullRows;
+        }
+
+        const ShardId shardCount = static_cast<ShardId>(m_ingestor.GetShardCount());
+
+        if (m_sharedRows.empty())
+        {
+            m_sharedRows.resize(shardCount);
+            for (ShardId shard = 0; shard < shardCount; ++shard)
+            {
+                ITermTable const & termTable = m_termTables.GetTermTable(shard);
+                for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+                {
+                    m_sharedRows[shard][rank] = termTable.GetSharedRows(rank);
+                }
+            }
+        }
+
+        std::vector<size_t> histogram(c_histogramBuckets, 0);
+        std::vector<OverfullRow> overfullRows;
+        size_t sampledRowCount = 0;
+
+        for (ShardId shard = 0; shard < shardCount; ++shard)
+        {
+            IShard const & s = m_ingestor.GetShard(shard);
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                auto const & shared = m_sharedRows[shard][rank];
+                if (std::find(shared.begin(), shared.end(), true) == shared.end())
+                {
+                    // No shared rows at this rank.
+                    continue;
+                }
+
+                auto densities = s.GetRecentDensities(rank, sliceCount);
+                for (RowIndex row = 0; row < densities.size() && row < shared.size(); ++row)
+                {
+                    if (!shared[row])
+                    {
+                        continue;
+                    }
+
+                    const double density = densities[row];
+                    const size_t bucket =
+                        (std::min)(static_cast<size_t>(density * c_histogramBuckets),
+                                   c_histogramBuckets - 1);
+                    ++histogram[bucket];
+                    ++sampledRowCount;
+
+                    if (density > alertDensity)
+                    {
+                        overfullRows.push_back({ shard, RowId(rank, row), density });
+                    }
+                }
+            }
+        }
+
+        const size_t overfullRowCount = overfullRows.size();
+        std::sort(overfullRows.begin(),
+                  overfullRows.end(),
+                  [](OverfullRow const & a, OverfullRow const & b)
+                  {
+                      return a.m_density > b.m_density;
+                  });
+        if (overfullRows.size() > maxOverfullRows)
+        {
+            overfullRows.resize(maxOverfullRows);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            ++m_sampleCount;
+            m_sampledAlertDensity = alertDensity;
+            m_sampledRowCount = sampledRowCount;
+            m_overfullRowCount = overfullRowCount;
+            m_histogram = histogram;
+            m_overfullRows = overfullRows;
+        }
+
+        if (overfullRowCount > 0)
+        {
+            LogB(Logging::Warning,
+                 "RowDensityMonitor",
+                 "%zu of %zu shared rows exceed density %f. "
+                 "Consider rebuilding the TermTable.",
+                 overfullRowCount,
+                 sampledRowCount,
+                 alertDensity);
+        }
+    }
+
+
+    void RowDensityMonitor::Start(size_t intervalMilliseconds)
+    {
+        Stop();
+
+        std::lock_guard<std::mutex> lock(m_threadLock);
+        m_stopping = false;
+        m_thread = std::thread(&RowDensityMonitor::SamplerThreadEntryPoint,
+                               this,
+                               intervalMilliseconds);
+    }
+
+
+    void RowDensityMonitor::Stop()
+    {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(m_threadLock);
+            m_stopping = true;
+            thread = std::move(m_thread);
+        }
+        m_wakeup.notify_all();
+
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+
+    bool RowDensityMonitor::IsRunning() const
+    {
+        std::lock_guard<std::mutex> lock(m_threadLock);
+        return m_thread.joinable();
+    }
+
+
+    void RowDensityMonitor::SamplerThreadEntryPoint(size_t intervalMilliseconds)
+    {
+        std::unique_lock<std::mutex> lock(m_threadLock);
+        while (!m_stopping)
+        {
+            lock.unlock();
+            Sample();
+            lock.lock();
+
+            m_wakeup.wait_for(lock,
+                              std::chrono::milliseconds(intervalMilliseconds),
+                              [this]() { return m_stopping; });
+        }
+    }
+
+
+    size_t RowDensityMonitor::GetSampleCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_sampleCount;
+    }
+
+
+    std::vector<size_t> RowDensityMonitor::GetDensityHistogram() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_histogram;
+    }
+
+
+    std::vector<IRowDensityMonitor::OverfullRow>
+        RowDensityMonitor::GetOverfullRows() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_overfullRows;
+    }
+
+
+    void RowDensityMonitor::Print(std::ostream& out) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        out << "Row density monitor: "
+            << (IsRunning() ? "running" : "stopped")
+            << ", " << m_sampleCount << " samples." << std::endl
+            << "Sampling the " << m_sliceCount
+            << " most recent slices of each shard." << std::endl;
+
+        if (m_sampleCount == 0)
+        {
+            return;
+        }
+
+        out << "Shared row densities (" << m_sampledRowCount << " rows):"
+            << std::endl;
+        for (size_t bucket = 0; bucket < c_histogramBuckets; ++bucket)
+        {
+            if (m_histogram[bucket] == 0)
+            {
+                continue;
+            }
+            out << "  ["
+                << std::fixed << std::setprecision(2)
+                << static_cast<double>(bucket) / c_histogramBuckets
+                << ", "
+                << static_cast<double>(bucket + 1) / c_histogramBuckets
+                << "): " << m_histogram[bucket] << std::endl;
+        }
+        out.unsetf(std::ios_base::floatfield);
+
+        out << m_overfullRowCount << " shared rows above density "
+            << m_sampledAlertDensity << "." << std::endl;
+        for (auto const & row : m_overfullRows)
+        {
+            out << "  shard " << row.m_shard
+                << ", rank " << row.m_row.GetRank()
+                << ", row " << row.m_row.GetIndex()
+                << ": " << row.m_density << std::endl;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <array>                                // std::array member.
+#include <condition_variable>                   // std::condition_variable member.
+#include <mutex>                                // std::mutex member.
+#include <thread>                               // std::thread member.
+#include <vector>                               // std::vector member.
+
+#include "BitFunnel/Index/IRowDensityMonitor.h" // Base class.
+#include "BitFunnel/NonCopyable.h"              // Base class.
+
+
+namespace BitFunnel
+{
+    class IIngestor;
+    class ITermTableCollection;
+
+    //*************************************************************************
+    //
+    // RowDensityMonitor
+    //
+    // Implementation of IRowDensityMonitor that samples with
+    // IShard::GetRecentDensities(). Samples are serialized, so a Sample()
+    // call made while the background thread is sampling waits for it.
+    //
+    //*************************************************************************
+    class RowDensityMonitor : public IRowDensityMonitor, NonCopyable
+    {
+    public:
+        RowDensityMonitor(IIngestor const & ingestor,
+                          ITermTableCollection const & termTables);
+
+        ~RowDensityMonitor();
+
+        //
+        // IRowDensityMonitor methods.
+        //
+        virtual void Configure(size_t sliceCount,
+                               double alertDensity,
+                               size_t maxOverfullRows) override;
+        virtual void Sample() override;
+        virtual void Start(size_t intervalMilliseconds) override;
+        virtual void Stop() override;
+        virtual bool IsRunning() const override;
+        virtual size_t GetSampleCount() const override;
+        virtual std::vector<size_t> GetDensityHistogram() const override;
+        virtual std::vector<OverfullRow> GetOverfullRows() const override;
+        virtual void Print(std::ostream& out) const override;
+
+        static const size_t c_defaultSliceCount = 16;
+        static const size_t c_defaultMaxOverfullRows = 20;
+
+    private:
+        void SamplerThreadEntryPoint(size_t intervalMilliseconds);
+
+        IIngestor const & m_ingestor;
+        ITermTableCollection const & m_termTables;
+
+        // Serializes calls to Sample().
+        std::mutex m_sampleLock;
+
+        // Shared row flags, indexed by ShardId and Rank. Computed by the
+        // first sample since walking the TermTables is not free.
+        std::vector<std::array<std::vector<bool>, c_maxRankValue + 1>>
+            m_sharedRows;
+
+        // Protects the configuration and the results of the latest sample.
+        mutable std::mutex m_lock;
+        size_t m_sliceCount;
+        double m_alertDensity;
+        size_t m_maxOverfullRows;
+        size_t m_sampleCount;
+        double m_sampledAlertDensity;
+        size_t m_sampledRowCount;
+        size_t m_overfullRowCount;
+        std::vector<size_t> m_histogram;
+        std::vector<OverfullRow> m_overfullRows;
+
+        // Background sampler.
+        std::thread m_thread;
+        mutable std::mutex m_threadLock;
+        std::condition_variable m_wakeup;
+        bool m_stopping;
+    };
+}
@@ -21,8 +21,13 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <ostream>
 #include <stack>
+#include <unordered_map>
+#include <utility>
 
 #include "BitFunnel/Configuration/Factories.h"
 #include "BitFunnel/Configuration/IFileSystem.h"
@@ -35,7 +40,12 @@
 #include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/ISimpleIndex.h"
 #include "BitFunnel/Index/RowIdSequence.h"
+#include "BitFunnel/Index/ITermTable.h"
 #include "BitFunnel/Index/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
+#include "BitStatistics.h"
 #include "CsvTsv/Csv.h"
 #include "DocumentHandleInternal.h"
 #include "LoggerInterfaces/Check.h"
@@ -49,23 +59,167 @@
 namespace BitFunnel
 {
     void Factories::AnalyzeRowTables(ISimpleIndex const & index,
-                                     char const * outDir)
+                                     char const * outDir,
+                                     size_t threadCount)
     {
         CHECK_NE(*outDir, '\0')
             << "Output directory not set. ";
 
-        RowTableAnalyzer statistics(index);
+        RowTableAnalyzer statistics(index, threadCount);
         statistics.AnalyzeColumns(outDir);
         statistics.AnalyzeRows(outDir);
     }
 
 
-    RowTableAnalyzer::RowTableAnalyzer(ISimpleIndex const & index)
-        : m_index(index)
+    RowTableAnalyzer::RowTableAnalyzer(ISimpleIndex const & index,
+                                       size_t threadCount)
+        : m_index(index),
+          m_threadCount(threadCount)
     {
+        CHECK_GT(threadCount, 0u)
+            << "RowTableAnalyzer: threadCount must be at least 1.";
     }
 
 
+    // Runs taskCount tasks on one thread per processor.
+    static void RunTasks(
+        std::vector<std::unique_ptr<ITaskProcessor>> const & processors,
+        size_t taskCount)
+    {
+        auto distributor =
+            Factories::CreateTaskDistributor(processors, taskCount);
+        distributor->WaitForCompletion();
+    }
+
+
+    //*************************************************************************
+    //
+    // RowDensityProcessor
+    //
+    // Counts set bits in every row of one slice per task. Only bits of
+    // documents marked in the document active row are counted.
+    //
+    // Each processor accumulates its own counts. The caller sums them once
+    // all tasks are done.
+    //
+    //*************************************************************************
+    class RowDensityProcessor : public ITaskProcessor
+    {
+    public:
+        // Location of the rows of one shard within each of its slice buffers.
+        struct ShardLayout
+        {
+            size_t m_quadwordCount;
+            ptrdiff_t m_activeRowOffset;
+            std::array<std::vector<ptrdiff_t>, c_maxRankValue + 1> m_rowOffsets;
+        };
+
+        struct SliceTask
+        {
+            ShardId m_shard;
+            char const * m_buffer;
+        };
+
+        struct Counts
+        {
+            uint64_t m_activeBits;
+            std::array<std::vector<uint64_t>, c_maxRankValue + 1> m_setBits;
+        };
+
+        RowDensityProcessor(std::vector<ShardLayout> const & layouts,
+                            std::vector<SliceTask> const & tasks)
+          : m_layouts(layouts),
+            m_tasks(tasks),
+            m_counts(layouts.size())
+        {
+            for (size_t shard = 0; shard < layouts.size(); ++shard)
+            {
+                m_counts[shard].m_activeBits = 0;
+                for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+                {
+                    m_counts[shard].m_setBits[rank].resize(
+                        layouts[shard].m_rowOffsets[rank].size(), 0);
+                }
+            }
+        }
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            SliceTask const & task = m_tasks[taskId];
+            ShardLayout const & layout = m_layouts[task.m_shard];
+            Counts & counts = m_counts[task.m_shard];
+
+            uint64_t const * active = reinterpret_cast<uint64_t const *>(
+                task.m_buffer + layout.m_activeRowOffset);
+            counts.m_activeBits +=
+                BitStatistics::PopCount(active, layout.m_quadwordCount);
+
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                auto const & offsets = layout.m_rowOffsets[rank];
+                auto & setBits = counts.m_setBits[rank];
+                for (size_t row = 0; row < offsets.size(); ++row)
+                {
+                    uint64_t const * data = reinterpret_cast<uint64_t const *>(
+                        task.m_buffer + offsets[row]);
+                    setBits[row] +=
+                        BitStatistics::PopCountMasked(data,
+                                                      rank,
+                                                      active,
+                                                      layout.m_quadwordCount);
+                }
+            }
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+        std::vector<Counts> const & GetCounts() const
+        {
+            return m_counts;
+        }
+
+    private:
+        std::vector<ShardLayout> const & m_layouts;
+        std::vector<SliceTask> const & m_tasks;
+        std::vector<Counts> m_counts;
+    };
+
+
+    //*************************************************************************
+    //
+    // ColumnProcessor
+    //
+    // Counts the bits set in each column for the cached documents in one
+    // slice per task. Every column is written by exactly one task, so no
+    // partial results need to be combined.
+    //
+    //*************************************************************************
+    class ColumnProcessor : public ITaskProcessor
+    {
+    public:
+        typedef std::function<void(size_t)> Callback;
+
+        ColumnProcessor(Callback const & processSlice)
+          : m_processSlice(processSlice)
+        {
+        }
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            m_processSlice(taskId);
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+    private:
+        Callback m_processSlice;
+    };
+
+
     //*************************************************************************
     //
     // Analyze rows
@@ -83,11 +237,10 @@ namespace BitFunnel
         // TODO: Create with factory?
         TermToText termToText(*fileManager.TermToText().OpenForRead());
 
+        auto densities = GetRowDensities();
+
         for (ShardId shardId = 0; shardId < ingestor.GetShardCount(); ++shardId)
         {
-            auto terms(Factories::CreateDocumentFrequencyTable(
-                *fileManager.DocFreqTable(shardId).OpenForRead()));
-
             auto fileSystem = Factories::CreateFileSystem();
             auto outFileManager =
                 Factories::CreateFileManager(outDir,
@@ -96,14 +249,107 @@ namespace BitFunnel
                                              *fileSystem);
 
             AnalyzeRowsInOneShard(shardId,
+                                  densities[shardId],
                                   termToText,
                                   *outFileManager->RowDensities(shardId).OpenForWrite());
         }
     }
 
 
+    std::vector<RowTableAnalyzer::RankDensities>
+        RowTableAnalyzer::GetRowDensities() const
+    {
+        auto & ingestor = m_index.GetIngestor();
+
+        // Hold a token to ensure that the slice buffers won't be recycled
+        // while they are being read.
+        auto token = ingestor.GetTokenManager().RequestToken();
+
+        std::vector<RowDensityProcessor::ShardLayout> layouts;
+        std::vector<RowDensityProcessor::SliceTask> tasks;
+        for (ShardId shardId = 0; shardId < ingestor.GetShardCount(); ++shardId)
+        {
+            IShard const & shard = ingestor.GetShard(shardId);
+            ITermTable const & termTable = m_index.GetTermTable(shardId);
+
+            RowDensityProcessor::ShardLayout layout;
+            layout.m_quadwordCount = shard.GetSliceCapacity() / 64;
+            layout.m_activeRowOffset = shard.GetRowOffset(
+                *RowIdSequence(termTable.GetDocumentActiveTerm(),
+                               termTable).begin());
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                const size_t rowCount = termTable.GetTotalRowCount(rank);
+                for (RowIndex row = 0; row < rowCount; ++row)
+                {
+                    layout.m_rowOffsets[rank].push_back(
+                        shard.GetRowOffset(RowId(rank, row)));
+                }
+            }
+            layouts.push_back(layout);
+
+            // GetSliceBuffers() can change at any time, but no buffer
+            // observed while holding the token can be recycled.
+            std::vector<void*> const & buffers = shard.GetSliceBuffers();
+            for (auto buffer : buffers)
+            {
+                tasks.push_back({ shardId, static_cast<char const *>(buffer) });
+            }
+        }
+
+        std::vector<std::unique_ptr<ITaskProcessor>> processors;
+        const size_t processorCount =
+            (std::max)(size_t(1), (std::min)(m_threadCount, tasks.size()));
+        for (size_t i = 0; i < processorCount; ++i)
+        {
+            processors.push_back(
+                std::unique_ptr<ITaskProcessor>(
+                    new RowDensityProcessor(layouts, tasks)));
+        }
+        RunTasks(processors, tasks.size());
+
+        std::vector<RankDensities> densities(layouts.size());
+        for (ShardId shardId = 0; shardId < layouts.size(); ++shardId)
+        {
+            uint64_t activeBits = 0;
+            for (auto const & processor : processors)
+            {
+                activeBits += static_cast<RowDensityProcessor const &>(*processor)
+                    .GetCounts()[shardId].m_activeBits;
+            }
+
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                const size_t rowCount = layouts[shardId].m_rowOffsets[rank].size();
+                std::vector<uint64_t> setBits(rowCount, 0);
+                for (auto const & processor : processors)
+                {
+                    auto const & partial =
+                        static_cast<RowDensityProcessor const &>(*processor)
+                        .GetCounts()[shardId].m_setBits[rank];
+                    for (size_t row = 0; row < rowCount; ++row)
+                    {
+                        setBits[row] += partial[row];
+                    }
+                }
+
+                for (size_t row = 0; row < rowCount; ++row)
+                {
+                    densities[shardId][rank].push_back(
+                        (activeBits == 0) ?
+                        0.0 :
+                        static_cast<double>(setBits[row]) / activeBits);
+                }
+            }
+        }
+
+        return densities;
+    }
+
+
     void RowTableAnalyzer::AnalyzeRowsInOneShard(
         ShardId const & shardId,
+        RankDensities const & densities,
         ITermToText const & termToText,
         std::ostream& out) const
     {
@@ -111,21 +357,13 @@ namespace BitFunnel
         auto terms(Factories::CreateDocumentFrequencyTable(
             *fileManager.DocFreqTable(shardId).OpenForRead()));
 
-        std::array<std::vector<double>, c_maxRankValue> densities;
-
-        for (Rank rank = 0; rank < c_maxRankValue; ++rank)
-        {
-            auto & shard = m_index.GetIngestor().GetShard(shardId);
-            densities[rank] = shard.GetDensities(rank);
-        }
-
         // Use CsvTableFormatter to escape terms that contain commas and quotes.
         CsvTsv::CsvTableFormatter formatter(out);
 
         for (auto dfEntry : *terms)
         {
             Term term = dfEntry.GetTerm();
-            RowIdSequence rows(term, m_index.GetTermTable0());
+            RowIdSequence rows(term, m_index.GetTermTable(shardId));
 
             formatter.WriteField(termToText.Lookup(term.GetRawHash()));
             formatter.WriteField(dfEntry.GetFrequency());
@@ -163,42 +401,86 @@ namespace BitFunnel
 
         std::vector<Column> columns;
 
+        // For each slice holding cached documents, the (DocIndex, column)
+        // pairs of those documents.
+        std::vector<Slice const *> slices;
+        std::vector<std::vector<std::pair<DocIndex, size_t>>> sliceColumns;
+        std::unordered_map<Slice const *, size_t> sliceIds;
+
         for (auto doc : cache)
         {
             const DocumentHandleInternal
                 handle(ingestor.GetHandle(doc.second));
 
             Slice const & slice = handle.GetSlice();
-            const ShardId shard = slice.GetShard().GetId();
-
             columns.emplace_back(doc.second,
-                                 shard,
+                                 slice.GetShard().GetId(),
                                  doc.first.GetPostingCount());
 
-            void const * buffer = slice.GetSliceBuffer();
-            const DocIndex column = handle.GetIndex();
+            auto it = sliceIds.find(&slice);
+            if (it == sliceIds.end())
+            {
+                it = sliceIds.insert(std::make_pair(&slice, slices.size())).first;
+                slices.push_back(&slice);
+                sliceColumns.emplace_back();
+            }
+            sliceColumns[it->second].push_back(
+                std::make_pair(handle.GetIndex(), columns.size() - 1));
+        }
+
+        auto processSlice = [&](size_t sliceId)
+        {
+            Slice const & slice = *slices[sliceId];
+            char const * buffer = static_cast<char const *>(slice.GetSliceBuffer());
+
+            // Visit the documents in column order so that those sharing a
+            // rank 0 quadword are counted together.
+            auto & docs = sliceColumns[sliceId];
+            std::sort(docs.begin(), docs.end());
 
             for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
             {
-                RowTableDescriptor rowTable = slice.GetRowTable(rank);
-
-                size_t bitCount = 0;
+                RowTableDescriptor const & rowTable = slice.GetRowTable(rank);
                 const size_t rowCount = rowTable.GetRowCount();
+
+                std::vector<uint64_t const *> rows;
                 for (RowIndex row = 0; row < rowCount; ++row)
                 {
-                    if (rowTable.GetBit(buffer, row, column) != 0)
-                    {
-                        ++bitCount;
-                    }
+                    rows.push_back(reinterpret_cast<uint64_t const *>(
+                        buffer + rowTable.GetRowOffset(row)));
                 }
 
-                columns.back().SetCount(rank, bitCount);
+                size_t i = 0;
+                while (i < docs.size())
+                {
+                    const size_t quadword = docs[i].first / 64;
+                    uint32_t counts[64] = {};
+                    BitStatistics::AddColumnCounts(rows, rank, quadword, counts);
+
+                    for (; i < docs.size() && docs[i].first / 64 == quadword; ++i)
+                    {
+                        Column & column = columns[docs[i].second];
+                        const size_t bitCount = counts[docs[i].first % 64];
+                        column.SetCount(rank, bitCount);
 
-                double density =
-                    (rowCount == 0) ? 0.0 : static_cast<double>(bitCount) / rowCount;
-                columns.back().SetDensity(rank, density);
+                        double density =
+                            (rowCount == 0) ? 0.0 : static_cast<double>(bitCount) / rowCount;
+                        column.SetDensity(rank, density);
+                    }
+                }
             }
+        };
+
+        std::vector<std::unique_ptr<ITaskProcessor>> processors;
+        const size_t processorCount =
+            (std::max)(size_t(1), (std::min)(m_threadCount, slices.size()));
+        for (size_t i = 0; i < processorCount; ++i)
+        {
+            processors.push_back(
+                std::unique_ptr<ITaskProcessor>(
+                    new ColumnProcessor(processSlice)));
         }
+        RunTasks(processors, slices.size());
 
         auto fileSystem = Factories::CreateFileSystem();
         auto outFileManager =
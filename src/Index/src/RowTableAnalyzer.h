@@ -36,17 +36,36 @@ namespace BitFunnel
     class ISimpleIndex;
     class ITermToText;
 
+    //*************************************************************************
+    //
+    // RowTableAnalyzer
+    //
+    // Writes row and column density reports for an ISimpleIndex. Both are
+    // computed slice by slice with the BitStatistics kernels, spread across
+    // threadCount threads. Each thread accumulates partial results that are
+    // combined once all of its tasks are done.
+    //
+    //*************************************************************************
     class RowTableAnalyzer
     {
     public:
-        RowTableAnalyzer(ISimpleIndex const & index);
+        RowTableAnalyzer(ISimpleIndex const & index, size_t threadCount);
 
         void AnalyzeRows(char const * outDir) const;
         void AnalyzeColumns(char const * outDir) const;
 
+        // Row densities, indexed by rank and then by RowIndex.
+        typedef std::array<std::vector<double>, c_maxRankValue + 1>
+            RankDensities;
+
+        // Returns the density of every row in every shard, measured over the
+        // active documents. Indexed by ShardId.
+        std::vector<RankDensities> GetRowDensities() const;
+
     private:
         void AnalyzeRowsInOneShard(
             ShardId const & shardId,
+            RankDensities const & densities,
             ITermToText const & termToText,
             std::ostream& out) const;
 
@@ -70,5 +89,6 @@ namespace BitFunnel
         };
 
         ISimpleIndex const & m_index;
+        const size_t m_threadCount;
     };
 }
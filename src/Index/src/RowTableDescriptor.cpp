@@ -46,7 +46,8 @@ namespace BitFunnel
           m_rank(rank),
           m_maxRank(maxRank),
           m_bufferOffset(rowTableBufferOffset),
-          m_bytesPerRow(Row::BytesInRow(capacity, rank, maxRank))
+          m_bytesPerRow(Row::BytesInRow(capacity, rank, maxRank)),
+          m_bytesPerSummary(BytesInSummary(capacity, rank, maxRank))
     {
         // Make sure capacity is properly rounded already.
         // TODO: fix.
@@ -65,7 +66,8 @@ namespace BitFunnel
           m_rank(other.m_rank),
           m_maxRank(other.m_maxRank),
           m_bufferOffset(other.m_bufferOffset),
-          m_bytesPerRow(other.m_bytesPerRow)
+          m_bytesPerRow(other.m_bytesPerRow),
+          m_bytesPerSummary(other.m_bytesPerSummary)
     {
     }
 
@@ -105,6 +107,13 @@ namespace BitFunnel
             // Fill up the match-all row with all ones.
             uint64_t * rowData = GetRowData(sliceBuffer, row.GetIndex());
             memset(rowData, 0xFF, m_bytesPerRow);
+
+            if (HasSummaries())
+            {
+                char* summary = reinterpret_cast<char*>(sliceBuffer) +
+                    GetSummaryOffset(row.GetIndex());
+                memset(summary, 0xFF, m_bytesPerSummary);
+            }
         }
     }
 
@@ -154,6 +163,11 @@ namespace BitFunnel
         // uint64_t newVal = *(row + offset) | bitMask;
         // *(row + offset) = newVal;
 #endif
+
+        if (HasSummaries())
+        {
+            SetSummaryBit(sliceBuffer, rowIndex, docIndex);
+        }
     }
 
 
@@ -184,6 +198,22 @@ namespace BitFunnel
     }
 
 
+    bool RowTableDescriptor::HasSummaries() const
+    {
+        return m_bytesPerSummary > 0;
+    }
+
+
+    ptrdiff_t RowTableDescriptor::GetSummaryOffset(RowIndex rowIndex) const
+    {
+        LogAssertB(HasSummaries(), "RowTable has no summaries.");
+
+        // Summaries follow the last row.
+        return GetRowOffset(m_rowCount) +
+            static_cast<ptrdiff_t>(rowIndex * m_bytesPerSummary);
+    }
+
+
     /* static */
     size_t RowTableDescriptor::GetBufferSize(DocIndex capacity,
                                              RowIndex rowCount,
@@ -196,7 +226,54 @@ namespace BitFunnel
         //            "capacity not evenly rounded.");
 
         return static_cast<unsigned>(
-            Row::BytesInRow(capacity, rank, maxRank) * rowCount);
+            (Row::BytesInRow(capacity, rank, maxRank) +
+             BytesInSummary(capacity, rank, maxRank)) * rowCount);
+    }
+
+
+    /* static */
+    size_t RowTableDescriptor::BytesInSummary(DocIndex capacity,
+                                              Rank rank,
+                                              Rank maxRank)
+    {
+        // Only rank 0 rows are summarized. Higher rank rows already act as
+        // coarse summaries of the rank 0 rows below them.
+        if (rank != 0)
+        {
+            return 0;
+        }
+
+        // Round up to whole quadwords so that the matcher can scan summaries
+        // with quadword loads.
+        const size_t bits =
+            (Row::DocumentsInRank0Row(capacity, maxRank) + c_docsPerSummaryBit - 1)
+            / c_docsPerSummaryBit;
+        return (bits + 63) / 64 * sizeof(uint64_t);
+    }
+
+
+    void RowTableDescriptor::SetSummaryBit(void* sliceBuffer,
+                                           RowIndex rowIndex,
+                                           DocIndex docIndex) const
+    {
+        uint64_t* const summary = reinterpret_cast<uint64_t*>(
+            reinterpret_cast<char*>(sliceBuffer) + GetSummaryOffset(rowIndex));
+        const size_t block = docIndex / c_docsPerSummaryBit;
+        const size_t offset = block >> 6;
+        uint64_t bitPos = block & 0x3F;
+
+        // Most postings land in blocks that are already marked, so check
+        // before paying for the interlocked operation.
+        if ((summary[offset] & (1ull << bitPos)) != 0)
+        {
+            return;
+        }
+
+#ifdef _MSC_VER
+        _interlockedbittestandset64(reinterpret_cast<long long *>(summary + offset), bitPos);
+#else
+        asm("lock btsq %1, %0" : "+m" (*(summary + offset)) : "r" (bitPos));
+#endif
     }
 
 
@@ -45,6 +45,14 @@ namespace BitFunnel
     // All methods except Initialize are thread safe. Initialize method is not
     // thread-safe with respect to calling *Bit methods at the same time.
     //
+    // The rank 0 RowTable also keeps a summary bitmap for each row, placed
+    // after the rows themselves. Each summary bit covers c_docsPerSummaryBit
+    // documents (one cache line of the row) and is set if any of those
+    // documents might have their bit set. The matcher uses summaries to skip
+    // iterations where a required row is empty. SetBit() maintains the
+    // summary. ClearBit() leaves it alone, so a summary bit may be set for a
+    // block that no longer has any bits set.
+    //
     //*************************************************************************
     class RowTableDescriptor
     {
@@ -94,6 +102,14 @@ namespace BitFunnel
         // start of the sliceBuffer.
         ptrdiff_t GetRowOffset(RowIndex rowIndex) const;
 
+        // Returns true if this RowTable maintains summary bitmaps.
+        bool HasSummaries() const;
+
+        // Returns the offset of the summary bitmap for the row with the given
+        // index, relative to the start of the sliceBuffer. Only valid when
+        // HasSummaries() is true.
+        ptrdiff_t GetSummaryOffset(RowIndex rowIndex) const;
+
         // Returns true if the given RowTableDescriptor is data-compatible with
         // this instance. Used when loading Slices from the stream.
         bool IsCompatibleWith(RowTableDescriptor const & other) const;
@@ -106,6 +122,16 @@ namespace BitFunnel
                                     Rank rank,
                                     Rank maxRank);
 
+        // Returns the byte size of the summary bitmap for one row. Returns 0
+        // for ranks that do not maintain summaries.
+        static size_t BytesInSummary(DocIndex capacity,
+                                     Rank rank,
+                                     Rank maxRank);
+
+        // Number of documents covered by one bit of a summary bitmap. This is
+        // one cache line of a rank 0 row.
+        static const size_t c_docsPerSummaryBit = c_bytesPerCacheLine * 8;
+
         // RocTable buffers are placed such that it is aligned with this 
         // byte alignment. For performance reasons it is advantageous that
         // it is placed either at quadword or at cacheline boundaries.
@@ -123,6 +149,11 @@ namespace BitFunnel
         uint64_t const * GetRowData(void const * sliceBuffer,
                                     RowIndex rowIndex) const;
 
+        // Marks the block containing docIndex in the row's summary bitmap.
+        void SetSummaryBit(void* sliceBuffer,
+                           RowIndex rowIndex,
+                           DocIndex docIndex) const;
+
         // Returns the QWORD number for the given DocIndex.
         size_t QwordPositionFromDocIndex(DocIndex docIndex) const;
 
@@ -140,5 +171,9 @@ namespace BitFunnel
 
         // Cached value of the number of bytes per single row.
         const size_t m_bytesPerRow;
+
+        // Cached value of the number of bytes per summary bitmap. Zero when
+        // this RowTable has no summaries.
+        const size_t m_bytesPerSummary;
     };
 }
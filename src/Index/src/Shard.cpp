@@ -20,6 +20,10 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+#include <limits>
+#include <map>
+
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/IRecycler.h"
 #include "BitFunnel/Index/ISliceBufferAllocator.h"
@@ -28,6 +32,7 @@
 #include "BitFunnel/Index/RowIdSequence.h"
 #include "BitFunnel/Index/Token.h"
 #include "BitFunnel/Term.h"
+#include "BitStatistics.h"
 #include "IRecyclable.h"
 #include "LoggerInterfaces/Check.h"
 #include "LoggerInterfaces/Logging.h"
@@ -83,6 +88,8 @@ namespace BitFunnel
           m_sliceBufferAllocator(sliceBufferAllocator),
           m_documentActiveRowId(RowIdForActiveDocument(termTable)),
           m_activeSlice(nullptr),
+          m_isGroupOpen(false),
+          m_currentGroupId(0),
           m_sliceBuffers(new std::vector<void*>()),
           m_sliceCapacity(GetCapacityForByteSize(sliceBufferSize,
                                                  docDataSchema,
@@ -140,6 +147,11 @@ namespace BitFunnel
         m_sliceBuffers = newSlices;
         m_activeSlice = newSlice;
 
+        if (m_isGroupOpen)
+        {
+            m_sliceGroups[newSlice] = m_currentGroupId;
+        }
+
         // TODO: think if this can be done outside of the lock.
         std::unique_ptr<IRecyclable>
             recyclableSliceList(new DeferredSliceListDelete(nullptr,
@@ -193,6 +205,24 @@ namespace BitFunnel
     }
 
 
+    bool Shard::HasSummary(RowId rowId) const
+    {
+        return GetRowTable(rowId.GetRank()).HasSummaries();
+    }
+
+
+    ptrdiff_t Shard::GetSummaryOffset(RowId rowId) const
+    {
+        return GetRowTable(rowId.GetRank()).GetSummaryOffset(rowId.GetIndex());
+    }
+
+
+    size_t Shard::GetDocumentsPerSummaryBit() const
+    {
+        return RowTableDescriptor::c_docsPerSummaryBit;
+    }
+
+
     RowTableDescriptor const & Shard::GetRowTable(Rank rank) const
     {
         return m_rowTables.at(rank);
@@ -326,6 +356,7 @@ namespace BitFunnel
 
             oldSlices = m_sliceBuffers.load();
             m_sliceBuffers = newSlices;
+            m_sliceGroups.erase(&slice);
 
             if (m_activeSlice == &slice)
             {
@@ -346,6 +377,368 @@ namespace BitFunnel
     }
 
 
+    void Shard::OpenGroup(GroupId groupId)
+    {
+        Slice* expiredSlice = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+            expiredSlice = SealActiveSlice();
+            m_isGroupOpen = true;
+            m_currentGroupId = groupId;
+        }
+
+        if (expiredSlice != nullptr)
+        {
+            Slice::DecrementRefCount(expiredSlice);
+        }
+    }
+
+
+    void Shard::CloseGroup()
+    {
+        Slice* expiredSlice = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+            expiredSlice = SealActiveSlice();
+            m_isGroupOpen = false;
+        }
+
+        if (expiredSlice != nullptr)
+        {
+            Slice::DecrementRefCount(expiredSlice);
+        }
+    }
+
+
+    bool Shard::IsGroupIngesting(GroupId groupId) const
+    {
+        std::lock_guard<std::mutex> lock(m_slicesLock);
+        for (auto const & entry : m_sliceGroups)
+        {
+            if (entry.second == groupId && !entry.first->IsClosed())
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    size_t Shard::ExpireGroup(GroupId groupId,
+                              std::vector<DocumentHandleInternal>& expired)
+    {
+        std::vector<Slice*> slices;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+            for (auto const & entry : m_sliceGroups)
+            {
+                if (entry.second == groupId)
+                {
+                    slices.push_back(const_cast<Slice*>(entry.first));
+                }
+            }
+        }
+
+        RowTableDescriptor const & rowTable =
+            GetRowTable(m_documentActiveRowId.GetRank());
+        const RowIndex row = m_documentActiveRowId.GetIndex();
+
+        for (auto slice : slices)
+        {
+            void* buffer = slice->GetSliceBuffer();
+            for (DocIndex index = 0; index < m_sliceCapacity; ++index)
+            {
+                if (rowTable.GetBit(buffer, row, index) != 0)
+                {
+                    rowTable.ClearBit(buffer, row, index);
+                    expired.push_back(DocumentHandleInternal(slice, index));
+                }
+            }
+
+            if (slice->ExpireAllDocuments())
+            {
+                // RecycleSlice() takes m_slicesLock, so the reference is
+                // released outside of the lock.
+                Slice::DecrementRefCount(slice);
+            }
+        }
+
+        return slices.size();
+    }
+
+
+    void Shard::SelectMerges(double minLiveRatio,
+                             std::vector<std::unique_ptr<PendingMerge>>& merges)
+    {
+        // Candidates are bucketed by group, since a merged Slice may only
+        // hold documents from a single group. The key's first member is
+        // false for Slices which belong to no group.
+        typedef std::pair<bool, GroupId> GroupKey;
+        std::map<GroupKey, std::vector<std::pair<Slice*, DocIndex>>> candidates;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+            for (auto buffer : *m_sliceBuffers.load())
+            {
+                Slice* slice = Slice::GetSliceFromBuffer(buffer, GetSlicePtrOffset());
+                if (slice == m_activeSlice || !slice->IsClosed())
+                {
+                    continue;
+                }
+
+                const DocIndex liveCount = slice->GetLiveDocumentCount();
+                if (liveCount >= minLiveRatio * m_sliceCapacity)
+                {
+                    continue;
+                }
+
+                auto it = m_sliceGroups.find(slice);
+                const GroupKey key = (it == m_sliceGroups.end())
+                    ? GroupKey(false, 0)
+                    : GroupKey(true, it->second);
+                candidates[key].push_back(std::make_pair(slice, liveCount));
+            }
+        }
+
+        for (auto const & entry : candidates)
+        {
+            // Pack candidates into merged Slices in list order. Merging a
+            // single Slice would not reduce the number of Slices.
+            std::unique_ptr<PendingMerge> merge(new PendingMerge());
+            DocIndex liveCount = 0;
+            for (size_t i = 0; i <= entry.second.size(); ++i)
+            {
+                if (i == entry.second.size()
+                    || liveCount + entry.second[i].second > m_sliceCapacity)
+                {
+                    if (merge->m_sources.size() > 1)
+                    {
+                        merges.push_back(std::move(merge));
+                    }
+                    merge.reset(new PendingMerge());
+                    liveCount = 0;
+                }
+
+                if (i < entry.second.size())
+                {
+                    Slice* source = entry.second[i].first;
+                    merge->m_sources.push_back(source);
+                    merge->m_rewriteCounts.push_back(source->GetRewriteCount());
+                    liveCount += entry.second[i].second;
+                }
+            }
+        }
+    }
+
+
+    void Shard::BuildMerge(PendingMerge& merge)
+    {
+        // The new Slice is private to this thread until CommitMerge() swaps
+        // it into m_sliceBuffers, so its bits can be written without
+        // affecting queries.
+        merge.m_merged = new Slice(*this);
+        void* mergedBuffer = merge.m_merged->GetSliceBuffer();
+
+        RowTableDescriptor const & activeRowTable =
+            m_rowTables[m_documentActiveRowId.GetRank()];
+        const RowIndex activeRow = m_documentActiveRowId.GetIndex();
+
+        for (auto source : merge.m_sources)
+        {
+            void* sourceBuffer = source->GetSliceBuffer();
+            for (DocIndex index = 0; index < m_sliceCapacity; ++index)
+            {
+                if (activeRowTable.GetBit(sourceBuffer, activeRow, index) == 0)
+                {
+                    continue;
+                }
+
+                DocIndex mergedIndex;
+                LogAssertB(merge.m_merged->TryAllocateDocument(mergedIndex),
+                           "Merged slice has no space.");
+
+                // Rows of higher rank are shared between neighbouring
+                // columns, so a copied bit may belong to a neighbour. This
+                // can only introduce false positives.
+                for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+                {
+                    RowTableDescriptor const & rowTable = m_rowTables[rank];
+                    for (RowIndex row = 0; row < rowTable.GetRowCount(); ++row)
+                    {
+                        if (rowTable.GetBit(sourceBuffer, row, index) != 0)
+                        {
+                            rowTable.SetBit(mergedBuffer, row, mergedIndex);
+                        }
+                    }
+                }
+
+                merge.m_merged->CommitDocument();
+                merge.m_columns.push_back(
+                    PendingMerge::Column(source, index, mergedIndex));
+            }
+        }
+
+        // The merged Slice never becomes the active Slice, so its remaining
+        // capacity is abandoned.
+        merge.m_merged->Seal();
+    }
+
+
+    size_t Shard::CommitMerge(PendingMerge& merge,
+                              std::vector<DocumentHandleInternal>& moved)
+    {
+        Slice* const merged = merge.m_merged;
+        void* const mergedBuffer = merged->GetSliceBuffer();
+        std::vector<Slice*> const & sources = merge.m_sources;
+
+        // A source rewritten by Update() since SelectMerges() may have been
+        // copied part way through the rewrite.
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            if (sources[i]->GetRewriteCount() != merge.m_rewriteCounts[i])
+            {
+                return 0;
+            }
+        }
+
+        std::vector<void*>* oldSlices = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_slicesLock);
+
+            // A source which was recycled since SelectMerges(), because its
+            // group expired or its last document was deleted, is no longer
+            // in m_sliceBuffers.
+            for (auto source : sources)
+            {
+                if (std::find(m_sliceBuffers.load()->begin(),
+                              m_sliceBuffers.load()->end(),
+                              source->GetSliceBuffer()) == m_sliceBuffers.load()->end())
+                {
+                    return 0;
+                }
+            }
+
+            // Documents deleted since BuildMerge() copied them must not be
+            // resurrected. The DocTable entries are copied here rather than
+            // in BuildMerge(), because Update() releases the variable size
+            // blobs of the columns it rewrites.
+            RowTableDescriptor const & activeRowTable =
+                m_rowTables[m_documentActiveRowId.GetRank()];
+            const RowIndex activeRow = m_documentActiveRowId.GetIndex();
+            for (auto const & column : merge.m_columns)
+            {
+                if (activeRowTable.GetBit(column.m_source->GetSliceBuffer(),
+                                          activeRow,
+                                          column.m_sourceIndex) == 0)
+                {
+                    activeRowTable.ClearBit(mergedBuffer, activeRow, column.m_mergedIndex);
+                    merged->ExpireDocument();
+                    continue;
+                }
+
+                m_docTable->CopyItem(mergedBuffer,
+                                     column.m_mergedIndex,
+                                     column.m_source->GetSliceBuffer(),
+                                     column.m_sourceIndex);
+                moved.push_back(DocumentHandleInternal(merged, column.m_mergedIndex));
+            }
+
+            // The merged Slice takes the place of the first source so that
+            // m_sliceBuffers stays ordered by age.
+            std::vector<void*>* const newSlices = new std::vector<void*>();
+            newSlices->reserve(m_sliceBuffers.load()->size() - sources.size() + 1);
+            for (auto buffer : *m_sliceBuffers.load())
+            {
+                if (buffer == sources.front()->GetSliceBuffer())
+                {
+                    newSlices->push_back(mergedBuffer);
+                }
+                else if (std::find_if(sources.begin(),
+                                      sources.end(),
+                                      [buffer](Slice* slice)
+                                      {
+                                          return slice->GetSliceBuffer() == buffer;
+                                      }) == sources.end())
+                {
+                    newSlices->push_back(buffer);
+                }
+            }
+
+            oldSlices = m_sliceBuffers.load();
+            m_sliceBuffers = newSlices;
+            merge.m_merged = nullptr;
+
+            auto it = m_sliceGroups.find(sources.front());
+            if (it != m_sliceGroups.end())
+            {
+                m_sliceGroups[merged] = it->second;
+            }
+            for (auto source : sources)
+            {
+                m_sliceGroups.erase(source);
+            }
+        }
+
+        // Queries which obtained the old list still see the source Slices
+        // unchanged, so they are expired and recycled without clearing their
+        // document active bits.
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            sources[i]->ExpireAllDocuments();
+
+            std::unique_ptr<IRecyclable>
+                recyclableSlice(new DeferredSliceListDelete(sources[i],
+                                                            i == 0 ? oldSlices : nullptr,
+                                                            m_tokenManager));
+            m_recycler.ScheduleRecyling(recyclableSlice);
+        }
+
+        return sources.size();
+    }
+
+
+    //*************************************************************************
+    //
+    // Shard::PendingMerge
+    //
+    //*************************************************************************
+    Shard::PendingMerge::PendingMerge()
+      : m_merged(nullptr)
+    {
+    }
+
+
+    Shard::PendingMerge::~PendingMerge()
+    {
+        // A merged Slice which was never swapped in is private, so it can be
+        // deleted without waiting for queries.
+        delete m_merged;
+    }
+
+
+    Shard::PendingMerge::Column::Column(Slice* source,
+                                        DocIndex sourceIndex,
+                                        DocIndex mergedIndex)
+      : m_source(source),
+        m_sourceIndex(sourceIndex),
+        m_mergedIndex(mergedIndex)
+    {
+    }
+
+
+    Slice* Shard::SealActiveSlice()
+    {
+        Slice* slice = m_activeSlice;
+        m_activeSlice = nullptr;
+
+        if (slice != nullptr && slice->Seal())
+        {
+            return slice;
+        }
+        return nullptr;
+    }
+
+
     void Shard::ReleaseSliceBuffer(void* sliceBuffer)
     {
         m_sliceBufferAllocator.Release(sliceBuffer);
@@ -373,6 +766,37 @@ namespace BitFunnel
     }
 
 
+    void Shard::ClearDocument(DocIndex index, void* sliceBuffer)
+    {
+        // Tells CommitMerge() that a copy of this Slice may be stale.
+        Slice::GetSliceFromBuffer(sliceBuffer, GetSlicePtrOffset())->IncrementRewriteCount();
+
+        RowTableDescriptor const & rowTable = m_rowTables[0];
+        rowTable.ClearBit(sliceBuffer, m_documentActiveRowId.GetIndex(), index);
+
+        // GetRowCount() stands for no match-all row in rank 0.
+        RowIndex matchAllRow = rowTable.GetRowCount();
+        RowIdSequence matchAllRows(m_termTable.GetMatchAllTerm(), m_termTable);
+        for (auto const row : matchAllRows)
+        {
+            if (row.GetRank() == 0)
+            {
+                matchAllRow = row.GetIndex();
+            }
+        }
+
+        for (RowIndex row = 0; row < rowTable.GetRowCount(); ++row)
+        {
+            if (row != matchAllRow && rowTable.GetBit(sliceBuffer, row, index) != 0)
+            {
+                rowTable.ClearBit(sliceBuffer, row, index);
+            }
+        }
+
+        m_docTable->Cleanup(sliceBuffer, index);
+    }
+
+
     void Shard::AssertFact(FactHandle fact, bool value, DocIndex index, void* sliceBuffer)
     {
         Term term(fact, 0u, 0u, 1u);
@@ -453,6 +877,13 @@ namespace BitFunnel
 
 
     std::vector<double> Shard::GetDensities(Rank rank) const
+    {
+        return GetRecentDensities(rank, (std::numeric_limits<size_t>::max)());
+    }
+
+
+    std::vector<double> Shard::GetRecentDensities(Rank rank,
+                                                  size_t sliceCount) const
     {
         // Hold a token to ensure that m_sliceBuffers won't be recycled.
         auto token = m_tokenManager.RequestToken();
@@ -464,39 +895,48 @@ namespace BitFunnel
         //      recycled.
         std::vector<void*> const & buffers = *m_sliceBuffers;
 
+        // New slices are appended to the end of m_sliceBuffers.
+        const size_t firstSlice =
+            (buffers.size() > sliceCount) ? buffers.size() - sliceCount : 0;
+
         RowTableDescriptor const & rowTable = m_rowTables[rank];
         RowTableDescriptor const & rowTable0 = m_rowTables[0];
 
         RowIndex active = (*RowIdSequence(m_termTable.GetDocumentActiveTerm(),
                                           m_termTable).begin()).GetIndex();
 
-        std::vector<double> densities;
-        for (RowIndex row = 0; row < rowTable.GetRowCount(); ++row)
+        const size_t quadwordCount = GetSliceCapacity() / 64;
+
+        // Only count bits for documents that are active in the index.
+        size_t activeBitCount = 0;
+        std::vector<size_t> setBitCounts(rowTable.GetRowCount(), 0);
+        for (size_t slice = firstSlice; slice < buffers.size(); ++slice)
         {
-            size_t activeBitCount = 0;
-            size_t setBitCount = 0;
-            for (auto buffer : buffers)
+            char const * base = static_cast<char const *>(buffers[slice]);
+            uint64_t const * activeRow = reinterpret_cast<uint64_t const *>(
+                base + rowTable0.GetRowOffset(active));
+
+            activeBitCount += BitStatistics::PopCount(activeRow, quadwordCount);
+
+            for (RowIndex row = 0; row < rowTable.GetRowCount(); ++row)
             {
-                for (DocIndex doc = 0; doc < GetSliceCapacity(); ++doc)
-                {
-                    // Only count bits for active documents.
-                    if (rowTable0.GetBit(buffer, active, doc) != 0)
-                    {
-                        // This document is active in the index.
-                        // Go ahead and include its bits in the density
-                        // calculation.
-                        ++activeBitCount;
-                        if (rowTable.GetBit(buffer, row, doc) != 0)
-                        {
-                            ++setBitCount;
-                        }
-                    }
-                }
+                uint64_t const * rowData = reinterpret_cast<uint64_t const *>(
+                    base + rowTable.GetRowOffset(row));
+                setBitCounts[row] +=
+                    BitStatistics::PopCountMasked(rowData,
+                                                  rank,
+                                                  activeRow,
+                                                  quadwordCount);
             }
+        }
+
+        std::vector<double> densities;
+        for (RowIndex row = 0; row < rowTable.GetRowCount(); ++row)
+        {
             double density =
                 (activeBitCount == 0) ?
                 0.0 :
-                static_cast<double>(setBitCount) / activeBitCount;
+                static_cast<double>(setBitCounts[row]) / activeBitCount;
 
             densities.push_back(density);
         }
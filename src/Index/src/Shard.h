@@ -25,9 +25,11 @@
 
 #include <memory>                           // std::unique_ptr member.
 #include <ostream>                          // TODO: Remove this temporary include.
+#include <unordered_map>                    // std::unordered_map embedded.
 #include <vector>
 
 #include "BitFunnel/BitFunnelTypes.h"       // ShardId parameter, embedded.
+#include "BitFunnel/Index/IIngestor.h"      // GroupId parameter.
 #include "BitFunnel/Index/IShard.h"         // Base class.
 #include "BitFunnel/NonCopyable.h"          // Base class.
 #include "BitFunnel/Term.h"                 // Term parameter.
@@ -81,6 +83,20 @@ namespace BitFunnel
         void AddPosting(Term const & term, DocIndex index, void* sliceBuffer);
         void AssertFact(FactHandle fact, bool value, DocIndex index, void* sliceBuffer);
 
+        // Prepares a document's column to be ingested again. Clears the
+        // document active bit first, so that queries stop matching the
+        // document, and then the document's bits in every other rank 0 row
+        // except the match-all row. Rows of higher rank are shared with
+        // neighbouring columns and are left as is, so stale bits there can
+        // only cause false positives. Releases the document's variable size
+        // blobs.
+        //
+        // The index does not keep a document's terms after ingestion:
+        // IDocument cannot enumerate them and the IDocumentCache is optional.
+        // So the old postings are not known, and every rank 0 row is probed.
+        // Rows whose bit is already clear are only read, never written.
+        void ClearDocument(DocIndex index, void* sliceBuffer);
+
         void TemporaryRecordDocument();
         void TemporaryWriteIndexedIdfTable(std::ostream& out) const;
         void TemporaryWriteCumulativeTermCounts(std::ostream& out) const;
@@ -108,6 +124,12 @@ namespace BitFunnel
         // Returns the offset of the row in the slice buffer in a shard.
         virtual ptrdiff_t GetRowOffset(RowId rowId) const override;
 
+        // Summary bitmaps are maintained for rank 0 rows. See
+        // RowTableDescriptor for details.
+        virtual bool HasSummary(RowId rowId) const override;
+        virtual ptrdiff_t GetSummaryOffset(RowId rowId) const override;
+        virtual size_t GetDocumentsPerSummaryBit() const override;
+
         virtual void TemporaryWriteDocumentFrequencyTable(
             std::ostream& out,
             ITermToText const * termToText) const override;
@@ -118,6 +140,9 @@ namespace BitFunnel
         // documents.
         virtual std::vector<double>
             GetDensities(Rank rank) const override;
+
+        virtual std::vector<double>
+            GetRecentDensities(Rank rank, size_t sliceCount) const override;
         //
         // Shard exclusive members.
         //
@@ -161,6 +186,91 @@ namespace BitFunnel
         // copy of the vector of slices, is scheduled for recycling.
         void RecycleSlice(Slice& slice);
 
+        // Seals the active Slice and assigns Slices created from now on to
+        // the given group. The remaining capacity of the sealed Slice is
+        // abandoned so that a group never shares a Slice with documents
+        // outside of it.
+        void OpenGroup(GroupId groupId);
+
+        // Seals the active Slice. Slices created from now on belong to no
+        // group.
+        void CloseGroup();
+
+        // Returns true if a Slice of the given group can still allocate
+        // documents or has documents which are pending commit.
+        bool IsGroupIngesting(GroupId groupId) const;
+
+        // Expires every document in the Slices of the given group, clearing
+        // their document active bits, and hands each Slice to RecycleSlice()
+        // as a whole. Appends a handle to each document which was active
+        // to expired. The caller must hold a Token so that the handles remain
+        // valid, must ensure that no documents are being deleted from the
+        // group, and must check IsGroupIngesting() first. Returns the number
+        // of Slices recycled.
+        size_t ExpireGroup(GroupId groupId,
+                           std::vector<DocumentHandleInternal>& expired);
+
+        // A merge of closed Slices into a new Slice, prepared by
+        // SelectMerges() and BuildMerge() and completed by CommitMerge().
+        // Deletes the new Slice if it was never swapped in.
+        class PendingMerge : NonCopyable
+        {
+        public:
+            PendingMerge();
+            ~PendingMerge();
+
+        private:
+            friend class Shard;
+
+            // A live column of a source Slice and its copy in m_merged.
+            class Column
+            {
+            public:
+                Column(Slice* source, DocIndex sourceIndex, DocIndex mergedIndex);
+
+                Slice* m_source;
+                DocIndex m_sourceIndex;
+                DocIndex m_mergedIndex;
+            };
+
+            std::vector<Slice*> m_sources;
+
+            // Slice::GetRewriteCount() of each source when it was selected.
+            std::vector<size_t> m_rewriteCounts;
+
+            Slice* m_merged;
+            std::vector<Column> m_columns;
+        };
+
+        // Compaction merges closed Slices, other than the active Slice,
+        // whose fraction of live documents is below minLiveRatio. It runs in
+        // three steps so that the bulk of the work, copying row bits, does
+        // not block deletes and updates:
+        //
+        // SelectMerges() appends a PendingMerge to merges for each set of
+        // candidate Slices in the same group whose live documents fit in one
+        // Slice. The caller must ensure that no document is being updated.
+        void SelectMerges(double minLiveRatio,
+                          std::vector<std::unique_ptr<PendingMerge>>& merges);
+
+        // BuildMerge() copies the row bits of the live columns of the
+        // sources into a new private Slice. It may run concurrently with
+        // queries, deletes and updates. The caller must hold a Token.
+        void BuildMerge(PendingMerge& merge);
+
+        // CommitMerge() drops copies of documents deleted since BuildMerge(),
+        // copies the DocTable entries, and replaces the sources with the new
+        // Slice in the list of slice buffers in a single exchange, so that
+        // each query sees either the old Slices or the new one, never both or
+        // neither. The old Slices are recycled once the queries using them
+        // drain. Appends a handle to each copied document to moved. The merge
+        // is abandoned if a source was updated or recycled in the meantime.
+        // The caller must hold a Token and must ensure that no document is
+        // deleted or updated concurrently. Returns the number of Slices
+        // retired.
+        size_t CommitMerge(PendingMerge& merge,
+                           std::vector<DocumentHandleInternal>& moved);
+
         // Returns term table associated with this shard.
         ITermTable const & GetTermTable() const;
 
@@ -227,6 +337,13 @@ namespace BitFunnel
         //   swap newSlices and m_sliceBuffers, schedule newSlices for recycling.
         void CreateNewActiveSlice();
 
+        // Seals m_activeSlice and clears it so that the next document
+        // allocates a new Slice. Returns the sealed Slice if it is now fully
+        // expired, in which case the caller must release the index's
+        // reference to it after releasing m_slicesLock. Returns nullptr
+        // otherwise. Must be called with m_slicesLock held.
+        Slice* SealActiveSlice();
+
         //
         // Constructor parameters.
         //
@@ -262,6 +379,15 @@ namespace BitFunnel
         // allocate a new Slice via CreateNewActiveSlice().
         Slice* m_activeSlice;
 
+        // Group which owns Slices created by CreateNewActiveSlice(). Only
+        // meaningful while m_isGroupOpen is true.
+        bool m_isGroupOpen;
+        GroupId m_currentGroupId;
+
+        // Group of each Slice created while a group was open. Slices leave
+        // the map when they are recycled.
+        std::unordered_map<Slice const *, GroupId> m_sliceGroups;
+
         // Vector of pointers to slice buffers.
         //
         // DESIGN NOTE: We store a pointer to an std::vector here instead of
@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 
 
+#include "BitFunnel/Exceptions.h"
 #include "LoggerInterfaces/Logging.h"
 #include "Shard.h"
 #include "Slice.h"
@@ -36,7 +37,8 @@ namespace BitFunnel
           m_buffer(shard.AllocateSliceBuffer()),
           m_unallocatedCount(shard.GetSliceCapacity()),
           m_commitPendingCount(0),
-          m_expiredCount(0)
+          m_expiredCount(0),
+          m_rewriteCount(0)
     {
         Initialize();
 
@@ -110,6 +112,68 @@ namespace BitFunnel
     }
 
 
+    bool Slice::Seal()
+    {
+        std::lock_guard<std::mutex> lock(m_docIndexLock);
+
+        m_expiredCount += m_unallocatedCount;
+        m_unallocatedCount = 0;
+
+        return m_expiredCount == m_capacity;
+    }
+
+
+    bool Slice::ExpireAllDocuments()
+    {
+        std::lock_guard<std::mutex> lock(m_docIndexLock);
+
+        if (m_commitPendingCount != 0)
+        {
+            RecoverableError
+                error("Slice::ExpireAllDocuments(): documents are pending commit.");
+            throw error;
+        }
+
+        const bool wasExpired = (m_expiredCount == m_capacity);
+
+        m_expiredCount = m_capacity;
+        m_unallocatedCount = 0;
+
+        return !wasExpired;
+    }
+
+
+    DocIndex Slice::GetLiveDocumentCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_docIndexLock);
+
+        return m_capacity
+            - m_unallocatedCount
+            - m_commitPendingCount
+            - m_expiredCount;
+    }
+
+
+    bool Slice::IsClosed() const
+    {
+        std::lock_guard<std::mutex> lock(m_docIndexLock);
+
+        return m_unallocatedCount == 0 && m_commitPendingCount == 0;
+    }
+
+
+    void Slice::IncrementRewriteCount()
+    {
+        ++m_rewriteCount;
+    }
+
+
+    size_t Slice::GetRewriteCount() const
+    {
+        return m_rewriteCount;
+    }
+
+
     DocTableDescriptor const & Slice::GetDocTable() const
     {
         return m_shard.GetDocTable();
@@ -205,6 +205,36 @@ namespace BitFunnel
         //   return m_expiredCount == m_capacity.
         bool ExpireDocument();
 
+        // Abandons the unallocated capacity of the Slice by counting it as
+        // expired. No further documents can be allocated in a sealed Slice.
+        // Returns true if the entire capacity of the Slice is now expired, in
+        // which case the caller is responsible of recycling the Slice.
+        // Thread safe.
+        bool Seal();
+
+        // Expires every committed document which has not already been
+        // expired and abandons the unallocated capacity, leaving the Slice
+        // fully expired. Throws RecoverableError, leaving the Slice
+        // unchanged, if documents are pending commit. Returns true if the
+        // Slice was not already fully expired, in which case the caller is
+        // responsible of recycling the Slice.
+        // Thread safe.
+        bool ExpireAllDocuments();
+
+        // Returns the number of committed documents which have not expired.
+        // Thread safe.
+        DocIndex GetLiveDocumentCount() const;
+
+        // Returns true if no further documents can be allocated in the Slice
+        // and none are pending commit. Thread safe.
+        bool IsClosed() const;
+
+        // Counts rewrites of committed columns by Ingestor::Update(), so
+        // that slice compaction can tell whether a copy of the Slice may be
+        // stale. Thread safe.
+        void IncrementRewriteCount();
+        size_t GetRewriteCount() const;
+
         // Returns true if the Slice is fully expired, meaning that all of its
         // documents are expired. In this case the Slice can be removed from
         // the index.
@@ -282,5 +312,8 @@ namespace BitFunnel
         // The number of DocIndex'es that have been expired from the slice.
         // When this value reaches m_capacity, the slice can be recycled.
         std::atomic<size_t> m_expiredCount;
+
+        // The number of times a committed column has been rewritten.
+        std::atomic<size_t> m_rewriteCount;
     };
 }
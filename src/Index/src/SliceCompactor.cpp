@@ -0,0 +1,161 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <chrono>
+
+#include "Ingestor.h"
+#include "LoggerInterfaces/Check.h"
+#include "SliceCompactor.h"
+
+
+namespace BitFunnel
+{
+    SliceCompactor::SliceCompactor(Ingestor & ingestor)
+      : m_ingestor(ingestor),
+        // A Slice at a quarter of its capacity costs four times the scan
+        // time per document of a full one.
+        m_minLiveRatio(0.25),
+        m_passCount(0),
+        m_retiredSliceCount(0),
+        m_movedDocumentCount(0),
+        m_stopping(false)
+    {
+    }
+
+
+    SliceCompactor::~SliceCompactor()
+    {
+        Stop();
+    }
+
+
+    void SliceCompactor::Configure(double minLiveRatio)
+    {
+        CHECK_GE(minLiveRatio, 0.0)
+            << "SliceCompactor: minLiveRatio must not be negative.";
+        CHECK_LE(minLiveRatio, 1.0)
+            << "SliceCompactor: minLiveRatio must not exceed 1.";
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_minLiveRatio = minLiveRatio;
+    }
+
+
+    size_t SliceCompactor::Compact()
+    {
+        std::lock_guard<std::mutex> compactLock(m_compactLock);
+
+        double minLiveRatio;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            minLiveRatio = m_minLiveRatio;
+        }
+
+        size_t movedCount = 0;
+        const size_t retiredCount =
+            m_ingestor.CompactSlices(minLiveRatio, movedCount);
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        ++m_passCount;
+        m_retiredSliceCount += retiredCount;
+        m_movedDocumentCount += movedCount;
+
+        return retiredCount;
+    }
+
+
+    void SliceCompactor::Start(size_t intervalMilliseconds)
+    {
+        Stop();
+
+        std::lock_guard<std::mutex> lock(m_threadLock);
+        m_stopping = false;
+        m_thread = std::thread(&SliceCompactor::CompactorThreadEntryPoint,
+                               this,
+                               intervalMilliseconds);
+    }
+
+
+    void SliceCompactor::Stop()
+    {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(m_threadLock);
+            m_stopping = true;
+            thread = std::move(m_thread);
+        }
+        m_wakeup.notify_all();
+
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+
+    bool SliceCompactor::IsRunning() const
+    {
+        std::lock_guard<std::mutex> lock(m_threadLock);
+        return m_thread.joinable();
+    }
+
+
+    void SliceCompactor::CompactorThreadEntryPoint(size_t intervalMilliseconds)
+    {
+        std::unique_lock<std::mutex> lock(m_threadLock);
+        while (!m_stopping)
+        {
+            m_wakeup.wait_for(lock,
+                              std::chrono::milliseconds(intervalMilliseconds),
+                              [this]() { return m_stopping; });
+
+            if (!m_stopping)
+            {
+                lock.unlock();
+                Compact();
+                lock.lock();
+            }
+        }
+    }
+
+
+    size_t SliceCompactor::GetPassCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_passCount;
+    }
+
+
+    size_t SliceCompactor::GetRetiredSliceCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_retiredSliceCount;
+    }
+
+
+    size_t SliceCompactor::GetMovedDocumentCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_movedDocumentCount;
+    }
+}
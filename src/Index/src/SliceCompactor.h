@@ -0,0 +1,86 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>                   // std::condition_variable member.
+#include <mutex>                                // std::mutex member.
+#include <thread>                               // std::thread member.
+
+#include "BitFunnel/Index/ISliceCompactor.h"    // Base class.
+#include "BitFunnel/NonCopyable.h"              // Base class.
+
+
+namespace BitFunnel
+{
+    class Ingestor;
+
+    //*************************************************************************
+    //
+    // SliceCompactor
+    //
+    // Implementation of ISliceCompactor that compacts each Shard with
+    // Ingestor::CompactSlices(). Passes are serialized, so a Compact() call
+    // made while the background thread is compacting waits for it.
+    //
+    //*************************************************************************
+    class SliceCompactor : public ISliceCompactor, NonCopyable
+    {
+    public:
+        SliceCompactor(Ingestor & ingestor);
+
+        ~SliceCompactor();
+
+        //
+        // ISliceCompactor methods.
+        //
+        virtual void Configure(double minLiveRatio) override;
+        virtual size_t Compact() override;
+        virtual void Start(size_t intervalMilliseconds) override;
+        virtual void Stop() override;
+        virtual bool IsRunning() const override;
+        virtual size_t GetPassCount() const override;
+        virtual size_t GetRetiredSliceCount() const override;
+        virtual size_t GetMovedDocumentCount() const override;
+
+    private:
+        void CompactorThreadEntryPoint(size_t intervalMilliseconds);
+
+        Ingestor & m_ingestor;
+
+        // Serializes calls to Compact().
+        std::mutex m_compactLock;
+
+        // Protects the configuration and the statistics.
+        mutable std::mutex m_lock;
+        double m_minLiveRatio;
+        size_t m_passCount;
+        size_t m_retiredSliceCount;
+        size_t m_movedDocumentCount;
+
+        // Background compactor.
+        std::thread m_thread;
+        mutable std::mutex m_threadLock;
+        std::condition_variable m_wakeup;
+        bool m_stopping;
+    };
+}
@@ -0,0 +1,192 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>                            // std::min() in template.
+#include <istream>                              // std::istream in template.
+#include <memory>                               // std::unique_ptr member.
+#include <ostream>                              // std::ostream in template.
+#include <queue>                                // std::priority_queue member.
+#include <stdint.h>                             // uint64_t in template.
+#include <utility>                              // std::pair template parameter.
+#include <vector>                               // std::vector member.
+
+#include "BitFunnel/NonCopyable.h"              // Base class.
+#include "BitFunnel/Utilities/StreamUtilities.h"  // Used in template definitions.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // SortedRuns
+    //
+    // Helpers for sorting more records than fit in memory. A run is a record
+    // count followed by the records themselves, already in sorted order.
+    // Records must be trivially copyable since they are written as raw bytes.
+    //
+    // RunReader streams the records of a single run back in fixed size
+    // blocks. RunMerger performs a k-way merge of several runs, holding one
+    // block per run in memory.
+    //
+    //*************************************************************************
+    namespace SortedRuns
+    {
+        template <typename T>
+        void WriteRun(std::ostream& output, std::vector<T> const & records)
+        {
+            StreamUtilities::WriteField<uint64_t>(output, records.size());
+            if (records.size() > 0)
+            {
+                StreamUtilities::WriteBytes(
+                    output,
+                    reinterpret_cast<char const *>(records.data()),
+                    records.size() * sizeof(T));
+            }
+        }
+
+
+        template <typename T>
+        class RunReader : public NonCopyable
+        {
+        public:
+            RunReader(std::unique_ptr<std::istream> input, size_t blockSize)
+              : m_input(std::move(input)),
+                m_blockSize(blockSize),
+                m_remaining(StreamUtilities::ReadField<uint64_t>(*m_input)),
+                m_position(0)
+            {
+            }
+
+
+            // Copies the next record into record and returns true. Returns
+            // false when the run is exhausted.
+            bool Next(T& record)
+            {
+                if (m_position == m_block.size())
+                {
+                    if (m_remaining == 0)
+                    {
+                        return false;
+                    }
+
+                    const size_t count =
+                        static_cast<size_t>((std::min)(m_remaining,
+                                                       static_cast<uint64_t>(m_blockSize)));
+                    m_block.resize(count);
+                    StreamUtilities::ReadBytes(*m_input,
+                                               m_block.data(),
+                                               count * sizeof(T));
+                    m_remaining -= count;
+                    m_position = 0;
+                }
+
+                record = m_block[m_position++];
+                return true;
+            }
+
+        private:
+            std::unique_ptr<std::istream> m_input;
+            const size_t m_blockSize;
+            uint64_t m_remaining;
+            std::vector<T> m_block;
+            size_t m_position;
+        };
+
+
+        // LESS is a strict weak ordering on T. Each run must be sorted
+        // according to LESS. Records are returned in LESS order.
+        template <typename T, typename LESS>
+        class RunMerger : public NonCopyable
+        {
+        public:
+            RunMerger(std::vector<std::unique_ptr<std::istream>> inputs,
+                      size_t blockSize,
+                      LESS less)
+              : m_heap(HeapCompare(less))
+            {
+                for (auto & input : inputs)
+                {
+                    m_readers.emplace_back(
+                        new RunReader<T>(std::move(input), blockSize));
+                    Advance(m_readers.size() - 1);
+                }
+            }
+
+
+            // Copies the smallest remaining record into record and returns
+            // true. Returns false when all runs are exhausted.
+            bool Next(T& record)
+            {
+                if (m_heap.empty())
+                {
+                    return false;
+                }
+
+                record = m_heap.top().first;
+                const size_t run = m_heap.top().second;
+                m_heap.pop();
+                Advance(run);
+
+                return true;
+            }
+
+        private:
+            typedef std::pair<T, size_t> HeapEntry;
+
+            // std::priority_queue is a max heap, so the comparison is
+            // reversed.
+            class HeapCompare
+            {
+            public:
+                HeapCompare(LESS less)
+                  : m_less(less)
+                {
+                }
+
+                bool operator()(HeapEntry const & a, HeapEntry const & b) const
+                {
+                    return m_less(b.first, a.first);
+                }
+
+            private:
+                LESS m_less;
+            };
+
+
+            void Advance(size_t run)
+            {
+                T record;
+                if (m_readers[run]->Next(record))
+                {
+                    m_heap.push(std::make_pair(record, run));
+                }
+            }
+
+            std::vector<std::unique_ptr<RunReader<T>>> m_readers;
+            std::priority_queue<HeapEntry,
+                                std::vector<HeapEntry>,
+                                HeapCompare> m_heap;
+        };
+    }
+}
@@ -0,0 +1,552 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>                                // std::sort().
+#include <functional>                               // std::less.
+#include <iostream>                                 // std::cout.
+#include <istream>                                  // std::istream template parameter.
+#include <ostream>                                  // std::ostream::operator<<().
+
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/ITermToText.h"
+#include "DocumentFrequencyTable.h"
+#include "FrequencyEstimator.h"
+#include "IndexedIdfTable.h"
+#include "LoggerInterfaces/Check.h"
+#include "SortedRuns.h"
+#include "StreamingStatistics.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IStreamingStatistics>
+        Factories::CreateStreamingStatistics(
+            IFileManager & fileManager,
+            IShardDefinition const & shardDefinition,
+            size_t maxTermsInMemory,
+            double samplingRate)
+    {
+        return std::unique_ptr<IStreamingStatistics>(
+            new StreamingStatistics(fileManager,
+                                    shardDefinition,
+                                    maxTermsInMemory,
+                                    samplingRate));
+    }
+
+
+    StreamingStatistics::StreamingStatistics(
+        IFileManager & fileManager,
+        IShardDefinition const & shardDefinition,
+        size_t maxTermsInMemory,
+        double samplingRate)
+      : m_fileManager(fileManager),
+        m_shardDefinition(shardDefinition),
+        m_maxTermsInMemory(maxTermsInMemory),
+        m_samplingRate(samplingRate),
+        m_runCount(0),
+        m_documentCount(0),
+        m_totalSourceByteSize(0)
+    {
+        CHECK_NE(maxTermsInMemory, 0u)
+            << "StreamingStatistics: maxTermsInMemory must be positive.";
+
+        for (ShardId shard = 0; shard < shardDefinition.GetShardCount(); ++shard)
+        {
+            m_shards.emplace_back(new ShardCounts());
+        }
+    }
+
+
+    void StreamingStatistics::AddDocument(std::vector<Term> const & terms,
+                                          size_t sourceByteSize)
+    {
+        ++m_documentCount;
+        m_totalSourceByteSize += sourceByteSize;
+        m_histogram.AddDocument(terms.size());
+
+        ShardCounts & shard =
+            *m_shards[m_shardDefinition.GetShard(terms.size())];
+
+        // A full table is detached under the lock and spilled after
+        // releasing it, so other threads keep counting during the sort and
+        // write.
+        CountTable full;
+        {
+            std::lock_guard<std::mutex> lock(shard.m_lock);
+
+            const uint64_t document = shard.m_documentCount++;
+            for (auto const & term : terms)
+            {
+                Counts & counts =
+                    shard.m_counts.insert(
+                        std::make_pair(term, Counts({ 0, document }))).first->second;
+                ++counts.m_count;
+            }
+
+            if (shard.m_counts.size() >= m_maxTermsInMemory)
+            {
+                full.swap(shard.m_counts);
+            }
+        }
+
+        if (full.size() > 0)
+        {
+            const size_t run = Spill(full);
+
+            std::lock_guard<std::mutex> lock(shard.m_lock);
+            shard.m_runs.push_back(run);
+        }
+    }
+
+
+    size_t StreamingStatistics::GetDocumentCount() const
+    {
+        return m_documentCount;
+    }
+
+
+    size_t StreamingStatistics::GetTotalSourceBytesIngested() const
+    {
+        return m_totalSourceByteSize;
+    }
+
+
+    size_t StreamingStatistics::GetRunCount() const
+    {
+        return m_runCount;
+    }
+
+
+    void StreamingStatistics::WriteStatistics(ITermToText const * termToText)
+    {
+        if (termToText != nullptr)
+        {
+            auto out = m_fileManager.TermToText().OpenForWrite();
+            termToText->Write(*out);
+        }
+
+        {
+            auto out = m_fileManager.DocumentHistogram().OpenForWrite();
+            m_histogram.Write(*out);
+        }
+
+        for (ShardId shard = 0; shard < m_shards.size(); ++shard)
+        {
+            WriteShard(shard, termToText);
+        }
+    }
+
+
+    size_t StreamingStatistics::Spill(CountTable & counts)
+    {
+        std::vector<TermCountRecord> records;
+        records.reserve(counts.size());
+        for (auto const & entry : counts)
+        {
+            TermCountRecord record = {};
+            record.m_hash = entry.first.GetRawHash();
+            record.m_count = entry.second.m_count;
+            record.m_firstDocument = entry.second.m_firstDocument;
+            record.m_gramSize = entry.first.GetGramSize();
+            record.m_stream = entry.first.GetStream();
+            records.push_back(record);
+        }
+
+        // Release the table's memory before writing, rather than just
+        // clearing its contents.
+        CountTable().swap(counts);
+
+        std::sort(records.begin(), records.end(), TermLess());
+        return WriteRun(records);
+    }
+
+
+    // Supplies IndexedIdfTable entries by reading the HashCountRecord runs
+    // in order and converting each count to an idf with estimator.
+    class StreamingStatistics::IdfSource : public IndexedIdfTable::IEntrySource
+    {
+    public:
+        IdfSource(StreamingStatistics & statistics,
+                  std::vector<size_t> const & runs,
+                  FrequencyEstimator const & estimator)
+          : m_statistics(statistics),
+            m_runs(runs),
+            m_estimator(estimator),
+            m_nextRun(0)
+        {
+        }
+
+
+        virtual void Reset() override
+        {
+            m_reader.reset();
+            m_nextRun = 0;
+        }
+
+
+        virtual bool Next(IndexedIdfTable::Entry & entry) override
+        {
+            HashCountRecord record;
+            for (;;)
+            {
+                if (m_reader.get() == nullptr)
+                {
+                    if (m_nextRun == m_runs.size())
+                    {
+                        return false;
+                    }
+                    m_reader.reset(new SortedRuns::RunReader<HashCountRecord>(
+                        m_statistics.m_fileManager.TermCountRun(
+                            m_runs[m_nextRun++]).OpenForRead(),
+                        c_mergeBlockSize));
+                }
+
+                if (m_reader->Next(record))
+                {
+                    break;
+                }
+                m_reader.reset();
+            }
+
+            const double frequency = m_estimator.GetFrequency(record.m_count);
+            entry = std::make_pair(record.m_hash,
+                                   Term::ComputeIdfX10(frequency,
+                                                       Term::c_maxIdfX10Value));
+            return true;
+        }
+
+    private:
+        StreamingStatistics & m_statistics;
+        std::vector<size_t> const & m_runs;
+        FrequencyEstimator const & m_estimator;
+
+        std::unique_ptr<SortedRuns::RunReader<HashCountRecord>> m_reader;
+        size_t m_nextRun;
+    };
+
+
+    void StreamingStatistics::WriteShard(ShardId shardId,
+                                         ITermToText const * termToText)
+    {
+        ShardCounts & shard = *m_shards[shardId];
+        std::lock_guard<std::mutex> lock(shard.m_lock);
+
+        if (shard.m_counts.size() > 0)
+        {
+            shard.m_runs.push_back(Spill(shard.m_counts));
+        }
+
+        const size_t documentCount = shard.m_documentCount;
+
+        // Number of terms with each of the small counts that the
+        // FrequencyEstimator corrects.
+        std::vector<size_t> countOfCounts(FrequencyEstimator::c_maxCorrectedCount + 2, 0);
+        size_t termCount = 0;
+
+        // Merged counts in hash order, for the IndexedIdfTable.
+        std::vector<HashCountRecord> hashCounts;
+        std::vector<size_t> hashRuns;
+        Term::Hash lastHash = 0;
+        bool hasHash = false;
+
+        // Merged counts, for the DocumentFrequencyTable.
+        std::vector<FrequencyRecord> frequencies;
+        std::vector<size_t> frequencyRuns;
+
+        // The first document of each term, for the CumulativeTermCounts.
+        std::vector<uint64_t> firstDocuments;
+        std::vector<size_t> firstDocumentRuns;
+
+        auto emit = [&](TermCountRecord const & record)
+        {
+            ++termCount;
+
+            if (record.m_count < countOfCounts.size())
+            {
+                ++countOfCounts[record.m_count];
+            }
+
+            // The merge produces records in hash order, so these runs need
+            // no sorting. As in IndexedIdfTable::Write(), only the first
+            // record for each hash is used.
+            if (!hasHash || record.m_hash != lastHash)
+            {
+                HashCountRecord h = {};
+                h.m_hash = record.m_hash;
+                h.m_count = record.m_count;
+                hashCounts.push_back(h);
+                if (hashCounts.size() >= m_maxTermsInMemory)
+                {
+                    hashRuns.push_back(WriteRun(hashCounts));
+                    hashCounts.clear();
+                }
+                lastHash = record.m_hash;
+                hasHash = true;
+            }
+
+            FrequencyRecord f = {};
+            f.m_hash = record.m_hash;
+            f.m_count = record.m_count;
+            f.m_gramSize = record.m_gramSize;
+            f.m_stream = record.m_stream;
+            frequencies.push_back(f);
+            if (frequencies.size() >= m_maxTermsInMemory)
+            {
+                SpillRecords(frequencies, FrequencyLess(), frequencyRuns);
+            }
+
+            firstDocuments.push_back(record.m_firstDocument);
+            if (firstDocuments.size() >= m_maxTermsInMemory)
+            {
+                SpillRecords(firstDocuments, std::less<uint64_t>(), firstDocumentRuns);
+            }
+        };
+
+        //
+        // Merge the runs sorted by term, combining the counts for each term.
+        //
+        {
+            SortedRuns::RunMerger<TermCountRecord, TermLess>
+                merger(OpenRuns(shard.m_runs), c_mergeBlockSize, TermLess());
+
+            TermCountRecord current;
+            if (merger.Next(current))
+            {
+                TermCountRecord record;
+                while (merger.Next(record))
+                {
+                    if (record.m_hash == current.m_hash &&
+                        record.m_gramSize == current.m_gramSize)
+                    {
+                        current.m_count += record.m_count;
+                        if (record.m_firstDocument < current.m_firstDocument)
+                        {
+                            current.m_firstDocument = record.m_firstDocument;
+                            current.m_stream = record.m_stream;
+                        }
+                    }
+                    else
+                    {
+                        emit(current);
+                        current = record;
+                    }
+                }
+                emit(current);
+            }
+        }
+        DeleteRuns(shard.m_runs);
+        shard.m_runs.clear();
+
+        if (hashCounts.size() > 0)
+        {
+            hashRuns.push_back(WriteRun(hashCounts));
+        }
+        std::vector<HashCountRecord>().swap(hashCounts);
+
+        if (frequencies.size() > 0)
+        {
+            SpillRecords(frequencies, FrequencyLess(), frequencyRuns);
+        }
+        std::vector<FrequencyRecord>().swap(frequencies);
+
+        if (firstDocuments.size() > 0)
+        {
+            SpillRecords(firstDocuments, std::less<uint64_t>(), firstDocumentRuns);
+        }
+        std::vector<uint64_t>().swap(firstDocuments);
+
+        const FrequencyEstimator estimator(documentCount,
+                                           m_samplingRate,
+                                           countOfCounts);
+
+        {
+            auto out = m_fileManager.CumulativeTermCounts(shardId).OpenForWrite();
+
+            SortedRuns::RunMerger<uint64_t, std::less<uint64_t>>
+                merger(OpenRuns(firstDocumentRuns),
+                       c_mergeBlockSize,
+                       std::less<uint64_t>());
+
+            uint64_t firstDocument;
+            bool hasFirstDocument = merger.Next(firstDocument);
+            size_t cumulative = 0;
+            for (size_t i = 0; i < documentCount; ++i)
+            {
+                // As in the index, counts include the terms of document i.
+                while (hasFirstDocument && firstDocument == i)
+                {
+                    ++cumulative;
+                    hasFirstDocument = merger.Next(firstDocument);
+                }
+                *out << i << "," << cumulative << std::endl;
+            }
+        }
+        DeleteRuns(firstDocumentRuns);
+
+        {
+            auto out = m_fileManager.DocFreqTable(shardId).OpenForWrite();
+            DocumentFrequencyTableWriter writer(*out, termToText);
+
+            std::unique_ptr<std::ostream> boundsOut;
+            std::unique_ptr<FrequencyBoundsWriter> bounds;
+            if (m_samplingRate < 1.0)
+            {
+                boundsOut = m_fileManager.DocFreqBounds(shardId).OpenForWrite();
+                bounds.reset(new FrequencyBoundsWriter(*boundsOut));
+            }
+
+            SortedRuns::RunMerger<FrequencyRecord, FrequencyLess>
+                merger(OpenRuns(frequencyRuns), c_mergeBlockSize, FrequencyLess());
+
+            FrequencyRecord record;
+            while (merger.Next(record))
+            {
+                const double frequency = estimator.GetFrequency(record.m_count);
+                Term term(record.m_hash,
+                          record.m_stream,
+                          Term::ComputeIdfX10(frequency,
+                                              Term::c_maxIdfX10Value),
+                          record.m_gramSize);
+                writer.Write(DocumentFrequencyTable::Entry(term, frequency));
+
+                if (bounds.get() != nullptr)
+                {
+                    bounds->Write(term, record.m_count, estimator);
+                }
+            }
+            writer.Complete();
+
+            if (bounds.get() != nullptr)
+            {
+                bounds->Complete();
+            }
+        }
+        DeleteRuns(frequencyRuns);
+
+        std::cout << "DocumentFrequencyTable count: "
+                  << termCount
+                  << std::endl;
+
+        {
+            IdfSource source(*this, hashRuns, estimator);
+            auto out = m_fileManager.IndexedIdfTable(shardId).OpenForWrite();
+            IndexedIdfTable::Write(*out, source);
+        }
+        DeleteRuns(hashRuns);
+    }
+
+
+    template <typename T>
+    size_t StreamingStatistics::WriteRun(std::vector<T> const & records)
+    {
+        const size_t run = m_runCount++;
+        auto out = m_fileManager.TermCountRun(run).OpenForWrite();
+        SortedRuns::WriteRun(*out, records);
+        return run;
+    }
+
+
+    template <typename T, typename LESS>
+    void StreamingStatistics::SpillRecords(std::vector<T> & records,
+                                           LESS less,
+                                           std::vector<size_t> & runs)
+    {
+        std::sort(records.begin(), records.end(), less);
+        runs.push_back(WriteRun(records));
+        records.clear();
+    }
+
+
+    std::vector<std::unique_ptr<std::istream>>
+        StreamingStatistics::OpenRuns(std::vector<size_t> const & runs)
+    {
+        std::vector<std::unique_ptr<std::istream>> inputs;
+        for (auto run : runs)
+        {
+            inputs.push_back(m_fileManager.TermCountRun(run).OpenForRead());
+        }
+        return inputs;
+    }
+
+
+    void StreamingStatistics::DeleteRuns(std::vector<size_t> const & runs)
+    {
+        for (auto run : runs)
+        {
+            m_fileManager.TermCountRun(run).Delete();
+        }
+    }
+
+
+    //*************************************************************************
+    //
+    // StreamingStatistics::TermLess
+    //
+    //*************************************************************************
+    bool StreamingStatistics::TermLess::operator()(
+        TermCountRecord const & a,
+        TermCountRecord const & b) const
+    {
+        if (a.m_hash != b.m_hash)
+        {
+            return a.m_hash < b.m_hash;
+        }
+        return a.m_gramSize < b.m_gramSize;
+    }
+
+
+    //*************************************************************************
+    //
+    // StreamingStatistics::FrequencyLess
+    //
+    //*************************************************************************
+    bool StreamingStatistics::FrequencyLess::operator()(
+        FrequencyRecord const & a,
+        FrequencyRecord const & b) const
+    {
+        // Sorts by decreasing count, and therefore decreasing frequency.
+        // Ties are broken by term so that the output does not depend on how
+        // terms were divided among runs.
+        if (a.m_count != b.m_count)
+        {
+            return a.m_count > b.m_count;
+        }
+        if (a.m_hash != b.m_hash)
+        {
+            return a.m_hash < b.m_hash;
+        }
+        return a.m_gramSize < b.m_gramSize;
+    }
+
+
+    //*************************************************************************
+    //
+    // StreamingStatistics::ShardCounts
+    //
+    //*************************************************************************
+    StreamingStatistics::ShardCounts::ShardCounts()
+      : m_documentCount(0)
+    {
+    }
+}
@@ -0,0 +1,201 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>                                   // std::atomic member.
+#include <iosfwd>                                   // std::istream template parameter.
+#include <memory>                                   // std::unique_ptr member.
+#include <mutex>                                    // std::mutex member.
+#include <stdint.h>                                 // uint64_t member.
+#include <unordered_map>                            // std::unordered_map member.
+#include <vector>                                   // std::vector member.
+
+#include "BitFunnel/BitFunnelTypes.h"               // ShardId parameter.
+#include "BitFunnel/Index/IStreamingStatistics.h"   // Base class.
+#include "BitFunnel/NonCopyable.h"                  // Base class.
+#include "BitFunnel/Term.h"                         // Term template parameter.
+#include "DocumentHistogramBuilder.h"               // DocumentHistogramBuilder member.
+
+
+namespace BitFunnel
+{
+    class IFileManager;
+    class IShardDefinition;
+
+    //*************************************************************************
+    //
+    // StreamingStatistics
+    //
+    // Gathers the corpus statistics produced by StatisticsBuilder without
+    // building slices. Each shard counts documents per term in a table that
+    // holds at most maxTermsInMemory terms. When the table fills, it is
+    // detached under the shard's lock, then sorted by term and spilled to
+    // disk as a run (see SortedRuns.h) without holding the lock.
+    //
+    // WriteStatistics() performs a k-way merge of each shard's runs. The
+    // merged counts go to three further sets of runs: counts in hash order
+    // for the IndexedIdfTable, counts in decreasing frequency order for the
+    // DocumentFrequencyTable, and the first document of each term, from
+    // which the CumulativeTermCounts are recovered. Each table is then
+    // streamed from its runs, and every run is deleted once it has been
+    // merged.
+    //
+    // Memory use is bounded by maxTermsInMemory records per buffer, one
+    // block per run during a merge, and one detached table per thread that
+    // is spilling concurrently. It does not grow with the vocabulary or the
+    // number of documents.
+    //
+    // When the documents are a sample of the corpus (samplingRate < 1),
+    // frequencies are estimated by a FrequencyEstimator, and the confidence
+    // bounds for each term are written to DocFreqBounds-[SHARD].csv.
+    //
+    //*************************************************************************
+    class StreamingStatistics : public IStreamingStatistics, NonCopyable
+    {
+    public:
+        StreamingStatistics(IFileManager & fileManager,
+                            IShardDefinition const & shardDefinition,
+                            size_t maxTermsInMemory,
+                            double samplingRate);
+
+        //
+        // IStreamingStatistics methods.
+        //
+        virtual void AddDocument(std::vector<Term> const & terms,
+                                 size_t sourceByteSize) override;
+
+        virtual size_t GetDocumentCount() const override;
+
+        virtual size_t GetTotalSourceBytesIngested() const override;
+
+        virtual size_t GetRunCount() const override;
+
+        virtual void WriteStatistics(ITermToText const * termToText) override;
+
+    private:
+        // Record stored in runs sorted by term.
+        struct TermCountRecord
+        {
+            Term::Hash m_hash;
+            uint64_t m_count;
+            uint64_t m_firstDocument;
+            Term::GramSize m_gramSize;
+            Term::StreamId m_stream;
+        };
+
+        // Record stored in runs sorted by decreasing count.
+        struct FrequencyRecord
+        {
+            Term::Hash m_hash;
+            uint64_t m_count;
+            Term::GramSize m_gramSize;
+            Term::StreamId m_stream;
+        };
+
+        // Record stored in runs in hash order. Consecutive runs continue
+        // the same order, so they are read back one after another.
+        struct HashCountRecord
+        {
+            Term::Hash m_hash;
+            uint64_t m_count;
+        };
+
+        struct TermLess
+        {
+            bool operator()(TermCountRecord const & a,
+                            TermCountRecord const & b) const;
+        };
+
+        struct FrequencyLess
+        {
+            bool operator()(FrequencyRecord const & a,
+                            FrequencyRecord const & b) const;
+        };
+
+        struct Counts
+        {
+            uint64_t m_count;
+            uint64_t m_firstDocument;
+        };
+
+        typedef std::unordered_map<Term, Counts, Term::Hasher> CountTable;
+
+        class ShardCounts : NonCopyable
+        {
+        public:
+            ShardCounts();
+
+            std::mutex m_lock;
+            CountTable m_counts;
+            size_t m_documentCount;
+            std::vector<size_t> m_runs;
+        };
+
+        // Supplies IndexedIdfTable entries from a sequence of
+        // HashCountRecord runs.
+        class IdfSource;
+
+        // Sorts a table detached from a shard, releases its memory, and
+        // writes it out as a new run. Returns the run number.
+        size_t Spill(CountTable & counts);
+
+        void WriteShard(ShardId shard, ITermToText const * termToText);
+
+        template <typename T>
+        size_t WriteRun(std::vector<T> const & records);
+
+        // Sorts records, writes them as a new run appended to runs, and
+        // clears records.
+        template <typename T, typename LESS>
+        void SpillRecords(std::vector<T> & records,
+                          LESS less,
+                          std::vector<size_t> & runs);
+
+        std::vector<std::unique_ptr<std::istream>>
+            OpenRuns(std::vector<size_t> const & runs);
+
+        void DeleteRuns(std::vector<size_t> const & runs);
+
+        // Number of records per run held in memory during a merge.
+        static const size_t c_mergeBlockSize = 4096;
+
+        //
+        // Constructor parameters.
+        //
+        IFileManager & m_fileManager;
+        IShardDefinition const & m_shardDefinition;
+        const size_t m_maxTermsInMemory;
+        const double m_samplingRate;
+
+        //
+        // Other members.
+        //
+        std::atomic<size_t> m_runCount;
+        std::atomic<size_t> m_documentCount;
+        std::atomic<size_t> m_totalSourceByteSize;
+
+        DocumentHistogramBuilder m_histogram;
+
+        std::vector<std::unique_ptr<ShardCounts>> m_shards;
+    };
+}
@@ -88,6 +88,20 @@ namespace BitFunnel
     }
 
 
+    Term::Term(Hash rawHash,
+               StreamId stream,
+               GramSize gramSize,
+               IdfX10 idfSum,
+               IdfX10 idfMax)
+        : m_rawHash(rawHash),
+          m_stream(stream),
+          m_gramSize(gramSize),
+          m_idfSum(idfSum),
+          m_idfMax(idfMax)
+    {
+    }
+
+
     Term::Term(std::istream& input)
     {
         unsigned temp;
@@ -447,6 +447,39 @@ namespace BitFunnel
     }
 
 
+    std::vector<bool> TermTable::GetSharedRows(Rank rank) const
+    {
+        EnsureSealed(true);
+
+        const size_t rowCount = GetTotalRowCount(rank);
+        std::vector<bool> shared(rowCount, false);
+
+        // Adhoc rows occupy the lowest RowIndex values at each rank.
+        for (RowIndex row = 0; row < m_adhocRowCounts[rank] && row < rowCount; ++row)
+        {
+            shared[row] = true;
+        }
+
+        std::vector<size_t> termCounts(rowCount, 0);
+        for (auto const & rows : m_termHashToRows)
+        {
+            for (RowIndex r = rows.second.GetStart(); r < rows.second.GetEnd(); ++r)
+            {
+                const RowId row = m_rowIds[r];
+                if (row.GetRank() == rank && row.GetIndex() < rowCount)
+                {
+                    if (++termCounts[row.GetIndex()] > 1)
+                    {
+                        shared[row.GetIndex()] = true;
+                    }
+                }
+            }
+        }
+
+        return shared;
+    }
+
+
     PackedRowIdSequence TermTable::GetRows(const Term& term) const
     {
         const Term::Hash hash = term.GetRawHash();
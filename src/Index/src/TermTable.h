@@ -97,6 +97,8 @@ namespace BitFunnel
         // document using this TermTable.
         virtual double GetBytesPerDocument(Rank rank) const override;
 
+        virtual std::vector<bool> GetSharedRows(Rank rank) const override;
+
         // Returns a PackedRowIdSequence structure associated with the
         // specified term. The PackedRowIdSequence structure contains
         // information about the term's rows. PackedRowIdSequence is used
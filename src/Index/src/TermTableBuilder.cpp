@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 
 #include <algorithm>
+#include <functional>   // std::function embedded.
 #include <iostream>     // TODO: Remove this temporary include.
 #include <math.h>
 #include <ostream>
@@ -31,6 +32,9 @@
 #include "BitFunnel/Index/IFactSet.h"
 #include "BitFunnel/Index/ITermTable.h"
 #include "BitFunnel/Index/ITermTreatment.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
 #include "BitFunnel/Utilities/Stopwatch.h"
 #include "DocumentFrequencyTable.h"
 #include "LoggerInterfaces/Check.h"
@@ -50,7 +54,8 @@ namespace BitFunnel
                                           ITermTreatment const & treatment,
                                           IDocumentFrequencyTable const & terms,
                                           IFactSet const & facts,
-                                          ITermTable & termTable)
+                                          ITermTable & termTable,
+                                          size_t threadCount)
     {
         // TODO: make skipDistance (currently c_explicitRowRandomizaitonLimit) a parameter.
         return
@@ -60,10 +65,39 @@ namespace BitFunnel
                                                                     terms,
                                                                     facts,
                                                                     termTable,
-                                                                    c_explicitRowRandomizationLimit));
+                                                                    c_explicitRowRandomizationLimit,
+                                                                    threadCount));
     }
 
 
+    //*************************************************************************
+    //
+    // RowAssignerTaskProcessor runs the first phase of the build for one
+    // rank per task.
+    //
+    //*************************************************************************
+    class RowAssignerTaskProcessor : public ITaskProcessor
+    {
+    public:
+        RowAssignerTaskProcessor(std::function<void(size_t)> const & assign)
+          : m_assign(assign)
+        {
+        }
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            m_assign(taskId);
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+    private:
+        std::function<void(size_t)> m_assign;
+    };
+
+
     //*************************************************************************
     //
     // TermTableBuilder
@@ -75,14 +109,16 @@ namespace BitFunnel
                                        IDocumentFrequencyTable const & terms,
                                        IFactSet const & facts,
                                        ITermTable & termTable,
-                                       unsigned randomSkipDistance)
+                                       unsigned randomSkipDistance,
+                                       size_t threadCount)
         : m_termTable(termTable),
           m_buildTime(0.0),
-          // seed, min value, max value.
-          m_random(std::make_unique<RandomInt<unsigned>>(0,
-                                                         0,
-                                                         randomSkipDistance))
+          m_assignmentTime(0.0),
+          m_threadCount(threadCount)
     {
+        CHECK_GT(threadCount, 0u)
+            << "TermTableBuilder: threadCount must be at least 1.";
+
         Stopwatch stopwatch;
 
         // Create one RowAssigner for each rank.
@@ -93,48 +129,60 @@ namespace BitFunnel
                     new RowAssigner(rank,
                                     density,
                                     termTable,
-                                    *m_random)));
+                                    randomSkipDistance)));
         }
 
+        // First phase: assign rows for each rank.
+        auto assign = [&](size_t rank)
+        {
+            m_rowAssigners[rank]->AssignTerms(terms, treatment, adhocFrequency);
+        };
 
-        // For each entry in the document frequency table.
+        if (threadCount > 1)
+        {
+            std::vector<std::unique_ptr<ITaskProcessor>> processors;
+            for (size_t i = 0; i < (std::min)(threadCount, m_rowAssigners.size()); ++i)
+            {
+                processors.push_back(
+                    std::unique_ptr<ITaskProcessor>(
+                        new RowAssignerTaskProcessor(assign)));
+            }
+
+            auto distributor =
+                Factories::CreateTaskDistributor(processors,
+                                                 m_rowAssigners.size());
+            distributor->WaitForCompletion();
+        }
+        else
+        {
+            // The threadCount == 1 case is implemented to simplify debugging.
+            for (size_t rank = 0; rank < m_rowAssigners.size(); ++rank)
+            {
+                assign(rank);
+            }
+        }
+
+        m_assignmentTime = stopwatch.ElapsedTime();
+
+        // Second phase: record the assigned rows for each explicit term.
         // (note that the entries are sorted in order of decreasing frequency).
         for (auto dfEntry : terms)
         {
             // TODO: Consider handling disposed terms here.
 
-            //std::cout << "Term: ";
-            //dfEntry.GetTerm().Print(std::cout);
-            //std::cout << "; frequency = " << dfEntry.GetFrequency() << std::endl;
-
-            // Get the term's RowConfiguration.
-            auto configuration = treatment.GetTreatment(dfEntry.GetTerm());
-
-            if (dfEntry.GetFrequency() < adhocFrequency)
-            {
-                // For each rank entry in the RowConfiguration.
-                for (auto rcEntry : configuration)
-                {
-                    // Assign the appropriate rows.
-                    m_rowAssigners[rcEntry.GetRank()]->
-                        AssignAdhoc(dfEntry.GetFrequency(),
-                                    rcEntry.GetRowCount());
-                }
-            }
-            else
+            if (dfEntry.GetFrequency() >= adhocFrequency)
             {
+                // Get the term's RowConfiguration.
+                auto configuration = treatment.GetTreatment(dfEntry.GetTerm());
+
                 m_termTable.OpenTerm();
-                //std::cout << "  Configuration: ";
-                //configuration.Write(std::cout);
-                //std::cout << std::endl;
 
                 // For each rank entry in the RowConfiguration.
                 for (auto rcEntry : configuration)
                 {
-                    // Assign the appropriate rows.
                     m_rowAssigners[rcEntry.GetRank()]->
-                        AssignExplicit(dfEntry.GetFrequency(),
-                                       rcEntry.GetRowCount());
+                        AddRowIds(dfEntry.GetFrequency(),
+                                  rcEntry.GetRowCount());
                 }
 
                 m_termTable.CloseTerm(dfEntry.GetTerm().GetRawHash());
@@ -214,6 +262,8 @@ namespace BitFunnel
     void TermTableBuilder::Print(std::ostream& output) const
     {
         output << "Total build time: " << m_buildTime << " seconds." << std::endl;
+        output << "Row assignment time: " << m_assignmentTime
+               << " seconds on " << m_threadCount << " thread(s)." << std::endl;
 
         for (auto&& assigner : m_rowAssigners)
         {
@@ -257,17 +307,20 @@ namespace BitFunnel
         Rank rank,
         double density,
         ITermTable & termTable,
-        RandomInt<unsigned>& random)
+        unsigned randomSkipDistance)
         : m_rank(rank),
           m_density(density),
           m_termTable(termTable),
           m_adhocTotal(0),
           m_currentRow(0),
+          m_bins(new BinQueue(density)),
+          m_nextExplicitRow(0),
           m_privateExplicitTermCount(0),
           m_sharedAdhocTermCount(0),
           m_sharedExplicitTermCount(0),
           m_privateExplicitRowCount(0),
-          m_random(random)
+          // seed, min value, max value.
+          m_random(rank, 0, randomSkipDistance)
     {
         // TODO: Is there a way to reduce this coupling between RowAssigner
         // and the internals of TermTable?
@@ -280,6 +333,65 @@ namespace BitFunnel
     }
 
 
+    void TermTableBuilder::RowAssigner::AssignTerms(
+        IDocumentFrequencyTable const & terms,
+        ITermTreatment const & treatment,
+        double adhocFrequency)
+    {
+        for (auto dfEntry : terms)
+        {
+            // Get the term's RowConfiguration.
+            auto configuration = treatment.GetTreatment(dfEntry.GetTerm());
+
+            // For each rank entry in the RowConfiguration.
+            for (auto rcEntry : configuration)
+            {
+                if (rcEntry.GetRank() != m_rank)
+                {
+                    continue;
+                }
+
+                // Assign the appropriate rows.
+                if (dfEntry.GetFrequency() < adhocFrequency)
+                {
+                    AssignAdhoc(dfEntry.GetFrequency(),
+                                rcEntry.GetRowCount());
+                }
+                else
+                {
+                    AssignExplicit(dfEntry.GetFrequency(),
+                                   rcEntry.GetRowCount());
+                }
+            }
+        }
+    }
+
+
+    void TermTableBuilder::RowAssigner::AddRowIds(double frequency,
+                                                  RowIndex count)
+    {
+        const RowIndex rowCount = GetExplicitRowCount(frequency, count);
+
+        CHECK_LE(m_nextExplicitRow + rowCount, m_explicitRows.size())
+            << "TermTableBuilder::RowAssigner::AddRowIds: terms out of order.";
+
+        for (RowIndex i = 0; i < rowCount; ++i)
+        {
+            // TODO: figure out ShardId value here.
+            m_termTable.AddRowId(RowId(m_rank, m_explicitRows[m_nextExplicitRow++]));
+        }
+    }
+
+
+    RowIndex TermTableBuilder::RowAssigner::GetExplicitRowCount(
+        double frequency,
+        RowIndex count) const
+    {
+        // Private rows need only a single row, even if count > 1.
+        return (Term::FrequencyAtRank(frequency, m_rank) >= m_density) ? 1 : count;
+    }
+
+
     void TermTableBuilder::RowAssigner::AssignExplicit(double frequency,
                                                        RowIndex count)
     {
@@ -296,9 +408,9 @@ namespace BitFunnel
             ++m_privateExplicitTermCount;
             ++m_privateExplicitRowCount;
 
-            // Just reserve the RowIndex and then add the appropriate RowID to
-            // the TermTableBuilder.
-            m_termTable.AddRowId(RowId(m_rank, m_currentRow++));
+            // Just reserve the RowIndex. AddRowIds() will add the
+            // appropriate RowID to the TermTable.
+            m_explicitRows.push_back(m_currentRow++);
         }
         else
         {
@@ -316,7 +428,8 @@ namespace BitFunnel
             for (RowIndex i = 0; i < count; ++i)
             {
                 // Look for an existing bin with enough space.
-                auto it = m_bins.lower_bound(Bin(f));
+                Bin bin(f);
+                bool found = m_bins->TryRemoveBestFit(f, bin);
                 size_t skipDistance = m_random();
 
                 // Skip over skipDistance bins by removing them.
@@ -328,28 +441,22 @@ namespace BitFunnel
                 // discusison. If this would skip past the end, we create a new
                 // bin.
 
-                while (it != m_bins.end() && skipDistance > 0)
+                while (found && skipDistance > 0)
                 {
-                    Bin bin = *it;
-                    m_bins.erase(it);
                     skippedBins.push_back(bin);
-                    it = m_bins.lower_bound(Bin(f));
+                    found = m_bins->TryRemoveBestFit(f, bin);
                     --skipDistance;
                 }
 
-                if (it == m_bins.end())
+                if (!found)
                 {
                     // No existing bin has enough space. Start a new bin.
                     currentBins.push_back(Bin(m_density, f, m_currentRow++));
                 }
                 else
                 {
-                    // Found a bin with enough space.
-                    Bin bin = *it;
-
-                    // Remove this bin from m_bins since we will be updating
-                    // its space.
-                    m_bins.erase(it);
+                    // Found a bin with enough space. It has already been
+                    // removed from m_bins since we will be updating its space.
 
                     // Reserve space in this bin for term.
                     bin.Reserve(f);
@@ -358,27 +465,28 @@ namespace BitFunnel
                     // DESIGN NOTE: we can't immediately reinsert bin into
                     // m_bins because we must ensure that all bins for this
                     // term are unique. If we reinserted bin at this point,
-                    // the call to m_bins.lower_bound() might return it on
-                    // a future iteration.
+                    // the call to TryRemoveBestFit() might return it on a
+                    // future iteration.
                     currentBins.push_back(bin);
                 }
 
                 // Add back skipped bins.
-                m_bins.insert(skippedBins.begin(), skippedBins.end());
+                for (auto const & skipped : skippedBins)
+                {
+                    m_bins->Insert(skipped);
+                }
                 skippedBins.clear();
             }
 
             // All of the bins for this term have been identified.
 
-            // Now add the appropriate RowIds to the TermTable.
-            for (auto b : currentBins)
+            // Now record the RowIndexes for AddRowIds() and reinsert the
+            // bins into m_bins.
+            for (auto const & b : currentBins)
             {
-                // TODO: figure out ShardId value here.
-                m_termTable.AddRowId(RowId(m_rank, b.GetIndex()));
+                m_explicitRows.push_back(b.GetIndex());
+                m_bins->Insert(b);
             }
-
-            // Reinsert the bins into m_bins.
-            m_bins.insert(currentBins.begin(), currentBins.end());
         }
     }
 
@@ -448,7 +556,7 @@ namespace BitFunnel
             output << "    Total: " << GetAdhocRowCount() + m_currentRow
                    << std::endl;
             output << "    Adhoc: " << GetAdhocRowCount() << std::endl;
-            output << "    Shared Explicit: " << m_bins.size() << std::endl;
+            output << "    Shared Explicit: " << m_bins->size() << std::endl;
             output << "    Private Explicit: " << m_privateExplicitRowCount << std::endl;
             output << "    Explicit: " << GetExplicitRowCount() << std::endl;
             output << std::endl;
@@ -459,10 +567,7 @@ namespace BitFunnel
             output << std::endl;
 
             Accumulator a;
-            for (auto bin : m_bins)
-            {
-                a.Record(bin.GetFrequency(m_density));
-            }
+            m_bins->RecordFrequencies(a);
 
             output << std::endl;
 
@@ -475,4 +580,160 @@ namespace BitFunnel
 
         output << std::endl;
     }
+
+
+    //*************************************************************************
+    //
+    // TermTableBuilder::RowAssigner::BinQueue
+    //
+    //*************************************************************************
+    static size_t bsf(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        // DESIGN NOTE: this is undefined if the input operand is 0. Callers
+        // must ensure value is non-zero.
+        return static_cast<size_t>(__builtin_ctzll(value));
+#endif
+    }
+
+
+    TermTableBuilder::RowAssigner::BinQueue::BinQueue(double density)
+      : m_density(density),
+        m_bucketsPerUnitSpace(c_bucketCount / density),
+        m_buckets(c_bucketCount),
+        m_occupied((c_bucketCount + 63) / 64, 0),
+        m_size(0)
+    {
+    }
+
+
+    bool TermTableBuilder::RowAssigner::BinQueue::TryRemoveBestFit(
+        double frequency,
+        Bin & bin)
+    {
+        // Bins in the bucket that holds frequency may have less space than
+        // frequency, so they must be checked individually.
+        size_t bucket = GetBucket(frequency);
+        size_t best = m_buckets[bucket].size();
+        for (size_t i = 0; i < m_buckets[bucket].size(); ++i)
+        {
+            Bin const & candidate = m_buckets[bucket][i];
+            if (candidate.GetAvailableSpace() >= frequency &&
+                (best == m_buckets[bucket].size() ||
+                 candidate < m_buckets[bucket][best]))
+            {
+                best = i;
+            }
+        }
+
+        if (best == m_buckets[bucket].size())
+        {
+            // Every bin in a later bucket has more space than frequency.
+            // Take the smallest bin from the first non-empty one.
+            bucket = FindOccupiedBucket(bucket + 1);
+            if (bucket == c_bucketCount)
+            {
+                return false;
+            }
+
+            best = 0;
+            for (size_t i = 1; i < m_buckets[bucket].size(); ++i)
+            {
+                if (m_buckets[bucket][i] < m_buckets[bucket][best])
+                {
+                    best = i;
+                }
+            }
+        }
+
+        bin = m_buckets[bucket][best];
+        Remove(bucket, best);
+        return true;
+    }
+
+
+    void TermTableBuilder::RowAssigner::BinQueue::Insert(Bin const & bin)
+    {
+        const size_t bucket = GetBucket(bin.GetAvailableSpace());
+        m_buckets[bucket].push_back(bin);
+        m_occupied[bucket >> 6] |= 1ull << (bucket & 63);
+        ++m_size;
+    }
+
+
+    size_t TermTableBuilder::RowAssigner::BinQueue::size() const
+    {
+        return m_size;
+    }
+
+
+    void TermTableBuilder::RowAssigner::BinQueue::RecordFrequencies(
+        Accumulator & accumulator) const
+    {
+        for (auto const & bucket : m_buckets)
+        {
+            for (auto const & bin : bucket)
+            {
+                accumulator.Record(bin.GetFrequency(m_density));
+            }
+        }
+    }
+
+
+    size_t TermTableBuilder::RowAssigner::BinQueue::GetBucket(
+        double availableSpace) const
+    {
+        if (availableSpace <= 0.0)
+        {
+            return 0;
+        }
+
+        // Multiplication by a positive constant is monotonic, so bins in a
+        // higher bucket always have more space than bins in a lower one.
+        const double bucket = floor(availableSpace * m_bucketsPerUnitSpace);
+        return (bucket >= c_bucketCount) ?
+            c_bucketCount - 1 :
+            static_cast<size_t>(bucket);
+    }
+
+
+    size_t TermTableBuilder::RowAssigner::BinQueue::FindOccupiedBucket(
+        size_t bucket) const
+    {
+        if (bucket >= c_bucketCount)
+        {
+            return c_bucketCount;
+        }
+
+        size_t word = bucket >> 6;
+        uint64_t bits = m_occupied[word] & (~0ull << (bucket & 63));
+        while (bits == 0)
+        {
+            if (++word == m_occupied.size())
+            {
+                return c_bucketCount;
+            }
+            bits = m_occupied[word];
+        }
+
+        return (word << 6) + bsf(bits);
+    }
+
+
+    void TermTableBuilder::RowAssigner::BinQueue::Remove(size_t bucket,
+                                                         size_t position)
+    {
+        auto & bins = m_buckets[bucket];
+        bins[position] = bins.back();
+        bins.pop_back();
+        if (bins.empty())
+        {
+            m_occupied[bucket >> 6] &= ~(1ull << (bucket & 63));
+        }
+        --m_size;
+    }
 }
@@ -26,7 +26,6 @@
 #include <iterator>                             // typedef uses std::back_inserter_iterator.
 #include <map>                                  // std::map member.
 #include <memory>                               // std::unique_ptr member.
-#include <set>                                  // std::set member.
 #include <vector>                               // std::vector member.
 
 #include "BitFunnel/BitFunnelTypes.h"           // Rank parameter.
@@ -44,6 +43,19 @@ namespace BitFunnel
     class ITermTreatment;
     class ITermTable;
 
+    //*************************************************************************
+    //
+    // TermTableBuilder configures an ITermTable from an
+    // IDocumentFrequencyTable.
+    //
+    // The build has two phases. In the first phase, each rank's RowAssigner
+    // walks the entire IDocumentFrequencyTable and assigns rows to the terms
+    // that have entries at its rank. RowAssigners share no state, so the
+    // ranks are processed concurrently on up to threadCount threads. In the
+    // second phase, a single thread walks the terms again and records the
+    // assigned rows in the ITermTable, in the order the ITermTable requires.
+    //
+    //*************************************************************************
     class TermTableBuilder : public ITermTableBuilder
     {
     public:
@@ -53,7 +65,8 @@ namespace BitFunnel
                          IDocumentFrequencyTable const & terms,
                          IFactSet const & facts,
                          ITermTable & termTable,
-                         unsigned randomSkipDistance);
+                         unsigned randomSkipDistance,
+                         size_t threadCount);
 
         virtual void Print(std::ostream& output) const override;
 
@@ -86,9 +99,8 @@ namespace BitFunnel
         std::vector <std::unique_ptr<RowAssigner>> m_rowAssigners;
 
         double m_buildTime;
-
-        // Random number generator.
-        std::unique_ptr<RandomInt<unsigned>> m_random;
+        double m_assignmentTime;
+        size_t m_threadCount;
 
         class RowAssignment
         {
@@ -121,10 +133,19 @@ namespace BitFunnel
             RowAssigner(Rank rank,
                         double density,
                         ITermTable & termTable,
-                        RandomInt<unsigned>& random);
+                        unsigned randomSkipDistance);
 
-            void AssignExplicit(double frequency, RowIndex count);
-            void AssignAdhoc(double frequency, RowIndex count);
+            // First phase. Assigns rows for every term in terms that has an
+            // entry for this rank. Does not modify the ITermTable, so
+            // RowAssigners for different ranks may run concurrently.
+            void AssignTerms(IDocumentFrequencyTable const & terms,
+                             ITermTreatment const & treatment,
+                             double adhocFrequency);
+
+            // Second phase. Adds the RowIds assigned to the next explicit
+            // term with an entry at this rank to the ITermTable. Must be
+            // called for terms in the same order as AssignTerms() saw them.
+            void AddRowIds(double frequency, RowIndex count);
 
             RowIndex GetExplicitRowCount() const;
             RowIndex GetAdhocRowCount() const;
@@ -132,6 +153,13 @@ namespace BitFunnel
             void Print(std::ostream& output) const;
 
         private:
+            void AssignExplicit(double frequency, RowIndex count);
+            void AssignAdhoc(double frequency, RowIndex count);
+
+            // Returns the number of rows an explicit term with the given
+            // frequency and row count occupies at this rank.
+            RowIndex GetExplicitRowCount(double frequency, RowIndex count) const;
+
             // Constructor parameters.
             Rank m_rank;
             double m_density;
@@ -144,7 +172,13 @@ namespace BitFunnel
             RowIndex m_currentRow;
 
             class Bin;
-            std::set<Bin> m_bins;
+            class BinQueue;
+            std::unique_ptr<BinQueue> m_bins;
+
+            // Rows assigned to explicit terms, in term order. Filled by
+            // AssignTerms() and consumed by AddRowIds().
+            std::vector<RowIndex> m_explicitRows;
+            size_t m_nextExplicitRow;
 
             // If any termCount is > 0, then we consider this rank "in use" and
             // set the row count to be at least some minimum value..
@@ -158,7 +192,14 @@ namespace BitFunnel
 
             size_t m_privateExplicitRowCount;
 
-            RandomInt<unsigned>& m_random;
+            // Each RowAssigner has its own generator, seeded with its rank,
+            // so that the rows it assigns do not depend on thread scheduling.
+            // Rank 0 keeps the seed the shared generator used to have, but
+            // no longer sees draws made by other ranks, so shared explicit
+            // row placement differs from older builds whenever more than one
+            // rank has shared explicit rows. Row counts stay within about
+            // one percent.
+            RandomInt<unsigned> m_random;
 
 
             class Bin
@@ -212,6 +253,59 @@ namespace BitFunnel
                 double m_availableSpace;
                 RowIndex m_index;
             };
+
+
+            //*****************************************************************
+            //
+            // BinQueue holds the shared explicit rows that may still have
+            // space. It replaces a std::set<Bin> ordered by available space.
+            // Bins are kept in buckets on available space, quantized into
+            // c_bucketCount steps between 0 and the target density. A bitmap
+            // records which buckets are non-empty. A best-fit lookup checks
+            // the bucket that holds the requested frequency and then jumps to
+            // the next non-empty bucket. It does no per-bin allocation.
+            //
+            // TryRemoveBestFit() returns the same bin std::set<Bin> would:
+            // the one with the least available space that still fits the
+            // frequency. Ties go to the lower RowIndex. Density guarantees
+            // are therefore unchanged.
+            //
+            //*****************************************************************
+            class BinQueue
+            {
+            public:
+                BinQueue(double density);
+
+                // Removes the bin with the least available space that is at
+                // least frequency. Returns false if no bin has enough space.
+                bool TryRemoveBestFit(double frequency, Bin & bin);
+
+                void Insert(Bin const & bin);
+
+                size_t size() const;
+
+                // Records the frequency of each bin in accumulator.
+                void RecordFrequencies(Accumulator & accumulator) const;
+
+            private:
+                size_t GetBucket(double availableSpace) const;
+
+                // Returns the index of the first non-empty bucket at or after
+                // bucket, or c_bucketCount if there is none.
+                size_t FindOccupiedBucket(size_t bucket) const;
+
+                // Removes the bin at position in bucket.
+                void Remove(size_t bucket, size_t position);
+
+                static const size_t c_bucketCount = 4096;
+
+                const double m_density;
+                const double m_bucketsPerUnitSpace;
+
+                std::vector<std::vector<Bin>> m_buckets;
+                std::vector<uint64_t> m_occupied;
+                size_t m_size;
+            };
         };
     };
 }
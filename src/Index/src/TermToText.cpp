@@ -20,7 +20,12 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>                // std::copy(), std::sort().
+#include <vector>                   // std::vector embedded.
+
+#include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/Factories.h"
+#include "BinaryTableFormat.h"
 #include "CsvTsv/Csv.h"
 #include "TermToText.h"
 
@@ -40,6 +45,12 @@ namespace BitFunnel
 
     TermToText::TermToText(std::istream & input)
     {
+        if (BinaryTableFormat::IsBinary(input))
+        {
+            ReadBinary(input);
+            return;
+        }
+
         CsvTsv::CsvTableParser parser(input);
         CsvTsv::TableReader reader(parser);
 
@@ -96,6 +107,92 @@ namespace BitFunnel
     }
 
 
+    void TermToText::WriteBinary(std::ostream& output) const
+    {
+        std::vector<Term::Hash> hashes;
+        hashes.reserve(m_termToText.size());
+        size_t textBytes = 0;
+        for (auto & entry : m_termToText)
+        {
+            hashes.push_back(entry.first);
+            textBytes += entry.second.size();
+        }
+        std::sort(hashes.begin(), hashes.end());
+
+        const size_t count = hashes.size();
+        const size_t bytes =
+            count * sizeof(Term::Hash) + (count + 1) * sizeof(uint64_t) + textBytes;
+        std::vector<uint64_t> payload(BinaryTableFormat::QuadwordsFromBytes(bytes), 0);
+
+        Term::Hash * hashArray = reinterpret_cast<Term::Hash *>(payload.data());
+        uint64_t * offsets = reinterpret_cast<uint64_t *>(hashArray + count);
+        char * text = reinterpret_cast<char *>(offsets + count + 1);
+
+        uint64_t offset = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string const & value = m_termToText.find(hashes[i])->second;
+            hashArray[i] = hashes[i];
+            offsets[i] = offset;
+            std::copy(value.begin(), value.end(), text + offset);
+            offset += value.size();
+        }
+        offsets[count] = offset;
+
+        BinaryTableFormat::Write(output,
+                                 c_magic,
+                                 c_version,
+                                 count,
+                                 payload.data(),
+                                 bytes);
+    }
+
+
+    void TermToText::ReadBinary(std::istream & input)
+    {
+        std::vector<uint64_t> payload;
+        const size_t count =
+            BinaryTableFormat::Read(input, c_magic, c_version, payload);
+
+        // Bound count by division first so that a corrupt count cannot
+        // overflow the size of the hash and offset arrays.
+        const size_t available = payload.size() * sizeof(uint64_t);
+        const size_t bytesPerEntry = sizeof(Term::Hash) + sizeof(uint64_t);
+        if (available < sizeof(uint64_t) ||
+            count > (available - sizeof(uint64_t)) / bytesPerEntry)
+        {
+            RecoverableError error("TermToText: payload too small.");
+            throw error;
+        }
+
+        const size_t headerBytes =
+            count * sizeof(Term::Hash) + (count + 1) * sizeof(uint64_t);
+
+        Term::Hash const * hashes = reinterpret_cast<Term::Hash const *>(payload.data());
+        uint64_t const * offsets = reinterpret_cast<uint64_t const *>(hashes + count);
+        char const * text = reinterpret_cast<char const *>(offsets + count + 1);
+
+        if (offsets[count] > available - headerBytes)
+        {
+            RecoverableError error("TermToText: text out of range.");
+            throw error;
+        }
+
+        m_termToText.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (offsets[i] > offsets[i + 1])
+            {
+                RecoverableError error("TermToText: text out of range.");
+                throw error;
+            }
+
+            AddTerm(hashes[i],
+                    std::string(text + offsets[i], text + offsets[i + 1]));
+        }
+    }
+
+
     void TermToText::AddTerm(Term::Hash hash, std::string const & text)
     {
         auto it = m_termToText.find(hash);
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <iosfwd>                           // std::istream parameter.
+#include <stdint.h>                         // uint64_t constant.
 //#include <memory>                           // std::unique_ptr
 #include <string>                           // std::string embedded, template parameter.
 #include <unordered_map>                    // std::unordered_map embedded.
@@ -49,7 +50,8 @@ namespace BitFunnel
         // be added via AddTerm().
         TermToText();
 
-        // Constructs a map from data previously persisted via Write().
+        // Constructs a map from data previously persisted via Write() or
+        // WriteBinary().
         TermToText(std::istream & input);
 
         //
@@ -72,7 +74,18 @@ namespace BitFunnel
         //         is greater than 1.
         virtual void Write(std::ostream& output) const override;
 
+        // Persists the map to a stream in binary form (see
+        // BinaryTableFormat). The payload is a sorted array of Term::Hash,
+        // an array of count + 1 offsets into the text, and the text of all
+        // terms, concatenated.
+        virtual void WriteBinary(std::ostream& output) const override;
+
     private:
+        void ReadBinary(std::istream & input);
+
+        static const uint64_t c_magic = 0x0000545454464200ull;
+        static const uint32_t c_version = 1;
+
         // Empty string returned by Lookup() when hash is not in the map.
         // Implemented as a member because Lookup() returns a const reference.
         const std::string m_emptyString;
@@ -0,0 +1,389 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IDocumentFrequencyTable.h"
+#include "LoggerInterfaces/Check.h"
+#include "OptimalTermTreatments.h"
+#include "TermTreatmentSearch.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<ITermTreatmentSearch>
+        Factories::CreateTermTreatmentSearch(
+            IDocumentFrequencyTable const & terms,
+            double snr,
+            double bitsPerDocumentBudget,
+            Rank maxRank)
+    {
+        return std::unique_ptr<ITermTreatmentSearch>(
+            new TermTreatmentSearch(terms,
+                                    snr,
+                                    bitsPerDocumentBudget,
+                                    maxRank));
+    }
+
+
+    //*************************************************************************
+    //
+    // TermTreatmentSearch
+    //
+    //*************************************************************************
+    TermTreatmentSearch::TermTreatmentSearch(
+        IDocumentFrequencyTable const & terms,
+        double snr,
+        double bitsPerDocumentBudget,
+        Rank maxRank)
+      : m_snr(snr),
+        m_bitsPerDocumentBudget(bitsPerDocumentBudget),
+        m_maxRank(maxRank),
+        m_corpusTerms(Term::c_maxIdfX10Value + 1, 0),
+        m_queryTerms(Term::c_maxIdfX10Value + 1, 0),
+        m_queryCount(0)
+    {
+        // Analyze() encodes configurations as 6 decimal digits.
+        CHECK_LE(maxRank, 5u)
+            << "TermTreatmentSearch: maxRank must not exceed 5.";
+
+        for (auto const & entry : terms)
+        {
+            const Term::IdfX10 idf =
+                Term::ComputeIdfX10(entry.GetFrequency(),
+                                    Term::c_maxIdfX10Value);
+            ++m_corpusTerms[idf];
+        }
+    }
+
+
+    void TermTreatmentSearch::AddQuery(std::vector<Term> const & terms)
+    {
+        for (auto const & term : terms)
+        {
+            const Term::IdfX10 idf =
+                (std::min)(term.GetIdfSum(), Term::c_maxIdfX10Value);
+            ++m_queryTerms[idf];
+        }
+        ++m_queryCount;
+    }
+
+
+    void TermTreatmentSearch::Search(std::vector<double> const & densities)
+    {
+        for (auto density : densities)
+        {
+            bool isFeasible = true;
+            std::vector<std::vector<Choice>> choices(Term::c_maxIdfX10Value + 1);
+
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                const double signal = Term::IdfX10ToFrequency(idf);
+
+                // As in TreatmentOptimal, terms at least as frequent as the
+                // density get a private rank 0 row, which costs one bit per
+                // document and one quadword per iteration.
+                if (signal < density)
+                {
+                    FindChoices(density, signal, choices[idf]);
+                }
+                if (choices[idf].empty())
+                {
+                    isFeasible = isFeasible && !(signal < density);
+                    choices[idf].push_back(Choice(1, 1.0, 1.0));
+                }
+            }
+
+            std::vector<size_t> configurations;
+            double quadwords = 0.0;
+            double bits = 0.0;
+            Pick(choices, 0.0, configurations, quadwords, bits);
+
+            if (m_bitsPerDocumentBudget > 0.0 && bits > m_bitsPerDocumentBudget)
+            {
+                // Total bits do not increase with lambda. Double lambda until
+                // the budget is met, then bisect for the smallest lambda, and
+                // hence the fewest quadwords, which still meets it. If even
+                // the largest lambda, which picks the fewest bits for every
+                // idf, exceeds the budget, no configuration can meet it.
+                const unsigned c_maxDoublings = 100;
+                const unsigned c_bisections = 50;
+
+                double low = 0.0;
+                double high = 1.0;
+                for (unsigned i = 0; i < c_maxDoublings; ++i)
+                {
+                    Pick(choices, high, configurations, quadwords, bits);
+                    if (bits <= m_bitsPerDocumentBudget)
+                    {
+                        break;
+                    }
+                    low = high;
+                    high *= 2.0;
+                }
+
+                if (bits > m_bitsPerDocumentBudget)
+                {
+                    isFeasible = false;
+                }
+                else
+                {
+                    std::vector<size_t> middleConfigurations;
+                    double middleQuadwords;
+                    double middleBits;
+                    for (unsigned i = 0; i < c_bisections; ++i)
+                    {
+                        const double middle = (low + high) / 2.0;
+                        Pick(choices,
+                             middle,
+                             middleConfigurations,
+                             middleQuadwords,
+                             middleBits);
+                        if (middleBits <= m_bitsPerDocumentBudget)
+                        {
+                            high = middle;
+                            configurations.swap(middleConfigurations);
+                            quadwords = middleQuadwords;
+                            bits = middleBits;
+                        }
+                        else
+                        {
+                            low = middle;
+                        }
+                    }
+                }
+            }
+
+            m_candidates.push_back(Candidate(density, isFeasible, quadwords, bits));
+            m_configurations.push_back(configurations);
+        }
+    }
+
+
+    size_t TermTreatmentSearch::GetCandidateCount() const
+    {
+        return m_candidates.size();
+    }
+
+
+    ITermTreatmentSearch::Candidate const &
+        TermTreatmentSearch::GetCandidate(size_t index) const
+    {
+        CHECK_LT(index, m_candidates.size())
+            << "TermTreatmentSearch: candidate index out of range.";
+        return m_candidates[index];
+    }
+
+
+    size_t TermTreatmentSearch::GetBestCandidate() const
+    {
+        size_t best = m_candidates.size();
+        for (size_t i = 0; i < m_candidates.size(); ++i)
+        {
+            auto const & candidate = m_candidates[i];
+            if (candidate.IsFeasible() &&
+                (best == m_candidates.size() ||
+                 candidate.GetQuadwordsPerQuery() <
+                 m_candidates[best].GetQuadwordsPerQuery()))
+            {
+                best = i;
+            }
+        }
+
+        if (best == m_candidates.size())
+        {
+            RecoverableError
+                error("TermTreatmentSearch: no candidate meets the SNR and memory constraints.");
+            throw error;
+        }
+
+        return best;
+    }
+
+
+    std::unique_ptr<ITermTreatment>
+        TermTreatmentSearch::CreateTreatment(size_t index) const
+    {
+        CHECK_LT(index, m_configurations.size())
+            << "TermTreatmentSearch: candidate index out of range.";
+
+        std::vector<RowConfiguration> configurations;
+        for (auto configuration : m_configurations[index])
+        {
+            configurations.push_back(RowConfigurationFromSizeT(configuration));
+        }
+
+        return std::unique_ptr<ITermTreatment>(
+            new TreatmentTable(configurations));
+    }
+
+
+    void TermTreatmentSearch::Print(std::ostream& output) const
+    {
+        output
+            << "Queries: " << m_queryCount
+            << ", SNR floor: " << m_snr
+            << ", max rank: " << m_maxRank;
+        if (m_bitsPerDocumentBudget > 0.0)
+        {
+            output << ", bits/document budget: " << m_bitsPerDocumentBudget;
+        }
+        output << std::endl;
+
+        for (auto const & candidate : m_candidates)
+        {
+            output
+                << "density " << std::setprecision(3) << candidate.GetDensity()
+                << std::setprecision(6)
+                << ": quadwords/query " << candidate.GetQuadwordsPerQuery()
+                << ", bits/document " << candidate.GetBitsPerDocument()
+                << (candidate.IsFeasible() ? "" : " (infeasible)")
+                << std::endl;
+        }
+    }
+
+
+    void TermTreatmentSearch::FindChoices(double density,
+                                          double signal,
+                                          std::vector<Choice>& choices) const
+    {
+        size_t limit = 10;
+        for (Rank r = 0; r < m_maxRank; ++r)
+        {
+            limit *= 10;
+        }
+
+        std::vector<Choice> candidates;
+        for (size_t configuration = 1; configuration < limit; ++configuration)
+        {
+            auto result = Analyze(configuration, density, signal, false);
+            if (result.first && result.second.GetSNR() >= m_snr)
+            {
+                candidates.push_back(Choice(configuration,
+                                            result.second.GetQuadwords(),
+                                            result.second.GetBits()));
+            }
+        }
+
+        std::sort(candidates.begin(),
+                  candidates.end(),
+                  [](Choice const & a, Choice const & b)
+                  {
+                      return a.m_bits < b.m_bits ||
+                          (a.m_bits == b.m_bits && a.m_quadwords < b.m_quadwords);
+                  });
+
+        // After sorting by bits, a choice is worth keeping only if it reads
+        // fewer quadwords than every choice with fewer bits.
+        for (auto const & candidate : candidates)
+        {
+            if (choices.empty() ||
+                candidate.m_quadwords < choices.back().m_quadwords)
+            {
+                choices.push_back(candidate);
+            }
+        }
+    }
+
+
+    void TermTreatmentSearch::Pick(
+        std::vector<std::vector<Choice>> const & choices,
+        double lambda,
+        std::vector<size_t>& configurations,
+        double& quadwords,
+        double& bits) const
+    {
+        configurations.clear();
+        quadwords = 0.0;
+        bits = 0.0;
+
+        const double queryCount =
+            static_cast<double>((std::max)(m_queryCount, static_cast<size_t>(1)));
+
+        for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+        {
+            const double queryTerms = m_queryTerms[idf] / queryCount;
+            const double corpusTerms = static_cast<double>(m_corpusTerms[idf]);
+
+            // Choices are ordered by increasing bits, so ties go to the
+            // choice with fewer bits.
+            Choice const * best = nullptr;
+            double bestCost = std::numeric_limits<double>::infinity();
+            for (auto const & choice : choices[idf])
+            {
+                const double cost = queryTerms * choice.m_quadwords +
+                    lambda * corpusTerms * choice.m_bits;
+                if (best == nullptr || cost < bestCost)
+                {
+                    best = &choice;
+                    bestCost = cost;
+                }
+            }
+
+            quadwords += queryTerms * best->m_quadwords;
+            bits += corpusTerms * best->m_bits;
+            configurations.push_back(best->m_configuration);
+        }
+    }
+
+
+    //*************************************************************************
+    //
+    // TermTreatmentSearch::Choice
+    //
+    //*************************************************************************
+    TermTreatmentSearch::Choice::Choice(size_t configuration,
+                                        double quadwords,
+                                        double bits)
+      : m_configuration(configuration),
+        m_quadwords(quadwords),
+        m_bits(bits)
+    {
+    }
+
+
+    //*************************************************************************
+    //
+    // TreatmentTable
+    //
+    //*************************************************************************
+    TreatmentTable::TreatmentTable(
+        std::vector<RowConfiguration> const & configurations)
+      : m_configurations(configurations)
+    {
+        CHECK_EQ(m_configurations.size(), Term::c_maxIdfX10Value + 1u)
+            << "TreatmentTable: expected one configuration per IdfX10 value.";
+    }
+
+
+    RowConfiguration TreatmentTable::GetTreatment(Term term) const
+    {
+        auto local = Term::c_maxIdfX10Value;
+        Term::IdfX10 idf = std::min(term.GetIdfSum(), local);
+        return m_configurations[idf];
+    }
+}
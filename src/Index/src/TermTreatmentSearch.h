@@ -0,0 +1,157 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>                                 // size_t member.
+#include <vector>                                   // std::vector member.
+
+#include "BitFunnel/Index/ITermTreatment.h"         // Base class.
+#include "BitFunnel/Index/ITermTreatmentSearch.h"   // Base class.
+#include "BitFunnel/NonCopyable.h"                  // Base class.
+
+
+namespace BitFunnel
+{
+    class IDocumentFrequencyTable;
+
+    //*************************************************************************
+    //
+    // TermTreatmentSearch
+    //
+    // ITermTreatmentSearch that scores each candidate density with the
+    // TermTreatmentMetrics computed by Analyze(). Only the idf of a term
+    // enters the model, so the corpus and the query log are reduced to
+    // histograms of term counts by idf.
+    //
+    // The quadword estimate for a query is the sum of the estimates for its
+    // terms. It ignores the short circuiting between terms, so it is an
+    // upper bound that ranks candidates rather than predicting the matcher's
+    // exact cost.
+    //
+    // With a memory budget, the configurations are chosen together rather
+    // than one idf at a time. Each idf contributes its quadwords plus a
+    // multiplier lambda times its bits, and lambda is raised until the
+    // total fits the budget. This trades quadwords for bits where they are
+    // cheapest, i.e. at idfs which are common in the corpus but rare in the
+    // query log.
+    //
+    //*************************************************************************
+    class TermTreatmentSearch : public ITermTreatmentSearch, NonCopyable
+    {
+    public:
+        // Row configurations with rows above maxRank are not considered.
+        // A bitsPerDocumentBudget of zero means no budget.
+        TermTreatmentSearch(IDocumentFrequencyTable const & terms,
+                            double snr,
+                            double bitsPerDocumentBudget,
+                            Rank maxRank);
+
+        //
+        // ITermTreatmentSearch methods.
+        //
+        virtual void AddQuery(std::vector<Term> const & terms) override;
+        virtual void Search(std::vector<double> const & densities) override;
+        virtual size_t GetCandidateCount() const override;
+        virtual Candidate const & GetCandidate(size_t index) const override;
+        virtual size_t GetBestCandidate() const override;
+        virtual std::unique_ptr<ITermTreatment>
+            CreateTreatment(size_t index) const override;
+        virtual void Print(std::ostream& output) const override;
+
+    private:
+        // A row configuration in the format used by Analyze(), with the
+        // expected quadwords per iteration and bits per document for one
+        // term.
+        class Choice
+        {
+        public:
+            Choice(size_t configuration, double quadwords, double bits);
+
+            size_t m_configuration;
+            double m_quadwords;
+            double m_bits;
+        };
+
+        // Appends the configurations which meet the SNR floor and which are
+        // not beaten in both quadwords and bits by another configuration.
+        // They are ordered by increasing bits and decreasing quadwords.
+        // Appends nothing if no configuration meets the SNR floor.
+        void FindChoices(double density,
+                         double signal,
+                         std::vector<Choice>& choices) const;
+
+        // Picks, for each IdfX10 value, the choice which minimizes the
+        // expected quadwords per query plus lambda times the bits per
+        // document, and returns the totals of both.
+        void Pick(std::vector<std::vector<Choice>> const & choices,
+                  double lambda,
+                  std::vector<size_t>& configurations,
+                  double& quadwords,
+                  double& bits) const;
+
+        //
+        // Constructor parameters.
+        //
+        const double m_snr;
+        const double m_bitsPerDocumentBudget;
+        const Rank m_maxRank;
+
+        //
+        // Other members.
+        //
+
+        // Number of corpus terms and query terms with each IdfX10 value.
+        std::vector<size_t> m_corpusTerms;
+        std::vector<size_t> m_queryTerms;
+        size_t m_queryCount;
+
+        std::vector<Candidate> m_candidates;
+
+        // For each candidate, the configuration chosen for each IdfX10
+        // value, in the format used by Analyze().
+        std::vector<std::vector<size_t>> m_configurations;
+    };
+
+
+    //*************************************************************************
+    //
+    // TreatmentTable
+    //
+    // ITermTreatment that looks up the RowConfiguration for a term by its
+    // IdfX10 value.
+    //
+    //*************************************************************************
+    class TreatmentTable : public ITermTreatment
+    {
+    public:
+        TreatmentTable(std::vector<RowConfiguration> const & configurations);
+
+        //
+        // ITermTreatment methods.
+        //
+        virtual RowConfiguration GetTreatment(Term term) const override;
+
+    private:
+        std::vector<RowConfiguration> m_configurations;
+    };
+}
@@ -0,0 +1,182 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitStatistics.h"
+
+
+namespace BitFunnel
+{
+    namespace BitStatisticsTest
+    {
+        static bool GetBit(uint64_t const * data, size_t bit)
+        {
+            return (data[bit / 64] & (1ull << (bit % 64))) != 0;
+        }
+
+
+        // Random quadwords with roughly the given fraction of bits set.
+        static std::vector<uint64_t> RandomRow(std::mt19937_64 & random,
+                                               size_t quadwordCount,
+                                               double density)
+        {
+            std::bernoulli_distribution bit(density);
+            std::vector<uint64_t> row(quadwordCount, 0);
+            for (size_t i = 0; i < 64 * quadwordCount; ++i)
+            {
+                if (bit(random))
+                {
+                    row[i / 64] |= 1ull << (i % 64);
+                }
+            }
+            return row;
+        }
+
+
+        // Lengths straddle the 4-quadword vectors and the 64-quadword
+        // Harley-Seal blocks, so that both the AVX2 and the POPCNT paths run.
+        static const size_t c_lengths[] = { 0, 1, 3, 4, 63, 64, 65, 200, 256 };
+
+
+        TEST(BitStatistics, PopCount)
+        {
+            std::mt19937_64 random(1);
+            for (auto length : c_lengths)
+            {
+                for (double density : { 0.0, 0.1, 0.5, 1.0 })
+                {
+                    auto row = RandomRow(random, length, density);
+                    size_t expected = 0;
+                    for (size_t bit = 0; bit < 64 * length; ++bit)
+                    {
+                        expected += GetBit(row.data(), bit) ? 1 : 0;
+                    }
+                    EXPECT_EQ(BitStatistics::PopCount(row.data(), length),
+                              expected);
+                }
+            }
+        }
+
+
+        TEST(BitStatistics, PopCountMasked)
+        {
+            std::mt19937_64 random(2);
+            for (auto length : c_lengths)
+            {
+                // Higher rank rows cover 2^rank rank 0 quadwords apiece.
+                const size_t rankLength = length + 64;
+                for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+                {
+                    auto row = RandomRow(random, rankLength, 0.3);
+                    auto mask = RandomRow(random, length, 0.7);
+
+                    size_t expected = 0;
+                    for (size_t doc = 0; doc < 64 * length; ++doc)
+                    {
+                        const size_t rowBit =
+                            ((doc >> (6 + rank)) << 6) | (doc % 64);
+                        if (GetBit(mask.data(), doc) &&
+                            GetBit(row.data(), rowBit))
+                        {
+                            ++expected;
+                        }
+                    }
+
+                    EXPECT_EQ(BitStatistics::PopCountMasked(row.data(),
+                                                            rank,
+                                                            mask.data(),
+                                                            length),
+                              expected)
+                        << "length " << length << ", rank " << rank;
+                }
+            }
+        }
+
+
+        TEST(BitStatistics, Transpose)
+        {
+            std::mt19937_64 random(3);
+            auto original = RandomRow(random, 64, 0.5);
+            auto block = original;
+            BitStatistics::Transpose(block.data());
+
+            for (size_t i = 0; i < 64; ++i)
+            {
+                for (size_t j = 0; j < 64; ++j)
+                {
+                    EXPECT_EQ(GetBit(block.data(), 64 * j + i),
+                              GetBit(original.data(), 64 * i + j));
+                }
+            }
+        }
+
+
+        TEST(BitStatistics, AddColumnCounts)
+        {
+            std::mt19937_64 random(4);
+            const size_t c_quadwordCount = 16;
+
+            for (Rank rank = 0; rank <= 3; ++rank)
+            {
+                // Row counts on both sides of the 64-row transpose blocks.
+                for (size_t rowCount : { 1, 63, 64, 150 })
+                {
+                    std::vector<std::vector<uint64_t>> rowData;
+                    std::vector<uint64_t const *> rows;
+                    for (size_t row = 0; row < rowCount; ++row)
+                    {
+                        rowData.push_back(
+                            RandomRow(random, c_quadwordCount >> rank, 0.2));
+                    }
+                    for (auto const & row : rowData)
+                    {
+                        rows.push_back(row.data());
+                    }
+
+                    for (size_t quadword = 0; quadword < c_quadwordCount; ++quadword)
+                    {
+                        uint32_t counts[64] = {};
+                        BitStatistics::AddColumnCounts(rows, rank, quadword, counts);
+
+                        for (size_t bit = 0; bit < 64; ++bit)
+                        {
+                            uint32_t expected = 0;
+                            for (auto row : rows)
+                            {
+                                if (GetBit(row, 64 * (quadword >> rank) + bit))
+                                {
+                                    ++expected;
+                                }
+                            }
+                            EXPECT_EQ(counts[bit], expected);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,110 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Correlate.h"
+
+
+namespace BitFunnel
+{
+    namespace CorrelateTest
+    {
+        typedef std::map<std::pair<Term::Hash, Term::Hash>, size_t> PairCounts;
+
+
+        static PairCounts GetCounts(CollisionTable const & table)
+        {
+            PairCounts counts;
+            auto const & entries = table.GetEntries();
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                if (i > 0)
+                {
+                    // Entries must be sorted and collapsed.
+                    EXPECT_TRUE(entries[i - 1].m_left < entries[i].m_left ||
+                                (entries[i - 1].m_left == entries[i].m_left &&
+                                 entries[i - 1].m_right < entries[i].m_right));
+                }
+                counts[std::make_pair(entries[i].m_left, entries[i].m_right)] =
+                    entries[i].m_count;
+            }
+            return counts;
+        }
+
+
+        TEST(CollisionTable, Counts)
+        {
+            CollisionTable table;
+
+            // Terms 1 and 2 share 300 rows, which would overflow an 8-bit
+            // counter. Term 3 shares one of them.
+            for (size_t row = 0; row < 300; ++row)
+            {
+                table.AddRow({ 1, 2 });
+            }
+            table.AddRow({ 1, 2, 3 });
+            table.AddRow({ 4 });
+            table.Seal();
+
+            PairCounts expected;
+            expected[std::make_pair(1, 2)] = 301;
+            expected[std::make_pair(2, 1)] = 301;
+            expected[std::make_pair(1, 3)] = 1;
+            expected[std::make_pair(3, 1)] = 1;
+            expected[std::make_pair(2, 3)] = 1;
+            expected[std::make_pair(3, 2)] = 1;
+
+            EXPECT_EQ(GetCounts(table), expected);
+        }
+
+
+        // Splitting rows across tables and merging must give the same counts
+        // as adding every row to one table.
+        TEST(CollisionTable, Merge)
+        {
+            CollisionTable all;
+            std::vector<CollisionTable> parts(3);
+
+            for (Term::Hash row = 0; row < 1000; ++row)
+            {
+                std::vector<Term::Hash> hashes = { row % 7, 7 + row % 5, 12 + row % 3 };
+                all.AddRow(hashes);
+                parts[row % parts.size()].AddRow(hashes);
+            }
+            all.Seal();
+
+            CollisionTable merged;
+            for (auto & part : parts)
+            {
+                merged.Merge(part);
+            }
+
+            EXPECT_EQ(GetCounts(merged), GetCounts(all));
+        }
+    }
+}
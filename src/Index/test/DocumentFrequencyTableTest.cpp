@@ -135,5 +135,38 @@ namespace BitFunnel
                 EXPECT_EQ(observed, expected);
             }
         }
+
+
+        // Write DocumentFrequencyTable to stream in binary form, then
+        // construct new DocumentFrequencyTable from stream and verify
+        // contents.
+        TEST(DocumentFrequencyTable, BinaryRoundTrip)
+        {
+            DocumentFrequencyTable terms;
+
+            Term::Hash maxHash = 100;
+            for (Term::Hash hash = 0; hash < maxHash; ++hash)
+            {
+                terms.AddEntry(MakeEntry(hash));
+            }
+
+            std::stringstream stream;
+            terms.WriteBinary(stream);
+
+            DocumentFrequencyTable terms2(stream);
+            ASSERT_EQ(terms2.size(), terms.size());
+
+            // WriteBinary() sorted terms, so the order must match.
+            for (size_t i = 0; i < terms.size(); ++i)
+            {
+                EXPECT_EQ(terms2[i], terms[i]);
+            }
+
+            // A corrupted payload must be detected.
+            std::string bytes = stream.str();
+            bytes[bytes.size() - 1] ^= 1;
+            std::stringstream corrupted(bytes);
+            EXPECT_ANY_THROW(DocumentFrequencyTable terms3(corrupted));
+        }
     }
 }
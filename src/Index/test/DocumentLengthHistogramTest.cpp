@@ -57,5 +57,46 @@ namespace BitFunnel
         ASSERT_EQ("Postings,Count\n0,1\n3,2\n5,1\n", stream.str());
     }
 
+
+    //*********************************************************************
+    TEST(DocumentHistogramBuilder, Decay)
+    {
+        DocumentHistogramBuilder testHistogram;
+        testHistogram.AddDocument(3);
+        for (size_t i = 0; i < 5; ++i)
+        {
+            testHistogram.AddDocument(7);
+        }
+
+        testHistogram.Decay();
+        EXPECT_EQ(testHistogram.GetValue(3), 0u);
+        EXPECT_EQ(testHistogram.GetValue(7), 2u);
+        EXPECT_EQ(testHistogram.GetPostingCount(), 14u);
+
+        testHistogram.AddDocument(3);
+        std::stringstream stream;
+        testHistogram.Write(stream);
+        EXPECT_EQ("Postings,Count\n3,1\n7,2\n", stream.str());
+    }
+
+    //*********************************************************************
+    TEST(DocumentHistogramBuilder, RemoveDocument)
+    {
+        DocumentHistogramBuilder testHistogram;
+        testHistogram.AddDocument(3);
+        testHistogram.AddDocument(3);
+        testHistogram.AddDocument(5);
+
+        testHistogram.RemoveDocument(3);
+        testHistogram.RemoveDocument(5);
+        testHistogram.RemoveDocument(7);
+        EXPECT_EQ(testHistogram.GetValue(3), 1u);
+        EXPECT_EQ(testHistogram.GetPostingCount(), 3u);
+
+        std::stringstream stream;
+        testHistogram.Write(stream);
+        EXPECT_EQ("Postings,Count\n3,1\n", stream.str());
+    }
+
         // TODO: Implement and test file read/write.
 }
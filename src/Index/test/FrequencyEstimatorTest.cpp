@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FrequencyEstimator.h"
+
+
+namespace BitFunnel
+{
+    namespace FrequencyEstimatorTest
+    {
+        // With the whole corpus counted, the estimate is the observed
+        // frequency and the bounds collapse onto it.
+        TEST(FrequencyEstimator, FullCorpus)
+        {
+            const size_t documentCount = 1000;
+            std::vector<size_t> countOfCounts = { 0, 100, 10, 1 };
+            FrequencyEstimator estimator(documentCount, 1.0, countOfCounts);
+
+            for (uint64_t count = 0; count <= 20; ++count)
+            {
+                const double expected =
+                    static_cast<double>(count) / documentCount;
+                EXPECT_DOUBLE_EQ(expected, estimator.GetFrequency(count));
+                EXPECT_DOUBLE_EQ(expected, estimator.GetLowerBound(count));
+                EXPECT_DOUBLE_EQ(expected, estimator.GetUpperBound(count));
+            }
+        }
+
+
+        // Rare terms are discounted by the Good-Turing correction, which
+        // never raises a count and never reorders counts.
+        TEST(FrequencyEstimator, RareTermCorrection)
+        {
+            const size_t documentCount = 1000;
+            std::vector<size_t> countOfCounts = { 0, 400, 100, 60, 20, 18, 9 };
+            FrequencyEstimator estimator(documentCount, 0.1, countOfCounts);
+
+            // k* = 2 * 100 / 400 = 0.5.
+            EXPECT_DOUBLE_EQ(0.5 / documentCount, estimator.GetFrequency(1));
+
+            // k* = 3 * 60 / 100 = 1.8.
+            EXPECT_DOUBLE_EQ(1.8 / documentCount, estimator.GetFrequency(2));
+
+            // k* = 4 * 20 / 60 = 1.33 is clamped to the estimate for 2.
+            EXPECT_DOUBLE_EQ(1.8 / documentCount, estimator.GetFrequency(3));
+
+            // Counts beyond c_maxCorrectedCount are not corrected.
+            const uint64_t large = FrequencyEstimator::c_maxCorrectedCount + 1;
+            EXPECT_DOUBLE_EQ(static_cast<double>(large) / documentCount,
+                             estimator.GetFrequency(large));
+
+            double previous = 0.0;
+            for (uint64_t count = 0; count <= 20; ++count)
+            {
+                const double frequency = estimator.GetFrequency(count);
+                EXPECT_LE(frequency,
+                          static_cast<double>(count) / documentCount);
+                EXPECT_GE(frequency, previous);
+                previous = frequency;
+            }
+        }
+
+
+        // The bounds bracket the estimate and narrow as the sampling rate
+        // grows.
+        TEST(FrequencyEstimator, Bounds)
+        {
+            const size_t documentCount = 1000;
+            std::vector<size_t> countOfCounts;
+
+            double previousWidth = 1.0;
+            for (double rate : { 0.01, 0.1, 0.5, 0.9 })
+            {
+                FrequencyEstimator estimator(documentCount, rate, countOfCounts);
+                const uint64_t count = 50;
+                const double frequency = estimator.GetFrequency(count);
+                const double lower = estimator.GetLowerBound(count);
+                const double upper = estimator.GetUpperBound(count);
+
+                EXPECT_GT(lower, 0.0);
+                EXPECT_LT(lower, frequency);
+                EXPECT_GT(upper, frequency);
+                EXPECT_LT(upper, 1.0);
+
+                const double width = upper - lower;
+                EXPECT_LT(width, previousWidth);
+                previousWidth = width;
+            }
+        }
+    }
+}
@@ -0,0 +1,243 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/StreamUtilities.h"
+#include "IndexedIdfTable.h"
+
+
+namespace BitFunnel
+{
+    namespace IndexedIdfTableTest
+    {
+        const Term::IdfX10 c_defaultIdf = 60;
+
+        static Term::IdfX10 IdfFromHash(Term::Hash hash)
+        {
+            return static_cast<Term::IdfX10>(hash % 50);
+        }
+
+
+        TEST(IndexedIdfTable, RoundTrip)
+        {
+            // Hashes are added in decreasing order to check that Write()
+            // sorts them.
+            std::vector<IndexedIdfTable::Entry> entries;
+            for (Term::Hash i = 0; i <= 333; ++i)
+            {
+                const Term::Hash hash = 1000 - 3 * i;
+                entries.push_back(std::make_pair(hash, IdfFromHash(hash)));
+            }
+
+            // Only the first entry for a hash is kept.
+            entries.push_back(std::make_pair(1000ull, Term::IdfX10(1)));
+
+            std::stringstream stream;
+            IndexedIdfTable::Write(stream, entries);
+            IndexedIdfTable table(stream, c_defaultIdf);
+
+            for (Term::Hash hash = 0; hash <= 1000; ++hash)
+            {
+                const Term::IdfX10 expected =
+                    ((1000 - hash) % 3 == 0) ?
+                        IdfFromHash(hash) :
+                        c_defaultIdf;
+                EXPECT_EQ(table.GetIdf(hash), expected);
+            }
+        }
+
+
+        // Tables written in the older format (an entry count followed by
+        // (hash, idf) pairs) must still load.
+        TEST(IndexedIdfTable, OlderFormat)
+        {
+            std::stringstream stream;
+            StreamUtilities::WriteField<size_t>(stream, 3);
+            for (Term::Hash hash : { 7ull, 3ull, 5ull })
+            {
+                StreamUtilities::WriteField<Term::Hash>(stream, hash);
+                StreamUtilities::WriteField<Term::IdfX10>(stream, IdfFromHash(hash));
+            }
+
+            IndexedIdfTable table(stream, c_defaultIdf);
+            EXPECT_EQ(table.GetIdf(3), IdfFromHash(3));
+            EXPECT_EQ(table.GetIdf(5), IdfFromHash(5));
+            EXPECT_EQ(table.GetIdf(7), IdfFromHash(7));
+            EXPECT_EQ(table.GetIdf(4), c_defaultIdf);
+
+            // Rewriting converts to the binary form.
+            std::stringstream converted;
+            table.Write(converted);
+            IndexedIdfTable table2(converted, c_defaultIdf);
+            EXPECT_EQ(table2.GetIdf(5), IdfFromHash(5));
+            EXPECT_EQ(table2.GetIdf(4), c_defaultIdf);
+        }
+
+
+        class VectorSource : public IndexedIdfTable::IEntrySource
+        {
+        public:
+            VectorSource(std::vector<IndexedIdfTable::Entry> const & entries)
+              : m_entries(entries),
+                m_position(0)
+            {
+            }
+
+            virtual void Reset() override
+            {
+                m_position = 0;
+            }
+
+            virtual bool Next(IndexedIdfTable::Entry & entry) override
+            {
+                if (m_position == m_entries.size())
+                {
+                    return false;
+                }
+                entry = m_entries[m_position++];
+                return true;
+            }
+
+        private:
+            std::vector<IndexedIdfTable::Entry> const & m_entries;
+            size_t m_position;
+        };
+
+
+        // The streaming Write() must produce the same bytes as the
+        // in-memory Write(). Entry counts are chosen so that the payload
+        // checksum sees both whole quadwords and a partial final quadword.
+        TEST(IndexedIdfTable, StreamingWrite)
+        {
+            for (Term::Hash count : { 1ull, 8ull, 13ull, 334ull })
+            {
+                std::vector<IndexedIdfTable::Entry> entries;
+                for (Term::Hash hash = 0; hash < count; ++hash)
+                {
+                    entries.push_back(std::make_pair(3 * hash, IdfFromHash(hash)));
+                    if (hash % 5 == 0)
+                    {
+                        // Only the first entry for a hash is kept.
+                        entries.push_back(std::make_pair(3 * hash, Term::IdfX10(1)));
+                    }
+                }
+
+                std::stringstream expected;
+                IndexedIdfTable::Write(expected, entries);
+
+                VectorSource source(entries);
+                std::stringstream streamed;
+                IndexedIdfTable::Write(streamed, source);
+
+                EXPECT_EQ(streamed.str(), expected.str());
+
+                IndexedIdfTable table(streamed, c_defaultIdf);
+                for (Term::Hash hash = 0; hash < count; ++hash)
+                {
+                    EXPECT_EQ(table.GetIdf(3 * hash), IdfFromHash(hash));
+                    EXPECT_EQ(table.GetIdf(3 * hash + 1), c_defaultIdf);
+                }
+            }
+        }
+
+
+        // Offsets of header fields in the binary form.
+        const size_t c_entryCountOffset = 16;
+        const size_t c_payloadBytesOffset = 24;
+        const size_t c_headerBytes = 40;
+
+
+        static std::string WriteTable(Term::Hash count)
+        {
+            std::vector<IndexedIdfTable::Entry> entries;
+            for (Term::Hash hash = 0; hash < count; ++hash)
+            {
+                entries.push_back(std::make_pair(hash, IdfFromHash(hash)));
+            }
+
+            std::stringstream stream;
+            IndexedIdfTable::Write(stream, entries);
+            return stream.str();
+        }
+
+
+        static void SetHeaderField(std::string & table,
+                                   size_t offset,
+                                   uint64_t value)
+        {
+            std::memcpy(&table[offset], &value, sizeof(value));
+        }
+
+
+        // Every truncation, whether in the header or in the payload, must
+        // be reported as a RecoverableError.
+        TEST(IndexedIdfTable, Truncated)
+        {
+            const std::string table = WriteTable(100);
+            ASSERT_GT(table.size(), c_headerBytes);
+
+            for (size_t length = sizeof(uint64_t); length < table.size(); ++length)
+            {
+                std::stringstream stream(table.substr(0, length));
+                EXPECT_THROW(IndexedIdfTable(stream, c_defaultIdf),
+                             RecoverableError);
+            }
+        }
+
+
+        // A header that claims more payload than the file holds must be
+        // rejected before the payload is allocated, and an entry count
+        // too large for the payload must not overflow the size check.
+        TEST(IndexedIdfTable, OversizedHeader)
+        {
+            const std::string table = WriteTable(100);
+
+            for (uint64_t payloadBytes : { 1ull << 40, ~0ull - 3, ~0ull })
+            {
+                std::string corrupt = table;
+                SetHeaderField(corrupt, c_payloadBytesOffset, payloadBytes);
+                std::stringstream stream(corrupt);
+                EXPECT_THROW(IndexedIdfTable(stream, c_defaultIdf),
+                             RecoverableError);
+            }
+
+            // Entries are 9 bytes, so 0x1c71c71c71c71c72 entries wrap around
+            // to a 2 byte payload.
+            for (uint64_t entryCount : { 101ull, 0x1c71c71c71c71c72ull, ~0ull })
+            {
+                std::string corrupt = table;
+                SetHeaderField(corrupt, c_entryCountOffset, entryCount);
+                std::stringstream stream(corrupt);
+                EXPECT_THROW(IndexedIdfTable(stream, c_defaultIdf),
+                             RecoverableError);
+            }
+        }
+    }
+}
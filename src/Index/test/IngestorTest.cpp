@@ -22,16 +22,23 @@
 
 
 #include <cmath>
+#include <string>
 #include <limits>
 #include <memory>
+#include <sstream>
 #include <vector>
 #include <unordered_map>
 
 #include "gtest/gtest.h"
 
 #include "BitFunnel/BitFunnelTypes.h"
+#include "BitFunnel/Chunks/Factories.h"
 #include "BitFunnel/Configuration/IFileSystem.h"
 #include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IDocument.h"
 #include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/IShard.h"
 #include "BitFunnel/Index/ISimpleIndex.h"
@@ -39,7 +46,11 @@
 #include "BitFunnel/Mocks/Factories.h"
 #include "BitFunnel/Term.h"
 #include "DocumentFrequencyTable.h"
+#include "DocumentHandleInternal.h"
 #include "Primes.h"
+#include "RowTableDescriptor.h"
+#include "Shard.h"
+#include "Slice.h"
 
 
 namespace BitFunnel
@@ -257,4 +268,393 @@ namespace BitFunnel
         EXPECT_EQ(docFreqHistogram[21], 1u);
         EXPECT_EQ(docFreqHistogram[31], 1u);
     }
+
+
+    // Creates a document whose posting count is termCount.
+    static std::unique_ptr<IDocument> CreateDocument(ISimpleIndex & index,
+                                                     DocId id,
+                                                     size_t termCount)
+    {
+        auto document = Factories::CreateDocument(index.GetConfiguration(), id);
+        document->OpenStream(c_streamId);
+        for (size_t term = 0; term < termCount; ++term)
+        {
+            document->AddTerm(std::to_string(term).c_str());
+        }
+        document->CloseDocument(termCount);
+        return document;
+    }
+
+
+    // Adds a document whose posting count is termCount.
+    static void AddDocument(ISimpleIndex & index, DocId id, size_t termCount)
+    {
+        index.GetIngestor().Add(id, *CreateDocument(index, id, termCount));
+    }
+
+
+    // Posting count of document id in the RebalanceShards test. Most
+    // documents are short and a quarter are long, so giving the short ones a
+    // shard of their own saves far more row table memory than the overhead
+    // of an extra shard.
+    static size_t RebalancePostingCount(DocId id)
+    {
+        return (id % 4 == 0) ? 64 : 2;
+    }
+
+
+    // Starts with a shard definition whose boundaries do not fit the
+    // documents, then verifies that rebalancing from the live histogram
+    // routes subsequent documents by the new boundaries.
+    TEST(Ingestor, RebalanceShards)
+    {
+        const ShardId c_shardCount = 3;
+        auto shardDefinition = Factories::CreateShardDefinition();
+        shardDefinition->AddShard(1000);
+        shardDefinition->AddShard(2000);
+
+        auto fileSystem = Factories::CreateRAMFileSystem();
+        auto index = Factories::CreateSimpleIndex(*fileSystem);
+        index->SetShardDefinition(std::move(shardDefinition));
+        index->ConfigureAsMock(1, false);
+        index->StartIndex();
+
+        IIngestor & ingestor = index->GetIngestor();
+        ASSERT_EQ(ingestor.GetShardDefinition().GetShardCount(), c_shardCount);
+
+        DocId id = 0;
+        for (; id < 2000; ++id)
+        {
+            AddDocument(*index, id, RebalancePostingCount(id));
+        }
+
+        // Every document fits in the first shard.
+        EXPECT_EQ(ingestor.GetShardDocumentCount(0), 2000u);
+        EXPECT_EQ(ingestor.GetShardDocumentCount(1), 0u);
+        EXPECT_EQ(ingestor.GetShardDocumentCount(2), 0u);
+
+        ingestor.RebalanceShards();
+        IShardDefinition const & rebalanced = ingestor.GetShardDefinition();
+        ASSERT_GT(rebalanced.GetShardCount(), 1u);
+        ASSERT_LE(rebalanced.GetShardCount(), c_shardCount);
+
+        // Short and long documents are separated.
+        EXPECT_GE(rebalanced.GetMaxPostingCount(0), 2u);
+        EXPECT_LT(rebalanced.GetMaxPostingCount(0), 64u);
+        EXPECT_EQ(rebalanced.GetShard(2), 0u);
+        EXPECT_NE(rebalanced.GetShard(64), 0u);
+
+        std::vector<size_t> expected(c_shardCount);
+        for (ShardId shard = 0; shard < c_shardCount; ++shard)
+        {
+            expected[shard] = ingestor.GetShardDocumentCount(shard);
+        }
+        for (; id < 2400; ++id)
+        {
+            const size_t termCount = RebalancePostingCount(id);
+            ++expected[rebalanced.GetShard(termCount)];
+            AddDocument(*index, id, termCount);
+        }
+        for (ShardId shard = 0; shard < c_shardCount; ++shard)
+        {
+            EXPECT_EQ(ingestor.GetShardDocumentCount(shard), expected[shard]);
+        }
+        EXPECT_EQ(ingestor.GetShardDocumentCount(0), 2300u);
+
+        // Deleted documents leave their shard's count.
+        const size_t before = ingestor.GetShardDocumentCount(0);
+        ingestor.Delete(1);
+        EXPECT_EQ(ingestor.GetShardDocumentCount(0), before - 1);
+
+        // Periodic rebalancing replaces the definition as documents arrive.
+        // The replaced definitions are handed to the recycler.
+        ingestor.SetShardRebalanceInterval(100);
+        for (; id < 2600; ++id)
+        {
+            AddDocument(*index, id, RebalancePostingCount(id));
+        }
+        EXPECT_NE(&ingestor.GetShardDefinition(), &rebalanced);
+    }
+
+
+    // Each group occupies its own slices, so expiring a group recycles them
+    // and removes only that group's documents.
+    TEST(Ingestor, ExpireGroup)
+    {
+        auto fileSystem = Factories::CreateRAMFileSystem();
+        auto index = Factories::CreateSimpleIndex(*fileSystem);
+        index->ConfigureAsMock(1, false);
+        index->StartIndex();
+
+        IIngestor & ingestor = index->GetIngestor();
+        IShard & shard = ingestor.GetShard(0);
+        ASSERT_GT(shard.GetSliceCapacity(), 100u);
+
+        ingestor.OpenGroup(1);
+        DocId id = 0;
+        for (; id < 100; ++id)
+        {
+            AddDocument(*index, id, 1);
+        }
+        ingestor.OpenGroup(2);
+        for (; id < 200; ++id)
+        {
+            AddDocument(*index, id, 1);
+        }
+        ingestor.CloseGroup();
+        for (; id < 210; ++id)
+        {
+            AddDocument(*index, id, 1);
+        }
+
+        EXPECT_EQ(shard.GetSliceBuffers().size(), 3u);
+        EXPECT_EQ(ingestor.GetDocumentCount(), 210u);
+
+        // Closed groups cannot be reopened and open groups cannot expire.
+        EXPECT_ANY_THROW(ingestor.OpenGroup(2));
+        ingestor.OpenGroup(3);
+        EXPECT_ANY_THROW(ingestor.ExpireGroup(3));
+        ingestor.CloseGroup();
+        EXPECT_ANY_THROW(ingestor.ExpireGroup(4));
+
+        // A document deleted individually is not counted twice.
+        EXPECT_TRUE(ingestor.Delete(5));
+
+        ingestor.ExpireGroup(1);
+        EXPECT_EQ(shard.GetSliceBuffers().size(), 2u);
+        EXPECT_EQ(ingestor.GetDocumentCount(), 110u);
+        EXPECT_EQ(ingestor.GetShardDocumentCount(0), 110u);
+        EXPECT_FALSE(ingestor.Contains(0));
+        EXPECT_FALSE(ingestor.Contains(99));
+        EXPECT_TRUE(ingestor.Contains(100));
+        EXPECT_TRUE(ingestor.Contains(200));
+
+        ingestor.ExpireGroup(2);
+        EXPECT_EQ(shard.GetSliceBuffers().size(), 1u);
+        EXPECT_EQ(ingestor.GetDocumentCount(), 10u);
+        EXPECT_FALSE(ingestor.Contains(100));
+        EXPECT_TRUE(ingestor.Contains(209));
+
+        // An expired group's DocIds and GroupId may be reused.
+        ingestor.OpenGroup(1);
+        AddDocument(*index, 0, 1);
+        EXPECT_TRUE(ingestor.Contains(0));
+        ingestor.CloseGroup();
+    }
+
+
+    // A group cannot expire while a document allocated in one of its slices
+    // has not been committed, and is left intact by the attempt.
+    TEST(Ingestor, ExpireGroupPendingCommit)
+    {
+        auto fileSystem = Factories::CreateRAMFileSystem();
+        auto index = Factories::CreateSimpleIndex(*fileSystem);
+        index->ConfigureAsMock(1, false);
+        index->StartIndex();
+
+        IIngestor & ingestor = index->GetIngestor();
+        Shard & shard = dynamic_cast<Shard &>(ingestor.GetShard(0));
+
+        ingestor.OpenGroup(1);
+        AddDocument(*index, 0, 1);
+
+        // An Add() which has allocated its column but not yet committed it.
+        DocumentHandleInternal pending = shard.AllocateDocument(1);
+        ingestor.CloseGroup();
+
+        EXPECT_THROW(ingestor.ExpireGroup(1), RecoverableError);
+        EXPECT_TRUE(ingestor.Contains(0));
+        EXPECT_EQ(ingestor.GetShardDocumentCount(0), 1u);
+
+        pending.Activate();
+        pending.GetSlice().CommitDocument();
+
+        ingestor.ExpireGroup(1);
+        EXPECT_FALSE(ingestor.Contains(0));
+        EXPECT_EQ(shard.GetSliceBuffers().size(), 0u);
+    }
+
+
+    // Returns the value of the line starting with label in the output of
+    // IIngestor::PrintStatistics().
+    static size_t GetStatistic(IIngestor const & ingestor,
+                               std::string const & label)
+    {
+        std::stringstream statistics;
+        ingestor.PrintStatistics(statistics, 0);
+
+        std::string line;
+        while (std::getline(statistics, line))
+        {
+            if (line.compare(0, label.size(), label) == 0)
+            {
+                return std::stoull(line.substr(label.size()));
+            }
+        }
+
+        ADD_FAILURE() << "PrintStatistics() has no line '" << label << "'.";
+        return 0;
+    }
+
+
+    static size_t GetPostingCount(IIngestor const & ingestor)
+    {
+        return GetStatistic(ingestor, "Posting count: ");
+    }
+
+
+    // Returns the rank 0 rows in which the document's bit is set.
+    static std::vector<RowIndex> GetRank0Bits(IIngestor const & ingestor, DocId id)
+    {
+        const DocumentHandleInternal handle(ingestor.GetHandle(id));
+        const RowIndex rowCount =
+            handle.GetSlice().GetRowTable(0).GetRowCount();
+
+        std::vector<RowIndex> rows;
+        for (RowIndex row = 0; row < rowCount; ++row)
+        {
+            if (handle.GetBit(RowId(0, row)))
+            {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+
+
+    // Updating a document in place replaces its postings within its column
+    // instead of leaving an expired column behind.
+    TEST(Ingestor, UpdateInPlace)
+    {
+        const DocId c_maxDocId = 63;
+        auto fileSystem = Factories::CreateFileSystem();
+        auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                        c_maxDocId,
+                                                        c_streamId);
+        IIngestor & ingestor = index->GetIngestor();
+        IShard & shard = ingestor.GetShard(0);
+
+        const size_t documentCount = ingestor.GetDocumentCount();
+        const size_t sliceCount = shard.GetSliceBuffers().size();
+        const size_t sourceByteSize = ingestor.GetTotalSouceBytesIngested();
+        const size_t postingCount = GetPostingCount(ingestor);
+        const DocIndex column = DocumentHandleInternal(ingestor.GetHandle(6)).GetIndex();
+        const std::vector<RowIndex> neighbour = GetRank0Bits(ingestor, 7);
+        EXPECT_NE(GetRank0Bits(ingestor, 6), GetRank0Bits(ingestor, 5));
+
+        // Give document 6 the contents of document 5.
+        auto oldDocument = Factories::CreatePrimeFactorsDocument(
+            index->GetConfiguration(), 6, c_maxDocId, c_streamId);
+        auto document = Factories::CreatePrimeFactorsDocument(
+            index->GetConfiguration(), 5, c_maxDocId, c_streamId);
+        ASSERT_NE(oldDocument->GetPostingCount(), document->GetPostingCount());
+        EXPECT_TRUE(ingestor.Update(6, *document));
+
+        // The statistics count the new contents instead of the old ones.
+        EXPECT_EQ(ingestor.GetTotalSouceBytesIngested(),
+                  sourceByteSize
+                  - oldDocument->GetSourceByteSize()
+                  + document->GetSourceByteSize());
+        EXPECT_EQ(GetPostingCount(ingestor),
+                  postingCount
+                  - oldDocument->GetPostingCount()
+                  + document->GetPostingCount());
+
+        EXPECT_TRUE(ingestor.Contains(6));
+        EXPECT_EQ(ingestor.GetDocumentCount(), documentCount);
+        EXPECT_EQ(ingestor.GetShardDocumentCount(0), documentCount);
+        EXPECT_EQ(shard.GetSliceBuffers().size(), sliceCount);
+        EXPECT_EQ(DocumentHandleInternal(ingestor.GetHandle(6)).GetIndex(), column);
+
+        // The column holds exactly the bits of the new contents, and its
+        // neighbour is unaffected.
+        EXPECT_EQ(GetRank0Bits(ingestor, 6), GetRank0Bits(ingestor, 5));
+        EXPECT_EQ(GetRank0Bits(ingestor, 7), neighbour);
+
+        // Updating a document which is not in the index adds it.
+        EXPECT_FALSE(ingestor.Update(c_maxDocId + 1, *document));
+        EXPECT_TRUE(ingestor.Contains(c_maxDocId + 1));
+        EXPECT_EQ(ingestor.GetDocumentCount(), documentCount + 1);
+    }
+
+
+    // Updates retract the old document from the histogram that drives
+    // rebalancing, and are not counted as new documents.
+    TEST(Ingestor, UpdateRebalance)
+    {
+        const size_t c_documentCount = 2000;
+        const size_t c_longPostingCount = 64;
+        const size_t c_shortPostingCount = 2;
+
+        auto shardDefinition = Factories::CreateShardDefinition();
+        shardDefinition->AddShard(1000);
+        shardDefinition->AddShard(2000);
+
+        auto fileSystem = Factories::CreateRAMFileSystem();
+        auto index = Factories::CreateSimpleIndex(*fileSystem);
+        index->SetShardDefinition(std::move(shardDefinition));
+        index->ConfigureAsMock(1, false);
+        index->StartIndex();
+        IIngestor & ingestor = index->GetIngestor();
+
+        // Every document starts long and is then shortened in place.
+        for (DocId id = 0; id < c_documentCount; ++id)
+        {
+            AddDocument(*index, id, c_longPostingCount);
+        }
+        for (DocId id = 0; id < c_documentCount; ++id)
+        {
+            EXPECT_TRUE(ingestor.Update(
+                id, *CreateDocument(*index, id, c_shortPostingCount)));
+        }
+        EXPECT_EQ(GetStatistic(ingestor, "Document count: "), c_documentCount);
+
+        // The rebalanced definition must match that of an index which only
+        // ever held the short documents.
+        ingestor.RebalanceShards();
+
+        auto expectedDefinition = Factories::CreateShardDefinition();
+        expectedDefinition->AddShard(1000);
+        expectedDefinition->AddShard(2000);
+        auto expectedFileSystem = Factories::CreateRAMFileSystem();
+        auto expectedIndex = Factories::CreateSimpleIndex(*expectedFileSystem);
+        expectedIndex->SetShardDefinition(std::move(expectedDefinition));
+        expectedIndex->ConfigureAsMock(1, false);
+        expectedIndex->StartIndex();
+        for (DocId id = 0; id < c_documentCount; ++id)
+        {
+            AddDocument(*expectedIndex, id, c_shortPostingCount);
+        }
+        expectedIndex->GetIngestor().RebalanceShards();
+
+        IShardDefinition const & rebalanced = ingestor.GetShardDefinition();
+        IShardDefinition const & expected =
+            expectedIndex->GetIngestor().GetShardDefinition();
+        ASSERT_EQ(rebalanced.GetShardCount(), expected.GetShardCount());
+        for (ShardId shard = 0; shard < expected.GetShardCount(); ++shard)
+        {
+            EXPECT_EQ(rebalanced.GetMaxPostingCount(shard),
+                      expected.GetMaxPostingCount(shard));
+        }
+        EXPECT_EQ(rebalanced.GetShard(c_longPostingCount),
+                  expected.GetShard(c_longPostingCount));
+
+        // An update which moves a document to another shard is not a new
+        // document either.
+        const DocId movedId = 0;
+        const size_t movedPostingCount = 1500;
+        const ShardId fromShard = rebalanced.GetShard(c_shortPostingCount);
+        const ShardId toShard = rebalanced.GetShard(movedPostingCount);
+        ASSERT_NE(fromShard, toShard);
+        const size_t postingCount = GetPostingCount(ingestor);
+        const size_t toShardCount = ingestor.GetShardDocumentCount(toShard);
+
+        EXPECT_FALSE(ingestor.Update(
+            movedId, *CreateDocument(*index, movedId, movedPostingCount)));
+        EXPECT_EQ(GetStatistic(ingestor, "Document count: "), c_documentCount);
+        EXPECT_EQ(ingestor.GetDocumentCount(), c_documentCount);
+        EXPECT_EQ(ingestor.GetShardDocumentCount(toShard), toShardCount + 1);
+        EXPECT_EQ(GetPostingCount(ingestor),
+                  postingCount - c_shortPostingCount + movedPostingCount);
+    }
 }
@@ -0,0 +1,206 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "IRecyclable.h"
+
+
+namespace BitFunnel
+{
+    namespace RecyclerTest
+    {
+        class MockRecyclable : public IRecyclable
+        {
+        public:
+            MockRecyclable(ITokenManager& tokenManager,
+                           size_t byteSize,
+                           std::atomic<size_t>& recycledCount)
+              : m_tokenManager(tokenManager),
+                m_byteSize(byteSize),
+                m_recycledCount(recycledCount)
+            {
+            }
+
+            virtual ITokenManager& GetTokenManager() const override
+            {
+                return m_tokenManager;
+            }
+
+            virtual size_t GetByteSize() const override
+            {
+                return m_byteSize;
+            }
+
+            virtual void Recycle() override
+            {
+                ++m_recycledCount;
+            }
+
+        private:
+            ITokenManager& m_tokenManager;
+            size_t m_byteSize;
+            std::atomic<size_t>& m_recycledCount;
+        };
+
+
+        static void Schedule(IRecycler& recycler,
+                             ITokenManager& tokenManager,
+                             size_t byteSize,
+                             std::atomic<size_t>& recycledCount)
+        {
+            std::unique_ptr<IRecyclable>
+                item(new MockRecyclable(tokenManager, byteSize, recycledCount));
+            recycler.ScheduleRecyling(item);
+        }
+
+
+        // Polls until count reaches expected or a generous timeout elapses.
+        static bool WaitForCount(std::atomic<size_t> const & count,
+                                 size_t expected)
+        {
+            for (unsigned i = 0; i < 10000; ++i)
+            {
+                if (count == expected)
+                {
+                    return true;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return count == expected;
+        }
+
+
+        TEST(Recycler, WaitsForOutstandingTokens)
+        {
+            auto tokenManager = Factories::CreateTokenManager();
+            auto recycler = Factories::CreateRecycler();
+            auto background = std::async(std::launch::async, &IRecycler::Run, recycler.get());
+
+            std::atomic<size_t> recycledCount(0);
+            std::unique_ptr<Token> token(new Token(tokenManager->RequestToken()));
+
+            const size_t c_itemCount = 3;
+            for (size_t i = 0; i < c_itemCount; ++i)
+            {
+                Schedule(*recycler, *tokenManager, 10 * (i + 1), recycledCount);
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            EXPECT_EQ(recycledCount, 0u);
+            EXPECT_EQ(recycler->GetPendingItemCount(), c_itemCount);
+            EXPECT_EQ(recycler->GetPendingByteCount(), 60u);
+
+            token.reset();
+
+            EXPECT_TRUE(WaitForCount(recycledCount, c_itemCount));
+            EXPECT_EQ(recycler->GetPendingItemCount(), 0u);
+            EXPECT_EQ(recycler->GetPendingByteCount(), 0u);
+
+            recycler->Shutdown();
+            background.wait();
+            tokenManager->Shutdown();
+        }
+
+
+        // A Token held against one ITokenManager must not delay resources
+        // whose consumers are tracked by another.
+        TEST(Recycler, NoHeadOfLineBlocking)
+        {
+            auto slowTokenManager = Factories::CreateTokenManager();
+            auto fastTokenManager = Factories::CreateTokenManager();
+            auto recycler = Factories::CreateRecycler();
+            auto background = std::async(std::launch::async, &IRecycler::Run, recycler.get());
+
+            std::atomic<size_t> slowCount(0);
+            std::atomic<size_t> fastCount(0);
+            std::unique_ptr<Token> token(new Token(slowTokenManager->RequestToken()));
+
+            Schedule(*recycler, *slowTokenManager, 100, slowCount);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            Schedule(*recycler, *fastTokenManager, 1, fastCount);
+
+            EXPECT_TRUE(WaitForCount(fastCount, 1u));
+            EXPECT_EQ(slowCount, 0u);
+            EXPECT_EQ(recycler->GetPendingByteCount(), 100u);
+
+            token.reset();
+            EXPECT_TRUE(WaitForCount(slowCount, 1u));
+
+            recycler->Shutdown();
+            background.wait();
+            slowTokenManager->Shutdown();
+            fastTokenManager->Shutdown();
+        }
+
+
+        TEST(Recycler, ShutdownRecyclesEverything)
+        {
+            auto tokenManager = Factories::CreateTokenManager();
+            auto recycler = Factories::CreateRecycler();
+            auto background = std::async(std::launch::async, &IRecycler::Run, recycler.get());
+
+            std::atomic<size_t> recycledCount(0);
+
+            // Schedule from several threads to exercise the lock-free
+            // enqueue.
+            const size_t c_threadCount = 4;
+            const size_t c_itemsPerThread = 1000;
+            std::vector<std::future<void>> producers;
+            for (size_t t = 0; t < c_threadCount; ++t)
+            {
+                producers.push_back(std::async(std::launch::async, [&]()
+                {
+                    for (size_t i = 0; i < c_itemsPerThread; ++i)
+                    {
+                        auto token = tokenManager->RequestToken();
+                        Schedule(*recycler, *tokenManager, 1, recycledCount);
+                    }
+                }));
+            }
+            for (auto & producer : producers)
+            {
+                producer.wait();
+            }
+
+            recycler->Shutdown();
+            background.wait();
+
+            EXPECT_EQ(recycledCount, c_threadCount * c_itemsPerThread);
+            EXPECT_EQ(recycler->GetPendingItemCount(), 0u);
+            EXPECT_EQ(recycler->GetPendingByteCount(), 0u);
+
+            tokenManager->Shutdown();
+        }
+    }
+}
@@ -0,0 +1,215 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IDocument.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IRowDensityMonitor.h"
+#include "BitFunnel/Index/IShard.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Index/ISliceBufferAllocator.h"
+#include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/Index/RowIdSequence.h"
+#include "BitFunnel/Mocks/Factories.h"
+#include "Primes.h"
+
+
+namespace BitFunnel
+{
+    namespace RowDensityMonitorTest
+    {
+        static const DocId c_maxDocId = 1000;
+        static const Term::StreamId c_streamId = 0;
+
+        // Returns a PrimeFactors index whose TermTable maps terms "2" and "3"
+        // to the same rank 0 row. Every other term has a private row.
+        static std::unique_ptr<ISimpleIndex> CreateIndex(IFileSystem & fileSystem)
+        {
+            const Rank rank = 0;
+            const RowIndex adhocRowCount = 1;
+            RowIndex explicitRowCount = ITermTable::SystemTerm::Count;
+
+            auto termTable = Factories::CreateTermTable();
+
+            termTable->OpenTerm();
+            termTable->AddRowId(RowId(rank, explicitRowCount++));
+            termTable->CloseTerm(Term::ComputeRawHash("0"));
+
+            termTable->OpenTerm();
+            termTable->AddRowId(RowId(rank, explicitRowCount++));
+            termTable->CloseTerm(Term::ComputeRawHash("1"));
+
+            const RowIndex sharedRow = explicitRowCount++;
+            for (size_t i = 0; Primes::c_primesBelow10000[i] <= c_maxDocId; ++i)
+            {
+                const size_t p = Primes::c_primesBelow10000[i];
+                termTable->OpenTerm();
+                termTable->AddRowId(
+                    RowId(rank, (p == 2 || p == 3) ? sharedRow : explicitRowCount++));
+                termTable->CloseTerm(
+                    Term::ComputeRawHash(Primes::c_primesBelow10000Text[i].c_str()));
+            }
+
+            termTable->SetRowCounts(rank, explicitRowCount, adhocRowCount);
+            termTable->Seal();
+
+            auto termTables = Factories::CreateTermTableCollection();
+            termTables->AddTermTable(std::move(termTable));
+
+            auto index = Factories::CreateSimpleIndex(fileSystem);
+            index->SetTermTableCollection(std::move(termTables));
+            index->SetSliceBufferAllocator(
+                Factories::CreateSliceBufferAllocator(20000, 512));
+            index->ConfigureAsMock(1, false);
+            index->StartIndex();
+
+            for (DocId id = 0; id <= c_maxDocId; ++id)
+            {
+                auto document =
+                    Factories::CreatePrimeFactorsDocument(index->GetConfiguration(),
+                                                          id,
+                                                          c_maxDocId,
+                                                          c_streamId);
+                index->GetIngestor().Add(id, *document);
+            }
+
+            return index;
+        }
+
+
+        static RowIndex GetRow(ITermTable const & termTable, char const * text)
+        {
+            Term term(Term::ComputeRawHash(text), c_streamId, 0);
+            RowIdSequence rows(term, termTable);
+            return (*rows.begin()).GetIndex();
+        }
+
+
+        TEST(RowDensityMonitor, SharedRows)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            auto index = CreateIndex(*fileSystem);
+            ITermTable const & termTable = index->GetTermTable(0);
+
+            auto shared = termTable.GetSharedRows(0);
+            ASSERT_EQ(shared.size(), termTable.GetTotalRowCount(0));
+
+            // The single adhoc row is RowIndex 0.
+            EXPECT_TRUE(shared[0]);
+            EXPECT_TRUE(shared[GetRow(termTable, "2")]);
+            EXPECT_EQ(GetRow(termTable, "2"), GetRow(termTable, "3"));
+            EXPECT_FALSE(shared[GetRow(termTable, "5")]);
+            EXPECT_EQ(std::count(shared.begin(), shared.end(), true), 2);
+
+            EXPECT_TRUE(termTable.GetSharedRows(1).empty());
+        }
+
+
+        TEST(RowDensityMonitor, RecentDensities)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            auto index = CreateIndex(*fileSystem);
+            IShard & shard = index->GetIngestor().GetShard(0);
+            ASSERT_GT(shard.GetSliceBuffers().size(), 1u);
+
+            auto all = shard.GetDensities(0);
+            EXPECT_EQ(shard.GetRecentDensities(0, 1000), all);
+
+            // Only the newest slice holds documents divisible by 997.
+            const RowIndex row = GetRow(index->GetTermTable(0), "997");
+            auto recent = shard.GetRecentDensities(0, 1);
+            ASSERT_EQ(recent.size(), all.size());
+            EXPECT_GT(recent[row], all[row]);
+        }
+
+
+        TEST(RowDensityMonitor, Sample)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            auto index = CreateIndex(*fileSystem);
+            IRowDensityMonitor & monitor =
+                index->GetIngestor().GetRowDensityMonitor();
+
+            EXPECT_FALSE(monitor.IsRunning());
+            EXPECT_EQ(monitor.GetSampleCount(), 0u);
+
+            // About two thirds of the documents are divisible by 2 or 3.
+            monitor.Configure(2, 0.5, 10);
+            monitor.Sample();
+            EXPECT_EQ(monitor.GetSampleCount(), 1u);
+
+            auto histogram = monitor.GetDensityHistogram();
+            ASSERT_EQ(histogram.size(), IRowDensityMonitor::c_histogramBuckets);
+            EXPECT_EQ(std::accumulate(histogram.begin(), histogram.end(), 0u), 2u);
+
+            // Nothing sets bits in the adhoc row.
+            EXPECT_EQ(histogram[0], 1u);
+
+            auto overfull = monitor.GetOverfullRows();
+            ASSERT_EQ(overfull.size(), 1u);
+            EXPECT_EQ(overfull[0].m_shard, 0u);
+            EXPECT_EQ(overfull[0].m_row,
+                      RowId(0, GetRow(index->GetTermTable(0), "2")));
+            EXPECT_NEAR(overfull[0].m_density, 2.0 / 3.0, 0.1);
+
+            // The row is not reported once the alert density is above it.
+            monitor.Configure(2, 0.9, 10);
+            monitor.Sample();
+            EXPECT_TRUE(monitor.GetOverfullRows().empty());
+        }
+
+
+        TEST(RowDensityMonitor, StartStop)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            auto index = CreateIndex(*fileSystem);
+            IRowDensityMonitor & monitor =
+                index->GetIngestor().GetRowDensityMonitor();
+
+            monitor.Start(1);
+            EXPECT_TRUE(monitor.IsRunning());
+            for (size_t i = 0; i < 1000 && monitor.GetSampleCount() < 2; ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            monitor.Stop();
+
+            EXPECT_FALSE(monitor.IsRunning());
+            EXPECT_GE(monitor.GetSampleCount(), 2u);
+
+            // Left running, the monitor is stopped by Shutdown().
+            monitor.Start(1000);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IShard.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Mocks/Factories.h"
+#include "RowTableAnalyzer.h"
+
+
+namespace BitFunnel
+{
+    namespace RowTableAnalyzerTest
+    {
+        // The parallel, quadword-at-a-time densities must match those
+        // computed bit by bit by IShard::GetDensities(), for any thread count.
+        TEST(RowTableAnalyzer, RowDensities)
+        {
+            const DocId c_maxDocId = 1000;
+            const Term::StreamId c_streamId = 0;
+
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                            c_maxDocId,
+                                                            c_streamId);
+
+            // Expire some documents so that the active row matters.
+            for (DocId id = 0; id <= c_maxDocId; id += 7)
+            {
+                index->GetIngestor().Delete(id);
+            }
+
+            IShard & shard = index->GetIngestor().GetShard(0);
+            ASSERT_GT(shard.GetSliceBuffers().size(), 1u);
+
+            for (size_t threadCount = 1; threadCount <= 4; threadCount += 3)
+            {
+                RowTableAnalyzer analyzer(*index, threadCount);
+                auto densities = analyzer.GetRowDensities();
+                ASSERT_EQ(densities.size(), 1u);
+
+                for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+                {
+                    auto expected = shard.GetDensities(rank);
+                    auto const & observed = densities[0][rank];
+                    ASSERT_EQ(observed.size(), expected.size());
+                    for (size_t row = 0; row < expected.size(); ++row)
+                    {
+                        EXPECT_DOUBLE_EQ(observed[row], expected[row])
+                            << "rank " << rank << ", row " << row;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -21,12 +21,58 @@
 // THE SOFTWARE.
 
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
+#include "RowTableDescriptor.h"
+
 
 namespace BitFunnel
 {
-    TEST(RowTableDescriptor, Placeholder)
+    TEST(RowTableDescriptor, Summaries)
     {
+        const DocIndex capacity = 4096;
+        const RowIndex rowCount = 3;
+
+        RowTableDescriptor rank0(capacity, rowCount, 0, 0, 0);
+        ASSERT_TRUE(rank0.HasSummaries());
+
+        RowTableDescriptor rank3(capacity, rowCount, 3, 3, 0);
+        EXPECT_FALSE(rank3.HasSummaries());
+        EXPECT_EQ(RowTableDescriptor::BytesInSummary(capacity, 3, 3), 0u);
+
+        const size_t bufferSize =
+            RowTableDescriptor::GetBufferSize(capacity, rowCount, 0, 0);
+        std::vector<uint64_t> buffer(bufferSize / sizeof(uint64_t), 0);
+        void* sliceBuffer = buffer.data();
+
+        const DocIndex doc = 1000;
+        const size_t summaryBit = doc / RowTableDescriptor::c_docsPerSummaryBit;
+
+        rank0.SetBit(sliceBuffer, 1, doc);
+
+        for (RowIndex row = 0; row < rowCount; ++row)
+        {
+            uint64_t const * summary = reinterpret_cast<uint64_t const *>(
+                reinterpret_cast<char const *>(sliceBuffer) +
+                rank0.GetSummaryOffset(row));
+
+            const uint64_t expected = (row == 1) ? (1ull << summaryBit) : 0;
+            EXPECT_EQ(summary[0], expected);
+
+            // Summaries must not overlap the rows.
+            EXPECT_GE(rank0.GetSummaryOffset(row),
+                      rank0.GetRowOffset(rowCount - 1) +
+                      static_cast<ptrdiff_t>(capacity / 8));
+        }
+
+        // Clearing the bit leaves the summary conservative.
+        rank0.ClearBit(sliceBuffer, 1, doc);
+        EXPECT_EQ(rank0.GetBit(sliceBuffer, 1, doc), 0u);
+        uint64_t const * summary = reinterpret_cast<uint64_t const *>(
+            reinterpret_cast<char const *>(sliceBuffer) +
+            rank0.GetSummaryOffset(1));
+        EXPECT_EQ(summary[0], 1ull << summaryBit);
     }
 }
@@ -0,0 +1,288 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Index/IDocument.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IShard.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Index/ISliceCompactor.h"
+#include "BitFunnel/Index/Token.h"
+#include "BitFunnel/Mocks/Factories.h"
+#include "DocumentHandleInternal.h"
+#include "RowTableDescriptor.h"
+#include "Shard.h"
+#include "Slice.h"
+
+
+namespace BitFunnel
+{
+    namespace SliceCompactorTest
+    {
+        static const Term::StreamId c_streamId = 0;
+
+
+        // Returns the rank 0 rows in which the document's bit is set.
+        static std::vector<RowIndex> GetRank0Bits(IIngestor const & ingestor,
+                                                  DocId id)
+        {
+            const DocumentHandleInternal handle(ingestor.GetHandle(id));
+            const RowIndex rowCount =
+                handle.GetSlice().GetRowTable(0).GetRowCount();
+
+            std::vector<RowIndex> rows;
+            for (RowIndex row = 0; row < rowCount; ++row)
+            {
+                if (handle.GetBit(RowId(0, row)))
+                {
+                    rows.push_back(row);
+                }
+            }
+            return rows;
+        }
+
+
+        // Returns the number of live documents in the shard's slices.
+        static size_t GetLiveDocumentCount(IShard const & shard)
+        {
+            size_t count = 0;
+            for (auto buffer : shard.GetSliceBuffers())
+            {
+                count += Slice::GetSliceFromBuffer(buffer,
+                                                   Shard::GetSlicePtrOffset())
+                    ->GetLiveDocumentCount();
+            }
+            return count;
+        }
+
+
+        // Creates a PrimeFactors index spanning at least four slices, then
+        // deletes all but every tenth document of the first two slices.
+        // Returns the DocIds of the remaining documents.
+        static std::vector<DocId> CreateSparseIndex(
+            IFileSystem & fileSystem,
+            std::unique_ptr<ISimpleIndex>& index)
+        {
+            const DocId c_maxDocId = 1000;
+            index = Factories::CreatePrimeFactorsIndex(fileSystem,
+                                                       c_maxDocId,
+                                                       c_streamId);
+            IIngestor & ingestor = index->GetIngestor();
+            const DocIndex capacity = ingestor.GetShard(0).GetSliceCapacity();
+            EXPECT_GE(ingestor.GetShard(0).GetSliceBuffers().size(), 4u);
+
+            std::vector<DocId> remaining;
+            for (DocId id = 0; id <= c_maxDocId; ++id)
+            {
+                if (id < 2 * capacity && id % 10 != 0)
+                {
+                    EXPECT_TRUE(ingestor.Delete(id));
+                }
+                else
+                {
+                    remaining.push_back(id);
+                }
+            }
+
+            return remaining;
+        }
+
+
+        TEST(SliceCompactor, Compact)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            std::unique_ptr<ISimpleIndex> index;
+            const std::vector<DocId> remaining =
+                CreateSparseIndex(*fileSystem, index);
+
+            IIngestor & ingestor = index->GetIngestor();
+            IShard & shard = ingestor.GetShard(0);
+            const DocIndex capacity = shard.GetSliceCapacity();
+            const size_t sliceCount = shard.GetSliceBuffers().size();
+            const size_t documentCount = ingestor.GetDocumentCount();
+            EXPECT_EQ(documentCount, remaining.size());
+            EXPECT_EQ(GetLiveDocumentCount(shard), documentCount);
+
+            std::vector<std::vector<RowIndex>> bits;
+            for (auto id : remaining)
+            {
+                bits.push_back(GetRank0Bits(ingestor, id));
+            }
+            void const * movedBuffer =
+                DocumentHandleInternal(ingestor.GetHandle(0)).GetSlice().GetSliceBuffer();
+
+            ISliceCompactor & compactor = ingestor.GetSliceCompactor();
+            compactor.Configure(0.2);
+            EXPECT_EQ(compactor.Compact(), 2u);
+            EXPECT_EQ(compactor.GetPassCount(), 1u);
+            EXPECT_EQ(compactor.GetRetiredSliceCount(), 2u);
+            EXPECT_EQ(compactor.GetMovedDocumentCount(),
+                      2u * ((capacity + 9) / 10));
+
+            EXPECT_EQ(shard.GetSliceBuffers().size(), sliceCount - 1);
+            EXPECT_EQ(ingestor.GetDocumentCount(), documentCount);
+            EXPECT_EQ(GetLiveDocumentCount(shard), documentCount);
+            EXPECT_NE(DocumentHandleInternal(ingestor.GetHandle(0)).GetSlice().GetSliceBuffer(),
+                      movedBuffer);
+
+            // Every document keeps its DocId and row bits.
+            for (size_t i = 0; i < remaining.size(); ++i)
+            {
+                EXPECT_TRUE(ingestor.Contains(remaining[i]));
+                EXPECT_EQ(ingestor.GetHandle(remaining[i]).GetDocId(),
+                          remaining[i]);
+                EXPECT_EQ(GetRank0Bits(ingestor, remaining[i]), bits[i]);
+            }
+
+            // The merged slice is above the threshold, so there is nothing
+            // left to compact.
+            EXPECT_EQ(compactor.Compact(), 0u);
+
+            // Moved documents can still be deleted.
+            EXPECT_TRUE(ingestor.Delete(0));
+            EXPECT_FALSE(ingestor.Contains(0));
+            EXPECT_EQ(GetLiveDocumentCount(shard), documentCount - 1);
+        }
+
+
+        TEST(SliceCompactor, StartStop)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            std::unique_ptr<ISimpleIndex> index;
+            const std::vector<DocId> remaining =
+                CreateSparseIndex(*fileSystem, index);
+
+            IIngestor & ingestor = index->GetIngestor();
+            ISliceCompactor & compactor = ingestor.GetSliceCompactor();
+            EXPECT_FALSE(compactor.IsRunning());
+
+            compactor.Configure(0.2);
+            compactor.Start(1);
+            EXPECT_TRUE(compactor.IsRunning());
+
+            for (unsigned i = 0;
+                 i < 1000 && compactor.GetRetiredSliceCount() == 0;
+                 ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            compactor.Stop();
+            EXPECT_FALSE(compactor.IsRunning());
+            EXPECT_EQ(compactor.GetRetiredSliceCount(), 2u);
+            for (auto id : remaining)
+            {
+                EXPECT_TRUE(ingestor.Contains(id));
+            }
+
+            // Shutdown() stops a running compactor.
+            compactor.Start(1000);
+            index->GetIngestor().Shutdown();
+            EXPECT_FALSE(compactor.IsRunning());
+        }
+
+
+        // A document deleted while its merged copy is being built is not
+        // resurrected when the merge is committed.
+        TEST(SliceCompactor, DeleteDuringBuild)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            std::unique_ptr<ISimpleIndex> index;
+            CreateSparseIndex(*fileSystem, index);
+
+            IIngestor & ingestor = index->GetIngestor();
+            Shard & shard = dynamic_cast<Shard &>(ingestor.GetShard(0));
+            const DocIndex capacity = shard.GetSliceCapacity();
+            const size_t sliceCount = shard.GetSliceBuffers().size();
+            const size_t documentCount = ingestor.GetDocumentCount();
+
+            const Token token = ingestor.GetTokenManager().RequestToken();
+            std::vector<std::unique_ptr<Shard::PendingMerge>> merges;
+            shard.SelectMerges(0.2, merges);
+            ASSERT_EQ(merges.size(), 1u);
+            shard.BuildMerge(*merges[0]);
+
+            EXPECT_TRUE(ingestor.Delete(0));
+
+            std::vector<DocumentHandleInternal> moved;
+            EXPECT_EQ(shard.CommitMerge(*merges[0], moved), 2u);
+            EXPECT_EQ(moved.size(), 2u * ((capacity + 9) / 10) - 1);
+            for (auto const & handle : moved)
+            {
+                EXPECT_NE(handle.GetDocId(), 0u);
+            }
+            EXPECT_EQ(shard.GetSliceBuffers().size(), sliceCount - 1);
+            EXPECT_EQ(GetLiveDocumentCount(shard), documentCount - 1);
+        }
+
+
+        // A merge is abandoned if one of its sources is updated while the
+        // merged copy is being built, and succeeds on the next pass.
+        TEST(SliceCompactor, UpdateDuringBuild)
+        {
+            const DocId c_maxDocId = 1000;
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            std::unique_ptr<ISimpleIndex> index;
+            CreateSparseIndex(*fileSystem, index);
+
+            IIngestor & ingestor = index->GetIngestor();
+            Shard & shard = dynamic_cast<Shard &>(ingestor.GetShard(0));
+            const size_t sliceCount = shard.GetSliceBuffers().size();
+
+            // Give document 10 the contents of document 30.
+            auto document = Factories::CreatePrimeFactorsDocument(
+                index->GetConfiguration(), 30, c_maxDocId, c_streamId);
+            const std::vector<RowIndex> bits = GetRank0Bits(ingestor, 30);
+            EXPECT_NE(GetRank0Bits(ingestor, 10), bits);
+
+            {
+                const Token token = ingestor.GetTokenManager().RequestToken();
+                std::vector<std::unique_ptr<Shard::PendingMerge>> merges;
+                shard.SelectMerges(0.2, merges);
+                ASSERT_EQ(merges.size(), 1u);
+                shard.BuildMerge(*merges[0]);
+
+                EXPECT_TRUE(ingestor.Update(10, *document));
+
+                std::vector<DocumentHandleInternal> moved;
+                EXPECT_EQ(shard.CommitMerge(*merges[0], moved), 0u);
+                EXPECT_TRUE(moved.empty());
+                EXPECT_EQ(shard.GetSliceBuffers().size(), sliceCount);
+            }
+
+            ISliceCompactor & compactor = ingestor.GetSliceCompactor();
+            compactor.Configure(0.2);
+            EXPECT_EQ(compactor.Compact(), 2u);
+            EXPECT_EQ(shard.GetSliceBuffers().size(), sliceCount - 1);
+            EXPECT_EQ(GetRank0Bits(ingestor, 10), bits);
+        }
+    }
+}
@@ -0,0 +1,252 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IStreamingStatistics.h"
+#include "DocumentFrequencyTable.h"
+#include "DocumentFrequencyTableBuilder.h"
+#include "IndexedIdfTable.h"
+
+
+namespace BitFunnel
+{
+    namespace StreamingStatisticsTest
+    {
+        const Term::IdfX10 c_defaultIdf = 60;
+
+        // Document d contains the terms for each divisor of d + 1 up to
+        // c_maxTerm, so term k appears in every kth document.
+        const size_t c_documentCount = 97;
+        const Term::Hash c_maxTerm = 24;
+
+        static std::vector<Term> GetTerms(size_t document)
+        {
+            std::vector<Term> terms;
+            for (Term::Hash k = 1; k <= c_maxTerm; ++k)
+            {
+                if ((document + 1) % k == 0)
+                {
+                    terms.push_back(Term(k * 1000003ull, 0, c_defaultIdf));
+                }
+            }
+            return terms;
+        }
+
+
+        static std::map<Term::Hash, double>
+            GetFrequencies(IDocumentFrequencyTable const & table)
+        {
+            std::map<Term::Hash, double> frequencies;
+            double previous = 1.0;
+            for (auto const & entry : table)
+            {
+                EXPECT_LE(entry.GetFrequency(), previous);
+                previous = entry.GetFrequency();
+                frequencies[entry.GetTerm().GetRawHash()] = entry.GetFrequency();
+            }
+            return frequencies;
+        }
+
+
+        // The streaming statistics must match those computed in memory by
+        // DocumentFrequencyTableBuilder, no matter how many runs are spilled.
+        void VerifyStatistics(size_t maxTermsInMemory)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            auto fileManager = Factories::CreateFileManager("config",
+                                                            "config",
+                                                            "config",
+                                                            *fileSystem);
+            auto shardDefinition = Factories::CreateShardDefinition();
+
+            auto statistics =
+                Factories::CreateStreamingStatistics(*fileManager,
+                                                     *shardDefinition,
+                                                     maxTermsInMemory,
+                                                     1.0);
+            DocumentFrequencyTableBuilder builder;
+
+            for (size_t document = 0; document < c_documentCount; ++document)
+            {
+                auto terms = GetTerms(document);
+                statistics->AddDocument(terms, 100);
+
+                // Shard records the document after its terms.
+                for (auto const & term : terms)
+                {
+                    builder.OnTerm(term);
+                }
+                builder.OnDocumentEnter();
+            }
+
+            EXPECT_EQ(statistics->GetDocumentCount(), c_documentCount);
+            EXPECT_EQ(statistics->GetTotalSourceBytesIngested(),
+                      100 * c_documentCount);
+
+            if (maxTermsInMemory < c_maxTerm)
+            {
+                EXPECT_GT(statistics->GetRunCount(), 1u);
+            }
+
+            statistics->WriteStatistics(nullptr);
+
+            // CumulativeTermCounts
+            {
+                std::stringstream expected;
+                builder.WriteCumulativeTermCounts(expected);
+
+                auto input = fileManager->CumulativeTermCounts(0).OpenForRead();
+                std::stringstream observed;
+                observed << input->rdbuf();
+
+                EXPECT_EQ(observed.str(), expected.str());
+            }
+
+            // DocumentFrequencyTable
+            {
+                std::stringstream expectedStream;
+                builder.WriteFrequencies(expectedStream, 0.0, nullptr);
+                DocumentFrequencyTable expected(expectedStream);
+
+                DocumentFrequencyTable observed(
+                    *fileManager->DocFreqTable(0).OpenForRead());
+
+                ASSERT_EQ(observed.size(), c_maxTerm);
+                EXPECT_EQ(GetFrequencies(observed), GetFrequencies(expected));
+            }
+
+            // IndexedIdfTable
+            {
+                std::stringstream expectedStream;
+                builder.WriteIndexedIdfTable(expectedStream, 0.0);
+                IndexedIdfTable expected(expectedStream, c_defaultIdf);
+
+                IndexedIdfTable observed(
+                    *fileManager->IndexedIdfTable(0).OpenForRead(),
+                    c_defaultIdf);
+
+                for (Term::Hash k = 1; k <= c_maxTerm; ++k)
+                {
+                    EXPECT_EQ(observed.GetIdf(k * 1000003ull),
+                              expected.GetIdf(k * 1000003ull));
+                }
+            }
+
+            // Every run is deleted once it has been merged.
+            for (size_t run = 0; run < statistics->GetRunCount(); ++run)
+            {
+                EXPECT_THROW(fileManager->TermCountRun(run).Delete(),
+                             RecoverableError);
+            }
+        }
+
+
+        TEST(StreamingStatistics, InMemory)
+        {
+            VerifyStatistics(1000);
+        }
+
+
+        TEST(StreamingStatistics, SpilledRuns)
+        {
+            VerifyStatistics(5);
+        }
+
+
+        // Documents added from several threads, with tables spilled outside
+        // the shard lock, must give the same frequencies. The
+        // CumulativeTermCounts depend on the order in which documents
+        // arrive, so they are not compared.
+        TEST(StreamingStatistics, Concurrent)
+        {
+            const size_t c_threadCount = 4;
+
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            auto fileManager = Factories::CreateFileManager("config",
+                                                            "config",
+                                                            "config",
+                                                            *fileSystem);
+            auto shardDefinition = Factories::CreateShardDefinition();
+
+            auto statistics =
+                Factories::CreateStreamingStatistics(*fileManager,
+                                                     *shardDefinition,
+                                                     5,
+                                                     1.0);
+
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < c_threadCount; ++t)
+            {
+                threads.emplace_back([&statistics, t]()
+                {
+                    for (size_t document = t;
+                         document < c_documentCount;
+                         document += c_threadCount)
+                    {
+                        statistics->AddDocument(GetTerms(document), 100);
+                    }
+                });
+            }
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            EXPECT_EQ(statistics->GetDocumentCount(), c_documentCount);
+            EXPECT_GT(statistics->GetRunCount(), 1u);
+
+            statistics->WriteStatistics(nullptr);
+
+            DocumentFrequencyTableBuilder builder;
+            for (size_t document = 0; document < c_documentCount; ++document)
+            {
+                for (auto const & term : GetTerms(document))
+                {
+                    builder.OnTerm(term);
+                }
+                builder.OnDocumentEnter();
+            }
+
+            std::stringstream expectedStream;
+            builder.WriteFrequencies(expectedStream, 0.0, nullptr);
+            DocumentFrequencyTable expected(expectedStream);
+
+            DocumentFrequencyTable observed(
+                *fileManager->DocFreqTable(0).OpenForRead());
+
+            ASSERT_EQ(observed.size(), c_maxTerm);
+            EXPECT_EQ(GetFrequencies(observed), GetFrequencies(expected));
+        }
+    }
+}
@@ -299,7 +299,8 @@ private:
                                      terms,
                                      facts,
                                      termTable,
-                                     c_randomSkipDistance);
+                                     c_randomSkipDistance,
+                                     1);
 
             // builder.Print(std::cout);
 
@@ -343,6 +344,69 @@ private:
             // TODO: Verify facts
             // TODO: Verify row counts.
         }
+
+
+        // Row assignment must not depend on the number of threads.
+        TEST(TermTableBuilder, ThreadCount)
+        {
+            const double density = 0.1;
+            const double snr = 10.0;
+            const double adhocFrequency = 0.0001;
+            const unsigned randomSkipDistance = 4;
+
+            DocumentFrequencyTable terms;
+            double frequency = 0.5;
+            for (Term::Hash hash = 1000; hash < 6000; ++hash)
+            {
+                Term::IdfX10 idf =
+                    Term::ComputeIdfX10(frequency, Term::c_maxIdfX10Value);
+                terms.AddEntry(DocumentFrequencyTable::Entry(
+                    Term(hash, 1, idf, 1), frequency));
+                frequency *= 0.998;
+            }
+
+            TreatmentPrivateSharedRank0ToN treatment(density, snr, 0);
+            FactSetBase facts;
+
+            TermTable serial;
+            TermTableBuilder serialBuilder(density,
+                                           adhocFrequency,
+                                           treatment,
+                                           terms,
+                                           facts,
+                                           serial,
+                                           randomSkipDistance,
+                                           1);
+
+            TermTable parallel;
+            TermTableBuilder parallelBuilder(density,
+                                             adhocFrequency,
+                                             treatment,
+                                             terms,
+                                             facts,
+                                             parallel,
+                                             randomSkipDistance,
+                                             4);
+
+            for (auto term : terms)
+            {
+                RowIdSequence expected(term.GetTerm(), serial);
+                RowIdSequence observed(term.GetTerm(), parallel);
+
+                EXPECT_TRUE(std::equal(observed.begin(),
+                                       observed.end(),
+                                       expected.begin()));
+                EXPECT_TRUE(std::equal(expected.begin(),
+                                       expected.end(),
+                                       observed.begin()));
+            }
+
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                EXPECT_EQ(serial.GetTotalRowCount(rank),
+                          parallel.GetTotalRowCount(rank));
+            }
+        }
     }
 }
 #ifdef _MSC_VER
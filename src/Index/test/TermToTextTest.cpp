@@ -76,5 +76,30 @@ namespace BitFunnel
                 EXPECT_TRUE(expected.compare(observed) == 0);
             }
         }
+
+
+        // Same as RoundTrip, using the binary form.
+        TEST(TermToText, BinaryRoundTrip)
+        {
+            TermToText terms;
+
+            Term::Hash maxHash = 100;
+            for (Term::Hash hash = 0; hash < maxHash; ++hash)
+            {
+                std::string text = (hash == 0) ? "" : "term " + std::to_string(hash);
+                terms.AddTerm(hash, text);
+            }
+
+            std::stringstream stream;
+            terms.WriteBinary(stream);
+            TermToText terms2(stream);
+
+            for (Term::Hash hash = 0; hash < maxHash; ++hash)
+            {
+                std::string expected = (hash == 0) ? "" : "term " + std::to_string(hash);
+                std::string const & observed = terms2.Lookup(hash);
+                EXPECT_TRUE(expected.compare(observed) == 0);
+            }
+        }
     }
 }
@@ -0,0 +1,200 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/ITermTreatment.h"
+#include "BitFunnel/Index/ITermTreatmentSearch.h"
+#include "DocumentFrequencyTable.h"
+#include "OptimalTermTreatments.h"
+
+
+namespace BitFunnel
+{
+    namespace TermTreatmentSearchTest
+    {
+        static void InitializeTerms(DocumentFrequencyTable & terms)
+        {
+            for (Term::Hash hash = 1; hash <= 200; ++hash)
+            {
+                const double frequency = 0.5 / static_cast<double>(hash);
+                Term term(hash,
+                          0,
+                          Term::ComputeIdfX10(frequency,
+                                              Term::c_maxIdfX10Value));
+                terms.AddEntry(DocumentFrequencyTable::Entry(term, frequency));
+            }
+        }
+
+
+        static std::vector<Term> GetQuery(Term::IdfX10 a, Term::IdfX10 b)
+        {
+            return { Term(1ull, 0, a), Term(2ull, 0, b) };
+        }
+
+
+        TEST(TermTreatmentSearch, BestCandidate)
+        {
+            DocumentFrequencyTable terms;
+            InitializeTerms(terms);
+
+            const double snr = 10.0;
+            auto search =
+                Factories::CreateTermTreatmentSearch(terms, snr, 0.0, 2);
+            search->AddQuery(GetQuery(20, 30));
+            search->AddQuery(GetQuery(25, 40));
+            search->Search({ 0.05, 0.1, 0.2 });
+
+            ASSERT_EQ(3u, search->GetCandidateCount());
+
+            const size_t best = search->GetBestCandidate();
+            auto const & winner = search->GetCandidate(best);
+            EXPECT_TRUE(winner.IsFeasible());
+            for (size_t i = 0; i < search->GetCandidateCount(); ++i)
+            {
+                auto const & candidate = search->GetCandidate(i);
+                if (candidate.IsFeasible())
+                {
+                    EXPECT_LE(winner.GetQuadwordsPerQuery(),
+                              candidate.GetQuadwordsPerQuery());
+                }
+            }
+
+            // Every term below the density meets the SNR floor without rows
+            // above rank 2.
+            auto treatment = search->CreateTreatment(best);
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                const double signal = Term::IdfX10ToFrequency(idf);
+                if (signal < winner.GetDensity())
+                {
+                    auto rows = treatment->GetTreatment(Term(0ull, 0, idf));
+                    size_t configuration = 0;
+                    for (auto entry : rows)
+                    {
+                        EXPECT_LE(entry.GetRank(), 2u);
+                        size_t digit = 1;
+                        for (Rank r = 0; r < entry.GetRank(); ++r)
+                        {
+                            digit *= 10;
+                        }
+                        configuration += digit * entry.GetRowCount();
+                    }
+
+                    auto metrics = Analyze(configuration,
+                                           winner.GetDensity(),
+                                           signal,
+                                           false).second;
+                    EXPECT_GE(metrics.GetSNR(), snr);
+                }
+            }
+        }
+
+
+        TEST(TermTreatmentSearch, Budget)
+        {
+            DocumentFrequencyTable terms;
+            InitializeTerms(terms);
+
+            auto unbounded =
+                Factories::CreateTermTreatmentSearch(terms, 10.0, 0.0, 2);
+            unbounded->AddQuery(GetQuery(20, 30));
+            unbounded->Search({ 0.1 });
+            const double bits =
+                unbounded->GetCandidate(0).GetBitsPerDocument();
+            EXPECT_TRUE(unbounded->GetCandidate(0).IsFeasible());
+
+            // A budget below the fewest bits any configuration can reach.
+            auto bounded =
+                Factories::CreateTermTreatmentSearch(terms, 10.0, bits / 100, 2);
+            bounded->AddQuery(GetQuery(20, 30));
+            bounded->Search({ 0.1 });
+            EXPECT_FALSE(bounded->GetCandidate(0).IsFeasible());
+            EXPECT_THROW(bounded->GetBestCandidate(), RecoverableError);
+        }
+
+
+        // A budget below the bits of the configurations with the fewest
+        // quadwords is met by trading quadwords for bits, rather than
+        // rejecting the candidate.
+        TEST(TermTreatmentSearch, TradeQuadwordsForBits)
+        {
+            DocumentFrequencyTable terms;
+            InitializeTerms(terms);
+
+            const double snr = 10.0;
+            const double density = 0.1;
+
+            auto unbounded =
+                Factories::CreateTermTreatmentSearch(terms, snr, 0.0, 2);
+            unbounded->AddQuery(GetQuery(20, 30));
+            unbounded->Search({ density });
+            auto const & fastest = unbounded->GetCandidate(0);
+            ASSERT_TRUE(fastest.IsFeasible());
+
+            const double budget = fastest.GetBitsPerDocument() * 0.9;
+            auto bounded =
+                Factories::CreateTermTreatmentSearch(terms, snr, budget, 2);
+            bounded->AddQuery(GetQuery(20, 30));
+            bounded->Search({ density });
+            ASSERT_EQ(0u, bounded->GetBestCandidate());
+
+            auto const & candidate = bounded->GetCandidate(0);
+            EXPECT_TRUE(candidate.IsFeasible());
+            EXPECT_LE(candidate.GetBitsPerDocument(), budget);
+            EXPECT_GT(candidate.GetBitsPerDocument(), 0.0);
+            EXPECT_GE(candidate.GetQuadwordsPerQuery(),
+                      fastest.GetQuadwordsPerQuery());
+
+            // Every idf has rows, and those below the density still meet
+            // the SNR floor.
+            auto treatment = bounded->CreateTreatment(0);
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                auto rows = treatment->GetTreatment(Term(0ull, 0, idf));
+                size_t configuration = 0;
+                for (auto entry : rows)
+                {
+                    size_t digit = 1;
+                    for (Rank r = 0; r < entry.GetRank(); ++r)
+                    {
+                        digit *= 10;
+                    }
+                    configuration += digit * entry.GetRowCount();
+                }
+                ASSERT_GT(configuration, 0u);
+
+                const double signal = Term::IdfX10ToFrequency(idf);
+                if (signal < density)
+                {
+                    auto metrics =
+                        Analyze(configuration, density, signal, false).second;
+                    EXPECT_GE(metrics.GetSNR(), snr);
+                }
+            }
+        }
+    }
+}
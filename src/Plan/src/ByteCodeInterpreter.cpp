@@ -22,6 +22,7 @@
 
 #include <iostream>
 #include <limits>
+#include <xmmintrin.h>      // _mm_prefetch().
 
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/IDiagnosticStream.h"
@@ -32,6 +33,7 @@
 #include "CacheLineRecorder.h"
 #include "LoggerInterfaces/Check.h"
 #include "ResultsBuffer.h"
+#include "SummaryFilter.h"
 
 
 namespace BitFunnel
@@ -65,7 +67,9 @@ Decide on type of Slices
         ptrdiff_t const * rowOffsets,
         IDiagnosticStream * diagnosticStream,
         QueryInstrumentation & instrumentation,
-        CacheLineRecorder * cacheLineRecorder)
+        CacheLineRecorder * cacheLineRecorder,
+        size_t prefetchDistance,
+        uint64_t const * liveIterations)
       : m_code(code.GetCode()),
         m_jumpTable(code.GetJumpTable()),
         m_resultsBuffer(resultsBuffer),
@@ -77,7 +81,9 @@ Decide on type of Slices
         m_dedupe(),
         m_diagnosticStream(diagnosticStream),
         m_instrumentation(instrumentation),
-        m_cacheLineRecorder(cacheLineRecorder)
+        m_cacheLineRecorder(cacheLineRecorder),
+        m_prefetchDistance(prefetchDistance),
+        m_liveIterations(liveIterations)
     {
     }
 
@@ -110,8 +116,18 @@ Decide on type of Slices
 
         bool terminate = false;
 
+        uint64_t const * live = (m_liveIterations == nullptr) ?
+            nullptr :
+            m_liveIterations
+                + slice * SummaryFilter::GetQuadwordsPerSlice(m_iterationsPerSlice);
+
         for (size_t i = 0; i < m_iterationsPerSlice; ++i)
         {
+            if (live != nullptr && ((live[i >> 6] >> (i & 63)) & 1ull) == 0)
+            {
+                continue;
+            }
+
             terminate = RunOneIteration(sliceBuffer, i);
             if (terminate)
             {
@@ -178,6 +194,11 @@ Decide on type of Slices
                             sliceBuffer + m_rowOffsets[row]);
 
                     auto ptr = rowPtr + (offset >> delta);
+                    if (delta == 0 && m_prefetchDistance > 0)
+                    {
+                        _mm_prefetch(reinterpret_cast<char const *>(ptr + m_prefetchDistance),
+                                     _MM_HINT_T0);
+                    }
                     if (m_cacheLineRecorder != nullptr)
                     {
                         m_cacheLineRecorder->RecordAccess(ptr);
@@ -205,6 +226,11 @@ Decide on type of Slices
                             sliceBuffer + m_rowOffsets[row]);
 
                     auto ptr = rowPtr + (offset >> delta);
+                    if (delta == 0 && m_prefetchDistance > 0)
+                    {
+                        _mm_prefetch(reinterpret_cast<char const *>(ptr + m_prefetchDistance),
+                                     _MM_HINT_T0);
+                    }
                     if (m_cacheLineRecorder != nullptr)
                     {
                         m_cacheLineRecorder->RecordAccess(ptr);
@@ -255,7 +281,7 @@ Decide on type of Slices
             case Opcode::Constant:
                 throw NotImplemented("Constant opcode not implemented.");
             case Opcode::Not:
-                accumulator = !accumulator;
+                accumulator = ~accumulator;
                 ip++;
                 break;
             case Opcode::OrStack:
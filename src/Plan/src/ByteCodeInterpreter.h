@@ -62,7 +62,11 @@ namespace BitFunnel
 
         // Constructs a ByteCodeInterpreter for the sequence of instructions
         // in a specific ByteCodeGenerator. This interpreter will run against
-        // the rows passed as that second parameter.
+        // the rows passed as that second parameter. When prefetchDistance is
+        // non-zero, each row load at the current rank also prefetches the
+        // quadword prefetchDistance iterations ahead. When liveIterations is
+        // not nullptr, it holds one bit per iteration for each slice (see
+        // SummaryFilter) and iterations whose bit is clear are skipped.
         ByteCodeInterpreter(ByteCodeGenerator const & code,
                             ResultsBuffer & resultsBuffer,
                             size_t sliceCount,
@@ -72,7 +76,9 @@ namespace BitFunnel
                             ptrdiff_t const * rowOffsets,
                             IDiagnosticStream * diagnosticStream,
                             QueryInstrumentation & instrumentation,
-                            CacheLineRecorder * cacheLineRecorder);
+                            CacheLineRecorder * cacheLineRecorder,
+                            size_t prefetchDistance,
+                            uint64_t const * liveIterations);
 
         // Runs the instruction sequence for a specified number of iterations.
         // Each iteration processes a single quadword of row data at the
@@ -230,6 +236,8 @@ namespace BitFunnel
         IDiagnosticStream* m_diagnosticStream;
         QueryInstrumentation& m_instrumentation;
         CacheLineRecorder * m_cacheLineRecorder;
+        const size_t m_prefetchDistance;
+        uint64_t const * m_liveIterations;
     };
 
 
@@ -0,0 +1,113 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "CompileWorker.h"
+
+
+namespace BitFunnel
+{
+    CompileWorker::CompileWorker()
+      : m_busy(false),
+        m_stopping(false)
+    {
+    }
+
+
+    CompileWorker::~CompileWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stopping = true;
+        }
+        m_wakeup.notify_all();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+
+    bool CompileWorker::TryStart(std::function<void()> const & task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_busy)
+            {
+                return false;
+            }
+
+            m_task = task;
+            m_busy = true;
+
+            if (!m_thread.joinable())
+            {
+                m_thread = std::thread(&CompileWorker::WorkerThreadEntryPoint,
+                                       this);
+            }
+        }
+        m_wakeup.notify_one();
+
+        return true;
+    }
+
+
+    bool CompileWorker::IsIdle() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return !m_busy;
+    }
+
+
+    void CompileWorker::Wait()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_finished.wait(lock, [this]() { return !m_busy; });
+    }
+
+
+    void CompileWorker::WorkerThreadEntryPoint()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;)
+        {
+            m_wakeup.wait(lock, [this]() { return m_stopping || m_task; });
+
+            if (m_task)
+            {
+                std::function<void()> task;
+                task.swap(m_task);
+
+                lock.unlock();
+                task();
+                lock.lock();
+
+                m_busy = false;
+                m_finished.notify_all();
+            }
+            else if (m_stopping)
+            {
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>                   // std::condition_variable member.
+#include <functional>                           // std::function member.
+#include <mutex>                                // std::mutex member.
+#include <thread>                               // std::thread member.
+
+#include "BitFunnel/NonCopyable.h"              // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // CompileWorker
+    //
+    // A single background thread that runs one NativeJIT compile at a time
+    // for MatcherMode::Adaptive. Each QueryResources owns one, so the number
+    // of compile threads matches the number of query threads, and the thread
+    // is created once rather than per query.
+    //
+    //*************************************************************************
+    class CompileWorker : NonCopyable
+    {
+    public:
+        CompileWorker();
+
+        ~CompileWorker();
+
+        // Hands task to the worker thread, starting the thread on first use.
+        // Returns false without running task if an earlier task has not
+        // finished. The task must not throw.
+        bool TryStart(std::function<void()> const & task);
+
+        // Returns true if no task is running.
+        bool IsIdle() const;
+
+        // Blocks until the running task, if any, finishes.
+        void Wait();
+
+    private:
+        void WorkerThreadEntryPoint();
+
+        std::thread m_thread;
+        mutable std::mutex m_lock;
+        std::condition_variable m_wakeup;
+        std::condition_variable m_finished;
+        std::function<void()> m_task;
+        bool m_busy;
+        bool m_stopping;
+    };
+}
@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 
 #include "LoggerInterfaces/Check.h"
+#include "LoggerInterfaces/Logging.h"
 #include "MachineCodeGenerator.h"
 #include "NativeCodeGenerator.h"
 #include "NativeJIT/CodeGen/FunctionBuffer.h"
@@ -32,24 +33,41 @@ using namespace NativeJIT;
 
 namespace BitFunnel
 {
-    // New register scheme:
+    // Register scheme:
     //
-    // slice the pointer to the current slice buffer
-    // iteration is the iteration count in the inner loop
+    // offset is the byte offset of the current quadword from the start of
+    // the slice buffer.
     //
     // rax: scratch register
     // rbx: accumulator
-    // rcx: slice + iteration
-    // rdx: slice
-    // rsi: pointer to array of row offsets
+    // rcx: offset
     // rdi: pointer to parameters data structure
-    // r8-r15: row offset pointers
+    // r8-r15, rdx, rsi: row pointers
+    //
+    // When prefetching is enabled, each load of a row at the current rank is
+    // preceded by a prefetcht0 of the same row m_prefetchDistance quadwords
+    // ahead.
+    //
+    // Row pointers are the absolute addresses of rows in the current slice.
+    // NativeCodeGenerator computes them once per slice, so loads from
+    // register allocated rows address [offset + row pointer] directly. The
+    // pointers for the remaining rows are stored in
+    // NativeCodeGenerator::Parameters::m_rowPointers.
+    const unsigned MachineCodeGenerator::c_rowRegisters[c_registerCount] =
+    {
+        8, 9, 10, 11, 12, 13, 14, 15,   // r8-r15
+        2,                              // rdx
+        6                               // rsi
+    };
+
 
 
     MachineCodeGenerator::MachineCodeGenerator(RegisterAllocator const & registers,
-                                               FunctionBuffer & code)
+                                               FunctionBuffer & code,
+                                               size_t prefetchDistance)
       : m_registers(registers),
         m_code(code),
+        m_prefetchDistance(prefetchDistance),
         m_pushCount(0)
     {
     }
@@ -78,7 +96,6 @@ namespace BitFunnel
         {
             // Store rank-adjusted offset in rax.
             m_code.Emit<OpCode::Mov>(rax, rcx);
-            m_code.Emit<OpCode::Sub>(rax, rdx);
             m_code.EmitImmediate<OpCode::Shr>(rax, static_cast<uint8_t>(rankDelta + 3));
             m_code.EmitImmediate<OpCode::Shl>(rax, static_cast<uint8_t>(3));
 
@@ -87,15 +104,13 @@ namespace BitFunnel
                 if (m_registers.IsRegister(id))
                 {
                     // Case 1: rankDelta > 0 && !inverted && IsRegister
-                    m_code.Emit<OpCode::Add>(rax, rdx);
-                    unsigned reg = m_registers.GetRegister(id);
-                    m_code.Emit<OpCode::And>(rbx, rax, Register<8u, false>(reg), SIB::Scale1, 0);
+                    m_code.Emit<OpCode::And>(rbx, rax, GetRowRegister(id), SIB::Scale1, 0);
                 }
                 else
                 {
                     // Case 2: rankDelta > 0 && !inverted && !IsRegister
-                    m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
-                    m_code.Emit<OpCode::And>(rbx, rax, rdx, SIB::Scale1, 0);
+                    m_code.Emit<OpCode::Add>(rax, rdi, GetRowPointerOffset(id));
+                    m_code.Emit<OpCode::And>(rbx, rax, 0);
                 }
             }
             else
@@ -103,15 +118,13 @@ namespace BitFunnel
                 if (m_registers.IsRegister(id))
                 {
                     // Case 3: rankDelta > 0 && inverted && IsRegister
-                    m_code.Emit<OpCode::Add>(rax, rdx);
-                    unsigned reg = m_registers.GetRegister(id);
-                    m_code.Emit<OpCode::Mov>(rax, rax, Register<8u, false>(reg), SIB::Scale1, 0);
+                    m_code.Emit<OpCode::Mov>(rax, rax, GetRowRegister(id), SIB::Scale1, 0);
                 }
                 else
                 {
                     // Case 4: rankDelta > 0 && inverted && !IsRegister
-                    m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
-                    m_code.Emit<OpCode::Mov>(rax, rax, rdx, SIB::Scale1, 0);
+                    m_code.Emit<OpCode::Add>(rax, rdi, GetRowPointerOffset(id));
+                    m_code.Emit<OpCode::Mov>(rax, rax, 0);
                 }
 
                 // Combine inverted row with accumulator(RBX).
@@ -126,15 +139,15 @@ namespace BitFunnel
                 if (m_registers.IsRegister(id))
                 {
                     // Case 5: rankDelta == 0 && !inverted && IsRegister
-                    unsigned reg = m_registers.GetRegister(id);
-                    m_code.Emit<OpCode::And>(rbx, rcx, Register<8u, false>(reg), SIB::Scale1, 0);
+                    EmitPrefetch(rcx, GetRowRegister(id));
+                    m_code.Emit<OpCode::And>(rbx, rcx, GetRowRegister(id), SIB::Scale1, 0);
                 }
                 else
                 {
                     // Case 6: rankDelta == 0 && !inverted && !IsRegister
-                    m_code.Emit<OpCode::Mov>(rax, rcx);
-                    m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
-                    m_code.Emit<OpCode::And>(rbx, rax, 0);
+                    m_code.Emit<OpCode::Mov>(rax, rdi, GetRowPointerOffset(id));
+                    EmitPrefetch(rax, rcx);
+                    m_code.Emit<OpCode::And>(rbx, rax, rcx, SIB::Scale1, 0);
                 }
             }
             else
@@ -143,15 +156,15 @@ namespace BitFunnel
                 if (m_registers.IsRegister(id))
                 {
                     // Case 7: rankDelta == 0 && inverted && IsRegister
-                    unsigned reg = m_registers.GetRegister(id);
-                    m_code.Emit<OpCode::Mov>(rax, rcx, Register<8u, false>(reg), SIB::Scale1, 0);
+                    EmitPrefetch(rcx, GetRowRegister(id));
+                    m_code.Emit<OpCode::Mov>(rax, rcx, GetRowRegister(id), SIB::Scale1, 0);
                 }
                 else
                 {
                     // Case 8: rankDelta == 0 && inverted && !IsRegister
-                    m_code.Emit<OpCode::Mov>(rax, rcx);
-                    m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
-                    m_code.Emit<OpCode::Mov>(rax, rax, 0);
+                    m_code.Emit<OpCode::Mov>(rax, rdi, GetRowPointerOffset(id));
+                    EmitPrefetch(rax, rcx);
+                    m_code.Emit<OpCode::Mov>(rax, rax, rcx, SIB::Scale1, 0);
                 }
 
                 // Combine inverted row with accumulator(RBX).
@@ -180,22 +193,19 @@ namespace BitFunnel
         {
             // Store rank-adjusted offset in rax.
             m_code.Emit<OpCode::Mov>(rax, rcx);
-            m_code.Emit<OpCode::Sub>(rax, rdx);
             m_code.EmitImmediate<OpCode::Shr>(rax, static_cast<uint8_t>(rankDelta + 3));
             m_code.EmitImmediate<OpCode::Shl>(rax, static_cast<uint8_t>(3));
 
             if (m_registers.IsRegister(id))
             {
                 // Case 1: rankDelta > 0, IsRegister
-                m_code.Emit<OpCode::Add>(rax, rdx);
-                unsigned reg = m_registers.GetRegister(id);
-                m_code.Emit<OpCode::Mov>(rbx, rax, Register<8u, false>(reg), SIB::Scale1, 0);
+                m_code.Emit<OpCode::Mov>(rbx, rax, GetRowRegister(id), SIB::Scale1, 0);
             }
             else
             {
                 // Case 2: rankDelta > 0, !IsRegister
-                m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
-                m_code.Emit<OpCode::Mov>(rbx, rax, rdx, SIB::Scale1, 0);
+                m_code.Emit<OpCode::Add>(rax, rdi, GetRowPointerOffset(id));
+                m_code.Emit<OpCode::Mov>(rbx, rax, 0);
             }
         }
         else
@@ -203,15 +213,15 @@ namespace BitFunnel
             if (m_registers.IsRegister(id))
             {
                 // Case 3: rankDelta == 0, IsRegister
-                unsigned reg = m_registers.GetRegister(id);
-                m_code.Emit<OpCode::Mov>(rbx, rcx, Register<8u, false>(reg), SIB::Scale1, 0);
+                EmitPrefetch(rcx, GetRowRegister(id));
+                m_code.Emit<OpCode::Mov>(rbx, rcx, GetRowRegister(id), SIB::Scale1, 0);
             }
             else
             {
                 // Case 4: rankDelta == 0, !IsRegister
-                m_code.Emit<OpCode::Mov>(rax, rcx);
-                m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
-                m_code.Emit<OpCode::Mov>(rbx, rax, 0);
+                m_code.Emit<OpCode::Mov>(rax, rdi, GetRowPointerOffset(id));
+                EmitPrefetch(rax, rcx);
+                m_code.Emit<OpCode::Mov>(rbx, rax, rcx, SIB::Scale1, 0);
             }
         }
 
@@ -229,20 +239,15 @@ namespace BitFunnel
 
     void MachineCodeGenerator::LeftShiftOffset(size_t shift)
     {
-        // Decode the offset into RCX, adjust for the shift and then encode it back.
-        m_code.Emit<OpCode::Sub>(rcx, rdx);
         m_code.EmitImmediate<OpCode::Shl>(rcx, static_cast<uint8_t>(shift));
-        m_code.Emit<OpCode::Add>(rcx, rdx);
     }
 
 
     void MachineCodeGenerator::RightShiftOffset(size_t shift)
     {
-        // Decode the offset into RCX, adjust for the shift and then encode it back.
-        m_code.Emit<OpCode::Sub>(rcx, rdx);
+        // Round down to a quadword boundary.
         m_code.EmitImmediate<OpCode::Shr>(rcx, static_cast<uint8_t>(shift + 3));
         m_code.EmitImmediate<OpCode::Shl>(rcx, static_cast<uint8_t>(3));
-        m_code.Emit<OpCode::Add>(rcx, rdx);
     }
 
 
@@ -309,8 +314,7 @@ namespace BitFunnel
         // Free up a register.
         m_code.Emit<OpCode::Push>(rcx);
 
-        // Compute iteration number in rax.
-        m_code.Emit<OpCode::Sub>(rcx, rdx);
+        // Compute iteration number in rcx.
         m_code.EmitImmediate<OpCode::Shr>(rcx, static_cast<uint8_t>(3));
         m_code.Emit<OpCode::Sub>(rcx, rdi, NativeCodeGenerator::m_base);
 
@@ -391,4 +395,43 @@ namespace BitFunnel
     {
         return c_slotCount;
     }
+
+
+    unsigned MachineCodeGenerator::GetPhysicalRegister(unsigned reg)
+    {
+        LogAssertB(reg - c_registerBase < c_registerCount,
+                   "Row register out of range.");
+        return c_rowRegisters[reg - c_registerBase];
+    }
+
+
+    void MachineCodeGenerator::EmitPrefetch(Register<8u, false> base,
+                                            Register<8u, false> index)
+    {
+        // Only rows at the current rank stream through memory. Rows at
+        // higher ranks (rankDelta > 0) reuse the same quadword for many
+        // iterations, so they stay in cache without help.
+        if (m_prefetchDistance > 0)
+        {
+            m_code.Emit<OpCode::PrefetchT0>(
+                base,
+                index,
+                SIB::Scale1,
+                static_cast<int32_t>(m_prefetchDistance * sizeof(uint64_t)));
+        }
+    }
+
+
+    Register<8u, false> MachineCodeGenerator::GetRowRegister(unsigned id) const
+    {
+        return Register<8u, false>(GetPhysicalRegister(m_registers.GetRegister(id)));
+    }
+
+
+    int32_t MachineCodeGenerator::GetRowPointerOffset(unsigned id)
+    {
+        LogAssertB(id < c_maxRowsPerQuery, "Row id out of range.");
+        return NativeCodeGenerator::m_rowPointers
+            + static_cast<int32_t>(id * sizeof(void*));
+    }
 }
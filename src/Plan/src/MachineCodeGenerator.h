@@ -22,8 +22,11 @@
 
 #pragma once
 
+#include <stdint.h>                     // int32_t return value.
+
 #include "BitFunnel/NonCopyable.h"      // Base class.
 #include "ICodeGenerator.h"             // Base class.
+#include "NativeJIT/CodeGen/Register.h" // Register return value.
 
 
 namespace NativeJIT
@@ -54,8 +57,12 @@ namespace BitFunnel
         // Constructs a MachineCodeGenerator which generates X64 code using the
         // supplied X64FunctionGenerator. The registers parameter supplies a
         // RegisterAllocator that provides register assignments for some rows.
+        // When prefetchDistance is non-zero, every row load at the current
+        // rank is preceded by a prefetch of the quadword prefetchDistance
+        // iterations ahead.
         MachineCodeGenerator(RegisterAllocator const & registers,
-                             FunctionBuffer & code);
+                             FunctionBuffer & code,
+                             size_t prefetchDistance);
 
         //
         // ICodeGenerator methods
@@ -106,12 +113,28 @@ namespace BitFunnel
         // allocator.
         static unsigned GetRegisterCount();
 
+        // Returns the x64 register number that holds the row pointer for a
+        // register number assigned by the RegisterAllocator.
+        static unsigned GetPhysicalRegister(unsigned reg);
+
         // Returns the number of stack slots reserved for local variables and
         // parameter homes for calls to the static AddResultsHelper() and
         // FinishIterationHelper() methods.
         static unsigned GetSlotCount();
 
+        // Returns the displacement from the parameters pointer in rdi of the
+        // row pointer for a row that has not been assigned a register.
+        static int32_t GetRowPointerOffset(unsigned id);
+
     protected:
+        // Emits a prefetch of [base + index + m_prefetchDistance quadwords]
+        // if prefetching is enabled.
+        void EmitPrefetch(Register<8u, false> base, Register<8u, false> index);
+
+        // Returns the register holding the row pointer for a row that has
+        // been assigned a register.
+        Register<8u, false> GetRowRegister(unsigned id) const;
+
         //
         // Constructor parameters
         //
@@ -120,6 +143,8 @@ namespace BitFunnel
 
         FunctionBuffer & m_code;
 
+        const size_t m_prefetchDistance;
+
 
         // Records the number of items pushed on the X64 stack since the
         // stack frame setup was completed. Required to satisfy X64 calling
@@ -128,11 +153,15 @@ namespace BitFunnel
         // more information.
         unsigned m_pushCount;
 
-        // First available row pointer register is R8.
-        static const unsigned c_registerBase = 8;
+        // Register numbers handed out by the RegisterAllocator are indices
+        // into c_rowRegisters.
+        static const unsigned c_registerBase = 0;
 
-        // Row pointers stored in the eight registers R8..R15.
-        static const unsigned c_registerCount = 8;
+        // Row pointers are stored in every register not pinned by the
+        // matcher: R8..R15, RDX and RSI. See the register scheme in
+        // MachineCodeGenerator.cpp.
+        static const unsigned c_registerCount = 10;
+        static const unsigned c_rowRegisters[c_registerCount];
 
         // The number of stack slots reserved for local variables and
         // parameter homes for calls to the static AddResultsHelper() and
@@ -21,8 +21,11 @@
 // THE SOFTWARE.
 
 
+#include "BitFunnel/Plan/IMatcherCodeCache.h"
 #include "BitFunnel/Utilities/Allocator.h"
+#include "LoggerInterfaces/Check.h"
 #include "MatchTreeCompiler.h"
+#include "MatcherCodeCache.h"
 #include "NativeJIT/CodeGen/ExecutionBuffer.h"
 #include "QueryResources.h"
 #include "ResultsBuffer.h"
@@ -40,8 +43,31 @@ namespace BitFunnel
     MatchTreeCompiler::MatchTreeCompiler(QueryResources & resources,
                                          CompileNode const & tree,
                                          RegisterAllocator const & registers,
-                                         Rank initialRank)
+                                         Rank initialRank,
+                                         bool useSummaries)
+      : m_useSummaries(useSummaries)
     {
+        // If the plan has been compiled before, in this process or in a
+        // previous one, reuse its code instead of invoking NativeJIT.
+        IMatcherCodeCache * cache = resources.GetMatcherCodeCache();
+        std::string key;
+        if (cache != nullptr)
+        {
+            key = MatcherCodeCache::CreateKey(tree,
+                                              registers,
+                                              initialRank,
+                                              resources.GetPrefetchDistance(),
+                                              useSummaries);
+            void const * entryPoint = cache->Find(key);
+            if (entryPoint != nullptr)
+            {
+                m_function =
+                    reinterpret_cast<NativeCodeGenerator::Prototype::FunctionType>(
+                        const_cast<void*>(entryPoint));
+                return;
+            }
+        }
+
         NativeCodeGenerator::Prototype expression(resources.GetExpressionTreeAllocator(),
                                                   resources.GetCode());
         // TODO: Remove temporary debugging output.
@@ -51,8 +77,22 @@ namespace BitFunnel
             expression.PlacementConstruct<NativeCodeGenerator>(expression,
                                                                tree,
                                                                registers,
-                                                               initialRank);
+                                                               initialRank,
+                                                               resources.GetPrefetchDistance(),
+                                                               useSummaries);
         m_function = expression.Compile(node);
+
+        if (cache != nullptr)
+        {
+            // The FunctionBuffer holds RIP-relative constants and unwind
+            // information ahead of the function's code, so copy everything
+            // from the start of the buffer through the end of the epilog.
+            FunctionBuffer const & code = resources.GetCode();
+            cache->Add(key,
+                       code.BufferStart(),
+                       code.GetFunctionCodeEndOffset(),
+                       code.GetFunctionCodeStartOffset());
+        }
     }
 
 
@@ -60,19 +100,32 @@ namespace BitFunnel
                                   void * const * sliceBuffers,
                                   size_t iterationsPerSlice,
                                   ptrdiff_t const * rowOffsets,
+                                  uint64_t const * liveIterations,
                                   ResultsBuffer & results)
     {
+        // Code generated with summaries reads the bitmap without checking it.
+        if (m_useSummaries)
+        {
+            CHECK_NE(liveIterations, nullptr)
+                << "MatchTreeCompiler: matcher compiled with summaries requires "
+                << "liveIterations.";
+        }
+
+        // Matches are appended to those already in the results buffer so that
+        // native code can pick up where the interpreter left off.
         NativeCodeGenerator::Parameters parameters = {
             sliceCount,
             sliceBuffers,
             iterationsPerSlice,
             rowOffsets,
+            liveIterations,
             0,
             { 0 },
             results.m_capacity,
-            0,
+            results.m_size,
             results.m_buffer,
-            0
+            0,
+            {}
         };
 
         // For now ignore return value.
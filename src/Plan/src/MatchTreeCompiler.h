@@ -51,18 +51,26 @@ namespace BitFunnel
     class MatchTreeCompiler
     {
     public:
+        // When useSummaries is true, the generated code skips iterations
+        // whose bit is clear in the liveIterations bitmap passed to Run().
+        // See SummaryFilter.
         MatchTreeCompiler(QueryResources & resources,
                           CompileNode const & tree,
                           RegisterAllocator const & registers,
-                          Rank initialRank);
+                          Rank initialRank,
+                          bool useSummaries);
 
+        // liveIterations must be supplied if and only if the matcher was
+        // compiled with useSummaries.
         size_t Run(size_t slicecount,
                    void * const * slicebuffers,
                    size_t iterationsperslice,
                    ptrdiff_t const * rowoffsets,
+                   uint64_t const * liveIterations,
                    ResultsBuffer & results);
 
     private:
+        const bool m_useSummaries;
         NativeCodeGenerator::Prototype::FunctionType m_function;
     };
 }
@@ -0,0 +1,413 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <random>
+#include <sstream>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Plan/MatcherBenchmark.h"
+#include "BitFunnel/Plan/QueryInstrumentation.h"
+#include "BitFunnel/Utilities/Allocator.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "ByteCodeInterpreter.h"
+#include "CompileNode.h"
+#include "MachineCodeGenerator.h"
+#include "MatchTreeCompiler.h"
+#include "MatchTreeRewriter.h"
+#include "QueryResources.h"
+#include "RankDownCompiler.h"
+#include "RegisterAllocator.h"
+#include "ResultsBuffer.h"
+#include "RowMatchNode.h"
+#include "SummaryFilter.h"
+#include "TextObjectParser.h"
+
+
+namespace BitFunnel
+{
+    // The matchers read a Slice* from the start of each slice buffer when
+    // they report matches. The fabricated slices reserve a cache line for it
+    // and leave it null.
+    static const size_t c_sliceHeaderBytes = 64;
+
+    static const size_t c_cacheLineBytes = 64;
+
+    // Same as RowTableDescriptor::c_docsPerSummaryBit: one summary bit per
+    // cache line of a rank 0 row.
+    static const size_t c_docsPerSummaryBit = c_cacheLineBytes * 8;
+
+    static const size_t c_allocatorBufferSize = 1ull << 20;
+
+    // Same targets that Factories::RunQueryPlanner() gives the
+    // MatchTreeRewriter.
+    static const unsigned c_targetRowCount = 500;
+    static const unsigned c_targetCrossProductTermCount = 180;
+
+
+    //*************************************************************************
+    //
+    // MatcherBenchmark::Result
+    //
+    //*************************************************************************
+    MatcherBenchmark::Result::Result(size_t quadwordCount,
+                                     size_t matchCount,
+                                     double compileTime,
+                                     double matchTime)
+      : m_quadwordCount(quadwordCount),
+        m_matchCount(matchCount),
+        m_compileTime(compileTime),
+        m_matchTime(matchTime)
+    {
+    }
+
+
+    size_t MatcherBenchmark::Result::GetQuadwordCount() const
+    {
+        return m_quadwordCount;
+    }
+
+
+    size_t MatcherBenchmark::Result::GetMatchCount() const
+    {
+        return m_matchCount;
+    }
+
+
+    double MatcherBenchmark::Result::GetCompileTime() const
+    {
+        return m_compileTime;
+    }
+
+
+    double MatcherBenchmark::Result::GetMatchTime() const
+    {
+        return m_matchTime;
+    }
+
+
+    double MatcherBenchmark::Result::GetNanosecondsPerQuadword() const
+    {
+        return m_quadwordCount == 0 ? 0.0 : m_matchTime * 1e9 / m_quadwordCount;
+    }
+
+
+    double MatcherBenchmark::Result::GetNanosecondsPerMatch() const
+    {
+        return m_matchCount == 0 ? 0.0 : m_matchTime * 1e9 / m_matchCount;
+    }
+
+
+    //*************************************************************************
+    //
+    // MatcherBenchmark
+    //
+    //*************************************************************************
+    MatcherBenchmark::MatcherBenchmark(std::vector<RowDescriptor> const & rows,
+                                       size_t sliceCapacity,
+                                       size_t sliceCount,
+                                       unsigned seed)
+      : m_rows(rows),
+        m_sliceCapacity(sliceCapacity)
+    {
+        if (sliceCapacity == 0 ||
+            sliceCapacity % (64ull << c_maxRankValue) != 0)
+        {
+            RecoverableError
+                error("MatcherBenchmark: slice capacity must be a positive "
+                      "multiple of 64 << c_maxRankValue.");
+            throw error;
+        }
+
+        if (sliceCount == 0)
+        {
+            RecoverableError error("MatcherBenchmark: no slices.");
+            throw error;
+        }
+
+        size_t sliceBytes = c_sliceHeaderBytes;
+        for (auto const & row : m_rows)
+        {
+            if (row.m_rank > c_maxRankValue ||
+                !(row.m_density >= 0.0 && row.m_density <= 1.0))
+            {
+                RecoverableError
+                    error("MatcherBenchmark: bad row rank or density.");
+                throw error;
+            }
+
+            m_rowOffsets.push_back(static_cast<ptrdiff_t>(sliceBytes));
+            const size_t rowBytes = (sliceCapacity >> 3) >> row.m_rank;
+            sliceBytes += (rowBytes + c_cacheLineBytes - 1) /
+                c_cacheLineBytes * c_cacheLineBytes;
+
+            if (row.m_rank == 0)
+            {
+                m_summaryOffsets.push_back(static_cast<ptrdiff_t>(sliceBytes));
+                const size_t summaryBits =
+                    (sliceCapacity + c_docsPerSummaryBit - 1) / c_docsPerSummaryBit;
+                const size_t summaryBytes = (summaryBits + 63) / 64 * sizeof(uint64_t);
+                sliceBytes += (summaryBytes + c_cacheLineBytes - 1) /
+                    c_cacheLineBytes * c_cacheLineBytes;
+            }
+            else
+            {
+                m_summaryOffsets.push_back(0);
+            }
+        }
+
+        // Over allocate by a cache line so that the first slice can start
+        // on a cache line boundary.
+        const size_t quadwordsPerSlice = sliceBytes / sizeof(uint64_t);
+        const size_t quadwordsPerCacheLine = c_cacheLineBytes / sizeof(uint64_t);
+        m_storage.resize(quadwordsPerSlice * sliceCount + quadwordsPerCacheLine, 0);
+
+        const size_t misalignment =
+            reinterpret_cast<size_t>(m_storage.data()) % c_cacheLineBytes;
+        uint64_t * base = m_storage.data() +
+            (misalignment == 0 ? 0 :
+             (c_cacheLineBytes - misalignment) / sizeof(uint64_t));
+
+        // Bits are set by comparing the top 53 bits of the generator with the
+        // density, rather than through std::uniform_real_distribution, whose
+        // output differs between standard libraries.
+        std::mt19937_64 random(seed);
+
+        for (size_t slice = 0; slice < sliceCount; ++slice)
+        {
+            uint64_t * buffer = base + slice * quadwordsPerSlice;
+            m_sliceBuffers.push_back(buffer);
+
+            for (size_t row = 0; row < m_rows.size(); ++row)
+            {
+                const double density = m_rows[row].m_density;
+                uint64_t * data = buffer + m_rowOffsets[row] / sizeof(uint64_t);
+                const size_t quadwords =
+                    (sliceCapacity >> 6) >> m_rows[row].m_rank;
+                for (size_t q = 0; q < quadwords; ++q)
+                {
+                    uint64_t value = 0;
+                    for (size_t bit = 0; bit < 64; ++bit)
+                    {
+                        if ((random() >> 11) * (1.0 / 9007199254740992.0) < density)
+                        {
+                            value |= 1ull << bit;
+                        }
+                    }
+                    data[q] = value;
+                }
+
+                if (m_rows[row].m_rank == 0)
+                {
+                    uint64_t * summary =
+                        buffer + m_summaryOffsets[row] / sizeof(uint64_t);
+                    const size_t quadwordsPerBit = c_docsPerSummaryBit / 64;
+                    for (size_t q = 0; q < quadwords; ++q)
+                    {
+                        if (data[q] != 0)
+                        {
+                            const size_t bit = q / quadwordsPerBit;
+                            summary[bit >> 6] |= 1ull << (bit & 0x3F);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+
+    MatcherBenchmark::Result MatcherBenchmark::Run(char const * plan,
+                                                   MatcherMode mode,
+                                                   size_t passCount,
+                                                   size_t prefetchDistance,
+                                                   bool useSummaries) const
+    {
+        if (mode == MatcherMode::Adaptive)
+        {
+            RecoverableError
+                error("MatcherBenchmark: adaptive mode is not supported.");
+            throw error;
+        }
+
+        Allocator allocator(c_allocatorBufferSize);
+
+        std::stringstream input(plan);
+        TextObjectParser parser(input, allocator, &RowPlanBase::GetType);
+        RowMatchNode const & tree = RowMatchNode::Parse(parser);
+
+        RowMatchNode const & rewritten =
+            MatchTreeRewriter::Rewrite(tree,
+                                       c_targetRowCount,
+                                       c_targetCrossProductTermCount,
+                                       allocator);
+
+        RankDownCompiler compiler(allocator);
+        compiler.Compile(rewritten);
+        const Rank initialRank = compiler.GetMaximumRank();
+        CompileNode const & compileTree = compiler.CreateTree(initialRank);
+
+        const size_t iterationsPerSlice = (m_sliceCapacity >> 6) >> initialRank;
+
+        // As in QueryPlanner, summaries are only used when some rank 0 row
+        // is required by every match.
+        std::vector<ptrdiff_t> summaryOffsets;
+        if (useSummaries)
+        {
+            std::vector<unsigned> requiredRows;
+            SummaryFilter::CollectRequiredRows(rewritten, requiredRows);
+            for (auto id : requiredRows)
+            {
+                if (id >= m_rows.size() || m_rows[id].m_rank != 0)
+                {
+                    RecoverableError
+                        error("MatcherBenchmark: bad row in plan.");
+                    throw error;
+                }
+                summaryOffsets.push_back(m_summaryOffsets[id]);
+            }
+        }
+        const bool isFiltered = !summaryOffsets.empty();
+
+        const size_t liveQuadwordsPerSlice =
+            SummaryFilter::GetQuadwordsPerSlice(iterationsPerSlice);
+        std::vector<uint64_t> liveIterations(
+            isFiltered ? liveQuadwordsPerSlice * m_sliceBuffers.size() : 0);
+
+        // Computes the live iterations for every slice, as QueryPlanner does
+        // for each shard, and returns the bitmap for the matchers.
+        auto computeLiveIterations = [&]() -> uint64_t const *
+        {
+            if (!isFiltered)
+            {
+                return nullptr;
+            }
+
+            for (size_t slice = 0; slice < m_sliceBuffers.size(); ++slice)
+            {
+                SummaryFilter::ComputeSliceLiveIterations(
+                    m_sliceBuffers[slice],
+                    summaryOffsets,
+                    c_docsPerSummaryBit,
+                    initialRank,
+                    iterationsPerSlice,
+                    liveIterations.data() + slice * liveQuadwordsPerSlice);
+            }
+            return liveIterations.data();
+        };
+
+        ResultsBuffer results(GetDocumentCount());
+        double compileTime = 0.0;
+        double matchTime = 0.0;
+
+        ByteCodeGenerator code;
+        compileTree.Compile(code);
+        code.Seal();
+
+        // The interpreter always counts the row quadwords it reads. Native
+        // code only counts them when built with QUADWORDCOUNT, which would
+        // distort its timing, so for MatcherMode::Compiler the count comes
+        // from an untimed interpreter pass over the same plan.
+        size_t quadwordCount = 0;
+        const size_t interpreterPassCount =
+            (mode == MatcherMode::Interpreter) ? passCount : 1;
+        for (size_t pass = 0; pass < interpreterPassCount; ++pass)
+        {
+            results.Reset();
+            QueryInstrumentation instrumentation;
+
+            Stopwatch summaryTimer;
+            uint64_t const * live = computeLiveIterations();
+            const double summaryTime = summaryTimer.ElapsedTime();
+
+            ByteCodeInterpreter interpreter(code,
+                                            results,
+                                            m_sliceBuffers.size(),
+                                            m_sliceBuffers.data(),
+                                            iterationsPerSlice,
+                                            initialRank,
+                                            m_rowOffsets.data(),
+                                            nullptr,
+                                            instrumentation,
+                                            nullptr,
+                                            prefetchDistance,
+                                            live);
+
+            Stopwatch stopwatch;
+            interpreter.Run();
+            const double elapsed = summaryTime + stopwatch.ElapsedTime();
+
+            if (pass == 0 || elapsed < matchTime)
+            {
+                matchTime = elapsed;
+            }
+            quadwordCount = instrumentation.GetData().GetQuadwordCount();
+        }
+
+        if (mode == MatcherMode::Compiler)
+        {
+            QueryResources resources;
+            resources.SetPrefetchDistance(prefetchDistance);
+
+            RegisterAllocator const
+                registers(compileTree,
+                          static_cast<unsigned>(m_rows.size()),
+                          MachineCodeGenerator::GetRegisterBase(),
+                          MachineCodeGenerator::GetRegisterCount(),
+                          allocator);
+
+            Stopwatch compileTimer;
+            MatchTreeCompiler matcher(resources,
+                                      compileTree,
+                                      registers,
+                                      initialRank,
+                                      isFiltered);
+            compileTime = compileTimer.ElapsedTime();
+
+            for (size_t pass = 0; pass < passCount; ++pass)
+            {
+                results.Reset();
+
+                Stopwatch stopwatch;
+                uint64_t const * live = computeLiveIterations();
+                matcher.Run(m_sliceBuffers.size(),
+                            m_sliceBuffers.data(),
+                            iterationsPerSlice,
+                            m_rowOffsets.data(),
+                            live,
+                            results);
+                const double elapsed = stopwatch.ElapsedTime();
+
+                if (pass == 0 || elapsed < matchTime)
+                {
+                    matchTime = elapsed;
+                }
+            }
+        }
+
+        return Result(quadwordCount, results.size(), compileTime, matchTime);
+    }
+
+
+    size_t MatcherBenchmark::GetDocumentCount() const
+    {
+        return m_sliceCapacity * m_sliceBuffers.size();
+    }
+}
@@ -0,0 +1,327 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include <cstring>                              // std::memcpy.
+#include <sstream>                              // std::stringstream.
+#include <utility>                              // std::move.
+#include <vector>                               // std::vector.
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Plan/Factories.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/FileHeader.h"
+#include "BitFunnel/Utilities/IObjectFormatter.h"
+#include "BitFunnel/Utilities/StreamUtilities.h"
+#include "BitFunnel/Utilities/Version.h"
+#include "CompileNode.h"
+#include "MatcherCodeCache.h"
+#include "NativeCodeGenerator.h"
+#include "NativeJIT/CodeGen/ExecutionBuffer.h"
+#include "RegisterAllocator.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IMatcherCodeCache>
+        Factories::CreateMatcherCodeCache(size_t capacity)
+    {
+        return std::unique_ptr<IMatcherCodeCache>(new MatcherCodeCache(capacity));
+    }
+
+
+    // Version of the stream format written by MatcherCodeCache::Write().
+    static const Version c_matcherCodeCacheVersion(1, 0, 0);
+
+
+    // Version of the code emitted for a given cache key. Increment whenever
+    // NativeCodeGenerator or MatchTreeCompiler change the generated code
+    // without changing the key or the layout of Parameters, so that matchers
+    // saved by an older build are rejected instead of run.
+    //   1: Initial version.
+    //   2: Register allocation by estimated load frequency.
+    //   3: Iterations filtered by summary rows.
+    static const uint64_t c_codeGeneratorVersion = 3;
+
+
+    // Reads byteCount bytes from input. Unlike StreamUtilities, which asserts
+    // on a short read, throws RecoverableError so that a damaged cache file
+    // can be discarded.
+    static void ReadCheckedBytes(std::istream & input,
+                                 void * buffer,
+                                 size_t byteCount)
+    {
+        input.read(static_cast<char*>(buffer),
+                   static_cast<std::streamsize>(byteCount));
+        if (static_cast<size_t>(input.gcount()) != byteCount)
+        {
+            RecoverableError error("MatcherCodeCache::Read: unexpected end of stream.");
+            throw error;
+        }
+    }
+
+
+    template <typename T>
+    static T ReadCheckedField(std::istream & input)
+    {
+        T value;
+        ReadCheckedBytes(input, &value, sizeof(T));
+        return value;
+    }
+
+
+    //*************************************************************************
+    //
+    // MatcherCodeCache
+    //
+    //*************************************************************************
+    MatcherCodeCache::MatcherCodeCache(size_t capacity)
+      : m_code(new NativeJIT::ExecutionBuffer(capacity)),
+        m_bytesUsed(0)
+    {
+    }
+
+
+    MatcherCodeCache::~MatcherCodeCache()
+    {
+    }
+
+
+    // static
+    std::string MatcherCodeCache::CreateKey(CompileNode const & tree,
+                                            RegisterAllocator const & registers,
+                                            Rank initialRank,
+                                            size_t prefetchDistance,
+                                            bool useSummaries)
+    {
+        std::stringstream key;
+        key << "Rank: " << initialRank << std::endl;
+        key << "Prefetch: " << prefetchDistance << std::endl;
+        key << "Summaries: " << useSummaries << std::endl;
+
+        key << "Registers:";
+        for (unsigned r = 0; r < registers.GetRegistersAllocated(); ++r)
+        {
+            unsigned id = registers.GetRowIdFromRegister(r);
+            key << " " << id << ":" << registers.GetRegister(id);
+        }
+        key << std::endl;
+
+        std::unique_ptr<IObjectFormatter>
+            formatter(Factories::CreateObjectFormatter(key));
+        tree.Format(*formatter);
+
+        return key.str();
+    }
+
+
+    void const * MatcherCodeCache::Find(std::string const & key)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto it = m_entries.find(key);
+        if (it == m_entries.end())
+        {
+            return nullptr;
+        }
+        return it->second.GetEntryPoint();
+    }
+
+
+    void const * MatcherCodeCache::Add(std::string const & key,
+                                       void const * code,
+                                       size_t byteCount,
+                                       size_t entryOffset)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return AddInternal(key, code, byteCount, entryOffset);
+    }
+
+
+    size_t MatcherCodeCache::GetEntryCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_entries.size();
+    }
+
+
+    void MatcherCodeCache::Write(std::ostream & output,
+                                 uint64_t termTableVersion) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        FileHeader header(c_matcherCodeCacheVersion, "MatcherCodeCache");
+        header.Write(output);
+
+        StreamUtilities::WriteField<uint64_t>(output, termTableVersion);
+        StreamUtilities::WriteField<uint64_t>(output, GetCodeGeneratorSignature());
+        StreamUtilities::WriteField<size_t>(output, m_entries.size());
+
+        for (auto const & entry : m_entries)
+        {
+            StreamUtilities::WriteString(output, entry.first);
+            entry.second.Write(output);
+        }
+    }
+
+
+    bool MatcherCodeCache::Read(std::istream & input,
+                                uint64_t termTableVersion)
+    {
+        FileHeader header(input);
+        if (!header.GetVersion().IsCompatibleWith(c_matcherCodeCacheVersion))
+        {
+            return false;
+        }
+
+        if (ReadCheckedField<uint64_t>(input) != termTableVersion ||
+            ReadCheckedField<uint64_t>(input) != GetCodeGeneratorSignature())
+        {
+            return false;
+        }
+
+        // Read every entry before taking the lock so that a truncated stream
+        // leaves the cache unchanged.
+        struct Record
+        {
+            std::string m_key;
+            size_t m_entryOffset;
+            std::vector<unsigned char> m_code;
+        };
+
+        size_t count = ReadCheckedField<size_t>(input);
+        std::vector<Record> records;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Record record;
+
+            unsigned keyLength = ReadCheckedField<unsigned>(input);
+            record.m_key.resize(keyLength);
+            ReadCheckedBytes(input, &record.m_key[0], keyLength);
+
+            record.m_entryOffset = ReadCheckedField<size_t>(input);
+
+            size_t byteCount = ReadCheckedField<size_t>(input);
+            if (byteCount > m_code->MaxSize())
+            {
+                RecoverableError error("MatcherCodeCache::Read: code larger than cache.");
+                throw error;
+            }
+            record.m_code.resize(byteCount);
+            ReadCheckedBytes(input, record.m_code.data(), byteCount);
+
+            if (record.m_entryOffset >= record.m_code.size())
+            {
+                RecoverableError error("MatcherCodeCache::Read: entry point out of range.");
+                throw error;
+            }
+
+            records.push_back(std::move(record));
+        }
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (auto const & record : records)
+        {
+            if (m_entries.find(record.m_key) == m_entries.end())
+            {
+                if (AddInternal(record.m_key,
+                                record.m_code.data(),
+                                record.m_code.size(),
+                                record.m_entryOffset) == nullptr)
+                {
+                    // Out of space. Keep the entries that fit.
+                    break;
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    void const * MatcherCodeCache::AddInternal(std::string const & key,
+                                               void const * code,
+                                               size_t byteCount,
+                                               size_t entryOffset)
+    {
+        auto it = m_entries.find(key);
+        if (it != m_entries.end())
+        {
+            return it->second.GetEntryPoint();
+        }
+
+        if (m_bytesUsed + byteCount > m_code->MaxSize())
+        {
+            return nullptr;
+        }
+
+        unsigned char * destination =
+            static_cast<unsigned char*>(m_code->Allocate(byteCount));
+        m_bytesUsed += byteCount;
+        std::memcpy(destination, code, byteCount);
+
+        auto result =
+            m_entries.emplace(key, Entry(destination, byteCount, entryOffset));
+        return result.first->second.GetEntryPoint();
+    }
+
+
+    // static
+    uint64_t MatcherCodeCache::GetCodeGeneratorSignature()
+    {
+        uint64_t signature = sizeof(NativeCodeGenerator::Parameters);
+        signature |= c_codeGeneratorVersion << 40;
+#ifdef QUADWORDCOUNT
+        signature |= 1ull << 32;
+#endif
+        return signature;
+    }
+
+
+    //*************************************************************************
+    //
+    // MatcherCodeCache::Entry
+    //
+    //*************************************************************************
+    MatcherCodeCache::Entry::Entry(unsigned char const * code,
+                                   size_t byteCount,
+                                   size_t entryOffset)
+      : m_code(code),
+        m_byteCount(byteCount),
+        m_entryOffset(entryOffset)
+    {
+    }
+
+
+    void const * MatcherCodeCache::Entry::GetEntryPoint() const
+    {
+        return m_code + m_entryOffset;
+    }
+
+
+    void MatcherCodeCache::Entry::Write(std::ostream & output) const
+    {
+        StreamUtilities::WriteField<size_t>(output, m_entryOffset);
+        StreamUtilities::WriteField<size_t>(output, m_byteCount);
+        StreamUtilities::WriteBytes(output,
+                                    reinterpret_cast<char const *>(m_code),
+                                    m_byteCount);
+    }
+}
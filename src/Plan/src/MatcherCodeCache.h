@@ -0,0 +1,130 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#pragma once
+
+#include <memory>                               // std::unique_ptr embedded.
+#include <mutex>                                // std::mutex embedded.
+#include <string>                               // std::string embedded.
+#include <unordered_map>                        // std::unordered_map embedded.
+
+#include "BitFunnel/BitFunnelTypes.h"           // Rank parameter.
+#include "BitFunnel/NonCopyable.h"              // Base class.
+#include "BitFunnel/Plan/IMatcherCodeCache.h"   // Base class.
+
+
+namespace NativeJIT
+{
+    class ExecutionBuffer;
+}
+
+
+namespace BitFunnel
+{
+    class CompileNode;
+    class RegisterAllocator;
+
+    //*************************************************************************
+    //
+    // MatcherCodeCache
+    //
+    // Stores copies of matchers generated by MatchTreeCompiler in a private
+    // ExecutionBuffer. Each matcher is keyed by the text of its CompileNode
+    // tree, the initial rank, and the register assignment made by the
+    // RegisterAllocator. Together these completely determine the code that
+    // NativeCodeGenerator emits, so a hit on the key can reuse the code
+    // without consulting the term table. Physical rows are supplied at run
+    // time through the row offsets parameter.
+    //
+    // Memory for a matcher is never reclaimed. Once the ExecutionBuffer is
+    // full, Add() returns nullptr and the caller should use its own copy.
+    //
+    //*************************************************************************
+    class MatcherCodeCache : public IMatcherCodeCache, NonCopyable
+    {
+    public:
+        MatcherCodeCache(size_t capacity);
+
+        ~MatcherCodeCache();
+
+        // Returns the key that identifies the code generated for tree.
+        static std::string CreateKey(CompileNode const & tree,
+                                     RegisterAllocator const & registers,
+                                     Rank initialRank,
+                                     size_t prefetchDistance,
+                                     bool useSummaries);
+
+        //
+        // IMatcherCodeCache methods.
+        //
+        virtual void const * Find(std::string const & key) override;
+
+        virtual void const * Add(std::string const & key,
+                                 void const * code,
+                                 size_t byteCount,
+                                 size_t entryOffset) override;
+
+        virtual size_t GetEntryCount() const override;
+
+        virtual void Write(std::ostream & output,
+                           uint64_t termTableVersion) const override;
+
+        virtual bool Read(std::istream & input,
+                          uint64_t termTableVersion) override;
+
+    private:
+        class Entry
+        {
+        public:
+            Entry(unsigned char const * code,
+                  size_t byteCount,
+                  size_t entryOffset);
+
+            void const * GetEntryPoint() const;
+
+            void Write(std::ostream & output) const;
+
+        private:
+            unsigned char const * m_code;
+            size_t m_byteCount;
+            size_t m_entryOffset;
+        };
+
+        // Copies code into m_code and records it under key. Caller must hold
+        // m_lock.
+        void const * AddInternal(std::string const & key,
+                                 void const * code,
+                                 size_t byteCount,
+                                 size_t entryOffset);
+
+        // Identifies the layout of NativeCodeGenerator::Parameters, the code
+        // generator version, and the compile-time options that change
+        // generated code.
+        static uint64_t GetCodeGeneratorSignature();
+
+        mutable std::mutex m_lock;
+
+        std::unique_ptr<NativeJIT::ExecutionBuffer> m_code;
+        size_t m_bytesUsed;
+
+        std::unordered_map<std::string, Entry> m_entries;
+    };
+}
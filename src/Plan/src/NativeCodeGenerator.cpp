@@ -46,11 +46,15 @@ namespace BitFunnel
         Prototype& expression,
         CompileNode const & compileNodeTree,
         RegisterAllocator const & registers,
-        Rank initialRank)
+        Rank initialRank,
+        size_t prefetchDistance,
+        bool useSummaries)
       : Node(expression),
         m_compileNodeTree(compileNodeTree),
         m_registers(registers),
-        m_initialRank(initialRank)
+        m_initialRank(initialRank),
+        m_prefetchDistance(prefetchDistance),
+        m_useSummaries(useSummaries)
     {
     }
 
@@ -113,24 +117,44 @@ namespace BitFunnel
         // Allocate temporary variables.
         m_innerLoopLimit = tree.Temporary<size_t>();
 
-        // Initialize row pointers.
-        // RSI has pointer to row offsets.
-        code.Emit<OpCode::Mov>(rsi, rdi, m_rowOffsets);
+        // Row pointers depend on the slice, so they are initialized at the
+        // top of each iteration of the outer loop by EmitRowPointers().
+    }
+
+
+    // Converts row offsets into absolute row pointers for the current slice.
+    // The pointers are invariant in the inner loop, so computing them once
+    // per slice removes the slice base adjustment from every row access.
+    void NativeCodeGenerator::EmitRowPointers(ExpressionTree& tree)
+    {
+        auto & code = tree.GetCodeGenerator();
+
+        // The accumulator and offset registers are free between slices.
+        //   rax: slice buffer pointer.
+        //   rbx: pointer to array of row offsets.
+        code.Emit<OpCode::Mov>(rax, rdi, m_sliceBuffers);
+        code.Emit<OpCode::Mov>(rax, rax, 0);
+        code.Emit<OpCode::Mov>(rbx, rdi, m_rowOffsets);
 
-        // Load row offsets into R8..R8 + m_registers.GetRegistersAllocated()
-        // TODO: Should we use GetRegister() or explicitly use r+8?
-        // The former offers an opportunity to misconfigure the register allocator
-        // to use registers that conflict with other matcher registers.
         for (unsigned r = 0; r < m_registers.GetRegistersAllocated(); ++r)
         {
-            code.Emit<OpCode::Mov>(Register<8u, false>(r + 8),
-                                   rsi,
-                                   m_registers.GetRowIdFromRegister(r) * 8);
-            // TODO: Would the following alternative be better?
-            // This code may not work with the existing CompileNode compiler.
-            //code.Emit<OpCode::Mov>(Register<8u, false>(m_registers.GetRegister(r)),
-            //                       rsi,
-            //                       m_registers.GetRowIdFromRegister(r) * 8);
+            unsigned id = m_registers.GetRowIdFromRegister(r);
+            Register<8u, false> reg(
+                MachineCodeGenerator::GetPhysicalRegister(m_registers.GetRegister(id)));
+            code.Emit<OpCode::Mov>(reg, rbx, id * 8);
+            code.Emit<OpCode::Add>(reg, rax);
+        }
+
+        for (unsigned id = 0; id < m_registers.GetRowCount(); ++id)
+        {
+            if (m_registers.IsUsed(id) && !m_registers.IsRegister(id))
+            {
+                code.Emit<OpCode::Mov>(rcx, rbx, id * 8);
+                code.Emit<OpCode::Add>(rcx, rax);
+                code.Emit<OpCode::Mov>(rdi,
+                                       MachineCodeGenerator::GetRowPointerOffset(id),
+                                       rcx);
+            }
         }
     }
 
@@ -153,11 +177,22 @@ namespace BitFunnel
         code.Emit<OpCode::Or>(rax, rax);
         code.EmitConditionalJump<JccType::JZ>(bottomOfLoop);
 
+        EmitRowPointers(tree);
         EmitInnerLoop(tree);
 
         // Decrement the slice count by 1.
         code.Emit<OpCode::Dec, 8>(rdi, m_sliceCount);
 
+        if (m_useSummaries)
+        {
+            // Advance to the next slice's live iteration bitmap.
+            code.Emit<OpCode::Mov>(rax, rdi, m_iterationsPerSlice);
+            code.EmitImmediate<OpCode::Add>(rax, 63);
+            code.EmitImmediate<OpCode::Shr>(rax, static_cast<uint8_t>(6));
+            code.EmitImmediate<OpCode::Shl>(rax, static_cast<uint8_t>(3));
+            code.Emit<OpCode::Add>(rdi, m_liveIterations, rax);
+        }
+
         // Advance to the next slice.
         code.EmitImmediate<OpCode::Mov>(rax, 8);
         code.Emit<OpCode::Add>(rdi, m_sliceBuffers, rax);
@@ -180,15 +215,12 @@ namespace BitFunnel
         auto exitLoop = code.AllocateLabel();
 
         // Initialize loop counter and limit.
-        //   rcx: loop counter starts at the current slice buffer pointer.
-        //   m_innerLoopLimit: slice buffer pointer + bytes in starting row.
-        code.Emit<OpCode::Mov>(rdx, rdi, m_sliceBuffers);
-        code.Emit<OpCode::Mov>(rdx, rdx, 0);
+        //   rcx: loop counter is the byte offset into the starting row.
+        //   m_innerLoopLimit: bytes in starting row.
         code.Emit<OpCode::Mov>(rax, rdi, m_iterationsPerSlice);
         code.EmitImmediate<OpCode::Shl>(rax, static_cast<uint8_t>(3));
-        code.Emit<OpCode::Add>(rax, rdx);
         CodeGenHelpers::Emit<OpCode::Mov>(code, m_innerLoopLimit, rax);
-        code.Emit<OpCode::Mov>(rcx, rdx);
+        code.Emit<OpCode::Xor>(rcx, rcx);
 
 
         //
@@ -200,6 +232,22 @@ namespace BitFunnel
         CodeGenHelpers::Emit<OpCode::Cmp>(code, rcx, m_innerLoopLimit);
         code.EmitConditionalJump<JccType::JE>(exitLoop);    // TODO: Original code passed X64::Long.
 
+        if (m_useSummaries)
+        {
+            // Skip iterations where a required row's summary is empty. The
+            // accumulator is free at the top of the loop.
+            //   rax: quadword of the live iteration bitmap.
+            //   rbx: iteration number.
+            code.Emit<OpCode::Mov>(rax, rcx);
+            code.EmitImmediate<OpCode::Shr>(rax, static_cast<uint8_t>(9));
+            code.Emit<OpCode::Mov>(rbx, rdi, m_liveIterations);
+            code.Emit<OpCode::Mov>(rax, rbx, rax, SIB::Scale8, 0);
+            code.Emit<OpCode::Mov>(rbx, rcx);
+            code.EmitImmediate<OpCode::Shr>(rbx, static_cast<uint8_t>(3));
+            code.Emit<OpCode::Bt>(rax, rbx);
+            code.EmitConditionalJump<JccType::JNC>(bottomOfLoop);
+        }
+
         //
         // Body of loop
         //
@@ -207,17 +255,18 @@ namespace BitFunnel
         // TODO: Handle case where there are no rows.
 
         // Store this iteration's base offset in m_base.
-        code.Emit<OpCode::Push>(rcx);
         code.Emit<OpCode::Mov>(rax, rcx);
-        code.Emit<OpCode::Sub>(rax, rdx);
         code.EmitImmediate<OpCode::Shr>(rax, static_cast<uint8_t>(3));
-        code.EmitImmediate<OpCode::Mov>(cl, static_cast<uint8_t>(m_initialRank));
-        code.Emit<OpCode::Shl>(rax);
+        if (m_initialRank > 0)
+        {
+            code.EmitImmediate<OpCode::Shl>(rax, static_cast<uint8_t>(m_initialRank));
+        }
         code.Emit<OpCode::Mov>(rdi, m_base, rax);
-        code.Emit<OpCode::Pop>(rcx);
 
         {
-            MachineCodeGenerator generator(m_registers, tree.GetCodeGenerator());
+            MachineCodeGenerator generator(m_registers,
+                                           tree.GetCodeGenerator(),
+                                           m_prefetchDistance);
             m_compileNodeTree.Compile(generator);
         }
 
@@ -256,7 +305,7 @@ namespace BitFunnel
         code.EmitConditionalJump<JccType::JZ>(noMatches);
 
         // TODO: Instead of saving and restoring registers, consider just
-        // restoring them from [rsi + x].
+        // recomputing them as in EmitRowPointers().
         // Save registers.
         code.Emit<OpCode::Push>(r9);
         code.Emit<OpCode::Push>(r10);
@@ -270,8 +319,10 @@ namespace BitFunnel
         // r10 has m_matches.
         code.Emit<OpCode::Mov>(r10, rdi, m_matches);
 
-        // r9 has the Slice* extracted from the slice buffer pointer in rdx.
-        code.Emit<OpCode::Mov>(r9, rdx, 0);
+        // r9 has the Slice* extracted from the current slice buffer.
+        code.Emit<OpCode::Mov>(r9, rdi, m_sliceBuffers);
+        code.Emit<OpCode::Mov>(r9, r9, 0);
+        code.Emit<OpCode::Mov>(r9, r9, 0);
 
         auto quadwordLoopTop = code.AllocateLabel();
         auto quadwordLoopExit = code.AllocateLabel();
@@ -353,7 +404,6 @@ namespace BitFunnel
     //   m_matches[m_matchCount++]
     // Clobbers r10, r11, r12.
     // Assumes
-    //   rdx has slice buffer pointer.
     //   r13 has bit position of match.
     //   r15 has quadword number of match.
     //   r10 has m_matches
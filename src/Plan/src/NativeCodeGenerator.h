@@ -76,6 +76,12 @@ static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr)
             size_t m_iterationsPerSlice;
             ptrdiff_t const * m_rowOffsets;
 
+            // Bitmap of iterations that may have matches, one bit per
+            // iteration, SummaryFilter::GetQuadwordsPerSlice() quadwords per
+            // slice. Only consulted by code generated with useSummaries.
+            // Advanced by the generated code at the end of each slice.
+            uint64_t const * m_liveIterations;
+
             // Dedupe buffer
             size_t m_base;
             size_t m_dedupe[65];
@@ -86,6 +92,11 @@ static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr)
             ResultsBuffer::Result* m_matches;
 
             size_t m_quadwordCount;
+
+            // Absolute addresses of rows in the current slice for rows that
+            // were not assigned a register, indexed by abstract row id.
+            // Written by the generated code at the start of each slice.
+            char const * m_rowPointers[c_maxRowsPerQuery];
         };
         static_assert(std::is_standard_layout<Parameters>::value,
                       "Generated code requires that Parameters be standard layout.");
@@ -96,7 +107,9 @@ static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr)
         NativeCodeGenerator(Prototype& expression,
                             CompileNode const & compileNodeTree,
                             RegisterAllocator const & registers,
-                            Rank initialRank);
+                            Rank initialRank,
+                            size_t prefetchDistance,
+                            bool useSummaries);
 
         virtual ExpressionTree::Storage<size_t>
             CodeGenValue(ExpressionTree& tree) override;
@@ -107,17 +120,20 @@ static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr)
         static const int32_t m_sliceBuffers = OFFSET_OF(Parameters, m_sliceBuffers);
         static const int32_t m_iterationsPerSlice = OFFSET_OF(Parameters, m_iterationsPerSlice);
         static const int32_t m_rowOffsets = OFFSET_OF(Parameters, m_rowOffsets);
+        static const int32_t m_liveIterations = OFFSET_OF(Parameters, m_liveIterations);
         static const int32_t m_base = OFFSET_OF(Parameters, m_base);
         static const int32_t m_dedupe = OFFSET_OF(Parameters, m_dedupe);
         static const int32_t m_capacity = OFFSET_OF(Parameters, m_capacity);
         static const int32_t m_matchCount = OFFSET_OF(Parameters, m_matchCount);
         static const int32_t m_matches = OFFSET_OF(Parameters, m_matches);
         static const int32_t m_quadwordCount = OFFSET_OF(Parameters, m_quadwordCount);
+        static const int32_t m_rowPointers = OFFSET_OF(Parameters, m_rowPointers);
 
 
     private:
         void EmitRegisterInitialization(ExpressionTree& tree);
         void EmitOuterLoop(ExpressionTree& tree);
+        void EmitRowPointers(ExpressionTree& tree);
         void EmitInnerLoop(ExpressionTree& tree);
         void EmitFinishIteration(ExpressionTree& tree);
         void EmitStoreMatch(ExpressionTree & tree);
@@ -125,6 +141,8 @@ static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr)
         CompileNode const & m_compileNodeTree;
         RegisterAllocator const & m_registers;
         const Rank m_initialRank;
+        const size_t m_prefetchDistance;
+        const bool m_useSummaries;
 
         Register<8u, false> m_param1;
         Register<8u, false> m_return;
@@ -0,0 +1,117 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdint.h>
+#include <vector>
+#include <xmmintrin.h>      // _mm_prefetch().
+
+#include "BitFunnel/Plan/PrefetchCalibration.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+
+
+namespace BitFunnel
+{
+    // The synthetic streams stand in for the rows of a moderately large
+    // query. Together they are larger than a typical L2 cache so that the
+    // scan is limited by memory, not by the core.
+    static const size_t c_calibrationRowCount = 16;
+    static const size_t c_calibrationQuadwordsPerRow = 64 * 1024;
+
+    // Candidate distances in quadwords. Zero means no software prefetch.
+    static const size_t c_prefetchDistances[] = { 0, 4, 8, 16, 32, 64 };
+    static const size_t c_maxPrefetchDistance = 64;
+
+    static const unsigned c_calibrationTrialCount = 2;
+
+    // A non-zero distance must beat no prefetching by this factor to be
+    // selected. Keeps timing noise from turning prefetching on.
+    static const double c_minimumImprovement = 0.95;
+
+
+    static uint64_t Scan(uint64_t const * rows,
+                         size_t rowStride,
+                         size_t prefetchDistance)
+    {
+        uint64_t matches = 0;
+        for (size_t i = 0; i < c_calibrationQuadwordsPerRow; ++i)
+        {
+            uint64_t accumulator = ~0ull;
+            for (size_t r = 0; r < c_calibrationRowCount; ++r)
+            {
+                uint64_t const * ptr = rows + r * rowStride + i;
+                if (prefetchDistance > 0)
+                {
+                    _mm_prefetch(reinterpret_cast<char const *>(ptr + prefetchDistance),
+                                 _MM_HINT_T0);
+                }
+                accumulator &= *ptr;
+            }
+            matches += accumulator;
+        }
+        return matches;
+    }
+
+
+    size_t CalibratePrefetchDistance()
+    {
+        // Pad each row so that prefetches past its end stay inside the
+        // allocation.
+        const size_t rowStride =
+            c_calibrationQuadwordsPerRow + c_maxPrefetchDistance;
+        std::vector<uint64_t> rows(c_calibrationRowCount * rowStride, ~0ull);
+
+        // Accumulate the scan results so that the compiler cannot discard
+        // the scans. The first scan warms up the TLB.
+        volatile uint64_t sink = Scan(rows.data(), rowStride, 0);
+
+        double baseline = 0.0;
+        double bestTime = 0.0;
+        size_t bestDistance = 0;
+        for (size_t distance : c_prefetchDistances)
+        {
+            double time = 0.0;
+            for (unsigned trial = 0; trial < c_calibrationTrialCount; ++trial)
+            {
+                Stopwatch stopwatch;
+                sink = sink + Scan(rows.data(), rowStride, distance);
+                double elapsed = stopwatch.ElapsedTime();
+                if (trial == 0 || elapsed < time)
+                {
+                    time = elapsed;
+                }
+            }
+
+            if (distance == 0)
+            {
+                baseline = time;
+                bestTime = time;
+            }
+            else if (time < bestTime && time < baseline * c_minimumImprovement)
+            {
+                bestTime = time;
+                bestDistance = distance;
+            }
+        }
+
+        return bestDistance;
+    }
+}
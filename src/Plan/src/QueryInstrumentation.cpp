@@ -20,12 +20,44 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <string>
+
 #include "BitFunnel/Plan/QueryInstrumentation.h"
 #include "CsvTsv/Csv.h"
 
 
 namespace BitFunnel
 {
+    static void FormatCountersHeader(CsvTsv::CsvTableFormatter & formatter,
+                                     char const * prefix)
+    {
+        for (unsigned i = 0; i < PerformanceCounters::CounterCount; ++i)
+        {
+            formatter.WriteField(
+                std::string(prefix)
+                + PerformanceCounters::GetName(
+                    static_cast<PerformanceCounters::Counter>(i)));
+        }
+    }
+
+
+    static void FormatCounters(CsvTsv::CsvTableFormatter & formatter,
+                               PerformanceCounters::Values const & values)
+    {
+        for (auto value : values)
+        {
+            if (value == PerformanceCounters::c_unavailable)
+            {
+                formatter.WriteEmptyField();
+            }
+            else
+            {
+                formatter.WriteField(value);
+            }
+        }
+    }
+
+
     // static
     void QueryInstrumentation::Data::FormatHeader(
         CsvTsv::CsvTableFormatter & formatter)
@@ -37,6 +69,11 @@ namespace BitFunnel
         formatter.WriteField("parse");
         formatter.WriteField("plan");
         formatter.WriteField("match");
+        formatter.WriteField("compile");
+        formatter.WriteField("interpret");
+        formatter.WriteField("native");
+        FormatCountersHeader(formatter, "plan_");
+        FormatCountersHeader(formatter, "match_");
         formatter.WriteRowEnd();
     }
 
@@ -51,6 +88,11 @@ namespace BitFunnel
         formatter.WriteField(m_parsingTime);
         formatter.WriteField(m_planningTime);
         formatter.WriteField(m_matchingTime);
+        formatter.WriteField(m_compileTime);
+        formatter.WriteField(m_interpreterTime);
+        formatter.WriteField(m_nativeTime);
+        FormatCounters(formatter, m_planningCounters);
+        FormatCounters(formatter, m_matchingCounters);
         formatter.WriteRowEnd();
     }
 }
@@ -20,6 +20,10 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>    // std::min().
+#include <exception>    // std::exception_ptr.
+#include <memory>       // std::unique_ptr.
+
 #include "BitFunnel/Allocators/IAllocator.h"
 #include "BitFunnel/IDiagnosticStream.h"
 #include "BitFunnel/Index/IIngestor.h"
@@ -32,10 +36,13 @@
 #include "BitFunnel/Utilities/Allocator.h"
 #include "BitFunnel/Utilities/Factories.h"
 #include "BitFunnel/Utilities/IObjectFormatter.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
 #include "ByteCodeInterpreter.h"
 #include "CompileNode.h"
+#include "CompileWorker.h"
 #include "IPlanRows.h"
 #include "LoggerInterfaces/Logging.h"
+#include "MachineCodeGenerator.h"
 #include "MatchTreeCompiler.h"
 #include "MatchTreeRewriter.h"
 #include "NativeJIT/CodeGen/ExecutionBuffer.h"
@@ -46,6 +53,7 @@
 #include "ResultsBuffer.h"
 #include "RowPlan.h"
 #include "RowSet.h"
+#include "SummaryFilter.h"
 #include "TermPlan.h"
 #include "TermPlanConverter.h"
 
@@ -60,7 +68,7 @@ namespace BitFunnel
                                     IDiagnosticStream & diagnosticStream,
                                     QueryInstrumentation & instrumentation,
                                     ResultsBuffer & resultsBuffer,
-                                    bool useNativeCode)
+                                    MatcherMode matcherMode)
     {
         const int c_arbitraryRowCount = 500;
         QueryPlanner planner(tree,
@@ -70,7 +78,7 @@ namespace BitFunnel
                              diagnosticStream,
                              instrumentation,
                              resultsBuffer,
-                             useNativeCode);
+                             matcherMode);
     }
 
 
@@ -85,7 +93,7 @@ namespace BitFunnel
                                IDiagnosticStream & diagnosticStream,
                                QueryInstrumentation & instrumentation,
                                ResultsBuffer & resultsBuffer,
-                               bool useNativeCode)
+                               MatcherMode matcherMode)
       : m_resultsBuffer(resultsBuffer)
     {
         if (diagnosticStream.IsEnabled("planning/term"))
@@ -184,24 +192,65 @@ namespace BitFunnel
         rowSet.LoadRows();
         instrumentation.SetRowCount(rowSet.GetRowCount());
 
-        if (useNativeCode)
+        SummaryFilter summaries(rowPlan.GetMatchTree(), *m_planRows, index, initialRank);
+
+        if (matcherMode == MatcherMode::Adaptive &&
+            EstimateScanCost(index, initialRank, rowSet) < c_adaptiveCompileThreshold)
         {
-            RunNativeCode(index,
-                          resources,
-                          instrumentation,
-                          compileTree,
-                          initialRank,
-                          rowSet);
+            // Too cheap to be worth the compile.
+            matcherMode = MatcherMode::Interpreter;
         }
-        else
+
+        switch (matcherMode)
         {
+        case MatcherMode::Interpreter:
             RunByteCodeInterpreter(index,
                                    resources,
                                    instrumentation,
                                    compileTree,
                                    initialRank,
-                                   rowSet);
+                                   rowSet,
+                                   summaries);
+            break;
+        case MatcherMode::Compiler:
+            RunNativeCode(index,
+                          resources,
+                          instrumentation,
+                          compileTree,
+                          initialRank,
+                          rowSet,
+                          summaries);
+            break;
+        case MatcherMode::Adaptive:
+            RunAdaptive(index,
+                        resources,
+                        instrumentation,
+                        compileTree,
+                        initialRank,
+                        rowSet,
+                        summaries);
+            break;
+        }
+    }
+
+
+    // static
+    size_t QueryPlanner::EstimateScanCost(ISimpleIndex const & index,
+                                          Rank initialRank,
+                                          RowSet const & rowSet)
+    {
+        size_t quadwords = 0;
+        auto & ingestor = index.GetIngestor();
+        for (ShardId shardId = 0; shardId < ingestor.GetShardCount(); ++shardId)
+        {
+            auto & shard = ingestor.GetShard(shardId);
+            auto iterationsPerSlice = shard.GetSliceCapacity() >> 6 >> initialRank;
+            quadwords += shard.GetSliceBuffers().size() * iterationsPerSlice;
         }
+
+        // Every iteration may touch each row in the plan. Short circuit
+        // evaluation makes this an upper bound.
+        return quadwords * rowSet.GetRowCount();
     }
 
 
@@ -210,7 +259,8 @@ namespace BitFunnel
                                               QueryInstrumentation & instrumentation,
                                               CompileNode const & compileTree,
                                               Rank initialRank,
-                                              RowSet const & rowSet)
+                                              RowSet const & rowSet,
+                                              SummaryFilter & summaries)
     {
         // TODO: Clear results buffer here?
         compileTree.Compile(m_code);
@@ -230,6 +280,13 @@ namespace BitFunnel
                 // Iterations per slice calculation.
                 auto iterationsPerSlice = shard.GetSliceCapacity() >> 6 >> initialRank;
 
+                uint64_t const * liveIterations =
+                    summaries.IsEnabled() ?
+                        summaries.ComputeLiveIterations(shardId,
+                                                        sliceBuffers,
+                                                        iterationsPerSlice) :
+                        nullptr;
+
                 m_resultsBuffer.Reset();
 
                 ByteCodeInterpreter intepreter(m_code,
@@ -241,9 +298,13 @@ namespace BitFunnel
                                                rowSet.GetRowOffsets(shardId),
                                                nullptr,
                                                instrumentation,
-                                               resources.GetCacheLineRecorder());
+                                               resources.GetCacheLineRecorder(),
+                                               resources.GetPrefetchDistance(),
+                                               liveIterations);
 
+                Stopwatch stopwatch;
                 intepreter.Run();
+                instrumentation.AddInterpreterTime(stopwatch.ElapsedTime());
             }
 
             instrumentation.FinishMatching();
@@ -257,19 +318,23 @@ namespace BitFunnel
                                      QueryInstrumentation & instrumentation,
                                      CompileNode const & compileTree,
                                      Rank initialRank,
-                                     RowSet const & rowSet)
+                                     RowSet const & rowSet,
+                                     SummaryFilter & summaries)
     {
          // Perform register allocation on the compile tree.
          RegisterAllocator const registers(compileTree,
                                            rowSet.GetRowCount(),
-                                           c_registerBase,
-                                           c_registerCount,
+                                           MachineCodeGenerator::GetRegisterBase(),
+                                           MachineCodeGenerator::GetRegisterCount(),
                                            resources.GetMatchTreeAllocator());
 
+         Stopwatch compileTimer;
          MatchTreeCompiler compiler(resources,
                                     compileTree,
                                     registers,
-                                    initialRank);
+                                    initialRank,
+                                    summaries.IsEnabled());
+         instrumentation.AddCompileTime(compileTimer.ElapsedTime());
 
 
          // TODO: Clear results buffer here?
@@ -290,14 +355,23 @@ namespace BitFunnel
                 // Iterations per slice calculation.
                 auto iterationsPerSlice = shard.GetSliceCapacity() >> 6 >> initialRank;
 
+                uint64_t const * liveIterations =
+                    summaries.IsEnabled() ?
+                        summaries.ComputeLiveIterations(shardId,
+                                                        sliceBuffers,
+                                                        iterationsPerSlice) :
+                        nullptr;
 
                 m_resultsBuffer.Reset();
 
+                Stopwatch stopwatch;
                 size_t quadwordCount = compiler.Run(sliceBuffers.size(),
                                                     sliceBuffers.data(),
                                                     iterationsPerSlice,
                                                     rowSet.GetRowOffsets(shardId),
+                                                    liveIterations,
                                                     m_resultsBuffer);
+                instrumentation.AddNativeTime(stopwatch.ElapsedTime());
 
                 instrumentation.IncrementQuadwordCount(quadwordCount);
             }
@@ -308,6 +382,173 @@ namespace BitFunnel
     }
 
 
+    // Waits for a CompileWorker on scope exit.
+    class WaitForCompile : NonCopyable
+    {
+    public:
+        WaitForCompile(CompileWorker & worker)
+          : m_worker(worker)
+        {
+        }
+
+        ~WaitForCompile()
+        {
+            m_worker.Wait();
+        }
+
+    private:
+        CompileWorker & m_worker;
+    };
+
+
+    void QueryPlanner::RunAdaptive(ISimpleIndex const & index,
+                                   QueryResources & resources,
+                                   QueryInstrumentation & instrumentation,
+                                   CompileNode const & compileTree,
+                                   Rank initialRank,
+                                   RowSet const & rowSet,
+                                   SummaryFilter & summaries)
+    {
+        compileTree.Compile(m_code);
+        m_code.Seal();
+
+        // Register allocation uses the match tree allocator, so it must run
+        // on this thread. The background compile only touches the expression
+        // tree allocator and the FunctionBuffer, which the interpreter does
+        // not use.
+        RegisterAllocator const registers(compileTree,
+                                          rowSet.GetRowCount(),
+                                          MachineCodeGenerator::GetRegisterBase(),
+                                          MachineCodeGenerator::GetRegisterCount(),
+                                          resources.GetMatchTreeAllocator());
+
+        // The compile runs on this thread's CompileWorker rather than a new
+        // thread. If the worker is still busy, the whole query is
+        // interpreted.
+        CompileWorker & worker = resources.GetCompileWorker();
+        double compileTime = 0.0;
+        std::unique_ptr<MatchTreeCompiler> compiled;
+        std::exception_ptr compileError;
+        const bool compiling = worker.TryStart([&]()
+            {
+                try
+                {
+                    Stopwatch stopwatch;
+                    compiled.reset(new MatchTreeCompiler(resources,
+                                                         compileTree,
+                                                         registers,
+                                                         initialRank,
+                                                         summaries.IsEnabled()));
+                    compileTime = stopwatch.ElapsedTime();
+                }
+                catch (...)
+                {
+                    compileError = std::current_exception();
+                }
+            });
+
+        // The task refers to locals of this function, so it must finish
+        // before they go out of scope, even if matching throws.
+        WaitForCompile waitForCompile(worker);
+
+        std::unique_ptr<MatchTreeCompiler> compiler;
+
+        instrumentation.FinishPlanning();
+
+        // Get token before we GetSliceBuffers.
+        {
+            auto token = index.GetIngestor().GetTokenManager().RequestToken();
+
+            for (ShardId shardId = 0; shardId < index.GetIngestor().GetShardCount(); ++shardId)
+            {
+                auto & shard = index.GetIngestor().GetShard(shardId);
+                auto & sliceBuffers = shard.GetSliceBuffers();
+
+                // Iterations per slice calculation.
+                auto iterationsPerSlice = shard.GetSliceCapacity() >> 6 >> initialRank;
+
+                uint64_t const * liveIterations =
+                    summaries.IsEnabled() ?
+                        summaries.ComputeLiveIterations(shardId,
+                                                        sliceBuffers,
+                                                        iterationsPerSlice) :
+                        nullptr;
+                const size_t liveQuadwordsPerSlice =
+                    SummaryFilter::GetQuadwordsPerSlice(iterationsPerSlice);
+
+                m_resultsBuffer.Reset();
+
+                size_t slice = 0;
+                while (slice < sliceBuffers.size())
+                {
+                    if (compiling && compiler == nullptr && worker.IsIdle())
+                    {
+                        if (compileError != nullptr)
+                        {
+                            std::rethrow_exception(compileError);
+                        }
+                        compiler = std::move(compiled);
+                    }
+
+                    if (compiler != nullptr)
+                    {
+                        Stopwatch stopwatch;
+                        size_t quadwordCount =
+                            compiler->Run(sliceBuffers.size() - slice,
+                                          sliceBuffers.data() + slice,
+                                          iterationsPerSlice,
+                                          rowSet.GetRowOffsets(shardId),
+                                          (liveIterations == nullptr) ?
+                                              nullptr :
+                                              liveIterations + slice * liveQuadwordsPerSlice,
+                                          m_resultsBuffer);
+                        instrumentation.AddNativeTime(stopwatch.ElapsedTime());
+                        instrumentation.IncrementQuadwordCount(quadwordCount);
+                        break;
+                    }
+
+                    size_t batchSize =
+                        (std::min)(c_adaptiveSliceBatchSize,
+                                   sliceBuffers.size() - slice);
+
+                    Stopwatch stopwatch;
+                    ByteCodeInterpreter intepreter(m_code,
+                                                   m_resultsBuffer,
+                                                   batchSize,
+                                                   sliceBuffers.data() + slice,
+                                                   iterationsPerSlice,
+                                                   initialRank,
+                                                   rowSet.GetRowOffsets(shardId),
+                                                   nullptr,
+                                                   instrumentation,
+                                                   resources.GetCacheLineRecorder(),
+                                                   resources.GetPrefetchDistance(),
+                                                   (liveIterations == nullptr) ?
+                                                       nullptr :
+                                                       liveIterations + slice * liveQuadwordsPerSlice);
+                    intepreter.Run();
+                    instrumentation.AddInterpreterTime(stopwatch.ElapsedTime());
+
+                    slice += batchSize;
+                }
+            }
+
+            instrumentation.FinishMatching();
+            instrumentation.SetMatchCount(m_resultsBuffer.size());
+        } // End of token lifetime.
+
+        // The compile may still be running if the interpreter finished
+        // first. Wait for it so that the code reaches the matcher code cache
+        // and the compile time is recorded.
+        worker.Wait();
+        if (compileError != nullptr)
+        {
+            std::rethrow_exception(compileError);
+        }
+        instrumentation.AddCompileTime(compileTime);
+    }
+
+
     IPlanRows const & QueryPlanner::GetPlanRows() const
     {
         return *m_planRows;
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "BitFunnel/NonCopyable.h"        // Inherits from NonCopyable.
+#include "BitFunnel/Plan/MatcherMode.h"   // MatcherMode parameter.
 #include "ByteCodeInterpreter.h"
 
 
@@ -35,6 +36,7 @@ namespace BitFunnel
     class QueryResources;
     class ResultsBuffer;
     class RowSet;
+    class SummaryFilter;
     class TermMatchNode;
 
     class QueryPlanner : public NonCopyable
@@ -49,7 +51,7 @@ namespace BitFunnel
                      IDiagnosticStream& diagnosticStream,
                      QueryInstrumentation & instrumentation,
                      ResultsBuffer & resultsBuffer,
-                     bool useNativeCode);
+                     MatcherMode matcherMode);
 
         IPlanRows const & GetPlanRows() const;
 
@@ -59,14 +61,35 @@ namespace BitFunnel
                                     QueryInstrumentation & instrumentation,
                                     CompileNode const & compileTree,
                                     Rank maxRank,
-                                    RowSet const & rowSet);
+                                    RowSet const & rowSet,
+                                    SummaryFilter & summaries);
 
         void RunNativeCode(ISimpleIndex const & index,
                            QueryResources & resources,
                            QueryInstrumentation & instrumentation,
                            CompileNode const & compileTree,
                            Rank maxRank,
-                           RowSet const & rowSet);
+                           RowSet const & rowSet,
+                           SummaryFilter & summaries);
+
+        // Starts in the ByteCodeInterpreter while NativeJIT compiles the
+        // plan on the CompileWorker owned by resources. Once the compile
+        // finishes, the remaining slices are processed by native code. If
+        // the worker is busy, every slice is interpreted.
+        void RunAdaptive(ISimpleIndex const & index,
+                         QueryResources & resources,
+                         QueryInstrumentation & instrumentation,
+                         CompileNode const & compileTree,
+                         Rank maxRank,
+                         RowSet const & rowSet,
+                         SummaryFilter & summaries);
+
+        // Returns an estimate of the number of row quadwords the matcher
+        // will read across all shards. Used by MatcherMode::Adaptive to
+        // decide whether the query is worth compiling.
+        static size_t EstimateScanCost(ISimpleIndex const & index,
+                                       Rank initialRank,
+                                       RowSet const & rowSet);
 
         IPlanRows const * m_planRows;
 
@@ -74,13 +97,17 @@ namespace BitFunnel
         // check is mandatory. Details can be found in the MatchTreeCodeGenerator.
         // const unsigned m_maxIterationsScannedBetweenTerminationChecks;
 
-        // First available row pointer register is R8.
-        // TODO: is this valid on all platforms or only on Windows?
-        static const unsigned c_registerBase = 8;
-
-        // Row pointers stored in the eight registers R8..R15.
-        // TODO: is this valid on all platforms or only on Windows?
-        static const unsigned c_registerCount = 8;
+        // Queries estimated to read fewer row quadwords than this are run in
+        // the ByteCodeInterpreter under MatcherMode::Adaptive. This is an
+        // untuned default, chosen as the rough point where interpreting
+        // costs as much as a NativeJIT compile. It has not been measured and
+        // should be calibrated against compile times and interpreter scan
+        // rates on the target machine.
+        static const size_t c_adaptiveCompileThreshold = 1ull << 17;
+
+        // Number of slices the interpreter processes between checks for
+        // completion of the background compile.
+        static const size_t c_adaptiveSliceBatchSize = 4;
 
         ByteCodeGenerator m_code;
 
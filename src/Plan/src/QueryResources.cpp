@@ -25,6 +25,7 @@
 #include "BitFunnel/Index/IShard.h"
 #include "BitFunnel/Index/ISimpleIndex.h"
 #include "BitFunnel/Utilities/Allocator.h"
+#include "CompileWorker.h"
 #include "QueryResources.h"
 
 
@@ -34,13 +35,21 @@ namespace BitFunnel
                                    size_t codeAllocatorBytes)
       : m_matchTreeAllocator(new BitFunnel::Allocator(treeAllocatorBytes)),
         m_expressionTreeAllocator(new NativeJIT::Allocator(treeAllocatorBytes)),
-        m_codeAllocator(new NativeJIT::ExecutionBuffer(codeAllocatorBytes))
+        m_codeAllocator(new NativeJIT::ExecutionBuffer(codeAllocatorBytes)),
+        m_compileWorker(new CompileWorker()),
+        m_matcherCodeCache(nullptr),
+        m_prefetchDistance(0)
     {
         m_code.reset(new NativeJIT::FunctionBuffer(*m_codeAllocator,
                                                    static_cast<unsigned>(codeAllocatorBytes)));
     }
 
 
+    QueryResources::~QueryResources()
+    {
+    }
+
+
     void QueryResources::EnableCacheLineCounting(ISimpleIndex const & index)
     {
         m_cacheLineRecorder.reset(
@@ -48,6 +57,18 @@ namespace BitFunnel
     }
 
 
+    void QueryResources::SetMatcherCodeCache(IMatcherCodeCache * cache)
+    {
+        m_matcherCodeCache = cache;
+    }
+
+
+    void QueryResources::SetPrefetchDistance(size_t distance)
+    {
+        m_prefetchDistance = distance;
+    }
+
+
     void QueryResources::Reset()
     {
         m_matchTreeAllocator->Reset();
@@ -33,6 +33,8 @@
 
 namespace BitFunnel
 {
+    class CompileWorker;
+    class IMatcherCodeCache;
     class ISimpleIndex;
 
     class QueryResources
@@ -41,10 +43,28 @@ namespace BitFunnel
         QueryResources(size_t treeAllocatorBytes = 1ull << 16,
                        size_t codeAllocatorBytes = 1ull << 16);
 
+        virtual ~QueryResources();
+
         void EnableCacheLineCounting(ISimpleIndex const & index);
 
+        // Supplies a cache of compiled matchers shared with other
+        // QueryResources. The cache is not owned by QueryResources and
+        // survives Reset().
+        void SetMatcherCodeCache(IMatcherCodeCache * cache);
+
+        // Sets the number of iterations ahead that matchers prefetch row
+        // data. Zero disables prefetching. Survives Reset().
+        void SetPrefetchDistance(size_t distance);
+
         virtual void Reset();
 
+        // Returns the background thread used to compile matchers under
+        // MatcherMode::Adaptive. Survives Reset().
+        CompileWorker & GetCompileWorker() const
+        {
+            return *m_compileWorker;
+        }
+
         IAllocator & GetMatchTreeAllocator() const
         {
             return *m_matchTreeAllocator;
@@ -70,11 +90,24 @@ namespace BitFunnel
             return m_cacheLineRecorder.get();
         }
 
+        IMatcherCodeCache * GetMatcherCodeCache() const
+        {
+            return m_matcherCodeCache;
+        }
+
+        size_t GetPrefetchDistance() const
+        {
+            return m_prefetchDistance;
+        }
+
     private:
         std::unique_ptr<IAllocator> m_matchTreeAllocator;
         std::unique_ptr<NativeJIT::Allocator> m_expressionTreeAllocator;
         std::unique_ptr<NativeJIT::ExecutionBuffer> m_codeAllocator;
         std::unique_ptr<NativeJIT::FunctionBuffer> m_code;
         std::unique_ptr<CacheLineRecorder> m_cacheLineRecorder;
+        std::unique_ptr<CompileWorker> m_compileWorker;
+        IMatcherCodeCache * m_matcherCodeCache;
+        size_t m_prefetchDistance;
     };
 }
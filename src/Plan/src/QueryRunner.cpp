@@ -38,6 +38,7 @@
 #include "BitFunnel/Utilities/Factories.h"
 #include "BitFunnel/Utilities/Allocator.h"
 #include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/PerformanceCounters.h"
 #include "BitFunnel/Utilities/Stopwatch.h"
 #include "CsvTsv/Csv.h"
 #include "QueryResources.h"
@@ -46,15 +47,99 @@
 
 namespace BitFunnel
 {
+    //*************************************************************************
+    //
+    // QueryRunner::Latencies
+    //
+    //*************************************************************************
+    void QueryRunner::Latencies::Record(QueryInstrumentation::Data const & data,
+                                        double totalTime)
+    {
+        m_parsing.Record(data.GetParsingTime());
+        m_planning.Record(data.GetPlanningTime());
+        m_compile.Record(data.GetCompileTime());
+        m_matching.Record(data.GetMatchingTime());
+        m_total.Record(totalTime);
+    }
+
+
+    void QueryRunner::Latencies::Merge(Latencies const & other)
+    {
+        m_parsing.Merge(other.m_parsing);
+        m_planning.Merge(other.m_planning);
+        m_compile.Merge(other.m_compile);
+        m_matching.Merge(other.m_matching);
+        m_total.Merge(other.m_total);
+    }
+
+
+    void QueryRunner::Latencies::Reset()
+    {
+        m_parsing.Reset();
+        m_planning.Reset();
+        m_compile.Reset();
+        m_matching.Reset();
+        m_total.Reset();
+    }
+
+
+    void QueryRunner::Latencies::Print(std::ostream& out) const
+    {
+        out << "Latency (microseconds):" << std::endl;
+        m_parsing.Print(out, "parse");
+        m_planning.Print(out, "plan");
+        m_compile.Print(out, "compile");
+        m_matching.Print(out, "match");
+        m_total.Print(out, "total");
+    }
+
+
+    LatencyHistogram const & QueryRunner::Latencies::GetParsing() const
+    {
+        return m_parsing;
+    }
+
+
+    LatencyHistogram const & QueryRunner::Latencies::GetPlanning() const
+    {
+        return m_planning;
+    }
+
+
+    LatencyHistogram const & QueryRunner::Latencies::GetCompile() const
+    {
+        return m_compile;
+    }
+
+
+    LatencyHistogram const & QueryRunner::Latencies::GetMatching() const
+    {
+        return m_matching;
+    }
+
+
+    LatencyHistogram const & QueryRunner::Latencies::GetTotal() const
+    {
+        return m_total;
+    }
+
+
+    //*************************************************************************
+    //
+    // QueryRunner::Statistics
+    //
+    //*************************************************************************
     QueryRunner::Statistics::Statistics(
         size_t threadCount,
         size_t uniqueQueryCount,
         size_t processedCount,
-        double elapsedTime)
+        double elapsedTime,
+        Latencies const & latencies)
       : m_threadCount(threadCount),
         m_uniqueQueryCount(uniqueQueryCount),
         m_processedCount(processedCount),
-        m_elapsedTime(elapsedTime)
+        m_elapsedTime(elapsedTime),
+        m_latencies(latencies)
     {
     }
 
@@ -66,7 +151,44 @@ namespace BitFunnel
             << "Unique queries: " << m_uniqueQueryCount << std::endl
             << "Queries processed: " << m_processedCount << std::endl
             << "Elapsed time: " << m_elapsedTime << std::endl
-            << "QPS: " << m_processedCount / m_elapsedTime << std::endl;
+            << "QPS: " << GetQueriesPerSecond() << std::endl;
+        m_latencies.Print(out);
+    }
+
+
+    size_t QueryRunner::Statistics::GetThreadCount() const
+    {
+        return m_threadCount;
+    }
+
+
+    size_t QueryRunner::Statistics::GetProcessedCount() const
+    {
+        return m_processedCount;
+    }
+
+
+    double QueryRunner::Statistics::GetElapsedTime() const
+    {
+        return m_elapsedTime;
+    }
+
+
+    double QueryRunner::Statistics::GetQueriesPerSecond() const
+    {
+        return m_processedCount / m_elapsedTime;
+    }
+
+
+    QueryRunner::Latencies const & QueryRunner::Statistics::GetLatencies() const
+    {
+        return m_latencies;
+    }
+
+
+    double QueryRunner::Statistics::GetLatencyPercentile(double percentile) const
+    {
+        return m_latencies.GetTotal().GetPercentile(percentile);
     }
 
 
@@ -145,8 +267,11 @@ namespace BitFunnel
                        std::vector<std::string> const & queries,
                        std::vector<QueryInstrumentation::Data> & results,
                        size_t maxResultCount,
-                       bool useNativeCode,
+                       MatcherMode matcherMode,
                        bool countCacheLines,
+                       bool countHardwareEvents,
+                       IMatcherCodeCache * codeCache,
+                       size_t prefetchDistance,
                        ThreadSynchronizer& synchronizer);
 
         //
@@ -156,6 +281,8 @@ namespace BitFunnel
         virtual void ProcessTask(size_t taskId) override;
         virtual void Finished() override;
 
+        QueryRunner::Latencies const & GetLatencies() const;
+
     private:
         //
         // constructor parameters
@@ -164,7 +291,8 @@ namespace BitFunnel
         IStreamConfiguration const & m_config;
         std::vector<std::string> const & m_queries;
         std::vector<QueryInstrumentation::Data> & m_results;
-        bool m_useNativeCode;
+        MatcherMode m_matcherMode;
+        bool m_countHardwareEvents;
         ThreadSynchronizer& m_synchronizer;
 
         std::vector<ResultsBuffer::Result> m_matches;
@@ -175,6 +303,13 @@ namespace BitFunnel
 
         size_t m_queriesProcessed;
 
+        // Recorded by this processor's thread alone, so no locks are needed.
+        QueryRunner::Latencies m_latencies;
+
+        // Opened by the first call to ProcessTask(), because the counters
+        // measure the thread that opens them.
+        std::unique_ptr<PerformanceCounters> m_counters;
+
         static const size_t c_allocatorSize = 1ull << 16;
     };
 
@@ -184,14 +319,18 @@ namespace BitFunnel
                                    std::vector<std::string> const & queries,
                                    std::vector<QueryInstrumentation::Data> & results,
                                    size_t maxResultCount,
-                                   bool useNativeCode,
+                                   MatcherMode matcherMode,
                                    bool countCacheLines,
+                                   bool countHardwareEvents,
+                                   IMatcherCodeCache * codeCache,
+                                   size_t prefetchDistance,
                                    ThreadSynchronizer& synchronizer)
       : m_index(index),
         m_config(config),
         m_queries(queries),
         m_results(results),
-        m_useNativeCode(useNativeCode),
+        m_matcherMode(matcherMode),
+        m_countHardwareEvents(countHardwareEvents),
         m_synchronizer(synchronizer),
         m_matches(maxResultCount, {nullptr, 0}),
         m_resultsBuffer(index.GetIngestor().GetDocumentCount()),
@@ -202,6 +341,8 @@ namespace BitFunnel
         {
             m_resources.EnableCacheLineCounting(index);
         }
+        m_resources.SetMatcherCodeCache(codeCache);
+        m_resources.SetPrefetchDistance(prefetchDistance);
     }
 
 
@@ -210,11 +351,17 @@ namespace BitFunnel
         // If this is the first query, wait for other threads before continuing.
         if (m_queriesProcessed == 0)
         {
+            if (m_countHardwareEvents)
+            {
+                m_counters.reset(new PerformanceCounters());
+            }
             m_synchronizer.Wait();
         }
         ++m_queriesProcessed;
 
+        Stopwatch stopwatch;
         QueryInstrumentation instrumentation;
+        instrumentation.SetPerformanceCounters(m_counters.get());
         m_resources.Reset();
 
         size_t queryId = taskId % m_queries.size();
@@ -235,10 +382,11 @@ namespace BitFunnel
                                        *diagnosticStream,
                                        instrumentation,
                                        m_resultsBuffer,
-                                       m_useNativeCode);
+                                       m_matcherMode);
         }
 
         m_results[taskId] = instrumentation.GetData();
+        m_latencies.Record(instrumentation.GetData(), stopwatch.ElapsedTime());
     }
 
 
@@ -246,6 +394,12 @@ namespace BitFunnel
     {
     }
 
+
+    QueryRunner::Latencies const & QueryProcessor::GetLatencies() const
+    {
+        return m_latencies;
+    }
+
     //*************************************************************************
     //
     // QueryRunner
@@ -254,8 +408,12 @@ namespace BitFunnel
     QueryInstrumentation::Data QueryRunner::Run(
         char const * query,
         ISimpleIndex const & index,
-        bool useNativeCode,
-        bool countCacheLines)
+        MatcherMode matcherMode,
+        bool countCacheLines,
+        bool countHardwareEvents,
+        IMatcherCodeCache * codeCache,
+        size_t prefetchDistance,
+        Latencies * latencies)
     {
         std::vector<std::string> queries;
         queries.push_back(std::string(query));
@@ -274,12 +432,20 @@ namespace BitFunnel
                       queries,
                       results,
                       maxResultCount,
-                      useNativeCode,
+                      matcherMode,
                       countCacheLines,
+                      countHardwareEvents,
+                      codeCache,
+                      prefetchDistance,
                       synchronizer);
         processor.ProcessTask(0);
         processor.Finished();
 
+        if (latencies != nullptr)
+        {
+            latencies->Merge(processor.GetLatencies());
+        }
+
         return results[0];
     }
 
@@ -290,8 +456,11 @@ namespace BitFunnel
         size_t threadCount,
         std::vector<std::string> const & queries,
         size_t iterations,
-        bool useNativeCode,
-        bool countCacheLines)
+        MatcherMode matcherMode,
+        bool countCacheLines,
+        bool countHardwareEvents,
+        IMatcherCodeCache * codeCache,
+        size_t prefetchDistance)
     {
         std::vector<QueryInstrumentation::Data> results(queries.size() * iterations);
 
@@ -310,8 +479,11 @@ namespace BitFunnel
                                        queries,
                                        results,
                                        maxResultCount,
-                                       useNativeCode,
+                                       matcherMode,
                                        countCacheLines,
+                                       countHardwareEvents,
+                                       codeCache,
+                                       prefetchDistance,
                                        synchronizer)));
         }
 
@@ -331,10 +503,18 @@ namespace BitFunnel
             }
         }
 
+        Latencies latencies;
+        for (auto const & processor : processors)
+        {
+            latencies.Merge(
+                static_cast<QueryProcessor const &>(*processor).GetLatencies());
+        }
+
         auto statistics(QueryRunner::Statistics(threadCount,
                                                 queries.size(),
                                                 queriesProcessed,
-                                                elapsedTime));
+                                                elapsedTime,
+                                                latencies));
 
         {
             std::cout << "Writing results ..." << std::endl;
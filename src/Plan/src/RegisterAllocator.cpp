@@ -20,7 +20,8 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-#include <algorithm>            // For std::max().
+#include <algorithm>            // For std::min(), std::sort().
+#include <cmath>                // For std::expm1(), std::log1p(), std::pow().
 #include <new>
 
 #include "BitFunnel/Allocators/IAllocator.h"
@@ -104,7 +105,13 @@ namespace BitFunnel
 
     bool RegisterAllocator::IsRegister(unsigned id) const
     {
-        return (m_mapping != nullptr) && (m_mapping[id] < m_registerCount);
+        return (m_mapping != nullptr) && (m_mapping[id] < m_registersAllocated);
+    }
+
+
+    bool RegisterAllocator::IsUsed(unsigned id) const
+    {
+        return (m_mapping != nullptr) && m_rows[m_mapping[id]].IsUsed();
     }
 
 
@@ -118,6 +125,12 @@ namespace BitFunnel
     }
 
 
+    unsigned RegisterAllocator::GetRowCount() const
+    {
+        return m_rowCount;
+    }
+
+
     // TODO: Add unit test for this method.
     unsigned RegisterAllocator::GetRegistersAllocated() const
     {
@@ -159,7 +172,7 @@ namespace BitFunnel
                 unsigned id = node.GetRow().GetId();
                 LogAssertB(id < m_rowCount,
                            "id overflow.");
-                m_rows[id].UpdateDepth(depth, uses);
+                m_rows[id].AddUses(depth, uses);
                 new (m_abstractRows + id) AbstractRow(node.GetRow());
                 CollectRows(node.GetChild(), depth + 1, uses);
             }
@@ -171,7 +184,7 @@ namespace BitFunnel
                 unsigned id = node.GetRow().GetId();
                 LogAssertB(id < m_rowCount,
                            "id overflow.");
-                m_rows[id].UpdateDepth(depth, uses);
+                m_rows[id].AddUses(depth, uses);
                 new (m_abstractRows + id) AbstractRow(node.GetRow());
                 CollectRows(node.GetChild(), depth + 1, uses);
             }
@@ -217,7 +230,7 @@ namespace BitFunnel
                 unsigned id = node.GetRow().GetId();
                 LogAssertB(id < m_rowCount,
                            "id overflow.");
-                m_rows[id].UpdateDepth(depth, uses);
+                m_rows[id].AddUses(depth, uses);
                 new (m_abstractRows + id) AbstractRow(node.GetRow());
             }
             break;
@@ -243,6 +256,22 @@ namespace BitFunnel
     }
 
 
+    // static
+    double RegisterAllocator::ReachProbability(unsigned depth)
+    {
+        // Assume each row has density c_rowDensity and that rows are
+        // independent. After depth rows, each bit of the accumulator is set
+        // with probability c_rowDensity^depth and the matcher continues if
+        // any of the 64 bits in the quadword is set. Computing
+        // 1 - (1 - bitDensity)^64 directly rounds to zero once bitDensity
+        // drops below the double epsilon (around depth 16), which would make
+        // all deep rows tie, so use expm1/log1p to keep the precision.
+        const double c_rowDensity = 0.1;
+        const double bitDensity = std::pow(c_rowDensity, depth);
+        return -std::expm1(64 * std::log1p(-bitDensity));
+    }
+
+
     //*************************************************************************
     //
     // RegisterAllocator::Entry
@@ -251,35 +280,36 @@ namespace BitFunnel
     RegisterAllocator::Entry::Entry(unsigned id)
         : m_id(id),
           m_depth(c_noAssociatedRow),
-          m_uses(0)
+          m_uses(0),
+          m_frequency(0.0)
     {
     }
 
 
-    void RegisterAllocator::Entry::UpdateDepth(unsigned depth, unsigned uses)
+    void RegisterAllocator::Entry::AddUses(unsigned depth, unsigned uses)
     {
-        if (depth < m_depth)
-        {
-            m_depth = depth;
-            m_uses = uses;
-        }
-        else if (depth == m_depth)
-        {
-            m_uses += uses;
-        }
+        m_depth = (std::min)(m_depth, depth);
+        m_uses += uses;
+        m_frequency += uses * ReachProbability(depth);
     }
 
 
     bool RegisterAllocator::Entry::operator<(Entry const & other) const
     {
-        if (m_depth == other.m_depth)
+        // Break ties by depth and then by id so that the allocation, and
+        // therefore the generated code, is deterministic.
+        if (m_frequency != other.m_frequency)
         {
-            return m_uses > other.m_uses;
+            return m_frequency > other.m_frequency;
         }
-        else
+        else if (m_depth != other.m_depth)
         {
             return m_depth < other.m_depth;
         }
+        else
+        {
+            return m_id < other.m_id;
+        }
     }
 
 
@@ -301,6 +331,12 @@ namespace BitFunnel
     }
 
 
+    double RegisterAllocator::Entry::GetFrequency() const
+    {
+        return m_frequency;
+    }
+
+
     bool RegisterAllocator::Entry::IsUsed() const
     {
         return m_depth != c_noAssociatedRow;
@@ -32,15 +32,22 @@ namespace BitFunnel
     //*************************************************************************
     //
     // RegisterAllocator assigns regsiters to rows in a tree of CompileNodes.
-    // Rows closer to the root are assigned registers before rows deeper in
-    // the tree. For rows that are at the same depth, the row that is used more
-    // often is given a higher priority for register allocation. Typically the
+    // Rows are ordered by an estimate of how often the matcher will load them
+    // and the most frequently loaded rows are assigned registers.
+    //
+    // Each reference to a row contributes its number of uses, weighted by the
+    // probability that the matcher reaches that reference. Typically the
     // row usage is most impacted by the RankDown operation which will execute
     // a subtree 2^delta times. Multiple uses can also come from multiple
     // references in the tree itself. This can happen when multiplying out
     // an And or Ors, e.g. (a + b)(c + d) results in a(c + d) + b(c + d) which
     // uses c and d twice.
     //
+    // The probability of reaching a reference falls off with the number of
+    // rows evaluated before it, since each row ANDed into the accumulator
+    // makes an early exit more likely. A row used 64 times under a RankDown
+    // can therefore outrank a row that is evaluated once near the root.
+    //
     //*************************************************************************
     class RegisterAllocator
     {
@@ -62,9 +69,16 @@ namespace BitFunnel
         // assigned a register.
         bool IsRegister(unsigned id) const;
 
+        // Returns true if the abstract row with the specified id is
+        // referenced by the CompileNode tree.
+        bool IsUsed(unsigned id) const;
+
         // Returns the register number of the abstract row specified by id.
         unsigned GetRegister(unsigned id) const;
 
+        // Returns the rowCount parameter passed to the constructor.
+        unsigned GetRowCount() const;
+
         // Returns the number of registers actually allocated.
         unsigned GetRegistersAllocated() const;
 
@@ -86,13 +100,14 @@ namespace BitFunnel
         public:
             Entry(unsigned id);
 
-            void UpdateDepth(unsigned depth, unsigned uses);
+            void AddUses(unsigned depth, unsigned uses);
 
             bool operator<(Entry const & other) const;
 
             unsigned GetDepth() const;
             unsigned GetId() const;
             unsigned GetUses() const;
+            double GetFrequency() const;
 
             bool IsUsed() const;
 
@@ -100,12 +115,16 @@ namespace BitFunnel
             // This row's identifier.
             unsigned m_id;
 
-            // The number of rows that are evaluated before this row.
+            // The number of rows that are evaluated before the shallowest
+            // reference to this row.
             unsigned m_depth;
 
-            // Number of times the row is used at m_depth from the root.
+            // Number of times the row is used, summed over all references.
             unsigned m_uses;
 
+            // Estimated number of loads of this row per top level iteration.
+            double m_frequency;
+
             // m_depth is set to c_noAssociatedRow to indicate that this entry
             // is not associated with any row. c_noAssociatedRow is defined as
             // the largest unsigned value in order to push unassociated rows to
@@ -113,6 +132,10 @@ namespace BitFunnel
             static const unsigned c_noAssociatedRow = ~0U;
         };
 
+        // Returns the probability that the matcher reaches a row after
+        // ANDing depth rows into the accumulator.
+        static double ReachProbability(unsigned depth);
+
         // Total number of rows in the plan. Will be used to size m_mapping.
         unsigned m_rowCount;
 
@@ -0,0 +1,262 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IShard.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Index/Token.h"
+#include "IPlanRows.h"
+#include "RowMatchNode.h"
+#include "SummaryFilter.h"
+
+
+namespace BitFunnel
+{
+    SummaryFilter::SummaryFilter(RowMatchNode const & tree,
+                                 IPlanRows const & planRows,
+                                 ISimpleIndex const & index,
+                                 Rank initialRank)
+      : m_planRows(planRows),
+        m_index(index),
+        m_initialRank(initialRank),
+        m_isEnabled(false)
+    {
+        CollectRequiredRows(tree, m_rows);
+        m_isEnabled = !m_rows.empty() && SkipsEnoughIterations();
+    }
+
+
+    // With the MatcherBenchmark shapes at row density 0.1, where the
+    // summaries rule out nothing, the live iteration checks slowed the
+    // compiled matcher by 4% to 15%.
+    const double SummaryFilter::c_minSkippedFraction = 0.25;
+
+
+    bool SummaryFilter::IsEnabled() const
+    {
+        return m_isEnabled;
+    }
+
+
+    uint64_t const * SummaryFilter::ComputeLiveIterations(
+        ShardId shardId,
+        std::vector<void*> const & sliceBuffers,
+        size_t iterationsPerSlice)
+    {
+        IShard const & shard = m_index.GetIngestor().GetShard(shardId);
+
+        std::vector<ptrdiff_t> summaries;
+        for (auto id : m_rows)
+        {
+            RowId row = m_planRows.PhysicalRow(shardId, id);
+            if (shard.HasSummary(row))
+            {
+                summaries.push_back(shard.GetSummaryOffset(row));
+            }
+        }
+
+        const size_t quadwordsPerSlice = GetQuadwordsPerSlice(iterationsPerSlice);
+        m_liveIterations.resize(quadwordsPerSlice * sliceBuffers.size());
+
+        for (size_t s = 0; s < sliceBuffers.size(); ++s)
+        {
+            ComputeSliceLiveIterations(sliceBuffers[s],
+                                       summaries,
+                                       shard.GetDocumentsPerSummaryBit(),
+                                       m_initialRank,
+                                       iterationsPerSlice,
+                                       m_liveIterations.data() + s * quadwordsPerSlice);
+        }
+
+        return m_liveIterations.data();
+    }
+
+
+    static size_t CountBits(uint64_t value)
+    {
+#ifdef _MSC_VER
+        return static_cast<size_t>(__popcnt64(value));
+#else
+        return static_cast<size_t>(__builtin_popcountll(value));
+#endif
+    }
+
+
+    bool SummaryFilter::SkipsEnoughIterations()
+    {
+        // Slice buffers may only be examined while holding a token.
+        auto token = m_index.GetIngestor().GetTokenManager().RequestToken();
+
+        size_t iterations = 0;
+        size_t liveIterations = 0;
+        for (ShardId shardId = 0;
+             shardId < m_index.GetIngestor().GetShardCount();
+             ++shardId)
+        {
+            auto & shard = m_index.GetIngestor().GetShard(shardId);
+            auto & sliceBuffers = shard.GetSliceBuffers();
+            const size_t iterationsPerSlice =
+                shard.GetSliceCapacity() >> 6 >> m_initialRank;
+
+            uint64_t const * live = ComputeLiveIterations(shardId,
+                                                          sliceBuffers,
+                                                          iterationsPerSlice);
+            const size_t quadwords =
+                GetQuadwordsPerSlice(iterationsPerSlice) * sliceBuffers.size();
+            for (size_t i = 0; i < quadwords; ++i)
+            {
+                liveIterations += CountBits(live[i]);
+            }
+            iterations += iterationsPerSlice * sliceBuffers.size();
+        }
+
+        return iterations > 0 &&
+            static_cast<double>(iterations - liveIterations) >=
+                c_minSkippedFraction * static_cast<double>(iterations);
+    }
+
+
+    // Sets bits [begin, end) in bitmap.
+    static void SetBits(uint64_t * bitmap, size_t begin, size_t end)
+    {
+        while (begin < end)
+        {
+            const size_t offset = begin & 0x3F;
+            const size_t count = (std::min)(64 - offset, end - begin);
+            const uint64_t mask = (count == 64) ?
+                ~0ull : ((1ull << count) - 1) << offset;
+            bitmap[begin >> 6] |= mask;
+            begin += count;
+        }
+    }
+
+
+    static size_t CountTrailingZeros(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        // Undefined for zero, which callers exclude.
+        return static_cast<size_t>(__builtin_ctzll(value));
+#endif
+    }
+
+
+    void SummaryFilter::ComputeSliceLiveIterations(
+        void const * sliceBuffer,
+        std::vector<ptrdiff_t> const & summaryOffsets,
+        size_t docsPerSummaryBit,
+        Rank initialRank,
+        size_t iterationsPerSlice,
+        uint64_t * live)
+    {
+        const size_t quadwordsPerSlice = GetQuadwordsPerSlice(iterationsPerSlice);
+        std::fill(live, live + quadwordsPerSlice, 0ull);
+
+        // Each iteration covers 64 quadwords' worth of documents at the
+        // initial rank.
+        const size_t docsPerIteration = 64ull << initialRank;
+        const size_t summaryBits =
+            (iterationsPerSlice * docsPerIteration + docsPerSummaryBit - 1) /
+            docsPerSummaryBit;
+
+        // A document can only match if its bit is set in every required row,
+        // so the summaries are intersected a quadword at a time. Each run of
+        // set bits in the intersection then marks the iterations that
+        // overlap its documents.
+        char const * buffer = reinterpret_cast<char const *>(sliceBuffer);
+        for (size_t word = 0; word * 64 < summaryBits; ++word)
+        {
+            uint64_t bits = ~0ull;
+            for (size_t i = 0; i < summaryOffsets.size() && bits != 0; ++i)
+            {
+                bits &= reinterpret_cast<uint64_t const *>(
+                    buffer + summaryOffsets[i])[word];
+            }
+
+            while (bits != 0)
+            {
+                const size_t begin = CountTrailingZeros(bits);
+                const uint64_t shifted = ~(bits >> begin);
+                const size_t end = (shifted == 0) ?
+                    64 : begin + CountTrailingZeros(shifted);
+                bits = (end == 64) ? 0 : bits & (~0ull << end);
+
+                const size_t firstDoc = (word * 64 + begin) * docsPerSummaryBit;
+                const size_t lastDoc = (word * 64 + end) * docsPerSummaryBit - 1;
+                SetBits(live,
+                        firstDoc / docsPerIteration,
+                        (std::min)(lastDoc / docsPerIteration + 1,
+                                   iterationsPerSlice));
+            }
+        }
+    }
+
+
+    size_t SummaryFilter::GetQuadwordsPerSlice(size_t iterationsPerSlice)
+    {
+        return (iterationsPerSlice + 63) / 64;
+    }
+
+
+    void SummaryFilter::CollectRequiredRows(RowMatchNode const & node,
+                                            std::vector<unsigned> & rows)
+    {
+        // Only descend through conjunctions. A row under an Or or a Not is
+        // not required by every match.
+        switch (node.GetType())
+        {
+        case RowMatchNode::AndMatch:
+            {
+                auto const & andNode = dynamic_cast<RowMatchNode::And const &>(node);
+                CollectRequiredRows(andNode.GetLeft(), rows);
+                CollectRequiredRows(andNode.GetRight(), rows);
+            }
+            break;
+        case RowMatchNode::ReportMatch:
+            {
+                auto child = dynamic_cast<RowMatchNode::Report const &>(node).GetChild();
+                if (child != nullptr)
+                {
+                    CollectRequiredRows(*child, rows);
+                }
+            }
+            break;
+        case RowMatchNode::RowMatch:
+            {
+                AbstractRow const & row =
+                    dynamic_cast<RowMatchNode::Row const &>(node).GetRow();
+                if (!row.IsInverted() && row.GetRank() == 0)
+                {
+                    rows.push_back(row.GetId());
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>                     // ptrdiff_t parameter.
+#include <stdint.h>                     // uint64_t embedded.
+#include <vector>                       // std::vector embedded.
+
+#include "BitFunnel/BitFunnelTypes.h"   // Rank, ShardId parameters.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IPlanRows;
+    class ISimpleIndex;
+    class RowMatchNode;
+
+    //*************************************************************************
+    //
+    // SummaryFilter finds matcher iterations that cannot produce matches
+    // because a row required by every match is empty across the documents
+    // covered by the iteration. It works from the summary bitmaps that the
+    // index maintains for rank 0 rows (see RowTableDescriptor).
+    //
+    // For each slice, ComputeLiveIterations() produces a bitmap with one bit
+    // per iteration. Bits for iterations that can be skipped are cleared.
+    // Both the ByteCodeInterpreter and the generated native code consult
+    // this bitmap before running an iteration.
+    //
+    //*************************************************************************
+    class SummaryFilter : public NonCopyable
+    {
+    public:
+        // Collects the rank 0 rows that appear in every conjunct of the
+        // match tree.
+        SummaryFilter(RowMatchNode const & tree,
+                      IPlanRows const & planRows,
+                      ISimpleIndex const & index,
+                      Rank initialRank);
+
+        // Returns true if the plan has at least one required rank 0 row and
+        // the summaries currently rule out at least c_minSkippedFraction of
+        // the iterations. When false, the matcher should not pay for the
+        // live iteration checks, which cost up to about 15% of matching time
+        // when nothing is skipped.
+        bool IsEnabled() const;
+
+        // Returns the live iteration bitmaps for every slice in sliceBuffers.
+        // The bitmap for slice s starts at
+        //   GetQuadwordsPerSlice(iterationsPerSlice) * s
+        // quadwords from the returned pointer. The pointer is valid until the
+        // next call to ComputeLiveIterations().
+        uint64_t const * ComputeLiveIterations(ShardId shard,
+                                               std::vector<void*> const & sliceBuffers,
+                                               size_t iterationsPerSlice);
+
+        // Returns the number of quadwords in the bitmap for one slice.
+        static size_t GetQuadwordsPerSlice(size_t iterationsPerSlice);
+
+        // Appends to rows the abstract row ids of the rank 0 rows that
+        // appear in every conjunct of the match tree.
+        static void CollectRequiredRows(RowMatchNode const & node,
+                                        std::vector<unsigned> & rows);
+
+        // Writes the live iteration bitmap for a single slice to live, which
+        // must hold GetQuadwordsPerSlice(iterationsPerSlice) quadwords.
+        // summaryOffsets holds the byte offset of each required row's summary
+        // within sliceBuffer. An iteration is live if it covers a summary
+        // bit that is set in every one of the summaries.
+        static void ComputeSliceLiveIterations(
+            void const * sliceBuffer,
+            std::vector<ptrdiff_t> const & summaryOffsets,
+            size_t docsPerSummaryBit,
+            Rank initialRank,
+            size_t iterationsPerSlice,
+            uint64_t * live);
+
+    private:
+        // Returns true if the live iterations across every shard skip
+        // enough iterations to make the filter worthwhile.
+        bool SkipsEnoughIterations();
+
+        static const double c_minSkippedFraction;
+
+        IPlanRows const & m_planRows;
+        ISimpleIndex const & m_index;
+        const Rank m_initialRank;
+
+        // Abstract row ids of the required rank 0 rows.
+        std::vector<unsigned> m_rows;
+
+        bool m_isEnabled;
+
+        std::vector<uint64_t> m_liveIterations;
+    };
+}
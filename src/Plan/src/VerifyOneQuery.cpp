@@ -47,7 +47,23 @@ namespace BitFunnel
         ISimpleIndex const & index,
         std::string query,
         bool runVerification,
-        bool compilerMode)
+        MatcherMode matcherMode)
+    {
+        QueryInstrumentation::Data data;
+        return VerifyOneQuery(index,
+                              query,
+                              runVerification,
+                              matcherMode,
+                              data);
+    }
+
+
+    std::unique_ptr<IMatchVerifier> VerifyOneQuery(
+        ISimpleIndex const & index,
+        std::string query,
+        bool runVerification,
+        MatcherMode matcherMode,
+        QueryInstrumentation::Data & data)
     {
         QueryResources resources;
         auto & allocator = resources.GetMatchTreeAllocator();
@@ -111,7 +127,7 @@ namespace BitFunnel
                                        *diagnosticStream,
                                        instrumentation,
                                        results,
-                                       compilerMode);
+                                       matcherMode);
 
             for (auto result : results)
             {
@@ -119,6 +135,8 @@ namespace BitFunnel
                 verifier->AddObserved(handle.GetDocId());
             }
 
+            data = instrumentation.GetData();
+
             verifier->Verify();
             //verifier->Print(std::cout);
         }
@@ -32,6 +32,7 @@
 #include "BitFunnel/Mocks/Factories.h"
 #include "BitFunnel/Term.h"                     // Only needed for streamId
 #include "ByteCodeVerifier.h"
+#include "NativeCodeVerifier.h"
 #include "Primes.h"
 
 
@@ -539,6 +540,110 @@ namespace BitFunnel
     }
 
 
+    //*************************************************************************
+    //
+    // Not test cases
+    //
+    // The interpreter's Not opcode once used logical rather than bitwise
+    // negation, so it reported at most one document per quadword. These
+    // tests hold the interpreter and the native code to the same
+    // expectations.
+    //
+    //*************************************************************************
+
+    //
+    // Not of a single row.
+    //
+    static void VerifyNotRow(ICodeVerifier & verifier)
+    {
+        char const * text =
+            "LoadRowJz {"
+            "  Row: Row(0, 0, 0, false),"
+            "  Child: Report {"
+            "    Child: Not {"
+            "      Child: LoadRow(1, 0, 0, false)"
+            "    }"
+            "  }"
+            "}";
+
+        verifier.DeclareRow("2");
+        verifier.DeclareRow("3");
+
+        for (auto iteration : verifier.GetIterations())
+        {
+            const size_t slice = verifier.GetSliceNumber(iteration);
+            const size_t offset = verifier.GetOffset(iteration);
+
+            const uint64_t row0 = verifier.GetRowData(0, offset, slice);
+            const uint64_t row1 = verifier.GetRowData(1, offset, slice);
+            verifier.ExpectResult(row0 & ~row1, offset, slice);
+        }
+
+        verifier.Verify(text);
+    }
+
+
+    TEST(ByteCodeInterpreter, NotRow)
+    {
+        const Rank initialRank = 0;
+        ByteCodeVerifier interpreter(GetIndex(), initialRank);
+        VerifyNotRow(interpreter);
+
+        NativeCodeVerifier compiler(GetIndex(), initialRank);
+        VerifyNotRow(compiler);
+    }
+
+
+    //
+    // Not of an Or of two rows.
+    //
+    static void VerifyNotOr(ICodeVerifier & verifier)
+    {
+        char const * text =
+            "LoadRowJz {"
+            "  Row: Row(0, 0, 0, false),"
+            "  Child: Report {"
+            "    Child: Not {"
+            "      Child: OrTree {"
+            "        Children: ["
+            "          LoadRow(1, 0, 0, false),"
+            "          LoadRow(2, 0, 0, false)"
+            "        ]"
+            "      }"
+            "    }"
+            "  }"
+            "}";
+
+        verifier.DeclareRow("2");
+        verifier.DeclareRow("3");
+        verifier.DeclareRow("5");
+
+        for (auto iteration : verifier.GetIterations())
+        {
+            const size_t slice = verifier.GetSliceNumber(iteration);
+            const size_t offset = verifier.GetOffset(iteration);
+
+            const uint64_t row0 = verifier.GetRowData(0, offset, slice);
+            const uint64_t row1 = verifier.GetRowData(1, offset, slice);
+            const uint64_t row2 = verifier.GetRowData(2, offset, slice);
+            verifier.ExpectResult(row0 & ~(row1 | row2), offset, slice);
+        }
+
+        verifier.Verify(text);
+    }
+
+
+    TEST(ByteCodeInterpreter, NotOr)
+    {
+        const Rank initialRank = 0;
+        ByteCodeVerifier interpreter(GetIndex(), initialRank);
+        VerifyNotOr(interpreter);
+
+        NativeCodeVerifier compiler(GetIndex(), initialRank);
+        VerifyNotOr(compiler);
+    }
+
+
     //*************************************************************************
     //
     // Or test cases
@@ -79,6 +79,8 @@ namespace BitFunnel
             m_rowOffsets.data(),
             nullptr,
             instrumentation,
+            nullptr,
+            0,
             nullptr);
 
         interpreter.Run();
@@ -0,0 +1,83 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "gtest/gtest.h"
+
+#include "CompileWorker.h"
+
+
+namespace BitFunnel
+{
+    namespace CompileWorkerTest
+    {
+        TEST(CompileWorker, RunsTasksInTurn)
+        {
+            CompileWorker worker;
+            EXPECT_TRUE(worker.IsIdle());
+
+            std::atomic<int> runCount(0);
+            for (int i = 0; i < 3; ++i)
+            {
+                EXPECT_TRUE(worker.TryStart([&]() { ++runCount; }));
+                worker.Wait();
+                EXPECT_TRUE(worker.IsIdle());
+                EXPECT_EQ(runCount, i + 1);
+            }
+        }
+
+
+        // A worker that is still running a task refuses another, so that
+        // the caller falls back to interpreting.
+        TEST(CompileWorker, RefusesWhileBusy)
+        {
+            CompileWorker worker;
+
+            std::mutex lock;
+            std::condition_variable released;
+            bool release = false;
+
+            EXPECT_TRUE(worker.TryStart([&]()
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    released.wait(guard, [&]() { return release; });
+                }));
+
+            bool secondRan = false;
+            EXPECT_FALSE(worker.IsIdle());
+            EXPECT_FALSE(worker.TryStart([&]() { secondRan = true; }));
+
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                release = true;
+            }
+            released.notify_one();
+
+            worker.Wait();
+            EXPECT_TRUE(worker.IsIdle());
+            EXPECT_FALSE(secondRan);
+        }
+    }
+}
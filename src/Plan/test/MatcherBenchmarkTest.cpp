@@ -0,0 +1,184 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Plan/MatcherBenchmark.h"
+
+
+namespace BitFunnel
+{
+    namespace MatcherBenchmarkTest
+    {
+        // Rows 0 through 2 are deterministic so that match counts are known.
+        // Rows 3 through 5 are random. Row 5 is rare enough that summaries
+        // rule out some iterations.
+        std::vector<MatcherBenchmark::RowDescriptor> const c_rows =
+        {
+            { 0, 1.0 },
+            { 0, 0.0 },
+            { 3, 1.0 },
+            { 0, 0.5 },
+            { 6, 0.9 },
+            { 0, 0.0005 }
+        };
+
+        const size_t c_sliceCapacity = 4096;
+        const size_t c_sliceCount = 4;
+
+        MatcherMode const c_modes[] =
+        {
+            MatcherMode::Interpreter,
+            MatcherMode::Compiler
+        };
+
+
+        TEST(MatcherBenchmark, KnownMatchCounts)
+        {
+            MatcherBenchmark benchmark(c_rows, c_sliceCapacity, c_sliceCount, 1);
+            const size_t documents = c_sliceCapacity * c_sliceCount;
+            EXPECT_EQ(documents, benchmark.GetDocumentCount());
+
+            for (auto mode : c_modes)
+            {
+                auto all = benchmark.Run(
+                    "And { Children: [ Row(2, 3, 0, false), Row(0, 0, 0, false) ] }",
+                    mode,
+                    2,
+                    0,
+                    false);
+                EXPECT_EQ(documents, all.GetMatchCount());
+                EXPECT_GT(all.GetQuadwordCount(), 0u);
+
+                auto none = benchmark.Run(
+                    "And { Children: [ Row(0, 0, 0, false), Row(1, 0, 0, false) ] }",
+                    mode,
+                    1,
+                    0,
+                    false);
+                EXPECT_EQ(0u, none.GetMatchCount());
+                EXPECT_EQ(0.0, none.GetNanosecondsPerMatch());
+
+                auto negated = benchmark.Run(
+                    "And { Children: [ Row(0, 0, 0, false),"
+                    "  Not { Child: Row(1, 0, 0, false) } ] }",
+                    mode,
+                    1,
+                    0,
+                    false);
+                EXPECT_EQ(documents, negated.GetMatchCount());
+            }
+        }
+
+
+        TEST(MatcherBenchmark, BackendsAgree)
+        {
+            MatcherBenchmark benchmark(c_rows, c_sliceCapacity, c_sliceCount, 7);
+
+            char const * plan =
+                "And { Children: ["
+                "  Row(4, 6, 0, false),"
+                "  Or { Children: [ Row(3, 0, 0, false), Row(1, 0, 0, false) ] }"
+                "] }";
+
+            auto interpreted =
+                benchmark.Run(plan, MatcherMode::Interpreter, 1, 0, false);
+            auto compiled = benchmark.Run(plan, MatcherMode::Compiler, 1, 0, false);
+            auto prefetched = benchmark.Run(plan, MatcherMode::Compiler, 1, 8, false);
+
+            EXPECT_GT(interpreted.GetMatchCount(), 0u);
+            EXPECT_LT(interpreted.GetMatchCount(), benchmark.GetDocumentCount());
+            EXPECT_EQ(interpreted.GetMatchCount(), compiled.GetMatchCount());
+            EXPECT_EQ(compiled.GetMatchCount(), prefetched.GetMatchCount());
+        }
+
+
+        TEST(MatcherBenchmark, Summaries)
+        {
+            MatcherBenchmark benchmark(c_rows, c_sliceCapacity, c_sliceCount, 5);
+
+            char const * plan =
+                "And { Children: [ Row(5, 0, 0, false), Row(3, 0, 0, false) ] }";
+
+            for (auto mode : c_modes)
+            {
+                auto unfiltered = benchmark.Run(plan, mode, 1, 0, false);
+                auto filtered = benchmark.Run(plan, mode, 1, 0, true);
+
+                EXPECT_EQ(unfiltered.GetMatchCount(), filtered.GetMatchCount());
+                EXPECT_LT(filtered.GetQuadwordCount(),
+                          unfiltered.GetQuadwordCount());
+            }
+
+            // Row 1 is empty, so its summary rules out every iteration.
+            auto none = benchmark.Run(
+                "And { Children: [ Row(0, 0, 0, false), Row(1, 0, 0, false) ] }",
+                MatcherMode::Compiler,
+                1,
+                0,
+                true);
+            EXPECT_EQ(0u, none.GetMatchCount());
+            EXPECT_EQ(0u, none.GetQuadwordCount());
+
+            // Without a required rank 0 row there is nothing to filter.
+            auto unrequired = benchmark.Run(
+                "Or { Children: [ Row(0, 0, 0, false), Row(1, 0, 0, false) ] }",
+                MatcherMode::Compiler,
+                1,
+                0,
+                true);
+            EXPECT_EQ(benchmark.GetDocumentCount(), unrequired.GetMatchCount());
+        }
+
+
+        TEST(MatcherBenchmark, SameSeedSameRows)
+        {
+            char const * plan = "Row(3, 0, 0, false)";
+
+            MatcherBenchmark a(c_rows, c_sliceCapacity, c_sliceCount, 3);
+            MatcherBenchmark b(c_rows, c_sliceCapacity, c_sliceCount, 3);
+
+            EXPECT_EQ(a.Run(plan, MatcherMode::Interpreter, 1, 0, false).GetMatchCount(),
+                      b.Run(plan, MatcherMode::Interpreter, 1, 0, false).GetMatchCount());
+        }
+
+
+        TEST(MatcherBenchmark, BadParameters)
+        {
+            EXPECT_THROW(MatcherBenchmark(c_rows, 1000, c_sliceCount, 1),
+                         RecoverableError);
+            EXPECT_THROW(MatcherBenchmark({ { 0, 1.5 } }, c_sliceCapacity, 1, 1),
+                         RecoverableError);
+
+            MatcherBenchmark benchmark(c_rows, c_sliceCapacity, c_sliceCount, 1);
+            EXPECT_THROW(benchmark.Run("Row(0, 0, 0, false)",
+                                       MatcherMode::Adaptive,
+                                       1,
+                                       0,
+                                       false),
+                         RecoverableError);
+        }
+    }
+}
@@ -0,0 +1,144 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Exceptions.h"
+#include "MatcherCodeCache.h"
+
+
+namespace BitFunnel
+{
+    namespace MatcherCodeCacheTest
+    {
+        typedef int (*Function)();
+
+        // Two bytes of padding followed by
+        //   mov eax, 42
+        //   ret
+        // The entry point is at offset 2.
+        unsigned char const c_code[] =
+            { 0xcc, 0xcc, 0xb8, 0x2a, 0x00, 0x00, 0x00, 0xc3 };
+        size_t const c_entryOffset = 2;
+
+
+        int Call(void const * entryPoint)
+        {
+            auto function =
+                reinterpret_cast<Function>(const_cast<void*>(entryPoint));
+            return function();
+        }
+
+
+        TEST(MatcherCodeCache, AddFind)
+        {
+            MatcherCodeCache cache(4096);
+
+            EXPECT_EQ(cache.Find("a"), nullptr);
+
+            void const * added =
+                cache.Add("a", c_code, sizeof(c_code), c_entryOffset);
+            ASSERT_NE(added, nullptr);
+            EXPECT_EQ(cache.Find("a"), added);
+            EXPECT_EQ(cache.GetEntryCount(), 1u);
+            EXPECT_EQ(Call(added), 42);
+
+            // Adding the same key again returns the original code.
+            EXPECT_EQ(cache.Add("a", c_code, sizeof(c_code), c_entryOffset),
+                      added);
+            EXPECT_EQ(cache.GetEntryCount(), 1u);
+        }
+
+
+        TEST(MatcherCodeCache, OutOfSpace)
+        {
+            MatcherCodeCache cache(4096);
+
+            std::vector<unsigned char> large(4097, 0xc3);
+            EXPECT_EQ(cache.Add("large", large.data(), large.size(), 0),
+                      nullptr);
+            EXPECT_EQ(cache.GetEntryCount(), 0u);
+        }
+
+
+        TEST(MatcherCodeCache, RoundTrip)
+        {
+            const uint64_t c_version = 1234;
+            std::stringstream stream;
+
+            {
+                MatcherCodeCache cache(4096);
+                cache.Add("a", c_code, sizeof(c_code), c_entryOffset);
+                cache.Write(stream, c_version);
+            }
+
+            MatcherCodeCache cache(4096);
+            ASSERT_TRUE(cache.Read(stream, c_version));
+            EXPECT_EQ(cache.GetEntryCount(), 1u);
+
+            // Code is copied into the new cache's memory and still runs.
+            void const * loaded = cache.Find("a");
+            ASSERT_NE(loaded, nullptr);
+            EXPECT_EQ(Call(loaded), 42);
+        }
+
+
+        TEST(MatcherCodeCache, VersionMismatch)
+        {
+            std::stringstream stream;
+            {
+                MatcherCodeCache cache(4096);
+                cache.Add("a", c_code, sizeof(c_code), c_entryOffset);
+                cache.Write(stream, 1);
+            }
+
+            MatcherCodeCache cache(4096);
+            EXPECT_FALSE(cache.Read(stream, 2));
+            EXPECT_EQ(cache.GetEntryCount(), 0u);
+            EXPECT_EQ(cache.Find("a"), nullptr);
+        }
+
+
+        TEST(MatcherCodeCache, Truncated)
+        {
+            const uint64_t c_version = 1234;
+            std::stringstream stream;
+            {
+                MatcherCodeCache cache(4096);
+                cache.Add("a", c_code, sizeof(c_code), c_entryOffset);
+                cache.Add("b", c_code, sizeof(c_code), c_entryOffset);
+                cache.Write(stream, c_version);
+            }
+
+            // Drop the last byte of code from the second entry.
+            std::string text = stream.str();
+            std::stringstream truncated(text.substr(0, text.size() - 1));
+
+            MatcherCodeCache cache(4096);
+            EXPECT_THROW(cache.Read(truncated, c_version), RecoverableError);
+            EXPECT_EQ(cache.GetEntryCount(), 0u);
+            EXPECT_EQ(cache.Find("a"), nullptr);
+        }
+    }
+}
@@ -22,6 +22,7 @@
 
 #include <iomanip>
 #include <iostream>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -33,6 +34,7 @@
 #include "BitFunnel/Term.h"
 #include "BitFunnel/Utilities/Allocator.h"
 #include "CompileNode.h"
+#include "MachineCodeGenerator.h"
 #include "MatchTreeCompiler.h"
 #include "NativeCodeVerifier.h"
 #include "NativeJIT/CodeGen/ExecutionBuffer.h"
@@ -40,6 +42,7 @@
 #include "RegisterAllocator.h"
 #include "ResultsBuffer.h"
 #include "RowMatchNode.h"
+#include "SummaryFilter.h"
 #include "TextObjectParser.h"
 
 
@@ -68,7 +71,7 @@ namespace BitFunnel
 
         RegisterAllocator registers(compileNodeTree,
                                     8,
-                                    8,
+                                    MachineCodeGenerator::GetRegisterBase(),
                                     7,
                                     allocator);
 
@@ -77,7 +80,8 @@ namespace BitFunnel
         MatchTreeCompiler compiler(resources,
                                    compileNodeTree,
                                    registers,
-                                   m_initialRank);
+                                   m_initialRank,
+                                   false);
 
         ResultsBuffer results(m_index.GetIngestor().GetDocumentCount());
 
@@ -85,8 +89,132 @@ namespace BitFunnel
                      m_slices.data(),
                      GetIterationsPerSlice(),
                      m_rowOffsets.data(),
+                     nullptr,
                      results);
 
+        // Running the slices in two batches must append to the results of
+        // the first batch, as happens when MatcherMode::Adaptive switches
+        // from the interpreter to native code part way through a shard.
+        ResultsBuffer split(m_index.GetIngestor().GetDocumentCount());
+        size_t const firstBatch = m_slices.size() / 2;
+        compiler.Run(firstBatch,
+                     m_slices.data(),
+                     GetIterationsPerSlice(),
+                     m_rowOffsets.data(),
+                     nullptr,
+                     split);
+        compiler.Run(m_slices.size() - firstBatch,
+                     m_slices.data() + firstBatch,
+                     GetIterationsPerSlice(),
+                     m_rowOffsets.data(),
+                     nullptr,
+                     split);
+        EXPECT_EQ(split.size(), results.size());
+
+        // Prefetching must not change the matches.
+        {
+            QueryResources prefetchResources;
+            prefetchResources.SetPrefetchDistance(16);
+            MatchTreeCompiler prefetchCompiler(prefetchResources,
+                                               compileNodeTree,
+                                               registers,
+                                               m_initialRank,
+                                               false);
+
+            ResultsBuffer prefetched(m_index.GetIngestor().GetDocumentCount());
+            prefetchCompiler.Run(m_slices.size(),
+                                 m_slices.data(),
+                                 GetIterationsPerSlice(),
+                                 m_rowOffsets.data(),
+                                 nullptr,
+                                 prefetched);
+
+            EXPECT_EQ(prefetched.size(), results.size());
+        }
+
+        // Repeat with no row registers so that every row is read through
+        // NativeCodeGenerator::Parameters::m_rowPointers. This run also
+        // prefetches through the row pointers.
+        {
+            RegisterAllocator noRegisters(compileNodeTree,
+                                          8,
+                                          MachineCodeGenerator::GetRegisterBase(),
+                                          0,
+                                          allocator);
+
+            QueryResources spillResources;
+            spillResources.SetPrefetchDistance(8);
+            MatchTreeCompiler spillCompiler(spillResources,
+                                            compileNodeTree,
+                                            noRegisters,
+                                            m_initialRank,
+                                            false);
+
+            ResultsBuffer spilled(m_index.GetIngestor().GetDocumentCount());
+            spillCompiler.Run(m_slices.size(),
+                              m_slices.data(),
+                              GetIterationsPerSlice(),
+                              m_rowOffsets.data(),
+                              nullptr,
+                              spilled);
+
+            ASSERT_EQ(spilled.size(), results.size());
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                EXPECT_EQ(spilled.m_buffer[i].m_slice, results.m_buffer[i].m_slice);
+                EXPECT_EQ(spilled.m_buffer[i].m_index, results.m_buffer[i].m_index);
+            }
+        }
+
+        // Summary checks with every iteration live must not change the
+        // matches. A second run with the first iteration of every slice
+        // marked dead must drop exactly the matches from that iteration.
+        {
+            QueryResources summaryResources;
+            MatchTreeCompiler summaryCompiler(summaryResources,
+                                              compileNodeTree,
+                                              registers,
+                                              m_initialRank,
+                                              true);
+
+            const size_t quadwordsPerSlice =
+                SummaryFilter::GetQuadwordsPerSlice(GetIterationsPerSlice());
+            std::vector<uint64_t> live(quadwordsPerSlice * m_slices.size(),
+                                       ~0ull);
+
+            ResultsBuffer summarized(m_index.GetIngestor().GetDocumentCount());
+            summaryCompiler.Run(m_slices.size(),
+                                m_slices.data(),
+                                GetIterationsPerSlice(),
+                                m_rowOffsets.data(),
+                                live.data(),
+                                summarized);
+            EXPECT_EQ(summarized.size(), results.size());
+
+            size_t firstIterationMatches = 0;
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                if ((results.m_buffer[i].m_index >> (6 + m_initialRank)) == 0)
+                {
+                    ++firstIterationMatches;
+                }
+            }
+
+            for (size_t s = 0; s < m_slices.size(); ++s)
+            {
+                live[s * quadwordsPerSlice] &= ~1ull;
+            }
+
+            ResultsBuffer skipped(m_index.GetIngestor().GetDocumentCount());
+            summaryCompiler.Run(m_slices.size(),
+                                m_slices.data(),
+                                GetIterationsPerSlice(),
+                                m_rowOffsets.data(),
+                                live.data(),
+                                skipped);
+            EXPECT_EQ(skipped.size(), results.size() - firstIterationMatches);
+        }
+
         CheckResults(results);
     }
 }
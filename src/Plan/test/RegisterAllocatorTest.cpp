@@ -75,7 +75,9 @@ namespace BitFunnel
 
             {
                 // Moderateley complex example with LoadRowJz, AndRowJz,
-                // RankDown, Or, and Report.
+                // RankDown, Or, and Report. Row 2 is at the root but is only
+                // loaded once for every 64 loads of the rank 0 rows below
+                // the RankDown, so it is allocated last.
                 "And {"
                 "  Children: ["
                 "    Row(0, 0, 0, false),"
@@ -98,12 +100,12 @@ namespace BitFunnel
                 7,
                 7,
                 {
-                    106,    // Row 0
+                    105,    // Row 0
                     101,    // Row 1
-                    100,    // Row 2
-                    102,    // Row 3
+                    106,    // Row 2
+                    100,    // Row 3
                     103,    // Row 4
-                    105,    // Row 5 
+                    102,    // Row 5
                     104,    // Row 6
                 }
             },
@@ -136,12 +138,12 @@ namespace BitFunnel
                 7,
                 7,
                 {
-                    106,    // Row 0
+                    105,    // Row 0
                     101,    // Row 1
-                    100,    // Row 2
-                    102,    // Row 3
+                    106,    // Row 2
+                    100,    // Row 3
                     103,    // Row 4
-                    105,    // Row 5
+                    102,    // Row 5
                     104,    // Row 6
                 }
             },
@@ -172,13 +174,13 @@ namespace BitFunnel
                 7,
                 4,
                 {
-                    -1,    // Row 0
+                    -1,     // Row 0
                     101,    // Row 1
-                    100,    // Row 2
-                    102,    // Row 3
+                    -1,     // Row 2
+                    100,    // Row 3
                     103,    // Row 4
-                    -1,    // Row 5
-                    -1,    // Row 6
+                    102,    // Row 5
+                    -1,     // Row 6
                 }
             },
 
@@ -293,5 +295,60 @@ namespace BitFunnel
                 allocator.Reset();
             }
         }
+
+
+        // Verify that usage still orders rows that are too deep for
+        // 1 - (1 - p)^64 to be represented directly. A chain of c_depth rows
+        // leads to an Or where row c_depth + 2 is used 8 times under a
+        // RankDown and row c_depth + 1 is used once. Both are at the same
+        // depth, so if their reach probabilities rounded to zero, the tie
+        // would be broken by id and row c_depth + 1 would come first.
+        TEST(RegisterAllocator,DeepRows)
+        {
+            const unsigned c_depth = 20;
+            const unsigned c_rowCount = c_depth + 3;
+
+            std::stringstream text;
+            for (unsigned i = 0; i <= c_depth; ++i)
+            {
+                text << ((i == 0) ? "LoadRowJz {" : "AndRowJz {")
+                     << "Row: Row(" << i << ", 0, 0, false),"
+                     << "Child: ";
+            }
+            text << "Or { Children: ["
+                 << "AndRowJz {"
+                 << "Row: Row(" << c_depth + 1 << ", 0, 0, false),"
+                 << "Child: Report { Child: }"
+                 << "},"
+                 << "RankDown {"
+                 << "Delta: 3,"
+                 << "Child: AndRowJz {"
+                 << "Row: Row(" << c_depth + 2 << ", 0, 0, false),"
+                 << "Child: Report { Child: }"
+                 << "}"
+                 << "}"
+                 << "]}";
+            for (unsigned i = 0; i <= c_depth; ++i)
+            {
+                text << "}";
+            }
+
+            Allocator allocator(8192);
+            TextObjectParser parser(text, allocator, &CompileNode::GetType);
+            CompileNode const & compiled = CompileNode::Parse(parser);
+
+            RegisterAllocator registers(compiled,
+                                        c_rowCount,
+                                        100,
+                                        c_rowCount,
+                                        allocator);
+
+            for (unsigned i = 0; i <= c_depth; ++i)
+            {
+                VerifyRegister(i, 100 + i, registers);
+            }
+            VerifyRegister(c_depth + 2, 100 + c_depth + 1, registers);
+            VerifyRegister(c_depth + 1, 100 + c_depth + 2, registers);
+        }
     }
 }
@@ -0,0 +1,128 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "SummaryFilter.h"
+
+
+namespace BitFunnel
+{
+    namespace SummaryFilterTest
+    {
+        static const size_t c_docsPerSummaryBit = 512;
+
+        // Two summaries of 128 bits each, laid out back to back. 128 bits
+        // cover 65536 documents.
+        static const size_t c_summaryQuadwords = 2;
+        static const size_t c_documentCount = 128 * c_docsPerSummaryBit;
+
+
+        static std::vector<bool> GetLiveIterations(
+            std::vector<uint64_t> const & summaries,
+            Rank initialRank)
+        {
+            const size_t iterationsPerSlice =
+                c_documentCount / (64ull << initialRank);
+            std::vector<ptrdiff_t> offsets;
+            for (size_t i = 0; i < summaries.size() / c_summaryQuadwords; ++i)
+            {
+                offsets.push_back(static_cast<ptrdiff_t>(
+                    i * c_summaryQuadwords * sizeof(uint64_t)));
+            }
+
+            std::vector<uint64_t> live(
+                SummaryFilter::GetQuadwordsPerSlice(iterationsPerSlice), ~0ull);
+            SummaryFilter::ComputeSliceLiveIterations(summaries.data(),
+                                                      offsets,
+                                                      c_docsPerSummaryBit,
+                                                      initialRank,
+                                                      iterationsPerSlice,
+                                                      live.data());
+
+            std::vector<bool> result;
+            for (size_t i = 0; i < iterationsPerSlice; ++i)
+            {
+                result.push_back((live[i >> 6] & (1ull << (i & 0x3F))) != 0);
+            }
+            return result;
+        }
+
+
+        TEST(SummaryFilter, Rank0)
+        {
+            // Summary bit 0 and bits 63 through 66 are set in both rows. Bit 1
+            // is only set in the first row.
+            std::vector<uint64_t> summaries = {
+                0x8000000000000003ull, 0x7ull,
+                0x8000000000000001ull, 0x7ull
+            };
+
+            // Each summary bit covers 8 rank 0 iterations.
+            auto live = GetLiveIterations(summaries, 0);
+            ASSERT_EQ(live.size(), 1024u);
+            for (size_t i = 0; i < live.size(); ++i)
+            {
+                const size_t bit = i / 8;
+                const bool expected = (bit == 0) || (bit >= 63 && bit <= 66);
+                EXPECT_EQ(live[i], expected) << "iteration " << i;
+            }
+        }
+
+
+        TEST(SummaryFilter, HighRank)
+        {
+            // At rank 4 each iteration covers 1024 documents, or 2 summary
+            // bits. Bits 3 and 127 are set in both rows. Bit 4 is only set in
+            // the second row, and bit 5 only in the first.
+            std::vector<uint64_t> summaries = {
+                0x0000000000000028ull, 0x8000000000000000ull,
+                0x0000000000000018ull, 0x8000000000000000ull
+            };
+
+            auto live = GetLiveIterations(summaries, 4);
+            ASSERT_EQ(live.size(), 64u);
+            for (size_t i = 0; i < live.size(); ++i)
+            {
+                const bool expected = (i == 1) || (i == 63);
+                EXPECT_EQ(live[i], expected) << "iteration " << i;
+            }
+        }
+
+
+        TEST(SummaryFilter, AllSet)
+        {
+            std::vector<uint64_t> summaries(2 * c_summaryQuadwords, ~0ull);
+
+            for (Rank rank = 0; rank <= 6; ++rank)
+            {
+                for (auto isLive : GetLiveIterations(summaries, rank))
+                {
+                    EXPECT_TRUE(isLive);
+                }
+            }
+        }
+    }
+}
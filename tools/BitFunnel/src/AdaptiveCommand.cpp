@@ -0,0 +1,67 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iostream>
+
+#include "AdaptiveCommand.h"
+#include "Environment.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // AdaptiveCommand
+    //
+    //*************************************************************************
+    AdaptiveCommand::AdaptiveCommand(Environment & environment,
+                                     Id id,
+                                     char const * /*parameters*/)
+        : TaskBase(environment, id, Type::Synchronous)
+    {
+    }
+
+
+    void AdaptiveCommand::Execute()
+    {
+        GetEnvironment().SetMatcherMode(MatcherMode::Adaptive);
+        std::cout
+            << "Choosing between the byte code interpreter and the native x64"
+            << std::endl
+            << "compiler based on the estimated cost of each query."
+            << std::endl
+            << std::endl;
+    }
+
+
+    ICommand::Documentation AdaptiveCommand::GetDocumentation()
+    {
+        return Documentation(
+            "adaptive",
+            "Choose interpreter or compiler per query.",
+            "adaptive\n"
+            "  Run cheap queries in the byte code interpreter. Expensive\n"
+            "  queries start in the interpreter and switch to native x64\n"
+            "  code once it has been compiled on a background thread."
+        );
+    }
+}
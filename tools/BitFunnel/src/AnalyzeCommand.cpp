@@ -50,7 +50,8 @@ namespace BitFunnel
             << "output directory";
 
         Factories::AnalyzeRowTables(GetEnvironment().GetSimpleIndex(),
-                                    GetEnvironment().GetOutputDir().c_str());
+                                    GetEnvironment().GetOutputDir().c_str(),
+                                    GetEnvironment().GetThreadCount());
     }
 
 
@@ -61,6 +62,7 @@ namespace BitFunnel
             "Analyzes RowTables statistics (e.g. row and column densities).",
             "analyze\n"
             "  Analyzes RowTables statistics (e.g. row and column densities).\n"
+            "  Uses the thread count set by the -threads option.\n"
         );
     }
 
@@ -0,0 +1,530 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "BenchmarkTool.h"
+#include "BitFunnel/Chunks/DocumentFilters.h"
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Chunks/IChunkIngestionPipeline.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Plan/QueryRunner.h"
+#include "BitFunnel/Utilities/ReadLines.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "BitFunnelTool.h"
+#include "CmdLineParser/CmdLineParser.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // ZipfGenerator
+    //
+    // Draws term ranks in [0, vocabularySize) where the probability of rank r
+    // is proportional to 1 / (r + 1)^exponent. Uses std::mt19937_64 directly,
+    // rather than the standard distributions, whose output is implementation
+    // defined, so that a seed yields the same sequence on every platform.
+    //
+    //*************************************************************************
+    class ZipfGenerator
+    {
+    public:
+        ZipfGenerator(size_t vocabularySize, double exponent, unsigned seed)
+          : m_random(seed)
+        {
+            m_cumulative.reserve(vocabularySize);
+            double total = 0;
+            for (size_t rank = 0; rank < vocabularySize; ++rank)
+            {
+                total += 1.0 / std::pow(static_cast<double>(rank + 1), exponent);
+                m_cumulative.push_back(total);
+            }
+        }
+
+        size_t NextRank()
+        {
+            const double target = NextUnit() * m_cumulative.back();
+            auto it = std::upper_bound(m_cumulative.begin(),
+                                       m_cumulative.end(),
+                                       target);
+            return std::min(static_cast<size_t>(it - m_cumulative.begin()),
+                            m_cumulative.size() - 1);
+        }
+
+        // Returns a value uniformly distributed in [0, limit).
+        size_t NextUniform(size_t limit)
+        {
+            return static_cast<size_t>(m_random() % limit);
+        }
+
+    private:
+        // Returns a value uniformly distributed in [0, 1), using the top 53
+        // bits of the generator to fill a double's mantissa.
+        double NextUnit()
+        {
+            return (m_random() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        std::mt19937_64 m_random;
+        std::vector<double> m_cumulative;
+    };
+
+
+    static std::string TermText(size_t rank)
+    {
+        return "t" + std::to_string(rank);
+    }
+
+
+    //*************************************************************************
+    //
+    // BenchmarkTool
+    //
+    //*************************************************************************
+    BenchmarkTool::BenchmarkTool(IFileSystem& fileSystem)
+      : m_fileSystem(fileSystem)
+    {
+    }
+
+
+    int BenchmarkTool::Main(std::istream& /*input*/,
+                            std::ostream& output,
+                            int argc,
+                            char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "BenchmarkTool",
+            "Generate a synthetic Zipfian corpus, configure and ingest it, "
+            "then measure query throughput and latency.");
+
+        CmdLine::RequiredParameter<char const *> directory(
+            "directory",
+            "Existing directory where the corpus, configuration, query log, "
+            "and BenchmarkResults.csv will be written.");
+
+        // TODO: These parameters should be unsigned, but it doesn't seem to
+        // work with CmdLineParser.
+        CmdLine::OptionalParameter<int> documents(
+            "documents",
+            "Number of documents in the corpus.",
+            10000,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> chunks(
+            "chunks",
+            "Number of chunk files the corpus is divided into.",
+            8,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> vocabulary(
+            "vocabulary",
+            "Number of distinct terms the corpus draws from.",
+            50000,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> terms(
+            "terms",
+            "Mean number of postings per document.",
+            100,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<double> exponent(
+            "exponent",
+            "Exponent of the Zipf distribution.",
+            1.0,
+            CmdLine::GreaterThan(0.0));
+
+        CmdLine::OptionalParameter<double> density(
+            "density",
+            "Target upper bound for bit density.",
+            0.15,
+            CmdLine::Range(CmdLine::GreaterThan(0.0),
+                           CmdLine::LessThanOrEqual(1.0)));
+
+        CmdLine::OptionalParameter<char const *> treatment(
+            "treatment",
+            "Name of the term treatment to use.",
+            "PrivateSharedRank0And3");
+
+        CmdLine::OptionalParameter<int> queries(
+            "queries",
+            "Number of queries in the generated query log.",
+            1000,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> threads(
+            "threads",
+            "Maximum thread count. Queries run with 1, 2, 4, ... threads up "
+            "to this count. Ingestion uses this count.",
+            4,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> iterations(
+            "iterations",
+            "Number of passes over the query log at each thread count.",
+            1,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> seed(
+            "seed",
+            "random number generator seed.",
+            12345);
+
+        CmdLine::OptionalParameterList compiler(
+            "compiler",
+            "Match with the NativeJIT compiler instead of the interpreter.");
+
+        parser.AddParameter(directory);
+        parser.AddParameter(documents);
+        parser.AddParameter(chunks);
+        parser.AddParameter(vocabulary);
+        parser.AddParameter(terms);
+        parser.AddParameter(exponent);
+        parser.AddParameter(density);
+        parser.AddParameter(treatment);
+        parser.AddParameter(queries);
+        parser.AddParameter(threads);
+        parser.AddParameter(iterations);
+        parser.AddParameter(seed);
+        parser.AddParameter(compiler);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                Parameters parameters;
+                parameters.m_directory = directory;
+                parameters.m_documentCount = static_cast<size_t>(documents);
+                parameters.m_chunkCount = static_cast<size_t>(chunks);
+                parameters.m_vocabularySize = static_cast<size_t>(vocabulary);
+                parameters.m_meanTermCount = static_cast<size_t>(terms);
+                parameters.m_exponent = exponent;
+                parameters.m_density = density;
+                parameters.m_treatment = treatment;
+                parameters.m_queryCount = static_cast<size_t>(queries);
+                parameters.m_maxThreadCount = static_cast<size_t>(threads);
+                parameters.m_iterations = static_cast<size_t>(iterations);
+                parameters.m_seed = static_cast<unsigned>(seed);
+                parameters.m_useCompiler = compiler.IsActivated();
+
+                Run(output, parameters);
+
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+
+
+    void BenchmarkTool::Run(std::ostream& output,
+                            Parameters const & parameters) const
+    {
+        char const * directory = parameters.m_directory.c_str();
+        auto fileManager = Factories::CreateFileManager(directory,
+                                                        directory,
+                                                        directory,
+                                                        m_fileSystem);
+
+        ZipfGenerator generator(parameters.m_vocabularySize,
+                                parameters.m_exponent,
+                                parameters.m_seed);
+
+        output << "Generating corpus." << std::endl;
+        GenerateCorpus(parameters, *fileManager, generator);
+
+        output << "Configuring index." << std::endl;
+        Configure(output, parameters, *fileManager);
+
+        output << "Generating query log." << std::endl;
+        auto queries = GenerateQueries(parameters, *fileManager, generator);
+
+        auto index = Factories::CreateSimpleIndex(m_fileSystem);
+        index->ConfigureForServing(directory, 1, false);
+        index->StartIndex();
+
+        output << "Ingesting corpus." << std::endl;
+        std::vector<std::string> filePaths =
+            ReadLines(m_fileSystem, fileManager->Manifest().GetName().c_str());
+
+        NopFilter filter;
+        auto pipeline =
+            Factories::CreateChunkIngestionPipeline(m_fileSystem,
+                                                    filePaths,
+                                                    index->GetConfiguration(),
+                                                    index->GetIngestor(),
+                                                    filter,
+                                                    false,
+                                                    parameters.m_maxThreadCount);
+
+        Stopwatch stopwatch;
+        pipeline->Ingest();
+        const double ingestTime = stopwatch.ElapsedTime();
+
+        IIngestor const & ingestor = index->GetIngestor();
+        const size_t documentCount = ingestor.GetDocumentCount();
+        const size_t indexBytes = ingestor.GetUsedCapacityInBytes();
+
+        auto results = fileManager->BenchmarkResults().OpenForWrite();
+        *results << std::setprecision(12) << "metric,threads,value" << std::endl;
+
+        auto record = [&](char const * metric, size_t threads, double value)
+        {
+            *results << metric << "," << threads << "," << value << std::endl;
+            output << "  " << std::left << std::setw(28) << metric
+                   << std::right << std::setw(4) << threads
+                   << "  " << value << std::endl;
+        };
+
+        record("ingest_documents",
+               parameters.m_maxThreadCount,
+               static_cast<double>(documentCount));
+        record("ingest_seconds", parameters.m_maxThreadCount, ingestTime);
+        record("ingest_documents_per_second",
+               parameters.m_maxThreadCount,
+               documentCount / ingestTime);
+        record("index_bytes",
+               parameters.m_maxThreadCount,
+               static_cast<double>(indexBytes));
+
+        const MatcherMode matcherMode = parameters.m_useCompiler ?
+            MatcherMode::Compiler : MatcherMode::Interpreter;
+
+        std::vector<size_t> threadCounts;
+        for (size_t threads = 1;
+             threads < parameters.m_maxThreadCount;
+             threads *= 2)
+        {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(parameters.m_maxThreadCount);
+
+        for (auto threads : threadCounts)
+        {
+            output << "Running queries with "
+                   << threads
+                   << " thread(s)." << std::endl;
+
+            auto statistics = QueryRunner::Run(*index,
+                                               directory,
+                                               threads,
+                                               queries,
+                                               parameters.m_iterations,
+                                               matcherMode,
+                                               false,
+                                               false,
+                                               nullptr,
+                                               0);
+
+            record("queries_per_second",
+                   threads,
+                   statistics.GetQueriesPerSecond());
+            record("latency_p50_us",
+                   threads,
+                   statistics.GetLatencyPercentile(50) * 1e6);
+            record("latency_p90_us",
+                   threads,
+                   statistics.GetLatencyPercentile(90) * 1e6);
+            record("latency_p99_us",
+                   threads,
+                   statistics.GetLatencyPercentile(99) * 1e6);
+            record("latency_p999_us",
+                   threads,
+                   statistics.GetLatencyPercentile(99.9) * 1e6);
+        }
+
+        output << "Results written to "
+               << fileManager->BenchmarkResults().GetName()
+               << "." << std::endl;
+
+        // ~SimpleIndex() stops the index.
+    }
+
+
+    void BenchmarkTool::GenerateCorpus(Parameters const & parameters,
+                                       IFileManager & fileManager,
+                                       ZipfGenerator & generator) const
+    {
+        auto manifest = fileManager.Manifest().OpenForWrite();
+
+        std::vector<size_t> ranks;
+        size_t docId = 0;
+        for (size_t chunk = 0; chunk < parameters.m_chunkCount; ++chunk)
+        {
+            *manifest << fileManager.Chunk(chunk).GetName() << std::endl;
+
+            auto out = fileManager.Chunk(chunk).OpenForWrite();
+            const size_t end =
+                (chunk + 1) * parameters.m_documentCount / parameters.m_chunkCount;
+            for (; docId < end; ++docId)
+            {
+                // Document lengths are uniform over
+                // [mean / 2, mean + mean / 2].
+                const size_t mean = parameters.m_meanTermCount;
+                const size_t length =
+                    mean / 2 + generator.NextUniform(mean + 1);
+
+                ranks.clear();
+                for (size_t i = 0; i < length; ++i)
+                {
+                    ranks.push_back(generator.NextRank());
+                }
+                std::sort(ranks.begin(), ranks.end());
+                ranks.erase(std::unique(ranks.begin(), ranks.end()),
+                            ranks.end());
+
+                // Chunk format: a hexadecimal DocId, then a single stream
+                // "00" holding the terms. Streams, documents, and the chunk
+                // itself each end with an empty string.
+                *out << std::hex << std::setfill('0') << std::setw(16)
+                     << docId + 1 << std::dec << '\0'
+                     << "00" << '\0';
+                for (auto rank : ranks)
+                {
+                    *out << TermText(rank) << '\0';
+                }
+                *out << '\0' << '\0';
+            }
+            *out << '\0';
+        }
+    }
+
+
+    std::vector<std::string>
+        BenchmarkTool::GenerateQueries(Parameters const & parameters,
+                                       IFileManager & fileManager,
+                                       ZipfGenerator & generator) const
+    {
+        // Query lengths are uniform over [1, c_maxTermCount].
+        const size_t c_maxTermCount = 3;
+
+        std::vector<std::string> queries;
+        queries.reserve(parameters.m_queryCount);
+
+        std::vector<size_t> ranks;
+        for (size_t i = 0; i < parameters.m_queryCount; ++i)
+        {
+            const size_t termCount = 1 + generator.NextUniform(c_maxTermCount);
+
+            ranks.clear();
+            while (ranks.size() < termCount &&
+                   ranks.size() < parameters.m_vocabularySize)
+            {
+                const size_t rank = generator.NextRank();
+                if (std::find(ranks.begin(), ranks.end(), rank) == ranks.end())
+                {
+                    ranks.push_back(rank);
+                }
+            }
+
+            std::stringstream query;
+            for (size_t j = 0; j < ranks.size(); ++j)
+            {
+                if (j > 0)
+                {
+                    query << " ";
+                }
+                query << TermText(ranks[j]);
+            }
+            queries.push_back(query.str());
+        }
+
+        auto log = fileManager.QueryLog().OpenForWrite();
+        for (auto const & query : queries)
+        {
+            *log << query << std::endl;
+        }
+
+        return queries;
+    }
+
+
+    void BenchmarkTool::Configure(std::ostream& output,
+                                  Parameters const & parameters,
+                                  IFileManager & fileManager) const
+    {
+        BitFunnelTool tool(m_fileSystem);
+
+        const std::string manifest = fileManager.Manifest().GetName();
+        std::vector<char const *> statisticsArgs = {
+            "BitFunnel",
+            "statistics",
+            manifest.c_str(),
+            parameters.m_directory.c_str()
+        };
+
+        std::stringstream log;
+        if (tool.Main(std::cin,
+                      log,
+                      static_cast<int>(statisticsArgs.size()),
+                      statisticsArgs.data()) != 0)
+        {
+            output << log.str();
+            RecoverableError error("BenchmarkTool: statistics failed.");
+            throw error;
+        }
+
+        std::stringstream density;
+        density << parameters.m_density;
+        const std::string densityText = density.str();
+
+        std::vector<char const *> termTableArgs = {
+            "BitFunnel",
+            "termtable",
+            parameters.m_directory.c_str(),
+            densityText.c_str(),
+            parameters.m_treatment.c_str()
+        };
+
+        if (tool.Main(std::cin,
+                      log,
+                      static_cast<int>(termTableArgs.size()),
+                      termTableArgs.data()) != 0)
+        {
+            output << log.str();
+            RecoverableError error("BenchmarkTool: termtable failed.");
+            throw error;
+        }
+    }
+}
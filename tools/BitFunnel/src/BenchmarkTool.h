@@ -0,0 +1,106 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream parameter.
+#include <stddef.h>                     // size_t parameter.
+#include <string>                       // std::string parameter.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/IExecutable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IFileManager;
+    class IFileSystem;
+    class ZipfGenerator;
+
+    //*************************************************************************
+    //
+    // BenchmarkTool
+    //
+    // End-to-end benchmark over a synthetic corpus. Generates text chunks
+    // whose terms follow a Zipfian distribution, configures an index from
+    // them with the statistics and termtable commands, ingests the corpus,
+    // and runs a generated query log at a series of thread counts. All
+    // random choices derive from a single seed, so a given set of parameters
+    // always produces the same corpus and queries.
+    //
+    // Results are written as CSV rows of (metric, threads, value) so that
+    // runs from different builds can be compared mechanically.
+    //
+    //*************************************************************************
+    class BenchmarkTool : public IExecutable
+    {
+    public:
+        BenchmarkTool(IFileSystem& fileSystem);
+
+        //
+        // IExecutable methods
+        //
+        virtual int Main(std::istream& input,
+                         std::ostream& output,
+                         int argc,
+                         char const *argv[]) override;
+
+    private:
+        struct Parameters
+        {
+            std::string m_directory;
+            size_t m_documentCount;
+            size_t m_chunkCount;
+            size_t m_vocabularySize;
+            size_t m_meanTermCount;
+            double m_exponent;
+            double m_density;
+            std::string m_treatment;
+            size_t m_queryCount;
+            size_t m_maxThreadCount;
+            size_t m_iterations;
+            unsigned m_seed;
+            bool m_useCompiler;
+        };
+
+        void Run(std::ostream& output, Parameters const & parameters) const;
+
+        // Writes the corpus chunks and their manifest.
+        void GenerateCorpus(Parameters const & parameters,
+                            IFileManager & fileManager,
+                            ZipfGenerator & generator) const;
+
+        // Writes and returns a query log of conjunctions whose terms are
+        // drawn from the same distribution as the corpus.
+        std::vector<std::string>
+            GenerateQueries(Parameters const & parameters,
+                            IFileManager & fileManager,
+                            ZipfGenerator & generator) const;
+
+        // Runs the statistics and termtable commands against the corpus.
+        void Configure(std::ostream& output,
+                       Parameters const & parameters,
+                       IFileManager & fileManager) const;
+
+        IFileSystem& m_fileSystem;
+    };
+}
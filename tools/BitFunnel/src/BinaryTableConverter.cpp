@@ -0,0 +1,210 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iostream>
+
+#include "BinaryTableConverter.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IDocumentFrequencyTable.h"
+#include "BitFunnel/Index/IIndexedIdfTable.h"
+#include "BitFunnel/Index/ITermToText.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "CmdLineParser/CmdLineParser.h"
+
+
+namespace BitFunnel
+{
+    BinaryTableConverter::BinaryTableConverter(IFileSystem& fileSystem)
+        : m_fileSystem(fileSystem)
+    {
+    }
+
+
+    int BinaryTableConverter::Main(std::istream& /*input*/,
+                                   std::ostream& output,
+                                   int argc,
+                                   char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "BinaryTableConverter",
+            "Rewrites the DocumentFrequencyTable, IndexedIdfTable, and "
+            "TermToText files in a configuration directory in binary form.");
+
+        CmdLine::RequiredParameter<char const *> path(
+            "path",
+            "Path to the configuration directory.");
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> shardCount(
+            "shards",
+            "Set the number of shards to convert.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameterList termToText(
+            "text",
+            "Also convert the mapping from Term::Hash to term text.");
+
+        parser.AddParameter(path);
+        parser.AddParameter(shardCount);
+        parser.AddParameter(termToText);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                Go(output,
+                   path,
+                   static_cast<size_t>(shardCount),
+                   termToText.IsActivated());
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+
+
+    void BinaryTableConverter::Go(std::ostream& output,
+                                  char const * path,
+                                  size_t shardCount,
+                                  bool convertTermToText) const
+    {
+        auto fileManager = Factories::CreateFileManager(path,
+                                                        path,
+                                                        path,
+                                                        m_fileSystem);
+
+        for (size_t shard = 0; shard < shardCount; ++shard)
+        {
+            ConvertDocumentFrequencyTable(output, *fileManager, shard);
+            ConvertIndexedIdfTable(output, *fileManager, shard);
+        }
+
+        if (convertTermToText)
+        {
+            ConvertTermToText(output, *fileManager);
+        }
+    }
+
+
+    void BinaryTableConverter::ConvertDocumentFrequencyTable(
+        std::ostream& output,
+        IFileManager& fileManager,
+        size_t shard) const
+    {
+        Stopwatch stopwatch;
+        auto table = Factories::CreateDocumentFrequencyTable(
+            *fileManager.DocFreqTable(shard).OpenForRead());
+        const double textTime = stopwatch.ElapsedTime();
+
+        table->WriteBinary(*fileManager.DocFreqTable(shard).OpenForWrite());
+
+        stopwatch.Reset();
+        table = Factories::CreateDocumentFrequencyTable(
+            *fileManager.DocFreqTable(shard).OpenForRead());
+        const double binaryTime = stopwatch.ElapsedTime();
+
+        ReportTimes(output,
+                    fileManager.DocFreqTable(shard).GetName(),
+                    textTime,
+                    binaryTime);
+    }
+
+
+    void BinaryTableConverter::ConvertIndexedIdfTable(
+        std::ostream& output,
+        IFileManager& fileManager,
+        size_t shard) const
+    {
+        // TODO: use proper value here. Matches SimpleIndex.
+        const Term::IdfX10 defaultIdf = 60;
+
+        Stopwatch stopwatch;
+        auto table = Factories::CreateIndexedIdfTable(
+            *fileManager.IndexedIdfTable(shard).OpenForRead(),
+            defaultIdf);
+        const double textTime = stopwatch.ElapsedTime();
+
+        table->Write(*fileManager.IndexedIdfTable(shard).OpenForWrite());
+
+        stopwatch.Reset();
+        table = Factories::CreateIndexedIdfTable(
+            *fileManager.IndexedIdfTable(shard).OpenForRead(),
+            defaultIdf);
+        const double binaryTime = stopwatch.ElapsedTime();
+
+        ReportTimes(output,
+                    fileManager.IndexedIdfTable(shard).GetName(),
+                    textTime,
+                    binaryTime);
+    }
+
+
+    void BinaryTableConverter::ConvertTermToText(
+        std::ostream& output,
+        IFileManager& fileManager) const
+    {
+        Stopwatch stopwatch;
+        auto table = Factories::CreateTermToText(
+            *fileManager.TermToText().OpenForRead());
+        const double textTime = stopwatch.ElapsedTime();
+
+        table->WriteBinary(*fileManager.TermToText().OpenForWrite());
+
+        stopwatch.Reset();
+        table = Factories::CreateTermToText(
+            *fileManager.TermToText().OpenForRead());
+        const double binaryTime = stopwatch.ElapsedTime();
+
+        ReportTimes(output,
+                    fileManager.TermToText().GetName(),
+                    textTime,
+                    binaryTime);
+    }
+
+
+    void BinaryTableConverter::ReportTimes(std::ostream& output,
+                                           std::string const & name,
+                                           double textTime,
+                                           double binaryTime)
+    {
+        output
+            << name << std::endl
+            << "  previous load time: " << textTime << "s" << std::endl
+            << "  binary load time: " << binaryTime << "s" << std::endl;
+    }
+}
@@ -0,0 +1,87 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <string>                       // std::string parameter.
+
+#include "BitFunnel/IExecutable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IFileManager;
+    class IFileSystem;
+
+    //*************************************************************************
+    //
+    // BinaryTableConverter
+    //
+    // Rewrites the DocumentFrequencyTable, IndexedIdfTable and TermToText
+    // files in a configuration directory in their binary formats. The
+    // readers detect the format on load, so the converted files keep their
+    // original names. Reports the load time of each table before and after
+    // conversion.
+    //
+    //*************************************************************************
+    class BinaryTableConverter : public IExecutable
+    {
+    public:
+        BinaryTableConverter(IFileSystem& fileSystem);
+
+        //
+        // IExecutable methods
+        //
+        virtual int Main(std::istream& input,
+                         std::ostream& output,
+                         int argc,
+                         char const *argv[]) override;
+
+    private:
+        void Go(std::ostream& output,
+                char const * path,
+                size_t shardCount,
+                bool convertTermToText) const;
+
+        void ConvertDocumentFrequencyTable(std::ostream& output,
+                                           IFileManager& fileManager,
+                                           size_t shard) const;
+
+        void ConvertIndexedIdfTable(std::ostream& output,
+                                    IFileManager& fileManager,
+                                    size_t shard) const;
+
+        void ConvertTermToText(std::ostream& output,
+                               IFileManager& fileManager) const;
+
+        static void ReportTimes(std::ostream& output,
+                                std::string const & name,
+                                double textTime,
+                                double binaryTime);
+
+        //
+        // Constructor parameters.
+        //
+
+        IFileSystem& m_fileSystem;
+    };
+}
@@ -24,16 +24,22 @@
 #include <iostream>
 #include <memory>
 
+#include "BenchmarkTool.h"
+#include "BinaryTableConverter.h"
 #include "BitFunnel/Configuration/Factories.h"
 #include "BitFunnel/Configuration/IFileSystem.h"
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnelTool.h"
 #include "FilterChunks.h"
+#include "HashChunks.h"
+#include "MatcherBenchmarkTool.h"
 #include "QueryLogBuilderTool.h"
 #include "REPL.h"
+#include "SamplingComparison.h"
 #include "ShardBuilder.h"
 #include "StatisticsBuilder.h"
 #include "TermTableBuilderTool.h"
+#include "TreatmentSearchTool.h"
 
 
 namespace BitFunnel
@@ -91,10 +97,26 @@ namespace BitFunnel
     {
         std::unique_ptr<IExecutable> executable;
 
-        if (strcmp(name, "filter") == 0)
+        if (strcmp(name, "benchmark") == 0)
+        {
+            executable.reset(new BenchmarkTool(m_fileSystem));
+        }
+        else if (strcmp(name, "binary") == 0)
+        {
+            executable.reset(new BinaryTableConverter(m_fileSystem));
+        }
+        else if (strcmp(name, "filter") == 0)
         {
             executable.reset(new FilterChunks(m_fileSystem));
         }
+        else if (strcmp(name, "hash") == 0)
+        {
+            executable.reset(new HashChunks(m_fileSystem));
+        }
+        else if (strcmp(name, "matchers") == 0)
+        {
+            executable.reset(new MatcherBenchmarkTool(m_fileSystem));
+        }
         else if (strcmp(name, "querylog") == 0)
         {
             executable.reset(new QueryLogBuilderTool(m_fileSystem));
@@ -103,6 +125,10 @@ namespace BitFunnel
         {
             executable.reset(new REPL(m_fileSystem));
         }
+        else if (strcmp(name, "sampling") == 0)
+        {
+            executable.reset(new SamplingComparison(m_fileSystem));
+        }
         else if (strcmp(name, "shard") == 0)
         {
             executable.reset(new ShardBuilder(m_fileSystem));
@@ -115,6 +141,10 @@ namespace BitFunnel
         {
             executable.reset(new TermTableBuilderTool(m_fileSystem));
         }
+        else if (strcmp(name, "treatments") == 0)
+        {
+            executable.reset(new TreatmentSearchTool(m_fileSystem));
+        }
 
         return executable;
     }
@@ -148,11 +178,17 @@ namespace BitFunnel
             << "usage: BitFunnel <command> [<args>]" << std::endl
             << std::endl
             << "The most commonly used commands are" << std::endl
+            << "   benchmark      Measure ingestion and query performance on a synthetic corpus." << std::endl
+            << "   binary         Convert configuration tables to binary form." << std::endl
             << "   filter         Copy the corpus, filtering documents by predicate." << std::endl
+            << "   hash           Convert the corpus to chunks of pre-hashed terms." << std::endl
+            << "   matchers       Time the query matchers on synthetic slices." << std::endl
             << "   querylog       Generate a random query log." << std::endl
+            << "   sampling       Compare configurations built from a sample and from the full corpus." << std::endl
             << "   shard          Compute shard definition based on histogram." << std::endl
             << "   statistics     Generate corpus statistics used to configure the index." << std::endl
             << "   termtable      Construct a term table based on generated corpus statistics." << std::endl
+            << "   treatments     Search for the term treatment with the lowest query cost." << std::endl
             << "   repl           Run interative read-eval-print console." << std::endl
             << std::endl
             << "See 'bitfunnel <command> -help' to read about a specific command." << std::endl
@@ -43,7 +43,7 @@ namespace BitFunnel
 
     void CompilerCommand::Execute()
     {
-        GetEnvironment().SetCompilerMode(true);
+        GetEnvironment().SetMatcherMode(MatcherMode::Compiler);
         std::cout
             << "Using the native x64 compiler."
             << std::endl
@@ -58,7 +58,8 @@ namespace BitFunnel
 
         Factories::CreateCorrelate(GetEnvironment().GetSimpleIndex(),
                                    GetEnvironment().GetOutputDir().c_str(),
-                                   m_terms);
+                                   m_terms,
+                                   GetEnvironment().GetThreadCount());
     }
 
 
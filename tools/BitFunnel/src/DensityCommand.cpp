@@ -0,0 +1,147 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iostream>
+#include <string>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IRowDensityMonitor.h"
+#include "DensityCommand.h"
+#include "Environment.h"
+
+
+namespace BitFunnel
+{
+    // Number of overfull rows retained by each sample.
+    static const size_t c_maxOverfullRows = 20;
+
+
+    //*************************************************************************
+    //
+    // DensityCommand
+    //
+    //*************************************************************************
+    DensityCommand::DensityCommand(Environment & environment,
+                                   Id id,
+                                   char const * parameters)
+        : TaskBase(environment, id, Type::Synchronous),
+          m_action(Action::Print),
+          m_interval(0),
+          m_sliceCount(0),
+          m_alertDensity(0)
+    {
+        auto command = TaskFactory::GetNextToken(parameters);
+        if (command.empty())
+        {
+            m_action = Action::Print;
+        }
+        else if (command.compare("sample") == 0)
+        {
+            m_action = Action::Sample;
+        }
+        else if (command.compare("stop") == 0)
+        {
+            m_action = Action::Stop;
+        }
+        else if (command.compare("start") == 0)
+        {
+            m_action = Action::Start;
+
+            auto interval = TaskFactory::GetNextToken(parameters);
+            if (interval.empty())
+            {
+                RecoverableError error("density start expects an interval in milliseconds.");
+                throw error;
+            }
+            m_interval = stoull(interval);
+
+            auto slices = TaskFactory::GetNextToken(parameters);
+            if (!slices.empty())
+            {
+                m_sliceCount = stoull(slices);
+                if (m_sliceCount == 0)
+                {
+                    RecoverableError error("density start expects at least one slice.");
+                    throw error;
+                }
+
+                auto alert = TaskFactory::GetNextToken(parameters);
+                if (alert.empty())
+                {
+                    RecoverableError error("density start expects an alert density after the slice count.");
+                    throw error;
+                }
+                m_alertDensity = stod(alert);
+            }
+        }
+        else
+        {
+            RecoverableError error("density expects sample, start, or stop.");
+            throw error;
+        }
+    }
+
+
+    void DensityCommand::Execute()
+    {
+        IRowDensityMonitor & monitor =
+            GetEnvironment().GetIngestor().GetRowDensityMonitor();
+
+        switch (m_action)
+        {
+        case Action::Sample:
+            monitor.Sample();
+            break;
+        case Action::Start:
+            if (m_sliceCount > 0)
+            {
+                monitor.Configure(m_sliceCount, m_alertDensity, c_maxOverfullRows);
+            }
+            monitor.Start(m_interval);
+            break;
+        case Action::Stop:
+            monitor.Stop();
+            break;
+        case Action::Print:
+            break;
+        }
+
+        monitor.Print(std::cout);
+        std::cout << std::endl;
+    }
+
+
+    ICommand::Documentation DensityCommand::GetDocumentation()
+    {
+        return Documentation(
+            "density",
+            "Monitors the densities of shared rows in recent slices.",
+            "density [sample | start <milliseconds> [<slices> <alert>] | stop]\n"
+            "  With no argument, prints the most recent sample. 'sample'\n"
+            "  takes a sample now. 'start' samples every <milliseconds>\n"
+            "  on a background thread, optionally over the <slices> most\n"
+            "  recent slices of each shard, reporting shared rows denser\n"
+            "  than <alert>. 'stop' stops the background thread."
+        );
+    }
+}
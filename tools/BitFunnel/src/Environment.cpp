@@ -19,21 +19,34 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
+#include <iostream>
 
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
 #include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/Helpers.h"
+#include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Plan/Factories.h"
+#include "BitFunnel/Plan/PrefetchCalibration.h"
+#include "AdaptiveCommand.h"
 #include "AnalyzeCommand.h"
 #include "CacheLineCountCommand.h"
 #include "CdCommand.h"
 #include "CompilerCommand.h"
 #include "CorrelateCommand.h"
+#include "DensityCommand.h"
 #include "Environment.h"
 #include "ExitCommand.h"
 #include "FailOnExceptionCommand.h"
+#include "HardwareCountersCommand.h"
 #include "HelpCommand.h"
 #include "IngestCommands.h"
 #include "InterpreterCommand.h"
+#include "PrefetchCommand.h"
 #include "QueryCommand.h"
+#include "RebalanceCommand.h"
 #include "ScriptCommand.h"
 #include "ShowCommand.h"
 #include "StatusCommand.h"
@@ -46,6 +59,11 @@
 
 namespace BitFunnel
 {
+    // Bytes of executable memory reserved for matchers shared across
+    // queries and sessions.
+    static const size_t c_matcherCodeCacheBytes = 1ull << 24;
+
+
     Environment::Environment(IFileSystem& fileSystem,
                              char const * directory,
                              size_t gramSize,
@@ -57,8 +75,11 @@ namespace BitFunnel
         // Start one extra thread for the Recycler.
         m_taskPool(new TaskPool(threadCount + 1)),
         m_index(Factories::CreateSimpleIndex(fileSystem)),
+        m_matcherCodeCache(Factories::CreateMatcherCodeCache(c_matcherCodeCacheBytes)),
         m_cacheLineCountMode(false),
-        m_compilerMode(true),
+        m_hardwareCounterMode(false),
+        m_matcherMode(MatcherMode::Compiler),
+        m_prefetchDistance(0),
         m_failOnException(false),
         m_threadCount(threadCount)
     {
@@ -69,18 +90,23 @@ namespace BitFunnel
 
     void Environment::RegisterCommands()
     {
+        m_taskFactory->RegisterCommand<AdaptiveCommand>();
         m_taskFactory->RegisterCommand<Analyze>();
         m_taskFactory->RegisterCommand<Cache>();
         m_taskFactory->RegisterCommand<CacheLineCountCommand>();
+        m_taskFactory->RegisterCommand<HardwareCountersCommand>();
         m_taskFactory->RegisterCommand<Cd>();
         m_taskFactory->RegisterCommand<CompilerCommand>();
         m_taskFactory->RegisterCommand<Correlate>();
+        m_taskFactory->RegisterCommand<DensityCommand>();
         m_taskFactory->RegisterCommand<Exit>();
         m_taskFactory->RegisterCommand<FailOnException>();
         m_taskFactory->RegisterCommand<Help>();
         m_taskFactory->RegisterCommand<InterpreterCommand>();
         m_taskFactory->RegisterCommand<Load>();
+        m_taskFactory->RegisterCommand<PrefetchCommand>();
         m_taskFactory->RegisterCommand<Query>();
+        m_taskFactory->RegisterCommand<RebalanceCommand>();
         m_taskFactory->RegisterCommand<Script>();
         m_taskFactory->RegisterCommand<Show>();
         m_taskFactory->RegisterCommand<Status>();
@@ -92,6 +118,94 @@ namespace BitFunnel
     void Environment::StartIndex()
     {
         m_index->StartIndex();
+        LoadMatcherCodeCache();
+
+        m_prefetchDistance = CalibratePrefetchDistance();
+        std::cout
+            << "Matcher prefetch distance: "
+            << m_prefetchDistance
+            << std::endl;
+    }
+
+
+    void Environment::LoadMatcherCodeCache()
+    {
+        std::unique_ptr<std::istream> input;
+        try
+        {
+            input = m_index->GetFileManager().MatcherCodeCache().OpenForRead();
+        }
+        catch (RecoverableError)
+        {
+            // No matchers were saved by a previous session.
+            return;
+        }
+
+        if (input->peek() == std::char_traits<char>::eof())
+        {
+            return;
+        }
+
+        bool loaded = false;
+        try
+        {
+            loaded = m_matcherCodeCache->Read(*input, GetTermTableVersion());
+        }
+        catch (RecoverableError e)
+        {
+            // Read() leaves the cache unchanged on error, so a damaged file
+            // just means starting with no compiled matchers. The file is
+            // overwritten by SaveMatcherCodeCache().
+            std::cout
+                << "Discarding unreadable compiled matchers: "
+                << e.what()
+                << std::endl;
+            return;
+        }
+        catch (FatalError e)
+        {
+            // Thrown by the FileHeader asserts on a malformed header.
+            std::cout
+                << "Discarding unreadable compiled matchers: "
+                << e.what()
+                << std::endl;
+            return;
+        }
+
+        if (loaded)
+        {
+            std::cout
+                << "Loaded "
+                << m_matcherCodeCache->GetEntryCount()
+                << " compiled matchers."
+                << std::endl;
+        }
+        else
+        {
+            std::cout
+                << "Ignoring compiled matchers generated for a different term table"
+                << " or code generator."
+                << std::endl;
+        }
+    }
+
+
+    void Environment::SaveMatcherCodeCache()
+    {
+        auto output = m_index->GetFileManager().MatcherCodeCache().OpenForWrite();
+        m_matcherCodeCache->Write(*output, GetTermTableVersion());
+    }
+
+
+    uint64_t Environment::GetTermTableVersion() const
+    {
+        uint64_t version = 0;
+        for (ShardId shard = 0; shard < m_index->GetIngestor().GetShardCount(); ++shard)
+        {
+            version = (version << 1 | version >> 63) ^
+                BitFunnel::GetTermTableVersion(m_index->GetTermTable(shard));
+        }
+        return version;
     }
 
 
@@ -101,6 +215,12 @@ namespace BitFunnel
     }
 
 
+    IMatcherCodeCache & Environment::GetMatcherCodeCache() const
+    {
+        return *m_matcherCodeCache;
+    }
+
+
     bool Environment::GetCacheLineCountMode() const
     {
         return m_cacheLineCountMode;
@@ -113,6 +233,18 @@ namespace BitFunnel
     }
 
 
+    bool Environment::GetHardwareCounterMode() const
+    {
+        return m_hardwareCounterMode;
+    }
+
+
+    void Environment::SetHardwareCounterMode(bool mode)
+    {
+        m_hardwareCounterMode = mode;
+    }
+
+
     bool Environment::GetFailOnException() const
     {
         return m_failOnException;
@@ -125,15 +257,27 @@ namespace BitFunnel
     }
 
 
-    bool Environment::GetCompilerMode() const
+    MatcherMode Environment::GetMatcherMode() const
     {
-        return m_compilerMode;
+        return m_matcherMode;
     }
 
 
-    void Environment::SetCompilerMode(bool mode)
+    void Environment::SetMatcherMode(MatcherMode mode)
     {
-        m_compilerMode = mode;
+        m_matcherMode = mode;
+    }
+
+
+    size_t Environment::GetPrefetchDistance() const
+    {
+        return m_prefetchDistance;
+    }
+
+
+    void Environment::SetPrefetchDistance(size_t distance)
+    {
+        m_prefetchDistance = distance;
     }
 
 
@@ -161,6 +305,12 @@ namespace BitFunnel
     }
 
 
+    QueryRunner::Latencies & Environment::GetQueryLatencies()
+    {
+        return m_queryLatencies;
+    }
+
+
     TaskFactory & Environment::GetTaskFactory() const
     {
         return *m_taskFactory;
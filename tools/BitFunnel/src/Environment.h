@@ -22,13 +22,16 @@
 
 #pragma once
 
-#include <memory>                           // std::unique_ptr embedded.
+#include <memory>                               // std::unique_ptr embedded.
 
-#include "BitFunnel/Index/ISimpleIndex.h"   // Parameterizes std::unique_ptr.
-#include "BitFunnel/NonCopyable.h"          // Base class.
-#include "BitFunnel/Term.h"                 // Term::GramSize embedded.
-#include "TaskFactory.h"                    // Parameterizes std::unique_ptr.
-#include "TaskPool.h"                       // Parameterizes std::unique_ptr.
+#include "BitFunnel/Index/ISimpleIndex.h"       // Parameterizes std::unique_ptr.
+#include "BitFunnel/NonCopyable.h"              // Base class.
+#include "BitFunnel/Plan/IMatcherCodeCache.h"   // Parameterizes std::unique_ptr.
+#include "BitFunnel/Plan/MatcherMode.h"         // MatcherMode embedded.
+#include "BitFunnel/Plan/QueryRunner.h"         // QueryRunner::Latencies embedded.
+#include "BitFunnel/Term.h"                     // Term::GramSize embedded.
+#include "TaskFactory.h"                        // Parameterizes std::unique_ptr.
+#include "TaskPool.h"                           // Parameterizes std::unique_ptr.
 
 
 namespace BitFunnel
@@ -47,13 +50,33 @@ namespace BitFunnel
 
         void StartIndex();
 
+        // Loads the MatcherCodeCache file written by a previous session, if
+        // it exists and was generated for the current term tables.
+        void LoadMatcherCodeCache();
+
+        // Writes the contents of the matcher code cache to the
+        // MatcherCodeCache file.
+        void SaveMatcherCodeCache();
+
         IFileSystem & GetFileSystem() const;
 
+        IMatcherCodeCache & GetMatcherCodeCache() const;
+
         bool GetCacheLineCountMode() const;
         void SetCacheLineCountMode(bool mode);
 
-        bool GetCompilerMode() const;
-        void SetCompilerMode(bool mode);
+        // When true, queries record PerformanceCounters for their planning
+        // and matching phases.
+        bool GetHardwareCounterMode() const;
+        void SetHardwareCounterMode(bool mode);
+
+        MatcherMode GetMatcherMode() const;
+        void SetMatcherMode(MatcherMode mode);
+
+        // Number of iterations ahead that matchers prefetch row data. Zero
+        // disables prefetching. StartIndex() calibrates the initial value.
+        size_t GetPrefetchDistance() const;
+        void SetPrefetchDistance(size_t distance);
 
         bool GetFailOnException() const;
         void SetFailOnException(bool mode);
@@ -64,6 +87,10 @@ namespace BitFunnel
         size_t GetThreadCount() const;
         void SetThreadCount(size_t threadCount);
 
+        // Latencies of every query processed by the query command in this
+        // session.
+        QueryRunner::Latencies & GetQueryLatencies();
+
         TaskFactory & GetTaskFactory() const;
         TaskPool & GetTaskPool() const;
         IConfiguration const & GetConfiguration() const;
@@ -74,16 +101,23 @@ namespace BitFunnel
     private:
         void RegisterCommands();
 
+        // Combines the versions of the term tables for every shard.
+        uint64_t GetTermTableVersion() const;
+
         IFileSystem& m_fileSystem;
 
         std::unique_ptr<TaskFactory> m_taskFactory;
         std::unique_ptr<TaskPool> m_taskPool;
         std::unique_ptr<ISimpleIndex> m_index;
+        std::unique_ptr<IMatcherCodeCache> m_matcherCodeCache;
 
         bool m_cacheLineCountMode;
-        bool m_compilerMode;
+        bool m_hardwareCounterMode;
+        MatcherMode m_matcherMode;
+        size_t m_prefetchDistance;
         bool m_failOnException;
         size_t m_threadCount;
         std::string m_outputDir;
+        QueryRunner::Latencies m_queryLatencies;
     };
 }
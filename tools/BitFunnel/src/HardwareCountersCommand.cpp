@@ -0,0 +1,94 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include <iostream>
+
+#include "BitFunnel/Utilities/PerformanceCounters.h"
+#include "Environment.h"
+#include "HardwareCountersCommand.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // HardwareCountersCommand
+    //
+    //*************************************************************************
+    HardwareCountersCommand::HardwareCountersCommand(Environment & environment,
+                                                     Id id,
+                                                     char const * /*parameters*/)
+        : TaskBase(environment, id, Type::Synchronous)
+    {
+    }
+
+
+    void HardwareCountersCommand::Execute()
+    {
+        auto & env = GetEnvironment();
+        env.SetHardwareCounterMode(!env.GetHardwareCounterMode());
+
+        if (env.GetHardwareCounterMode())
+        {
+            std::cout
+                << "Counting hardware events during planning and matching.";
+
+            // Report the counters that this machine will leave blank.
+            PerformanceCounters counters;
+            for (unsigned i = 0; i < PerformanceCounters::CounterCount; ++i)
+            {
+                auto counter = static_cast<PerformanceCounters::Counter>(i);
+                if (!counters.IsAvailable(counter))
+                {
+                    std::cout
+                        << std::endl
+                        << "  "
+                        << PerformanceCounters::GetName(counter)
+                        << " not available.";
+                }
+            }
+        }
+        else
+        {
+            std::cout
+                << "Hardware event counting disabled.";
+        }
+        std::cout
+            << std::endl
+            << std::endl;
+    }
+
+
+    ICommand::Documentation HardwareCountersCommand::GetDocumentation()
+    {
+        return Documentation(
+            "counters",
+            "Toggles counting of hardware events.",
+            "counters\n"
+            "  Toggles counting of cycles, instructions, LLC misses, dTLB misses\n"
+            "  and branch misses during query planning and matching. The counts\n"
+            "  appear as extra columns in the query results. Requires Linux\n"
+            "  perf_event_open() access to hardware counters. Counts are scaled\n"
+            "  up when the kernel shares the counters with other users, and left\n"
+            "  blank when they could not be measured."
+        );
+    }
+}
@@ -0,0 +1,188 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Chunks/IChunkManifestIngestor.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Utilities/ReadLines.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "HashChunks.h"
+
+
+namespace BitFunnel
+{
+    HashChunks::HashChunks(IFileSystem& fileSystem)
+        : m_fileSystem(fileSystem)
+    {
+    }
+
+
+    int HashChunks::Main(std::istream& /*input*/,
+                         std::ostream& output,
+                         int argc,
+                         char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "HashChunks",
+            "Converts a set of chunk files specified by a manifest "
+            "to the hashed chunk format, which stores raw term hashes "
+            "instead of term text.");
+
+        CmdLine::RequiredParameter<char const *> manifestFileName(
+            "manifestFile",
+            "Path to a file containing the paths to the chunk files to be converted. "
+            "One chunk file per line. Paths are relative to working directory.");
+
+        CmdLine::RequiredParameter<char const *> outputPath(
+            "outDir",
+            "Path to the output directory where the hashed "
+            "chunk files will be written.");
+
+        CmdLine::OptionalParameter<char const *> expand(
+            "expand",
+            "Expand ngrams during conversion, using the IDF table in the "
+            "specified configuration directory. Hashed chunks must be "
+            "regenerated whenever that IDF table changes.",
+            nullptr);
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> gramSize(
+            "gramsize",
+            "Set the maximum ngram size for phrases when using -expand.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        parser.AddParameter(manifestFileName);
+        parser.AddParameter(outputPath);
+        parser.AddParameter(expand);
+        parser.AddParameter(gramSize);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                HashChunkList(output,
+                              outputPath,
+                              manifestFileName,
+                              expand,
+                              gramSize);
+
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+
+
+    void HashChunks::HashChunkList(
+        std::ostream& output,
+        char const * outputDirectory,
+        char const * chunkListFileName,
+        char const * configDirectory,
+        // TODO: gramSize should be unsigned once CmdLineParser supports unsigned.
+        int gramSize) const
+    {
+        const bool expandNGrams = (configDirectory != nullptr);
+
+        // Without ngram expansion the IConfiguration is only used to
+        // read the chunks, so statistics configuration suffices.
+        auto index = Factories::CreateSimpleIndex(m_fileSystem);
+        if (expandNGrams)
+        {
+            index->ConfigureForServing(configDirectory,
+                                       static_cast<size_t>(gramSize),
+                                       false);
+        }
+        else
+        {
+            index->ConfigureForStatistics(outputDirectory, 1, false);
+        }
+        index->StartIndex();
+
+        output
+            << "Loading chunk list file '" << chunkListFileName << "'" << std::endl
+            << "Output dir: '" << outputDirectory << "'" << std::endl;
+
+        std::vector<std::string> filePaths = ReadLines(m_fileSystem, chunkListFileName);
+
+        output << "Reading " << filePaths.size() << " files\n";
+
+        // Create special file manager for output.
+        auto fileManager = Factories::CreateFileManager(
+            outputDirectory,
+            outputDirectory,
+            outputDirectory,
+            m_fileSystem);
+
+        auto manifest = Factories::CreateChunkManifestHasher(
+            m_fileSystem,
+            *fileManager,
+            filePaths,
+            index->GetConfiguration(),
+            expandNGrams);
+
+        output << "Hashing chunks . . ." << std::endl;
+
+        Stopwatch stopwatch;
+
+        {
+            // Block scopes manifestFile.
+            auto manifestFile = fileManager->Manifest().OpenForWrite();
+
+            for (size_t i = 0; i < filePaths.size(); ++i)
+            {
+                manifest->IngestChunk(i);
+
+                *manifestFile
+                    << fileManager->Chunk(i).GetName()
+                    << std::endl;
+            }
+        }
+
+        output
+            << "Hashing complete." << std::endl
+            << "  Elapsed time = " << stopwatch.ElapsedTime() << std::endl;
+    }
+}
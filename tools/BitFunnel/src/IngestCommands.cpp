@@ -24,6 +24,7 @@
 
 #include "BitFunnel/Chunks/DocumentFilters.h"
 #include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Chunks/IChunkIngestionPipeline.h"
 #include "BitFunnel/Chunks/IChunkManifestIngestor.h"
 #include "BitFunnel/Chunks/IChunkProcessor.h"
 #include "BitFunnel/Data/Sonnets.h"
@@ -132,16 +133,17 @@ namespace BitFunnel
 
             NopFilter filter;
 
-            auto manifest = Factories::CreateChunkManifestIngestor(
+            auto pipeline = Factories::CreateChunkIngestionPipeline(
                 fileSystem,
-                nullptr,
                 filePaths,
                 configuration,
                 ingestor,
                 filter,
-                m_cacheDocuments);
+                m_cacheDocuments,
+                threadCount);
 
-            IngestChunks(*manifest, threadCount);
+            pipeline->Ingest();
+            pipeline->PrintStatistics(std::cout);
 
             // std::cout << "Ingestion complete." << std::endl;
         }
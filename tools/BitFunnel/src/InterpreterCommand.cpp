@@ -43,7 +43,7 @@ namespace BitFunnel
 
     void InterpreterCommand::Execute()
     {
-        GetEnvironment().SetCompilerMode(false);
+        GetEnvironment().SetMatcherMode(MatcherMode::Interpreter);
         std::cout
             << "Using the byte code interpreter."
             << std::endl
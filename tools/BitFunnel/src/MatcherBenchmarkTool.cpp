@@ -0,0 +1,280 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Plan/MatcherBenchmark.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "MatcherBenchmarkTool.h"
+
+
+namespace BitFunnel
+{
+    struct QueryShape
+    {
+        std::string m_name;
+        std::string m_plan;
+    };
+
+
+    // Rows 0 through 39 are rank 0, rows 40 and 41 are rank 3, rows 42 and
+    // 43 are rank 6 and row 44 is a rare rank 0 row. See CreateRows().
+    static const size_t c_rank0RowCount = 40;
+    static const size_t c_rank3Row = 40;
+    static const size_t c_rank6Row = 42;
+    static const size_t c_rareRow = 44;
+
+
+    static std::string Row(size_t id, Rank rank)
+    {
+        std::stringstream text;
+        text << "Row(" << id << ", " << rank << ", 0, false)";
+        return text.str();
+    }
+
+
+    // Returns a node of the given type ("And" or "Or") over rank 0 rows
+    // [first, first + count).
+    static std::string Rows(char const * type, size_t first, size_t count)
+    {
+        std::stringstream text;
+        text << type << " { Children: [";
+        for (size_t i = 0; i < count; ++i)
+        {
+            text << (i == 0 ? " " : ", ") << Row(first + i, 0);
+        }
+        text << " ] }";
+        return text.str();
+    }
+
+
+    // Returns an And of orCount Ors, each over rowsPerOr rank 0 rows. Every
+    // row of an Or is loaded whenever the Or is reached, so unlike a long
+    // And chain, all of the rows are loaded often.
+    static std::string AndOfOrs(size_t orCount, size_t rowsPerOr)
+    {
+        std::stringstream text;
+        text << "And { Children: [";
+        for (size_t i = 0; i < orCount; ++i)
+        {
+            text << (i == 0 ? " " : ", ")
+                 << Rows("Or", i * rowsPerOr, rowsPerOr);
+        }
+        text << " ] }";
+        return text.str();
+    }
+
+
+    static std::vector<QueryShape> CreateShapes()
+    {
+        std::vector<QueryShape> shapes;
+
+        shapes.push_back({ "and2", Rows("And", 0, 2) });
+        shapes.push_back({ "and4", Rows("And", 0, 4) });
+        shapes.push_back({ "and8", Rows("And", 0, 8) });
+        shapes.push_back({
+            "or4",
+            "And { Children: [ " + Row(0, 0) + ", " + Rows("Or", 1, 4) + " ] }" });
+        shapes.push_back({
+            "not",
+            "And { Children: [ " + Row(0, 0) + ", " + Row(1, 0) +
+            ", Not { Child: " + Row(2, 0) + " } ] }" });
+        shapes.push_back({
+            "mixed",
+            "And { Children: [ " +
+            Row(c_rank6Row, 6) + ", " + Row(c_rank6Row + 1, 6) + ", " +
+            Row(c_rank3Row, 3) + ", " + Row(c_rank3Row + 1, 3) + ", " +
+            Row(0, 0) + ", " + Row(1, 0) + " ] }" });
+
+        // Wide queries, with more rows than the matcher has registers.
+        shapes.push_back({ "and20", Rows("And", 0, 20) });
+        shapes.push_back({ "and40", Rows("And", 0, 40) });
+        shapes.push_back({ "or20", AndOfOrs(4, 5) });
+        shapes.push_back({ "or40", AndOfOrs(4, 10) });
+        shapes.push_back({
+            "mixed24",
+            "And { Children: [ " +
+            Row(c_rank6Row, 6) + ", " + Row(c_rank3Row, 3) + ", " +
+            AndOfOrs(2, 11) + " ] }" });
+
+        // A rare term ANDed with common ones, where summaries pay off.
+        shapes.push_back({
+            "rare",
+            "And { Children: [ " + Row(c_rareRow, 0) + ", " +
+            Row(0, 0) + ", " + Row(1, 0) + " ] }" });
+
+        return shapes;
+    }
+
+
+    // The term table aims for the same bit density in rows of every
+    // rank, so every fabricated row other than the rare one gets the same
+    // density.
+    static std::vector<MatcherBenchmark::RowDescriptor>
+        CreateRows(double density, double rareDensity)
+    {
+        std::vector<MatcherBenchmark::RowDescriptor> rows;
+        for (size_t i = 0; i < c_rank0RowCount; ++i)
+        {
+            rows.push_back({ 0, density });
+        }
+        rows.push_back({ 3, density });
+        rows.push_back({ 3, density });
+        rows.push_back({ 6, density });
+        rows.push_back({ 6, density });
+        rows.push_back({ 0, rareDensity });
+        return rows;
+    }
+
+
+    MatcherBenchmarkTool::MatcherBenchmarkTool(IFileSystem& /*fileSystem*/)
+    {
+    }
+
+
+    int MatcherBenchmarkTool::Main(std::istream& /*input*/,
+                                   std::ostream& output,
+                                   int argc,
+                                   char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "MatcherBenchmarkTool",
+            "Time the interpreter and native code matchers on fabricated "
+            "slices, without building an index.");
+
+        // TODO: These parameters should be unsigned, but it doesn't seem to
+        // work with CmdLineParser.
+        CmdLine::OptionalParameter<int> capacity(
+            "capacity",
+            "Documents per slice. Must be a multiple of 4096.",
+            16384,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> slices(
+            "slices",
+            "Number of slices.",
+            64,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<double> density(
+            "density",
+            "Bit density of every row.",
+            0.1,
+            CmdLine::Range(CmdLine::GreaterThanOrEqual(0.0),
+                           CmdLine::LessThanOrEqual(1.0)));
+
+        CmdLine::OptionalParameter<double> rareDensity(
+            "rare-density",
+            "Bit density of the rare row.",
+            0.0002,
+            CmdLine::Range(CmdLine::GreaterThanOrEqual(0.0),
+                           CmdLine::LessThanOrEqual(1.0)));
+
+        CmdLine::OptionalParameter<int> passes(
+            "passes",
+            "Passes over the slices per measurement. The fastest is reported.",
+            5,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> prefetch(
+            "prefetch",
+            "Prefetch distance in quadwords. Zero disables prefetching.",
+            0,
+            CmdLine::GreaterThanOrEqual(0));
+
+        CmdLine::OptionalParameter<int> seed(
+            "seed",
+            "random number generator seed.",
+            12345);
+
+        parser.AddParameter(capacity);
+        parser.AddParameter(slices);
+        parser.AddParameter(density);
+        parser.AddParameter(rareDensity);
+        parser.AddParameter(passes);
+        parser.AddParameter(prefetch);
+        parser.AddParameter(seed);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                MatcherBenchmark benchmark(CreateRows(density, rareDensity),
+                                           static_cast<size_t>(capacity),
+                                           static_cast<size_t>(slices),
+                                           static_cast<unsigned>(seed));
+
+                output
+                    << "shape,matcher,summaries,quadwords,matches,compile_us,"
+                    << "match_us,ns_per_quadword,ns_per_match"
+                    << std::endl;
+
+                for (auto const & shape : CreateShapes())
+                {
+                    for (auto mode : { MatcherMode::Interpreter,
+                                       MatcherMode::Compiler })
+                    {
+                        for (auto useSummaries : { false, true })
+                        {
+                            auto result =
+                                benchmark.Run(shape.m_plan.c_str(),
+                                              mode,
+                                              static_cast<size_t>(passes),
+                                              static_cast<size_t>(prefetch),
+                                              useSummaries);
+                            output
+                                << shape.m_name << ","
+                                << (mode == MatcherMode::Interpreter ?
+                                    "interpreter" : "compiler") << ","
+                                << (useSummaries ? "on" : "off") << ","
+                                << result.GetQuadwordCount() << ","
+                                << result.GetMatchCount() << ","
+                                << result.GetCompileTime() * 1e6 << ","
+                                << result.GetMatchTime() * 1e6 << ","
+                                << result.GetNanosecondsPerQuadword() << ","
+                                << result.GetNanosecondsPerMatch()
+                                << std::endl;
+                        }
+                    }
+                }
+
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+}
@@ -0,0 +1,82 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iostream>
+#include <string>
+
+#include "Environment.h"
+#include "PrefetchCommand.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // PrefetchCommand
+    //
+    //*************************************************************************
+    PrefetchCommand::PrefetchCommand(Environment & environment,
+                                     Id id,
+                                     char const * parameters)
+        : TaskBase(environment, id, Type::Synchronous)
+    {
+        auto token = TaskFactory::GetNextToken(parameters);
+        m_distance = stoull(token);
+    }
+
+
+    void PrefetchCommand::Execute()
+    {
+        GetEnvironment().SetPrefetchDistance(m_distance);
+        if (m_distance == 0)
+        {
+            std::cout
+                << "Matcher prefetching disabled."
+                << std::endl
+                << std::endl;
+        }
+        else
+        {
+            std::cout
+                << "Matcher now prefetching "
+                << m_distance
+                << " iteration"
+                << ((m_distance == 1) ? "" : "s")
+                << " ahead."
+                << std::endl
+                << std::endl;
+        }
+    }
+
+
+    ICommand::Documentation PrefetchCommand::GetDocumentation()
+    {
+        return Documentation(
+            "prefetch",
+            "Set the matcher's prefetch distance.",
+            "prefetch <iterations>\n"
+            "  Set the number of iterations ahead that the matcher\n"
+            "  prefetches row data. Zero disables prefetching.\n"
+            "  The initial value is calibrated when the index starts."
+        );
+    }
+}
@@ -76,8 +76,12 @@ namespace BitFunnel
             auto instrumentation =
                 QueryRunner::Run(m_query.c_str(),
                                  GetEnvironment().GetSimpleIndex(),
-                                 GetEnvironment().GetCompilerMode(),
-                                 GetEnvironment().GetCacheLineCountMode());
+                                 GetEnvironment().GetMatcherMode(),
+                                 GetEnvironment().GetCacheLineCountMode(),
+                                 GetEnvironment().GetHardwareCounterMode(),
+                                 &GetEnvironment().GetMatcherCodeCache(),
+                                 GetEnvironment().GetPrefetchDistance(),
+                                 &GetEnvironment().GetQueryLatencies());
 
             std::cout << "Results:" << std::endl;
             CsvTsv::CsvTableFormatter formatter(std::cout);
@@ -107,10 +111,18 @@ namespace BitFunnel
                                  c_threadCount,
                                  queries,
                                  c_iterations,
-                                 GetEnvironment().GetCompilerMode(),
-                                 GetEnvironment().GetCacheLineCountMode());
+                                 GetEnvironment().GetMatcherMode(),
+                                 GetEnvironment().GetCacheLineCountMode(),
+                                 GetEnvironment().GetHardwareCounterMode(),
+                                 &GetEnvironment().GetMatcherCodeCache(),
+                                 GetEnvironment().GetPrefetchDistance());
             std::cout << "Results:" << std::endl;
             statistics.Print(std::cout);
+            GetEnvironment().GetQueryLatencies().Merge(statistics.GetLatencies());
+
+            // Persist matchers compiled for this log so that the next
+            // session can skip compilation for the same plans.
+            GetEnvironment().SaveMatcherCodeCache();
 
             // TODO: unify this with the fileManager that's passed into
             // QueryRunner::Run.
@@ -0,0 +1,112 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iostream>
+#include <string>
+
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "Environment.h"
+#include "RebalanceCommand.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // RebalanceCommand
+    //
+    //*************************************************************************
+    RebalanceCommand::RebalanceCommand(Environment & environment,
+                                       Id id,
+                                       char const * parameters)
+        : TaskBase(environment, id, Type::Synchronous),
+          m_now(false),
+          m_interval(0)
+    {
+        auto token = TaskFactory::GetNextToken(parameters);
+        if (token.empty() || token.compare("now") == 0)
+        {
+            m_now = true;
+        }
+        else
+        {
+            m_interval = stoull(token);
+        }
+    }
+
+
+    void RebalanceCommand::Execute()
+    {
+        IIngestor & ingestor = GetEnvironment().GetIngestor();
+
+        if (m_now)
+        {
+            ingestor.RebalanceShards();
+
+            IShardDefinition const & definition = ingestor.GetShardDefinition();
+            std::cout << "Shard boundaries (max postings):";
+            for (ShardId shard = 0; shard + 1 < definition.GetShardCount(); ++shard)
+            {
+                std::cout << " " << definition.GetMaxPostingCount(shard);
+            }
+            std::cout
+                << std::endl
+                << std::endl;
+        }
+        else
+        {
+            ingestor.SetShardRebalanceInterval(m_interval);
+            if (m_interval == 0)
+            {
+                std::cout
+                    << "Periodic shard rebalancing disabled."
+                    << std::endl
+                    << std::endl;
+            }
+            else
+            {
+                std::cout
+                    << "Rebalancing shards every "
+                    << m_interval
+                    << " documents."
+                    << std::endl
+                    << std::endl;
+            }
+        }
+    }
+
+
+    ICommand::Documentation RebalanceCommand::GetDocumentation()
+    {
+        return Documentation(
+            "rebalance",
+            "Recompute shard boundaries from ingested documents.",
+            "rebalance [now | <documents>]\n"
+            "  With no argument or 'now', recomputes the optimal shard\n"
+            "  boundaries from the posting counts of the documents\n"
+            "  ingested so far. New documents are routed by the new\n"
+            "  boundaries. Otherwise rebalances after every <documents>\n"
+            "  documents are ingested. Zero disables periodic rebalancing."
+        );
+    }
+}
@@ -0,0 +1,331 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BitFunnel/Chunks/DocumentFilters.h"
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Chunks/IChunkManifestIngestor.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IngestChunks.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Index/IShard.h"
+#include "BitFunnel/Plan/IMatchVerifier.h"
+#include "BitFunnel/Plan/VerifyOneQuery.h"
+#include "BitFunnel/Utilities/ReadLines.h"
+#include "BitFunnelTool.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "SamplingComparison.h"
+
+
+namespace BitFunnel
+{
+    SamplingComparison::SamplingComparison(IFileSystem& fileSystem)
+      : m_fileSystem(fileSystem)
+    {
+    }
+
+
+    int SamplingComparison::Main(std::istream& /*input*/,
+                                 std::ostream& output,
+                                 int argc,
+                                 char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "SamplingComparison",
+            "Compare an index configured from the full corpus with one "
+            "configured from a random sample.");
+
+        CmdLine::RequiredParameter<char const *> manifestFileName(
+            "manifestFile",
+            "Path to a file containing the paths to the chunk files to be ingested. "
+            "One chunk file per line. Paths are relative to working directory.");
+
+        CmdLine::RequiredParameter<char const *> queryLogFileName(
+            "queryLog",
+            "Path to a file containing one query per line.");
+
+        CmdLine::RequiredParameter<char const *> fullConfig(
+            "fullConfig",
+            "Existing directory where the full corpus configuration will be "
+            "written.");
+
+        CmdLine::RequiredParameter<char const *> sampleConfig(
+            "sampleConfig",
+            "Existing directory where the sampled configuration will be "
+            "written.");
+
+        CmdLine::RequiredParameter<double> fraction(
+            "fraction",
+            "fraction of corpus to sample.",
+            CmdLine::Range(CmdLine::GreaterThan(0.0),
+                           CmdLine::LessThanOrEqual(1.0)));
+
+        CmdLine::OptionalParameter<int> seed(
+            "seed",
+            "random number generator seed.",
+            12345);
+
+        CmdLine::OptionalParameter<double> density(
+            "density",
+            "Target upper bound for bit density.",
+            0.15,
+            CmdLine::Range(CmdLine::GreaterThan(0.0),
+                           CmdLine::LessThanOrEqual(1.0)));
+
+        CmdLine::OptionalParameter<char const *> treatment(
+            "treatment",
+            "Name of the term treatment to use.",
+            "PrivateSharedRank0And3");
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> gramSize(
+            "gramsize",
+            "Set the maximum ngram size for phrases.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        parser.AddParameter(manifestFileName);
+        parser.AddParameter(queryLogFileName);
+        parser.AddParameter(fullConfig);
+        parser.AddParameter(sampleConfig);
+        parser.AddParameter(fraction);
+        parser.AddParameter(seed);
+        parser.AddParameter(density);
+        parser.AddParameter(treatment);
+        parser.AddParameter(gramSize);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                const std::string gramSizeText = std::to_string(gramSize);
+                const std::string seedText = std::to_string(seed);
+                std::stringstream fractionText;
+                fractionText << static_cast<double>(fraction);
+                std::stringstream densityText;
+                densityText << static_cast<double>(density);
+
+                output << "Configuring from full corpus." << std::endl;
+                Configure(output,
+                          { "BitFunnel",
+                            "statistics",
+                            manifestFileName,
+                            fullConfig,
+                            "-gramsize",
+                            gramSizeText.c_str() },
+                          fullConfig,
+                          treatment,
+                          densityText.str());
+
+                output << "Configuring from sample." << std::endl;
+                Configure(output,
+                          { "BitFunnel",
+                            "statistics",
+                            manifestFileName,
+                            sampleConfig,
+                            "-gramsize",
+                            gramSizeText.c_str(),
+                            "-sample",
+                            seedText.c_str(),
+                            fractionText.str().c_str() },
+                          sampleConfig,
+                          treatment,
+                          densityText.str());
+
+                auto queries = ReadLines(m_fileSystem, queryLogFileName);
+
+                const auto full = Measure(output,
+                                          fullConfig,
+                                          manifestFileName,
+                                          queries,
+                                          static_cast<size_t>(gramSize));
+                const auto sampled = Measure(output,
+                                             sampleConfig,
+                                             manifestFileName,
+                                             queries,
+                                             static_cast<size_t>(gramSize));
+
+                output
+                    << std::endl
+                    << "Sampling rate: " << fraction << std::endl
+                    << "Queries: " << queries.size() << std::endl;
+                Report(output, "full", full);
+                Report(output, "sampled", sampled);
+
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+
+
+    void SamplingComparison::Configure(
+        std::ostream& output,
+        std::vector<char const *> statisticsArgs,
+        char const * configDirectory,
+        char const * treatment,
+        std::string const & density) const
+    {
+        BitFunnelTool tool(m_fileSystem);
+
+        std::stringstream log;
+        if (tool.Main(std::cin,
+                      log,
+                      static_cast<int>(statisticsArgs.size()),
+                      statisticsArgs.data()) != 0)
+        {
+            output << log.str();
+            RecoverableError error("SamplingComparison: statistics failed.");
+            throw error;
+        }
+
+        std::vector<char const *> termTableArgs = {
+            "BitFunnel",
+            "termtable",
+            configDirectory,
+            density.c_str(),
+            treatment
+        };
+
+        if (tool.Main(std::cin,
+                      log,
+                      static_cast<int>(termTableArgs.size()),
+                      termTableArgs.data()) != 0)
+        {
+            output << log.str();
+            RecoverableError error("SamplingComparison: termtable failed.");
+            throw error;
+        }
+    }
+
+
+    SamplingComparison::Measurements SamplingComparison::Measure(
+        std::ostream& output,
+        char const * configDirectory,
+        char const * manifestFileName,
+        std::vector<std::string> const & queries,
+        size_t gramSize) const
+    {
+        output << "Measuring '" << configDirectory << "'." << std::endl;
+
+        auto index = Factories::CreateSimpleIndex(m_fileSystem);
+        index->ConfigureForServing(configDirectory, gramSize, false);
+        index->StartIndex();
+
+        std::vector<std::string> filePaths =
+            ReadLines(m_fileSystem, manifestFileName);
+
+        NopFilter filter;
+        auto manifest = Factories::CreateChunkManifestIngestor(
+            m_fileSystem,
+            nullptr,
+            filePaths,
+            index->GetConfiguration(),
+            index->GetIngestor(),
+            filter,
+            true);
+
+        // Single threaded for repeatable document placement.
+        IngestChunks(*manifest, 1);
+
+        Measurements measurements = {};
+
+        IIngestor & ingestor = index->GetIngestor();
+        size_t rowCount = 0;
+        for (size_t shard = 0; shard < ingestor.GetShardCount(); ++shard)
+        {
+            auto densities = ingestor.GetShard(shard).GetDensities(0);
+            for (auto d : densities)
+            {
+                measurements.m_density += d;
+            }
+            rowCount += densities.size();
+        }
+        if (rowCount > 0)
+        {
+            measurements.m_density /= rowCount;
+        }
+
+        for (auto const & query : queries)
+        {
+            QueryInstrumentation::Data data;
+            auto verifier = VerifyOneQuery(*index,
+                                           query,
+                                           true,
+                                           MatcherMode::Interpreter,
+                                           data);
+            measurements.m_truePositives += verifier->GetTruePositiveCount();
+            measurements.m_falsePositives += verifier->GetFalsePositiveCount();
+            measurements.m_falseNegatives += verifier->GetFalseNegativeCount();
+            measurements.m_quadwords += data.GetQuadwordCount();
+        }
+
+        // ~SimpleIndex() stops the index.
+        return measurements;
+    }
+
+
+    void SamplingComparison::Report(std::ostream& output,
+                                    char const * name,
+                                    Measurements const & measurements)
+    {
+        output
+            << name << ":" << std::endl
+            << "  Mean rank 0 density: " << measurements.m_density << std::endl
+            << "  True positives: " << measurements.m_truePositives << std::endl
+            << "  False positives: " << measurements.m_falsePositives << std::endl
+            << "  False negatives: " << measurements.m_falseNegatives << std::endl
+            << "  SNR: ";
+        if (measurements.m_falsePositives == 0)
+        {
+            output << "infinite";
+        }
+        else
+        {
+            output << static_cast<double>(measurements.m_truePositives) /
+                measurements.m_falsePositives;
+        }
+        output
+            << std::endl
+            << "  Quadwords: " << measurements.m_quadwords << std::endl;
+    }
+}
@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream parameter.
+#include <string>                       // std::string parameter.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/IExecutable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IFileSystem;
+
+    //*************************************************************************
+    //
+    // SamplingComparison
+    //
+    // Measures the cost of configuring an index from a random sample of the
+    // corpus. Builds statistics and TermTables once from the full corpus and
+    // once from a sample, ingests the full corpus with each configuration,
+    // and reports the mean rank 0 bit density, the signal-to-noise ratio over
+    // a query log, and the number of quadwords the matcher scans.
+    //
+    //*************************************************************************
+    class SamplingComparison : public IExecutable
+    {
+    public:
+        SamplingComparison(IFileSystem& fileSystem);
+
+        //
+        // IExecutable methods
+        //
+        virtual int Main(std::istream& input,
+                         std::ostream& output,
+                         int argc,
+                         char const *argv[]) override;
+
+    private:
+        struct Measurements
+        {
+            double m_density;
+            size_t m_truePositives;
+            size_t m_falsePositives;
+            size_t m_falseNegatives;
+            size_t m_quadwords;
+        };
+
+        // Runs the statistics and termtable commands with the arguments in
+        // statisticsArgs, writing the configuration to configDirectory.
+        void Configure(std::ostream& output,
+                       std::vector<char const *> statisticsArgs,
+                       char const * configDirectory,
+                       char const * treatment,
+                       std::string const & density) const;
+
+        Measurements Measure(std::ostream& output,
+                             char const * configDirectory,
+                             char const * manifestFileName,
+                             std::vector<std::string> const & queries,
+                             size_t gramSize) const;
+
+        static void Report(std::ostream& output,
+                           char const * name,
+                           Measurements const & measurements);
+
+        IFileSystem& m_fileSystem;
+    };
+}
@@ -30,13 +30,19 @@
 #include "BitFunnel/Chunks/Factories.h"
 #include "BitFunnel/Chunks/IChunkManifestIngestor.h"
 #include "BitFunnel/Chunks/IChunkProcessor.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
 #include "BitFunnel/Configuration/IFileSystem.h"
 #include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IFactSet.h"
+#include "BitFunnel/Index/IIndexedIdfTable.h"
 #include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/IngestChunks.h"
 #include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Index/IStreamingStatistics.h"
 #include "BitFunnel/Utilities/ReadLines.h"
 #include "BitFunnel/Utilities/Stopwatch.h"
 #include "CmdLineParser/CmdLineParser.h"
@@ -81,10 +87,47 @@ namespace BitFunnel
             1u,
             CmdLine::GreaterThan(0));
 
+        CmdLine::OptionalParameterList streaming(
+            "streaming",
+            "Compute statistics without building an index, spilling term "
+            "counts to disk to bound memory use.");
+        CmdLine::RequiredParameter<int> maxTerms(
+            "max terms",
+            "number of terms held in memory per shard before spilling.",
+            CmdLine::GreaterThan(0));
+        streaming.AddParameter(maxTerms);
+
+        CmdLine::OptionalParameterList sample(
+            "sample",
+            "Estimate statistics from a random fraction of the corpus. "
+            "Implies -streaming. Also writes confidence bounds for the "
+            "estimated document frequencies.");
+        CmdLine::RequiredParameter<int> seed(
+            "seed",
+            "random number generator seed.");
+        CmdLine::RequiredParameter<double> fraction(
+            "fraction",
+            "fraction of corpus to sample.",
+            CmdLine::Range(CmdLine::GreaterThan(0.0),
+                           CmdLine::LessThanOrEqual(1.0)));
+        sample.AddParameter(seed);
+        sample.AddParameter(fraction);
+
+        CmdLine::OptionalParameter<int> threadCount(
+            "threads",
+            "Number of threads counting terms with -streaming or -sample. "
+            "With -sample, the documents chosen for a seed are only "
+            "reproducible with one thread.",
+            1,
+            CmdLine::GreaterThan(0));
+
         parser.AddParameter(manifestFileName);
         parser.AddParameter(outputPath);
         parser.AddParameter(termToText);
         parser.AddParameter(gramSize);
+        parser.AddParameter(streaming);
+        parser.AddParameter(sample);
+        parser.AddParameter(threadCount);
 
         int returnCode = 1;
 
@@ -92,12 +135,44 @@ namespace BitFunnel
         {
             try
             {
-                LoadAndIngestChunkList(output,
-                                       outputPath,
-                                       manifestFileName,
-                                       gramSize,
-                                       true,
-                                       termToText.IsActivated());
+                if (sample.IsActivated())
+                {
+                    RandomDocumentFilter filter(fraction,
+                                                static_cast<unsigned>(seed));
+                    StreamChunkList(output,
+                                    outputPath,
+                                    manifestFileName,
+                                    gramSize,
+                                    termToText.IsActivated(),
+                                    streaming.IsActivated() ?
+                                        static_cast<size_t>(maxTerms) :
+                                        c_defaultMaxTermsInMemory,
+                                    filter,
+                                    fraction,
+                                    static_cast<size_t>(threadCount));
+                }
+                else if (streaming.IsActivated())
+                {
+                    NopFilter filter;
+                    StreamChunkList(output,
+                                    outputPath,
+                                    manifestFileName,
+                                    gramSize,
+                                    termToText.IsActivated(),
+                                    static_cast<size_t>(maxTerms),
+                                    filter,
+                                    1.0,
+                                    static_cast<size_t>(threadCount));
+                }
+                else
+                {
+                    LoadAndIngestChunkList(output,
+                                           outputPath,
+                                           manifestFileName,
+                                           gramSize,
+                                           true,
+                                           termToText.IsActivated());
+                }
                 returnCode = 0;
             }
             catch (RecoverableError e)
@@ -188,4 +263,80 @@ namespace BitFunnel
             ingestor.WriteStatistics(index->GetFileManager(), termToText);
         }
     }
+
+
+    void StatisticsBuilder::StreamChunkList(
+        std::ostream& output,
+        char const * intermediateDirectory,
+        char const * chunkListFileName,
+        // TODO: gramSize should be unsigned once CmdLineParser supports unsigned.
+        int gramSize,
+        bool generateTermToText,
+        size_t maxTermsInMemory,
+        IDocumentFilter & filter,
+        double samplingRate,
+        size_t threadCount) const
+    {
+        auto fileManager = Factories::CreateFileManager(intermediateDirectory,
+                                                        intermediateDirectory,
+                                                        intermediateDirectory,
+                                                        m_fileSystem);
+
+        // As in ISimpleIndex::ConfigureForStatistics(), terms are created
+        // with an empty IndexedIdfTable and a single shard.
+        auto shardDefinition = Factories::CreateShardDefinition();
+        auto idfTable = Factories::CreateIndexedIdfTable();
+        auto facts = Factories::CreateFactSet();
+        auto configuration =
+            Factories::CreateConfiguration(static_cast<size_t>(gramSize),
+                                           generateTermToText,
+                                           *idfTable,
+                                           *facts);
+
+        auto statistics =
+            Factories::CreateStreamingStatistics(*fileManager,
+                                                 *shardDefinition,
+                                                 maxTermsInMemory,
+                                                 samplingRate);
+
+        output
+            << "Loading chunk list file '" << chunkListFileName << "'" << std::endl
+            << "Temp dir: '" << intermediateDirectory << "'"<< std::endl;
+
+        std::vector<std::string> filePaths = ReadLines(m_fileSystem, chunkListFileName);
+
+        output << "Reading " << filePaths.size() << " files\n";
+
+        auto manifest = Factories::CreateChunkManifestStatistics(
+            m_fileSystem,
+            filePaths,
+            *configuration,
+            *statistics,
+            filter);
+
+        output << "Counting terms . . ." << std::endl;
+
+        Stopwatch stopwatch;
+
+        IngestChunks(*manifest, threadCount);
+
+        const double elapsedTime = stopwatch.ElapsedTime();
+        const size_t totalSourceBytes = statistics->GetTotalSourceBytesIngested();
+
+        output
+            << "Counting complete." << std::endl
+            << "  Document count: " << statistics->GetDocumentCount() << std::endl
+            << "  Sampling rate: " << samplingRate << std::endl
+            << "  Sorted runs: " << statistics->GetRunCount() << std::endl
+            << "  Counting time = " << elapsedTime << std::endl
+            << "  Counting rate (bytes/s): "
+            << totalSourceBytes / elapsedTime << std::endl;
+
+        ITermToText const * termToText = nullptr;
+        if (configuration->KeepTermText())
+        {
+            termToText = &configuration->GetTermToText();
+        }
+        statistics->WriteStatistics(termToText);
+    }
 }
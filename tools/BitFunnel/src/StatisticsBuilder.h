@@ -26,6 +26,7 @@
 
 namespace BitFunnel
 {
+    class IDocumentFilter;
     class IFileSystem;
 
     class StatisticsBuilder : public IExecutable
@@ -50,6 +51,29 @@ namespace BitFunnel
             bool generateStatistics,
             bool generateTermToText) const;
 
+        // Computes the same statistics as LoadAndIngestChunkList() without
+        // building an index. Term counts are spilled to disk once a shard's
+        // table holds maxTermsInMemory terms, so memory use does not grow
+        // with the size of the corpus. Only documents accepted by filter
+        // are counted. When filter keeps a random sample of the corpus,
+        // samplingRate is the fraction kept and the frequencies written are
+        // estimates for the full corpus. Chunks are processed on threadCount
+        // threads.
+        void StreamChunkList(
+            std::ostream& output,
+            char const * intermediateDirectory,
+            char const * chunkListFileName,
+            int gramSize,
+            bool generateTermToText,
+            size_t maxTermsInMemory,
+            IDocumentFilter & filter,
+            double samplingRate,
+            size_t threadCount) const;
+
+        // Number of terms held in memory per shard when sampling without an
+        // explicit -streaming limit.
+        static const size_t c_defaultMaxTermsInMemory = 1ull << 24;
+
         IFileSystem& m_fileSystem;
     };
 }
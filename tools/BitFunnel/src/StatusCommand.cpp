@@ -23,9 +23,15 @@
 #include <iostream>
 
 #include "BitFunnel/BitFunnelTypes.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
 #include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IRecycler.h"
 #include "BitFunnel/Index/IShard.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
 #include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Index/Token.h"
+#include "BitFunnel/Plan/IMatcherCodeCache.h"
+#include "BitFunnel/Plan/QueryRunner.h"
 #include "Environment.h"
 #include "StatusCommand.h"
 
@@ -87,11 +93,97 @@ namespace BitFunnel
         }
         std::cout << std::endl;
 
+        // Per shard memory use. Row table bytes/document comes from the
+        // shard's TermTable. Slice bytes/document divides the memory in the
+        // shard's slices by its active documents, so it also reflects
+        // partially filled slices.
+        IIngestor & ingestor = GetEnvironment().GetIngestor();
+        IShardDefinition const & definition = ingestor.GetShardDefinition();
+        for (ShardId shard = 0; shard < ingestor.GetShardCount(); ++shard)
+        {
+            double termTableBytes = 0;
+            ITermTable const & termTable =
+                GetEnvironment().GetSimpleIndex().GetTermTable(shard);
+            for (Rank rank = 0; rank < c_maxRankValue; ++rank)
+            {
+                termTableBytes += termTable.GetBytesPerDocument(rank);
+            }
+
+            IShard & s = ingestor.GetShard(shard);
+            size_t sliceCount = 0;
+            {
+                auto token = ingestor.GetTokenManager().RequestToken();
+                sliceCount = s.GetSliceBuffers().size();
+            }
+            const size_t documentCount = ingestor.GetShardDocumentCount(shard);
+
+            std::cout << "Shard " << shard << ": ";
+            if (shard + 1 < definition.GetShardCount())
+            {
+                std::cout
+                    << "up to "
+                    << definition.GetMaxPostingCount(shard)
+                    << " postings, ";
+            }
+            else if (shard + 1 == definition.GetShardCount())
+            {
+                std::cout << "remaining postings, ";
+            }
+            else
+            {
+                std::cout << "draining, ";
+            }
+            std::cout
+                << documentCount << " documents, "
+                << termTableBytes << " bytes/document (row tables)";
+            if (documentCount > 0)
+            {
+                std::cout
+                    << ", "
+                    << static_cast<double>(sliceCount * s.GetSliceBufferSize())
+                       / documentCount
+                    << " bytes/document (slices)";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+
         std::cout
             << "Slice capacity: "
             << GetEnvironment().GetIngestor().GetShard(0).GetSliceCapacity()
             << std::endl;
         std::cout << std::endl;
+
+        IRecycler const & recycler = GetEnvironment().GetSimpleIndex().GetRecycler();
+        std::cout
+            << "Pending reclamation: "
+            << recycler.GetPendingByteCount()
+            << " bytes in "
+            << recycler.GetPendingItemCount()
+            << " items"
+            << std::endl;
+        std::cout << std::endl;
+
+        std::cout
+            << "Compiled matchers cached: "
+            << GetEnvironment().GetMatcherCodeCache().GetEntryCount()
+            << std::endl;
+        std::cout << std::endl;
+
+        std::cout
+            << "Matcher prefetch distance: "
+            << GetEnvironment().GetPrefetchDistance()
+            << std::endl;
+        std::cout << std::endl;
+
+        QueryRunner::Latencies const & latencies =
+            GetEnvironment().GetQueryLatencies();
+        if (latencies.GetTotal().GetCount() > 0)
+        {
+            std::cout << "Queries processed this session:" << std::endl;
+            latencies.Print(std::cout);
+            std::cout << std::endl;
+        }
     }
 
 
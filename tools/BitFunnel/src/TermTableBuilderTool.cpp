@@ -21,7 +21,12 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
 
 #include "BitFunnel/BitFunnelTypes.h"
 #include "BitFunnel/Configuration/Factories.h"
@@ -35,6 +40,9 @@
 #include "BitFunnel/Index/ITermTableBuilder.h"
 #include "BitFunnel/Index/ITermTreatment.h"
 #include "BitFunnel/Index/ITermTreatmentFactory.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
 #include "BitFunnel/Utilities/Stopwatch.h"
 #include "CmdLineParser/CmdLineParser.h"
 #include "TermTableBuilderTool.h"
@@ -42,6 +50,33 @@
 
 namespace BitFunnel
 {
+    //*************************************************************************
+    //
+    // ShardTaskProcessor builds the TermTable for one shard per task.
+    //
+    //*************************************************************************
+    class ShardTaskProcessor : public ITaskProcessor
+    {
+    public:
+        ShardTaskProcessor(std::function<void(size_t)> const & build)
+          : m_build(build)
+        {
+        }
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            m_build(taskId);
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+    private:
+        std::function<void(size_t)> m_build;
+    };
+
+
     TermTableBuilderTool::TermTableBuilderTool(IFileSystem& fileSystem)
       : m_fileSystem(fileSystem)
     {
@@ -82,12 +117,28 @@ namespace BitFunnel
             0.0,
             CmdLine::GreaterThan(0.0));
 
+        // TODO: These parameters should be unsigned, but it doesn't seem to
+        // work with CmdLineParser.
+        CmdLine::OptionalParameter<int> shardCount(
+            "shards",
+            "Number of shards to build TermTables for.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> threadCount(
+            "threads",
+            "Number of threads. Shards are built concurrently, and each "
+            "shard's ranks are assigned concurrently.",
+            1u,
+            CmdLine::GreaterThan(0));
 
         parser.AddParameter(config);
         parser.AddParameter(density);
         parser.AddParameter(treatment);
         parser.AddParameter(variant);
         parser.AddParameter(snr);
+        parser.AddParameter(shardCount);
+        parser.AddParameter(threadCount);
 
         int returnCode = 1;
 
@@ -95,7 +146,6 @@ namespace BitFunnel
         {
             try
             {
-                ShardId shard = 0;
                 double adhocFrequency = density;
 
                 // Check if treatmentName starts with Classic. This is a bit of
@@ -114,17 +164,84 @@ namespace BitFunnel
                     adhocFrequency = 0.01;
                 }
 
+                // TODO: these casts can be removed when shardCount and
+                // threadCount are fixed to be unsigned.
+                const size_t shards = static_cast<size_t>(shardCount);
+                const size_t threads = static_cast<size_t>(threadCount);
 
-                BuildTermTable(output,
-                               config,
-                               treatment,
-                               shard,
-                               density,
-                               snr,
-                               adhocFrequency,
-                               variant);
+                // Shards are built concurrently. Threads left over are
+                // used for concurrent row assignment within each shard.
+                const size_t concurrentShards = (std::min)(shards, threads);
+                const size_t threadsPerShard = threads / concurrentShards;
+
+                // Each shard writes its progress to its own stream so that
+                // the output of concurrent builds is not interleaved.
+                std::vector<std::stringstream> shardOutputs(shards);
+                std::vector<std::string> errors(shards);
+
+                auto build = [&](size_t shard)
+                {
+                    try
+                    {
+                        BuildTermTable(shardOutputs[shard],
+                                       config,
+                                       treatment,
+                                       static_cast<ShardId>(shard),
+                                       density,
+                                       snr,
+                                       adhocFrequency,
+                                       variant,
+                                       threadsPerShard);
+                    }
+                    catch (RecoverableError e)
+                    {
+                        errors[shard] = e.what();
+                    }
+                };
+
+                Stopwatch stopwatch;
+                if (concurrentShards > 1)
+                {
+                    std::vector<std::unique_ptr<ITaskProcessor>> processors;
+                    for (size_t i = 0; i < concurrentShards; ++i)
+                    {
+                        processors.push_back(
+                            std::unique_ptr<ITaskProcessor>(
+                                new ShardTaskProcessor(build)));
+                    }
+
+                    auto distributor =
+                        Factories::CreateTaskDistributor(processors, shards);
+                    distributor->WaitForCompletion();
+                }
+                else
+                {
+                    for (size_t shard = 0; shard < shards; ++shard)
+                    {
+                        build(shard);
+                    }
+                }
 
                 returnCode = 0;
+                for (size_t shard = 0; shard < shards; ++shard)
+                {
+                    if (shards > 1)
+                    {
+                        output << "Shard " << shard << ":" << std::endl;
+                    }
+                    output << shardOutputs[shard].str();
+                    if (!errors[shard].empty())
+                    {
+                        output << "Error: " << errors[shard] << std::endl;
+                        returnCode = 1;
+                    }
+                }
+
+                if (shards > 1)
+                {
+                    output << "Built " << shards << " TermTables in "
+                           << stopwatch.ElapsedTime() << " seconds." << std::endl;
+                }
             }
             catch (RecoverableError e)
             {
@@ -160,7 +277,8 @@ namespace BitFunnel
         double density,
         double snr,
         double adhocFrequency,
-        int variant) const
+        int variant,
+        size_t threadCount) const
     {
         output << "Loading files for TermTable build." << std::endl;
 
@@ -187,7 +305,8 @@ namespace BitFunnel
                                               *treatment,
                                               *terms,
                                               *facts,
-                                              *termTable));
+                                              *termTable,
+                                              threadCount));
 
         termTableBuilderTool->Print(output);
         termTableBuilderTool->Print(*fileManager->TermTableStatistics(shard).OpenForWrite());
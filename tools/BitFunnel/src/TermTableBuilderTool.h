@@ -50,7 +50,8 @@ namespace BitFunnel
             double density,
             double snr,
             double adhocFrequency,
-            int variant) const;
+            int variant,
+            size_t threadCount) const;
 
         //
         // Constructor parameters.
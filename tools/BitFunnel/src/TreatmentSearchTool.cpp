@@ -0,0 +1,260 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IDocumentFrequencyTable.h"
+#include "BitFunnel/Index/IFactSet.h"
+#include "BitFunnel/Index/IIndexedIdfTable.h"
+#include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Index/ITermTableBuilder.h"
+#include "BitFunnel/Index/ITermTreatment.h"
+#include "BitFunnel/Index/ITermTreatmentSearch.h"
+#include "BitFunnel/Utilities/ReadLines.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "TreatmentSearchTool.h"
+
+
+namespace BitFunnel
+{
+    TreatmentSearchTool::TreatmentSearchTool(IFileSystem& fileSystem)
+      : m_fileSystem(fileSystem)
+    {
+    }
+
+
+    int TreatmentSearchTool::Main(std::istream& /*input*/,
+                                  std::ostream& output,
+                                  int argc,
+                                  char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "TreatmentSearchTool",
+            "Search term treatments for the one with the fewest expected "
+            "quadwords per query and write its TermTable.");
+
+        CmdLine::RequiredParameter<char const *> config(
+            "config",
+            "Path to configuration directory containing files generated "
+            "by the 'BitFunnel statistics'.command.");
+
+        CmdLine::RequiredParameter<char const *> queryLog(
+            "queryLog",
+            "Path to a file containing one query per line.");
+
+        CmdLine::OptionalParameter<double> snr(
+            "snr",
+            "Minimum signal-to-noise ratio for every term.",
+            10.0,
+            CmdLine::GreaterThan(0.0));
+
+        CmdLine::OptionalParameter<double> budget(
+            "budget",
+            "Maximum bits per document. Zero means no budget.",
+            0.0,
+            CmdLine::GreaterThanOrEqual(0.0));
+
+        CmdLine::OptionalParameter<int> maxRank(
+            "maxrank",
+            "Highest rank considered for rows.",
+            3,
+            CmdLine::Range(CmdLine::GreaterThanOrEqual(0),
+                           CmdLine::LessThanOrEqual(5)));
+
+        CmdLine::OptionalParameterList densities(
+            "densities",
+            "Range of bit densities to search. Defaults to 0.05 to 0.3 in "
+            "steps of 0.05.");
+        CmdLine::RequiredParameter<double> minDensity(
+            "min",
+            "lowest density.",
+            CmdLine::Range(CmdLine::GreaterThan(0.0),
+                           CmdLine::LessThanOrEqual(1.0)));
+        CmdLine::RequiredParameter<double> maxDensity(
+            "max",
+            "highest density.",
+            CmdLine::Range(CmdLine::GreaterThan(0.0),
+                           CmdLine::LessThanOrEqual(1.0)));
+        CmdLine::RequiredParameter<double> step(
+            "step",
+            "step between densities.",
+            CmdLine::GreaterThan(0.0));
+        densities.AddParameter(minDensity);
+        densities.AddParameter(maxDensity);
+        densities.AddParameter(step);
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to
+        // work with CmdLineParser.
+        CmdLine::OptionalParameter<int> shardCount(
+            "shards",
+            "Number of shards to build TermTables for.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        parser.AddParameter(config);
+        parser.AddParameter(queryLog);
+        parser.AddParameter(snr);
+        parser.AddParameter(budget);
+        parser.AddParameter(maxRank);
+        parser.AddParameter(densities);
+        parser.AddParameter(shardCount);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                double low = 0.05;
+                double high = 0.3;
+                double increment = 0.05;
+                if (densities.IsActivated())
+                {
+                    low = minDensity;
+                    high = maxDensity;
+                    increment = step;
+                }
+
+                std::vector<double> candidates;
+                // Half a step of slack keeps the last density despite
+                // rounding.
+                for (double d = low; d <= high + increment / 2; d += increment)
+                {
+                    candidates.push_back(d);
+                }
+
+                for (int shard = 0; shard < shardCount; ++shard)
+                {
+                    if (shardCount > 1)
+                    {
+                        output << "Shard " << shard << ":" << std::endl;
+                    }
+                    SearchShard(output,
+                                config,
+                                queryLog,
+                                static_cast<ShardId>(shard),
+                                candidates,
+                                snr,
+                                budget,
+                                static_cast<Rank>(maxRank));
+                }
+
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+
+
+    void TreatmentSearchTool::SearchShard(
+        std::ostream& output,
+        char const * configDirectory,
+        char const * queryLogFileName,
+        ShardId shard,
+        std::vector<double> const & densities,
+        double snr,
+        double bitsPerDocumentBudget,
+        Rank maxRank) const
+    {
+        auto fileManager = Factories::CreateFileManager(configDirectory,
+                                                        configDirectory,
+                                                        configDirectory,
+                                                        m_fileSystem);
+
+        auto terms(Factories::CreateDocumentFrequencyTable(
+            *fileManager->DocFreqTable(shard).OpenForRead()));
+
+        // Query terms get their idf from the shard's IndexedIdfTable. Terms
+        // missing from the corpus get the maximum idf.
+        auto idfTable(Factories::CreateIndexedIdfTable(
+            *fileManager->IndexedIdfTable(shard).OpenForRead(),
+            Term::c_maxIdfX10Value));
+        auto facts(Factories::CreateFactSet());
+        auto configuration(Factories::CreateConfiguration(1,
+                                                          false,
+                                                          *idfTable,
+                                                          *facts));
+
+        auto search(Factories::CreateTermTreatmentSearch(*terms,
+                                                         snr,
+                                                         bitsPerDocumentBudget,
+                                                         maxRank));
+
+        // Queries are treated as conjunctions of whitespace separated
+        // unigrams in stream 0, the format written by 'BitFunnel querylog'.
+        auto queries = ReadLines(m_fileSystem, queryLogFileName);
+        std::vector<Term> queryTerms;
+        for (auto const & query : queries)
+        {
+            queryTerms.clear();
+            std::stringstream tokens(query);
+            std::string token;
+            while (tokens >> token)
+            {
+                queryTerms.push_back(Term(token.c_str(), 0, *configuration));
+            }
+            search->AddQuery(queryTerms);
+        }
+
+        search->Search(densities);
+        search->Print(output);
+
+        const size_t best = search->GetBestCandidate();
+        const double density = search->GetCandidate(best).GetDensity();
+        output << "Best density: " << density << std::endl;
+
+        auto treatment(search->CreateTreatment(best));
+        auto termTable(Factories::CreateTermTable());
+        auto builder(Factories::CreateTermTableBuilder(density,
+                                                       density,
+                                                       *treatment,
+                                                       *terms,
+                                                       *facts,
+                                                       *termTable,
+                                                       1));
+
+        builder->Print(output);
+        builder->Print(*fileManager->TermTableStatistics(shard).OpenForWrite());
+
+        output << "Writing TermTable files." << std::endl;
+        termTable->Write(*fileManager->TermTable(shard).OpenForWrite());
+    }
+}
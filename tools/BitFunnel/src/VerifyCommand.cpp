@@ -83,7 +83,7 @@ namespace BitFunnel
             auto verifier = VerifyOneQuery(GetEnvironment().GetSimpleIndex(),
                                            m_query,
                                            true,
-                                           GetEnvironment().GetCompilerMode());
+                                           GetEnvironment().GetMatcherMode());
             std::cout << "True positive count: "
                 << verifier->GetTruePositiveCount()
                 << std::endl
@@ -198,7 +198,7 @@ namespace BitFunnel
                 auto verifier = VerifyOneQuery(GetEnvironment().GetSimpleIndex(),
                                                query,
                                                !m_isOutput,
-                                               GetEnvironment().GetCompilerMode());
+                                               GetEnvironment().GetMatcherMode());
                 queryString = verifier->GetQuery();
 
                 if (!m_isOutput)
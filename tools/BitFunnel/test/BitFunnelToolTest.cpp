@@ -31,6 +31,7 @@
 #include "BitFunnel/Configuration/Factories.h"
 #include "BitFunnel/Configuration/IFileSystem.h"
 #include "BitFunnel/Data/Sonnets.h"
+#include "BitFunnel/IFileManager.h"
 #include "BitFunnelTool.h"
 
 
@@ -147,4 +148,77 @@ namespace BitFunnel
                       argv.data());
         }
     }
+
+
+    // Runs the benchmark on a small corpus in a fresh RAM filesystem.
+    // Returns the first chunk of the generated corpus and copies the query
+    // log and the results into queryLog and results.
+    static std::string RunBenchmark(char const * seed,
+                                    std::string& queryLog,
+                                    std::string& results)
+    {
+        auto fileSystem = BitFunnel::Factories::CreateRAMFileSystem();
+        auto fileManager =
+            BitFunnel::Factories::CreateFileManager("bench",
+                                                    "bench",
+                                                    "bench",
+                                                    *fileSystem);
+
+        BitFunnel::BitFunnelTool tool(*fileSystem);
+        std::vector<char const *> argv = {
+            "BitFunnel",
+            "benchmark",
+            "bench",
+            "-documents", "300",
+            "-chunks", "3",
+            "-vocabulary", "1000",
+            "-terms", "20",
+            "-queries", "50",
+            "-threads", "2",
+            "-seed", seed
+        };
+
+        std::stringstream output;
+        EXPECT_EQ(0, tool.Main(std::cin,
+                               output,
+                               static_cast<int>(argv.size()),
+                               argv.data()));
+
+        auto read = [](std::unique_ptr<std::istream> in)
+        {
+            std::stringstream contents;
+            contents << in->rdbuf();
+            return contents.str();
+        };
+
+        queryLog = read(fileManager->QueryLog().OpenForRead());
+        results = read(fileManager->BenchmarkResults().OpenForRead());
+        return read(fileManager->Chunk(0).OpenForRead());
+    }
+
+
+    TEST(BitFunnelTool, BenchmarkIsReproducible)
+    {
+        std::string queryLog1;
+        std::string results1;
+        std::string chunk1 = RunBenchmark("7", queryLog1, results1);
+
+        std::string queryLog2;
+        std::string results2;
+        std::string chunk2 = RunBenchmark("7", queryLog2, results2);
+
+        EXPECT_FALSE(chunk1.empty());
+        EXPECT_EQ(chunk1, chunk2);
+        EXPECT_EQ(queryLog1, queryLog2);
+
+        std::string queryLog3;
+        std::string results3;
+        std::string chunk3 = RunBenchmark("8", queryLog3, results3);
+        EXPECT_NE(chunk1, chunk3);
+
+        EXPECT_NE(std::string::npos, results1.find("ingest_documents,2,300\n"));
+        EXPECT_NE(std::string::npos, results1.find("queries_per_second,1,"));
+        EXPECT_NE(std::string::npos, results1.find("queries_per_second,2,"));
+        EXPECT_NE(std::string::npos, results1.find("latency_p99_us,2,"));
+    }
 }